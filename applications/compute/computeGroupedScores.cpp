@@ -20,6 +20,8 @@ namespace bpo = boost::program_options;
 
 std::string matrix = "", output = "", method = "";
 std::vector<std::string> metadata, columns;
+bool sparse = false;
+unsigned int num_threads = 0;
 
 MatrixReaderOptions options;
 
@@ -32,7 +34,9 @@ bool parseArguments(int argc, char* argv[]){
 		("output,o", bpo::value<std::string>(&output)->required(), "Name of the output file.")
 		("metadata,e", bpo::value<std::vector<std::string>>(&metadata)->multitoken()->required(), "List of a tab-separated metadata files in which the first column is a sample and the following columns are metadata information about that sample. One column has to store the name of the group to which the sample belongs. This file needs to have a header that has one element less than the following rows.")
 		("column,c", bpo::value<std::vector<std::string>>(&columns)->multitoken()->required(), "List of the column names in the metadata file that stores group information.")
-		("method,m", bpo::value<std::string>(&method)->required(), "Method used for scoring.");
+		("method,m", bpo::value<std::string>(&method)->required(), "Method used for scoring.")
+		("sparse,s", bpo::value<bool>(&sparse)->default_value(false)->zero_tokens(), "The expression matrix is a sparse matrix, e.g. the binary output of filterSCMatrix. Only methods that can be computed from the group moments are supported.")
+		("threads,j", bpo::value<unsigned int>(&num_threads)->default_value(0), "Number of threads used for sparse matrices. 0 uses all available cores.");
 
 	try{
 		bpo::store(bpo::command_line_parser(argc, argv).options(desc).run(), vm);
@@ -69,16 +73,26 @@ int main(int argc, char* argv[]){
 			metas.emplace_back(reader.readMetadataFile(strm, columns[i]));
 		}
 		
-		options.split_only_tab = true;
-		auto m = readDenseMatrix(matrix, options);
-		
 		auto result = DenseMatrix(0,0);
 		GroupedScores calculator;
-		calculator.calculateGroupedScores(m, metas, method, result);
+		if(sparse){
+			auto m = readSparseMatrix(matrix, options);
+			calculator.calculateGroupedScores(m, metas, method, result, num_threads);
+		} else{
+			options.split_only_tab = true;
+			auto m = readDenseMatrix(matrix, options);
+			calculator.calculateGroupedScores(m, metas, method, result);
+		}
 		writeMatrix(result);
 	} catch (std::invalid_argument e){
 		std::cout << e.what() << std::endl;
 		return -1;
+	} catch (const NotImplemented& e){
+		std::cerr << "ERROR: " << e.what() << std::endl;
+		return -1;
+	} catch (const IOError& e){
+		std::cerr << "ERROR: " << e.what() << std::endl;
+		return -1;
 	}
 
 	return 0;
@@ -91,7 +91,7 @@ bool parseArguments(int argc, char* argv[])
 double calculateSum(std::vector<std::tuple<size_t,size_t,double>> regulations, MapNameDatabase& name_database, std::map<std::string, double>& map){
 	double sum = 0;
 	for(std::tuple<size_t,size_t,double> tuple1 : regulations){
-	      std::string name_target_x = name_database(std::get<1>(tuple1));
+	      const std::string& name_target_x = name_database(std::get<1>(tuple1));
 
 	      if(map.find(name_target_x) == map.end()){
 			continue;
@@ -156,7 +156,7 @@ int runScoreAnalysis(std::string& scores_mirna,std::string& scores,std::string&
 			for(std::tuple<size_t,size_t,double> tuple : regulations){
 			      size_t target = std::get<1>(tuple);
 
-			      std::string name_tar = name_database(target);
+			      const std::string& name_tar = name_database(target);
 			      if(map.find(name_tar) == map.end()){
 				continue;
 			      }
@@ -273,7 +273,7 @@ int runMatrixAnalysis(std::string& expr1, std::string& method, std::string& grou
 			for(std::tuple<size_t,size_t,double> tuple : regulations){
 			      size_t target = std::get<1>(tuple);
 
-			      std::string name_tar = name_database(target);
+			      const std::string& name_tar = name_database(target);
 			      if(map.find(name_tar) == map.end()){
 				continue;
 			      }
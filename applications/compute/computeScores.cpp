@@ -1,14 +1,19 @@
 #include <iostream>
 #include <cmath>
 #include <cstdlib>
+#include <fstream>
+#include <future>
 #include <tuple>
 
 #include <boost/program_options.hpp>
 
 #include <genetrail2/core/MatrixHTest.h>
 #include <genetrail2/core/GeneSetWriter.h>
+#include <genetrail2/core/DenseMatrixBlockReader.h>
 #include <genetrail2/core/DenseMatrixReader.h>
 #include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/SparseMatrix.h>
+#include <genetrail2/core/SparseMatrixHTest.h>
 #include <genetrail2/core/TextFile.h>
 
 #include "../matrixTools.h"
@@ -17,7 +22,9 @@ using namespace GeneTrail;
 namespace bpo = boost::program_options;
 
 std::string expr1 = "", expr2 = "", output = "", method = "", groups = "";
-bool binary = false;
+bool binary = false, sparse = false;
+unsigned int num_threads = 0;
+size_t block_rows = 0, memory_budget = 0;
 
 MatrixReaderOptions matrixOptions;
 
@@ -34,7 +41,11 @@ bool parseArguments(int argc, char* argv[])
 		("no-row-names,r", bpo::value<bool>(&matrixOptions.no_rownames)->default_value(false)->zero_tokens(), "Does the file contain row names.")
 		("no-col-names,c", bpo::value<bool>(&matrixOptions.no_colnames)->default_value(false)->zero_tokens(), "Does the file contain column names.")
 		("add-col-name,a", bpo::value<bool>(&matrixOptions.additional_colname)->default_value(false)->zero_tokens(), "File containing two lines specifying which rownames belong to which group.")
-		("method,m", bpo::value<std::string>(&method)->required(), "Method used for scoring.");
+		("method,m", bpo::value<std::string>(&method)->required(), "Method used for scoring.")
+		("sparse,s", bpo::value<bool>(&sparse)->default_value(false)->zero_tokens(), "The expression matrix is a sparse matrix, e.g. the binary output of filterSCMatrix. Only methods that can be computed from the group moments are supported.")
+		("threads,j", bpo::value<unsigned int>(&num_threads)->default_value(0), "Number of threads used for sparse matrices. 0 uses all available cores.")
+		("block-rows,b", bpo::value<size_t>(&block_rows)->default_value(0), "Read and score the matrix in blocks of this many rows instead of loading it completely. 0 disables streaming unless a memory budget is given.")
+		("memory-budget", bpo::value<size_t>(&memory_budget)->default_value(0), "Memory (in MiB) available for matrix blocks. Implies streaming, the block size is derived from the budget unless --block-rows is given.");
 
 	try
 	{
@@ -52,6 +63,84 @@ bool parseArguments(int argc, char* argv[])
 }
 
 
+bool hasNaN(const Scores& scores)
+{
+	for(const auto& score : scores.scores()) {
+		if(std::isnan(score)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Scores the matrix block by block. While a block is scored, the next one
+ * is read in a separate thread. The scores are appended to the output in
+ * the order of the rows, so that the result is identical to scoring the
+ * whole matrix at once.
+ */
+int streamScores(const std::vector<std::string>& reference,
+                 const std::vector<std::string>& sample)
+{
+	MatrixHTest htest;
+
+	if(MatrixHTestFactory().getDescriptor(method).supports_vectors ==
+	   MatrixHTestFactory::SupportsVectors::Vectorized) {
+		std::cerr << "ERROR: Method '" << method
+		          << "' uses all rows jointly and cannot be computed in blocks."
+		          << std::endl;
+		return -6;
+	}
+
+	DenseMatrixBlockReader reader(expr1, matrixReaderFlags(matrixOptions));
+
+	if(block_rows == 0) {
+		block_rows = DenseMatrixBlockReader::rowsForBudget(
+		    memory_budget * 1024 * 1024, reader.cols());
+	}
+
+	std::ofstream out(output);
+	if(!out) {
+		std::cerr << "ERROR: Could not open " << output << " for writing."
+		          << std::endl;
+		return -4;
+	}
+
+	DenseMatrix current(0, 0), next(0, 0);
+	if(!reader.next(current, block_rows)) {
+		return 0;
+	}
+
+	// The columns are identical for all blocks
+	const auto ref_indices = getIndices(current, reference, "reference");
+	const auto sam_indices = getIndices(current, sample, "test");
+
+	GeneSetWriter writer;
+	bool nan_warning = false;
+	bool has_next = true;
+	while(has_next) {
+		auto prefetch = std::async(std::launch::async, [&reader, &next]() {
+			return reader.next(next, block_rows);
+		});
+
+		DenseColumnSubset ref(&current, ref_indices), sam(&current, sam_indices);
+		auto scores = htest.test(method, ref, sam);
+
+		if(!nan_warning && hasNaN(scores)) {
+			std::cerr << "WARNING: NaNs generated during score computation.\n";
+			nan_warning = true;
+		}
+
+		writer.writeScoringFile(scores, out);
+
+		has_next = prefetch.get();
+		std::swap(current, next);
+	}
+
+	return 0;
+}
+
 int main(int argc, char* argv[])
 {
 	if(!parseArguments(argc, argv))
@@ -65,16 +154,20 @@ int main(int argc, char* argv[])
 		return -2;
 	}
 
-	TextFile t(groups, ",", std::set<std::string>());
-	DenseMatrix matrix(0,0);
+	if(sparse && expr2 != "") {
+		std::cerr << "ERROR: Only a single sparse matrix is supported." << std::endl;
+		return -2;
+	}
 
-	try {
-		matrix = buildDenseMatrix(expr1, expr2, matrixOptions);
-	} catch(const IOError& e) {
-		std::cerr << "ERROR: Could not open input data matrix for reading." << std::endl;
-		return -4;
+	const bool stream = block_rows > 0 || memory_budget > 0;
+
+	if(stream && (sparse || expr2 != "")) {
+		std::cerr << "ERROR: Streaming is only supported for a single dense matrix." << std::endl;
+		return -2;
 	}
 
+	TextFile t(groups, ",", std::set<std::string>());
+
 	std::vector<std::string> reference, sample;
 	try {
 		reference = t.read();
@@ -84,18 +177,55 @@ int main(int argc, char* argv[])
 		return -5;
 	}
 
+	if(stream) {
+		try {
+			return streamScores(reference, sample);
+		} catch(const EmptyGroup& e) {
+			std::cerr << "ERROR: " << e.what() << "\n";
+			return -3;
+		} catch(const std::invalid_argument& e) {
+			std::cerr << "ERROR: Unknown method '" << e.what() << "'\n";
+			return -6;
+		} catch(const NotImplemented& e) {
+			std::cerr << "ERROR: " << e.what() << "\n";
+			return -6;
+		} catch(const IOError& e) {
+			std::cerr << "ERROR: " << e.what() << "\n";
+			return -4;
+		}
+	}
+
+	DenseMatrix matrix(0,0);
+	SparseMatrix sparse_matrix(0,0);
+
 	try {
-		auto subset = splitMatrix(matrix, reference, sample);
+		if(sparse) {
+			sparse_matrix = readSparseMatrix(expr1, matrixOptions);
+		} else {
+			matrix = buildDenseMatrix(expr1, expr2, matrixOptions);
+		}
+	} catch(const IOError& e) {
+		std::cerr << "ERROR: Could not open input data matrix for reading." << std::endl;
+		return -4;
+	}
 
-		MatrixHTest htest;
-		auto gene_set = htest.test(method, std::get<0>(subset), std::get<1>(subset));
+	try {
+		Scores gene_set(std::make_shared<EntityDatabase>());
+		if(sparse) {
+			SparseMatrixHTest htest;
+			htest.setNumberOfThreads(num_threads);
+			gene_set = htest.test(method, sparse_matrix,
+			                      getIndices(sparse_matrix, reference, "reference"),
+			                      getIndices(sparse_matrix, sample, "test"));
+		} else {
+			auto subset = splitMatrix(matrix, reference, sample);
+
+			MatrixHTest htest;
+			gene_set = htest.test(method, std::get<0>(subset), std::get<1>(subset));
+		}
 
-		for(const auto& score : gene_set.scores()) {
-			if(isnan(score)) {
-				std::cerr
-				    << "WARNING: NaNs generated during score computation.\n";
-				break;
-			}
+		if(hasNaN(gene_set)) {
+			std::cerr << "WARNING: NaNs generated during score computation.\n";
 		}
 
 		GeneSetWriter writer;
@@ -106,6 +236,9 @@ int main(int argc, char* argv[])
 	} catch(const std::invalid_argument& e) {
 		std::cerr << "ERROR: Unknown method '" << e.what() << "'\n";
 		return -6;
+	} catch(const NotImplemented& e) {
+		std::cerr << "ERROR: " << e.what() << "\n";
+		return -6;
 	}
 
 	return 0;
@@ -14,7 +14,9 @@
 #include <genetrail2/core/DenseMatrixReader.h>
 #include <genetrail2/core/DenseMatrixWriter.h>
 #include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/Exception.h>
 #include <genetrail2/core/SCMatrixFilter.h>
+#include <genetrail2/core/SparseMatrix.h>
 
 #include "../matrixTools.h"
 
@@ -24,6 +26,7 @@ namespace bpo = boost::program_options;
 FilterParams params;
 std::string matrix = "";
 MatrixReaderOptions options;
+bool sparse_input = false;
 
 bool parseArguments(int argc, char* argv[]){
 	bpo::variables_map vm;
@@ -38,11 +41,18 @@ bool parseArguments(int argc, char* argv[]){
 		("max-mitochondrial", bpo::value<double>(&params.max_mito)->default_value(1), "The maximal percentage of mitochondrial counts allowed for a cell to pass.")
 		("mitochondrial-genes", bpo::value<std::string>(&params.mito_genes)->required(), "A file containing mitochondrial genes as symbols.")
 		("statistics-file,e", bpo::value<std::string>(&params.out_statistics)->required(), "Name of the resulting statistics file.")
-		("output,o", bpo::value<std::string>(&params.out_matrix)->required(), "Name of the filtered output file.");
+		("output,o", bpo::value<std::string>(&params.out_matrix), "Name of the filtered output file.")
+		("sparse-output,s", bpo::value<std::string>(&params.out_sparse_matrix), "Name of the filtered output file in binary sparse matrix format.")
+		("sparse-input", bpo::value<bool>(&sparse_input)->default_value(false)->zero_tokens(), "The input matrix is a sparse matrix, e.g. in binary sparse matrix format. The column statistics are computed from the nonzero entries only.")
+		("threads,t", bpo::value<unsigned int>(&params.num_threads)->default_value(0), "Number of threads used for parsing. 0 uses all available cores.");
 
 	try{
 		bpo::store(bpo::command_line_parser(argc, argv).options(desc).run(), vm);
 		bpo::notify(vm);
+
+		if(params.out_matrix.empty() && params.out_sparse_matrix.empty()) {
+			throw bpo::error("At least one of --output and --sparse-output is required");
+		}
 	} catch(bpo::error& e){
 		std::cerr << "ERROR: " << e.what() << "\n";
 		desc.print(std::cerr);
@@ -71,10 +81,17 @@ int main(int argc, char* argv[]){
 		std::set<std::string> mito_genes = parseMitochondrialGenes();
 		
 		SCMatrixFilter filter;
-		filter.filterMatrix(matrix, mito_genes, params);
+		if(sparse_input) {
+			filter.filterMatrix(readSparseMatrix(matrix, options), mito_genes, params);
+		} else {
+			filter.filterMatrix(matrix, mito_genes, params);
+		}
 	} catch (std::invalid_argument e){
 		std::cout << e.what() << std::endl;
 		return -1;
+	} catch (const IOError& e){
+		std::cerr << "ERROR: " << e.what() << std::endl;
+		return -1;
 	}
 
 	return 0;
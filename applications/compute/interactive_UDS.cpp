@@ -8,6 +8,20 @@
 #include <utility>
 #include <fstream>
 #include <stdlib.h> 
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include <cerrno>
+#include <csignal>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
 
 #include <boost/program_options.hpp>
 #include <boost/algorithm/string.hpp>
@@ -19,15 +33,21 @@
 #include <genetrail2/core/Entropy.h>
 #include <genetrail2/core/Statistic.h>
 #include <genetrail2/core/MatrixIterator.h>
+#include <genetrail2/core/misc_algorithms.h>
+
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
 
 #include "../matrixTools.h"
 
 using namespace GeneTrail;
 namespace bpo = boost::program_options;
 
-std::string matrix = "", output = "", transformation = "";
+std::string matrix = "", output = "", transformation = "", socket_path = "";
 
-bool use_ranks = false;
+bool use_ranks = false, server = false;
+unsigned int threads = 0;
 DenseMatrix valueMatrix(0,0);
 MatrixReaderOptions matrixOptions;
 
@@ -40,7 +60,10 @@ bool parseArguments(int argc, char* argv[])
 		("matrix,m", bpo::value<std::string>(&matrix)->required(), "Name of the matrix file.")
 		("no-row-names,r", bpo::value<bool>(&matrixOptions.no_rownames)->default_value(false)->zero_tokens(), "Does the file contain row names.")
 		("no-col-names,c", bpo::value<bool>(&matrixOptions.no_colnames)->default_value(false)->zero_tokens(), "Does the file contain column names.")
-		("add-col-name,a", bpo::value<bool>(&matrixOptions.additional_colname)->default_value(false)->zero_tokens(), "File containing two lines specifying which rownames belong to which group.");
+		("add-col-name,a", bpo::value<bool>(&matrixOptions.additional_colname)->default_value(false)->zero_tokens(), "File containing two lines specifying which rownames belong to which group.")
+		("server", bpo::value<bool>(&server)->default_value(false)->zero_tokens(), "Answer newline-delimited JSON requests instead of running the interactive prompt.")
+		("socket,s", bpo::value<std::string>(&socket_path), "Path of the Unix socket the server listens on. Reads from stdin if omitted.")
+		("threads,t", bpo::value<unsigned int>(&threads)->default_value(0), "Number of threads answering requests. 0 uses all available cores.");
 
 	try
 	{
@@ -93,7 +116,8 @@ void greedy() {
 		scores.emplace_back(target_scores);
 		out << target << " <- c(";
 		curves.emplace_back(target);
-		std::vector<double> own_entropy = Entropy::conditional_cummulative_entropy_estimator(target_scores, scores);
+		Entropy::ConditionalCummulativeEntropyEstimator<double> estimator(target_scores);
+		std::vector<double> own_entropy = estimator.greedy(scores);
 		for(size_t i=0; i<own_entropy.size(); ++i) {
 				own_entropy[i] = (own_entropy.back() - own_entropy[i]) / own_entropy.back();
 				out << own_entropy[i];
@@ -103,18 +127,26 @@ void greedy() {
 		}
 		out << ")" << std::endl;
 
+		//Get values for regulators
+		std::vector<std::vector<std::vector<double>>> group_scores;
 		for(auto regg : regulator_groups) {
 				std::vector<std::string> regulators;
 				boost::split(regulators, regg, boost::is_any_of(","));
 
-				//Get values for regulators
 				std::vector<std::vector<double>> regulator_scores;
-				//regulator_scores.emplace_back(target_scores);
 				for (auto& reg : regulators) {
 						RowMajorMatrixIterator<Matrix> reg_it(&valueMatrix, valueMatrix.rowIndex(reg));
 						std::copy(reg_it->begin(), reg_it->end(), reg_scores.begin());
 						regulator_scores.emplace_back(reg_scores);
 				}
+				group_scores.emplace_back(std::move(regulator_scores));
+		}
+
+		// The groups are evaluated in parallel
+		std::vector<std::vector<double>> group_entropies = estimator.greedy(group_scores);
+
+		for(size_t g = 0; g < regulator_groups.size(); ++g) {
+				const std::string& regg = regulator_groups[g];
 
 				// Calculate entropy
 				std::string tmp = regg;
@@ -124,7 +156,7 @@ void greedy() {
 				/////////////////////////////////////////////////////////////////
 				out << tmp << " <- c(";
 				curves.emplace_back(tmp);
-				std::vector<double> entropy = Entropy::conditional_cummulative_entropy_estimator(target_scores, regulator_scores);
+				std::vector<double>& entropy = group_entropies[g];
 				for(size_t i=0; i<entropy.size(); ++i) {
 						entropy[i] = (entropy.back() - entropy[i]) / entropy.back();
 						out << entropy[i];
@@ -226,7 +258,8 @@ void kruskall() {
 		scores.emplace_back(target_scores);
 		out << target << " <- c(";
 		curves.emplace_back(target);
-		std::vector<double> own_entropy = Entropy::conditional_cummulative_entropy_kruskall_estimator(target_scores, scores);
+		Entropy::ConditionalCummulativeEntropyEstimator<double> estimator(target_scores);
+		std::vector<double> own_entropy = estimator.kruskall(scores);
 		for(size_t i=0; i<own_entropy.size(); ++i) {
 				own_entropy[i] = (own_entropy.back() - own_entropy[i]) / own_entropy.back();
 				out << own_entropy[i];
@@ -236,25 +269,33 @@ void kruskall() {
 		}
 		out << ")" << std::endl;
 
+		//Get values for regulators
+		std::vector<std::vector<std::vector<double>>> group_scores;
 		for(auto regg : regulator_groups) {
 				std::vector<std::string> regulators;
 				boost::split(regulators, regg, boost::is_any_of(","));
 
-				//Get values for regulators
 				std::vector<std::vector<double>> regulator_scores;
-				//regulator_scores.emplace_back(target_scores);
 				for (auto& reg : regulators) {
 						RowMajorMatrixIterator<Matrix> reg_it(&valueMatrix, valueMatrix.rowIndex(reg));
 						std::copy(reg_it->begin(), reg_it->end(), reg_scores.begin());
 						regulator_scores.emplace_back(reg_scores);
 				}
+				group_scores.emplace_back(std::move(regulator_scores));
+		}
+
+		// The groups are evaluated in parallel
+		std::vector<std::vector<double>> group_entropies = estimator.kruskall(group_scores);
+
+		for(size_t g = 0; g < regulator_groups.size(); ++g) {
+				const std::string& regg = regulator_groups[g];
 
 				// Calculate entropy
 				std::string tmp = regg;
 				boost::replace_all(tmp, ",", ".");
 				out << tmp << " <- c(";
 				curves.emplace_back(tmp);
-				std::vector<double> entropy = Entropy::conditional_cummulative_entropy_kruskall_estimator(target_scores, regulator_scores);
+				std::vector<double>& entropy = group_entropies[g];
 				for(size_t i=0; i<entropy.size(); ++i) {
 						entropy[i] = (entropy.back() - entropy[i]) / entropy.back();
 						out << entropy[i];
@@ -298,6 +339,390 @@ void kruskall() {
 }
 
 
+/*
+ * Server mode
+ *
+ * Every line of the input is a JSON request of the form
+ *
+ *   {"id": 1, "target": "TP53", "algorithm": "greedy", "groups": [["MDM2", "EP300"], ["CDKN1A"]]}
+ *
+ * or an array of such requests. "algorithm" is either "greedy" (default)
+ * or "kruskall", "id" is copied into the answer. Every request is answered
+ * with one line
+ *
+ *   {"id": 1, "target": "TP53", "algorithm": "greedy",
+ *    "self": {"entropy": [...], "mean": ..., "median": ...},
+ *    "groups": [{"regulators": ["MDM2", "EP300"], "entropy": [...], "mean": ..., "median": ...}, ...]}
+ *
+ * The curves are normalized like in the interactive mode. Failed requests
+ * are answered with {"id": 1, "error": "..."}. As requests are processed
+ * concurrently, answers may arrive out of order.
+ */
+
+// The per-row sort orders are computed once and kept for all requests.
+std::vector<Entropy::ConditionalCummulativeEntropyEstimator<double>> estimators;
+
+class RequestError : public std::runtime_error
+{
+  public:
+	explicit RequestError(const std::string& msg) : std::runtime_error(msg) {}
+};
+
+class WorkQueue
+{
+  public:
+	explicit WorkQueue(unsigned int num_threads)
+	{
+		for(unsigned int i = 0; i < num_threads; ++i) {
+			workers_.emplace_back([this]() { work(); });
+		}
+	}
+
+	~WorkQueue()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			done_ = true;
+		}
+		cv_.notify_all();
+		for(auto& w : workers_) {
+			w.join();
+		}
+	}
+
+	void push(std::function<void()> job)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			jobs_.emplace_back(std::move(job));
+		}
+		cv_.notify_one();
+	}
+
+  private:
+	void work()
+	{
+		while(true) {
+			std::function<void()> job;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				cv_.wait(lock, [this]() { return done_ || !jobs_.empty(); });
+				if(jobs_.empty()) {
+					return;
+				}
+				job = std::move(jobs_.front());
+				jobs_.pop_front();
+			}
+			job();
+		}
+	}
+
+	std::vector<std::thread> workers_;
+	std::deque<std::function<void()>> jobs_;
+	std::mutex mutex_;
+	std::condition_variable cv_;
+	bool done_ = false;
+};
+
+// Source of the requests and destination of the answers. Writes are
+// serialized, a socket is closed as soon as the last pending request has
+// been answered.
+class Connection
+{
+  public:
+	Connection(int in_fd, int out_fd, bool owns_fd) : in_fd_(in_fd), out_fd_(out_fd), owns_fd_(owns_fd) {}
+
+	~Connection()
+	{
+		if(owns_fd_) {
+			close(in_fd_);
+		}
+	}
+
+	void write(const std::string& line)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		size_t written = 0;
+		while(written < line.size()) {
+			ssize_t n = ::write(out_fd_, line.data() + written, line.size() - written);
+			if(n < 0 && errno == EINTR) {
+				continue;
+			}
+			// The client is gone, SIGPIPE is ignored in runServer
+			if(n <= 0) {
+				return;
+			}
+			written += n;
+		}
+	}
+
+	int inputFd() const { return in_fd_; }
+
+  private:
+	int in_fd_;
+	int out_fd_;
+	bool owns_fd_;
+	std::mutex mutex_;
+};
+
+std::vector<double> rowScores(DenseMatrix::index_type row)
+{
+	std::vector<double> scores(valueMatrix.cols());
+	for(DenseMatrix::index_type j = 0; j < valueMatrix.cols(); ++j) {
+		scores[j] = valueMatrix(row, j);
+	}
+	return scores;
+}
+
+DenseMatrix::index_type findRow(const std::string& name)
+{
+	if(!valueMatrix.hasRow(name)) {
+		throw RequestError("Unknown gene: " + name);
+	}
+	return valueMatrix.rowIndex(name);
+}
+
+const rapidjson::Value& member(const rapidjson::Value& request, const char* name)
+{
+	auto it = request.FindMember(name);
+	if(it == request.MemberEnd()) {
+		throw RequestError(std::string("Missing field: ") + name);
+	}
+	return it->value;
+}
+
+template <typename Writer> void writeNumber(Writer& writer, double value)
+{
+	if(std::isfinite(value)) {
+		writer.Double(value);
+	} else {
+		writer.Null();
+	}
+}
+
+template <typename Writer> void writeCurve(Writer& writer, std::vector<double>& entropy)
+{
+	for(size_t i = 0; i < entropy.size(); ++i) {
+		entropy[i] = (entropy.back() - entropy[i]) / entropy.back();
+	}
+
+	writer.Key("entropy");
+	writer.StartArray();
+	for(double e : entropy) {
+		writeNumber(writer, e);
+	}
+	writer.EndArray();
+	writer.Key("mean");
+	writeNumber(writer, statistic::mean<double>(entropy.begin(), entropy.end()));
+	writer.Key("median");
+	writeNumber(writer, statistic::median<double>(entropy.begin(), entropy.end()));
+}
+
+std::string answerRequest(const rapidjson::Value& request)
+{
+	rapidjson::StringBuffer buffer;
+	rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+	writer.StartObject();
+	if(request.IsObject() && request.HasMember("id")) {
+		writer.Key("id");
+		request["id"].Accept(writer);
+	}
+
+	try {
+		if(!request.IsObject()) {
+			throw RequestError("Request is not an object");
+		}
+
+		const rapidjson::Value& target = member(request, "target");
+		const rapidjson::Value& groups = member(request, "groups");
+		if(!target.IsString() || !groups.IsArray()) {
+			throw RequestError("Expected a string \"target\" and an array \"groups\"");
+		}
+
+		std::string algorithm = "greedy";
+		if(request.HasMember("algorithm") && request["algorithm"].IsString()) {
+			algorithm = request["algorithm"].GetString();
+		}
+		if(algorithm != "greedy" && algorithm != "kruskall") {
+			throw RequestError("Unknown algorithm: " + algorithm);
+		}
+
+		const DenseMatrix::index_type target_row = findRow(target.GetString());
+		const auto& estimator = estimators[target_row];
+
+		// Get values, the first group is the target itself
+		std::vector<std::vector<std::vector<double>>> group_scores;
+		group_scores.emplace_back(1, rowScores(target_row));
+		for(const auto& group : groups.GetArray()) {
+			if(!group.IsArray()) {
+				throw RequestError("Every group has to be an array of genes");
+			}
+			std::vector<std::vector<double>> regulator_scores;
+			for(const auto& reg : group.GetArray()) {
+				if(!reg.IsString()) {
+					throw RequestError("Gene names have to be strings");
+				}
+				regulator_scores.emplace_back(rowScores(findRow(reg.GetString())));
+			}
+			group_scores.emplace_back(std::move(regulator_scores));
+		}
+
+		// Requests are already processed in parallel
+		std::vector<std::vector<double>> entropies = algorithm == "greedy"
+			? estimator.greedy(group_scores, 1)
+			: estimator.kruskall(group_scores, 1);
+
+		writer.Key("target");
+		writer.String(target.GetString());
+		writer.Key("algorithm");
+		writer.String(algorithm.c_str());
+
+		writer.Key("self");
+		writer.StartObject();
+		writeCurve(writer, entropies[0]);
+		writer.EndObject();
+
+		writer.Key("groups");
+		writer.StartArray();
+		for(rapidjson::SizeType g = 0; g < groups.Size(); ++g) {
+			writer.StartObject();
+			writer.Key("regulators");
+			groups[g].Accept(writer);
+			writeCurve(writer, entropies[g + 1]);
+			writer.EndObject();
+		}
+		writer.EndArray();
+		writer.EndObject();
+	} catch(const std::exception& e) {
+		// Besides invalid requests this covers e.g. failed allocations, which
+		// must not escape the worker thread. Start over, the answer may be
+		// incomplete.
+		buffer.Clear();
+		writer.Reset(buffer);
+		writer.StartObject();
+		if(request.IsObject() && request.HasMember("id")) {
+			writer.Key("id");
+			request["id"].Accept(writer);
+		}
+		writer.Key("error");
+		writer.String(e.what());
+		writer.EndObject();
+	}
+
+	return std::string(buffer.GetString(), buffer.GetSize()) + "\n";
+}
+
+void answerLine(const std::string& line, const std::shared_ptr<Connection>& connection)
+{
+	try {
+		auto document = std::make_shared<rapidjson::Document>();
+		document->Parse(line.c_str());
+
+		if(document->HasParseError()) {
+			connection->write("{\"error\":\"Malformed JSON request\"}\n");
+			return;
+		}
+
+		if(document->IsArray()) {
+			for(const auto& request : document->GetArray()) {
+				connection->write(answerRequest(request));
+			}
+		} else {
+			connection->write(answerRequest(*document));
+		}
+	} catch(const std::exception&) {
+		// Runs on a worker thread, an escaping exception would terminate
+		// the whole server.
+		connection->write("{\"error\":\"Could not process request\"}\n");
+	}
+}
+
+// Reads requests from fd until EOF and hands every line to the work queue.
+void serveConnection(WorkQueue& queue, const std::shared_ptr<Connection>& connection)
+{
+	std::string pending;
+	char buffer[1 << 16];
+	while(true) {
+		ssize_t n = read(connection->inputFd(), buffer, sizeof(buffer));
+		if(n <= 0) {
+			break;
+		}
+		pending.append(buffer, n);
+
+		size_t start = 0;
+		for(size_t end = pending.find('\n'); end != std::string::npos; end = pending.find('\n', start)) {
+			std::string line = pending.substr(start, end - start);
+			start = end + 1;
+			if(line.find_first_not_of(" \t\r") != std::string::npos) {
+				queue.push([line, connection]() { answerLine(line, connection); });
+			}
+		}
+		pending.erase(0, start);
+	}
+
+	if(pending.find_first_not_of(" \t\r") != std::string::npos) {
+		queue.push([pending, connection]() { answerLine(pending, connection); });
+	}
+}
+
+void precomputeSortOrders()
+{
+	estimators.assign(valueMatrix.rows(), Entropy::ConditionalCummulativeEntropyEstimator<double>(std::vector<double>()));
+
+	parallel_for(DenseMatrix::index_type(0), valueMatrix.rows(), [&](DenseMatrix::index_type i) {
+		estimators[i] = Entropy::ConditionalCummulativeEntropyEstimator<double>(rowScores(i));
+	}, threads, DenseMatrix::index_type(64));
+}
+
+int runServer()
+{
+	precomputeSortOrders();
+
+	// A client that disconnects before its answers are written must not
+	// kill the server. Writes fail with EPIPE instead.
+	signal(SIGPIPE, SIG_IGN);
+
+	WorkQueue queue(threads == 0 ? default_num_threads() : threads);
+
+	if(socket_path.empty()) {
+		serveConnection(queue, std::make_shared<Connection>(STDIN_FILENO, STDOUT_FILENO, false));
+		return 0;
+	}
+
+	sockaddr_un address;
+	if(socket_path.size() >= sizeof(address.sun_path)) {
+		std::cerr << "ERROR: Socket path " << socket_path << " is too long" << std::endl;
+		return -4;
+	}
+
+	int server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	std::fill((char*)&address, (char*)&address + sizeof(address), 0);
+	address.sun_family = AF_UNIX;
+	std::copy(socket_path.begin(), socket_path.end(), address.sun_path);
+	unlink(socket_path.c_str());
+
+	if(server_fd < 0 || bind(server_fd, (sockaddr*)&address, sizeof(address)) < 0 || listen(server_fd, 16) < 0) {
+		std::cerr << "ERROR: Could not listen on socket " << socket_path << std::endl;
+		if(server_fd >= 0) {
+			close(server_fd);
+		}
+		return -4;
+	}
+
+	std::cerr << "Listening on " << socket_path << std::endl;
+	while(true) {
+		int client = accept(server_fd, nullptr, nullptr);
+		if(client < 0) {
+			continue;
+		}
+		auto connection = std::make_shared<Connection>(client, client, true);
+		std::thread([&queue, connection]() { serveConnection(queue, connection); }).detach();
+	}
+
+	return 0;
+}
+
 int main(int argc, char* argv[])
 { 
   	if(!parseArguments(argc, argv))
@@ -318,6 +743,10 @@ int main(int argc, char* argv[])
 		return -3;
 	}
 
+	if(server) {
+		return runServer();
+	}
+
 	while(true) {
 		std::cout << "Please select an algorithm (greedy,kruskall): ";
 		std::string s;
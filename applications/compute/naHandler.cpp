@@ -16,7 +16,8 @@
 using namespace GeneTrail;
 namespace bpo = boost::program_options;
 
-std::string input = "", output = "", strategy = "";
+std::string input = "", output = "", strategy = "", metric = "";
+unsigned int neighbours = 10, num_threads = 0;
 MatrixReaderOptions options;
 
 bool parseArguments(int argc, char* argv[]){
@@ -25,7 +26,10 @@ bool parseArguments(int argc, char* argv[]){
 
 	desc.add_options()("help,h", "Display this message")
 		("input,i", bpo::value<std::string>(&input)->required(), "Name of the input file with NAs.")
-		("strategy,s", bpo::value<std::string>(&strategy)->required(), "The strategy for handling NAs.")
+		("strategy,s", bpo::value<std::string>(&strategy)->required(), "The strategy for handling NAs. One of remove, mean, median, constantzero, knn.")
+		("neighbours,k", bpo::value<unsigned int>(&neighbours)->default_value(10), "Number of neighbours used by the knn strategy.")
+		("metric,d", bpo::value<std::string>(&metric)->default_value("euclidean"), "Distance used by the knn strategy. One of euclidean, correlation.")
+		("threads,j", bpo::value<unsigned int>(&num_threads)->default_value(0), "Number of threads. 0 uses all available cores.")
 		("output,o", bpo::value<std::string>(&output)->required(), "Name of the output file.");
 
 	try{
@@ -41,6 +45,7 @@ bool parseArguments(int argc, char* argv[]){
 
 bool handleNAs(DenseMatrix& m){
 	NAHandler h;
+	h.setNumberOfThreads(num_threads);
 	if(strategy.compare("remove") == 0){
 		h.handle(m, NAStrategyRemove());
 	} else if(strategy.compare("mean") == 0){
@@ -49,6 +54,21 @@ bool handleNAs(DenseMatrix& m){
 		h.handle(m, NAStrategyMedian());
 	} else if(strategy.compare("constantzero") == 0){
 		h.handle(m, NAStrategyZero());
+	} else if(strategy.compare("knn") == 0){
+		if(neighbours == 0){
+			std::cerr << "ERROR: The number of neighbours must be positive." << std::endl;
+			return false;
+		}
+		NAStrategyKNN::Metric d;
+		if(metric.compare("euclidean") == 0){
+			d = NAStrategyKNN::Metric::Euclidean;
+		} else if(metric.compare("correlation") == 0){
+			d = NAStrategyKNN::Metric::Correlation;
+		} else {
+			std::cerr << "ERROR: Metric is unknown." << std::endl;
+			return false;
+		}
+		h.handle(m, NAStrategyKNN(neighbours, d));
 	} else {
 		std::cerr << "ERROR: Strategy is unknown." << std::endl;
 		return false;
@@ -10,6 +10,9 @@
 #include <genetrail2/core/DenseMatrixWriter.h>
 #include <genetrail2/core/TextFile.h>
 #include <genetrail2/core/DenseColumnSubset.h>
+#include <genetrail2/core/SparseMatrix.h>
+#include <genetrail2/core/SparseMatrixTools.h>
+#include <genetrail2/core/SparseMatrixWriter.h>
 
 #include "../matrixTools.h"
 
@@ -20,6 +23,9 @@ namespace bpo = boost::program_options;
 std::string matrix = "", output = "", normalization = "", samples = "";
 DenseMatrix valueMatrix(0,0);
 MatrixReaderOptions matrixOptions;
+bool sparse = false, apply_log1p = false;
+double scale = 1e4;
+unsigned int num_threads = 0;
 
 bool parseArguments(int argc, char* argv[])
 {
@@ -29,17 +35,25 @@ bool parseArguments(int argc, char* argv[])
 	desc.add_options()("help,h", "Display this message")
 		("matrix,m", bpo::value<std::string>(&matrix)->required(), "Name of the matrix file.")
 		("output,o", bpo::value<std::string>(&output)->required(), "Name of the output file.")
-		("normalization,n", bpo::value<std::string>(&normalization)->required(), "Method to normalize the values (gauss, poisson, zscore).")
+		("normalization,n", bpo::value<std::string>(&normalization)->required(), "Method to normalize the values (gauss, poisson, zscore, library-size).")
 		("no-row-names,r", bpo::value<bool>(&matrixOptions.no_rownames)->default_value(false)->zero_tokens(), "Does the file contain row names.")
 		("no-col-names,c", bpo::value<bool>(&matrixOptions.no_colnames)->default_value(false)->zero_tokens(), "Does the file contain column names.")
 		("add-col-name,a", bpo::value<bool>(&matrixOptions.additional_colname)->default_value(false)->zero_tokens(), "Additional column names")
-		("samples,s", bpo::value<std::string>(&samples)->required(), "File containing one line specifying which rownames should be used in the analysis.");
+		("samples,s", bpo::value<std::string>(&samples), "File containing one line specifying which rownames should be used in the analysis. Required for dense matrices.")
+		("sparse", bpo::value<bool>(&sparse)->default_value(false)->zero_tokens(), "The matrix is a sparse matrix, e.g. the binary output of filterSCMatrix. Only none and library-size are supported and all columns are normalized. The result is written as binary sparse matrix.")
+		("scale", bpo::value<double>(&scale)->default_value(1e4), "Sum of every column after library-size normalization.")
+		("log1p", bpo::value<bool>(&apply_log1p)->default_value(false)->zero_tokens(), "Transform the normalized values x of a sparse matrix to log(1 + x).")
+		("threads,j", bpo::value<unsigned int>(&num_threads)->default_value(0), "Number of threads used for sparse matrices. 0 uses all available cores.");
 
 
 	try
 	{
 		bpo::store(bpo::command_line_parser(argc, argv).options(desc).run(), vm);
 		bpo::notify(vm);
+
+		if(!sparse && samples.empty()) {
+			throw bpo::error("the option '--samples' is required for dense matrices");
+		}
 	}
 	catch(bpo::error& e)
 	{
@@ -102,6 +116,43 @@ bool writeNormalizedMatrix(DenseColumnSubset subset)
 }
 
 
+int normalizeSparseMatrix()
+{
+	SparseMatrix m(0, 0);
+	try {
+		m = readSparseMatrix(matrix, matrixOptions);
+	} catch(const IOError& e) {
+		std::cerr << "ERROR: Could not read from matrix file " << matrix << std::endl;
+		return -3;
+	}
+
+	SparseMatrixTools tools;
+	tools.setNumberOfThreads(num_threads);
+
+	if(normalization == "library-size") {
+		tools.normalizeLibrarySize(m, scale);
+	} else if(normalization != "none") {
+		std::cerr << "ERROR: Sparse matrices only support the normalization methods none and library-size" << "\n";
+		return -5;
+	}
+
+	if(apply_log1p) {
+		tools.log1p(m);
+	}
+
+	std::ofstream out(output, std::ios::binary);
+	if(!out) {
+		std::cerr << "ERROR: Could not write normalized matrix in file " << output << std::endl;
+		return -7;
+	}
+
+	SparseMatrixWriter writer;
+	writer.writeBinary(out, m);
+
+	return 0;
+}
+
+
 int main(int argc, char* argv[])
 { 
   	if(!parseArguments(argc, argv))
@@ -115,6 +166,9 @@ int main(int argc, char* argv[])
 		return -2;
 	}
 
+	if(sparse) {
+		return normalizeSparseMatrix();
+	}
 	
 	try {readValueMatrix();}
 	catch(const IOError& e) {
@@ -18,6 +18,7 @@ namespace bpo = boost::program_options;
 std::string matrix = "", output = "";
 std::vector<std::string> metadata, columns;
 double threshold = 0.05;
+unsigned int num_threads = 0;
 MatrixReaderOptions options;
 
 bool parseArguments(int argc, char* argv[]){
@@ -29,7 +30,8 @@ bool parseArguments(int argc, char* argv[]){
 		("metadata,e", bpo::value<std::vector<std::string>>(&metadata)->multitoken()->required(), "List of a tab-separated metadata files in which the first column is a sample and the following columns are metadata information about that sample. One column has to store the name of the group to which the sample belongs. This file needs to have a header that has one element less than the following rows.")
 		("threshold,t", bpo::value<double>(&threshold)->required(), "The p-value threshold to name a p-value 'significant'.")
 		("column,c", bpo::value<std::vector<std::string>>(&columns)->multitoken()->required(), "List of column names in the metadata file that stores group information. Provide one column name for each input metadata")
-		("output,o", bpo::value<std::string>(&output)->required(), "An output file for the (category x group) matrix storing a p-value on how significant a category is only present in the respective group.");
+		("output,o", bpo::value<std::string>(&output)->required(), "An output file for the (category x group) matrix storing a p-value on how significant a category is only present in the respective group.")
+		("threads,j", bpo::value<unsigned int>(&num_threads)->default_value(0), "Number of threads. 0 uses all available cores.");
 
 	try{
 		bpo::store(bpo::command_line_parser(argc, argv).options(desc).run(), vm);
@@ -68,6 +70,7 @@ int main(int argc, char* argv[]){
 		auto m = readDenseMatrix(matrix, options);
 		
 		ORAGroupPreference ogp(threshold);
+		ogp.setNumberOfThreads(num_threads);
 		DenseMatrix result(0,0);
 		ogp.calculatePreference(m, metas, result);
 		
@@ -1,4 +1,4 @@
-#include <genetrail2/core/GeneSet.h>
+#include <genetrail2/core/Scores.h>
 
 #include <genetrail2/enrichment/common.h>
 #include <genetrail2/enrichment/EnrichmentAlgorithm.h>
@@ -52,6 +52,10 @@ EnrichmentAlgorithmPtr getAlgorithm(PValueMode mode, const std::string& method,
 		return createEnrichmentAlgorithm<SumEnrichment>(mode, scores);
 	} else if(method == "max-mean") {
 		return createEnrichmentAlgorithm<MaxMeanEnrichment>(mode, scores);
+	} else if(method == "normal-mean") {
+		return createEnrichmentAlgorithm<NormalApproximationEnrichment>(mode, scores, NormalApproximationEnrichment::Statistic::Mean);
+	} else if(method == "normal-sum") {
+		return createEnrichmentAlgorithm<NormalApproximationEnrichment>(mode, scores, NormalApproximationEnrichment::Statistic::Sum);
 	}
 
 	//TODO: Throw the proper exception
@@ -65,15 +69,12 @@ int main(int argc, char* argv[])
 		return -1;
 	}
 
-	GeneSet test_set;
+	Scores scores(std::make_shared<EntityDatabase>());
 	CategoryList cat_list;
-	if(init(test_set, cat_list, p) != 0) {
+	if(init(scores, cat_list, p) != 0) {
 		return -1;
 	}
 
-	auto db = std::make_shared<EntityDatabase>();
-	Scores scores(test_set, db);
-
 	auto algorithm = getAlgorithm(p.pValueMode, method, scores);
 
 	run(scores, cat_list, algorithm, p, true);
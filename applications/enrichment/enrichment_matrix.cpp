@@ -0,0 +1,146 @@
+#include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/DenseMatrixReader.h>
+#include <genetrail2/core/EntityDatabase.h>
+#include <genetrail2/core/Exception.h>
+
+#include <genetrail2/enrichment/common.h>
+#include <genetrail2/enrichment/CommandLineInterface.h>
+#include <genetrail2/enrichment/EnrichmentAlgorithm.h>
+#include <genetrail2/enrichment/MultiSampleEnrichment.h>
+#include <genetrail2/enrichment/Parameters.h>
+
+#include <boost/program_options.hpp>
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace GeneTrail;
+namespace bpo = boost::program_options;
+
+std::string matrix_file, method;
+bool increasing = false, absolute = false, binary = false;
+unsigned int num_threads = 0;
+size_t block_size = 0;
+
+bool parseArguments(int argc, char* argv[], Params& p)
+{
+	bpo::variables_map vm;
+	bpo::options_description desc;
+
+	addCommonCLIArgs(desc, p);
+	desc.add_options()
+		("matrix,m", bpo::value(&matrix_file)->required(), "A genes x samples matrix containing the scores of all samples.")
+		("method,k", bpo::value(&method)->default_value("mean"), "Method for gene set testing. One of mean, median, sum, max-mean, normal-mean, normal-sum, gsea, wilcoxon.")
+		("increasing", bpo::value(&increasing)->zero_tokens(), "Use increasingly sorted scores for gsea and wilcoxon. (Decreasing is default)")
+		("absolute", bpo::value(&absolute)->zero_tokens(), "Use absolute scores.")
+		("binary,b", bpo::value(&binary)->zero_tokens(), "Write binary matrices instead of text matrices.")
+		("threads,j", bpo::value(&num_threads)->default_value(0), "Number of threads. 0 uses all available cores.")
+		("block_size", bpo::value(&block_size)->default_value(0), "Number of samples that are kept in memory before they are written. 0 uses four samples per thread.");
+
+	try {
+		bpo::store(bpo::command_line_parser(argc, argv).options(desc).run(),
+		           vm);
+		bpo::notify(vm);
+	} catch(bpo::error& e) {
+		std::cerr << "ERROR: " << e.what() << "\n";
+		desc.print(std::cerr);
+		return false;
+	}
+
+	if(p.pValueMode != PValueMode::RowWise) {
+		std::cerr << "ERROR: Only row-wise p-values are supported." << std::endl;
+		return false;
+	}
+
+	return checkCLIArgs(p);
+}
+
+template <typename Statistics>
+EnrichmentAlgorithmFactory createSortedAlgorithm(PValueMode mode, Order order)
+{
+	return [mode, order](const Scores& scores) {
+		Scores sorted(scores);
+		sorted.sortByScore(order);
+		return createEnrichmentAlgorithm<Statistics>(
+		    mode, sorted.indices().begin(), sorted.indices().end(), order);
+	};
+}
+
+EnrichmentAlgorithmFactory getAlgorithm(PValueMode mode, const std::string& method)
+{
+	const Order order = increasing ? Order::Increasing : Order::Decreasing;
+
+	if(method == "mean") {
+		return [mode](const Scores& s) { return createEnrichmentAlgorithm<MeanEnrichment>(mode, s); };
+	} else if(method == "median") {
+		return [mode](const Scores& s) { return createEnrichmentAlgorithm<MedianEnrichment>(mode, s); };
+	} else if(method == "sum") {
+		return [mode](const Scores& s) { return createEnrichmentAlgorithm<SumEnrichment>(mode, s); };
+	} else if(method == "max-mean") {
+		return [mode](const Scores& s) { return createEnrichmentAlgorithm<MaxMeanEnrichment>(mode, s); };
+	} else if(method == "normal-mean") {
+		return [mode](const Scores& s) { return createEnrichmentAlgorithm<NormalApproximationEnrichment>(mode, s, NormalApproximationEnrichment::Statistic::Mean); };
+	} else if(method == "normal-sum") {
+		return [mode](const Scores& s) { return createEnrichmentAlgorithm<NormalApproximationEnrichment>(mode, s, NormalApproximationEnrichment::Statistic::Sum); };
+	} else if(method == "gsea") {
+		return createSortedAlgorithm<KolmogorovSmirnov>(mode, order);
+	} else if(method == "wilcoxon") {
+		return createSortedAlgorithm<WilcoxonRSTest>(mode, order);
+	}
+
+	throw NotImplemented(__FILE__, __LINE__, "Unknown method: " + method);
+}
+
+int main(int argc, char* argv[])
+{
+	Params p;
+	if(!parseArguments(argc, argv, p)) {
+		return -1;
+	}
+
+	CategoryList cat_list;
+	if(initCategories(cat_list, p) != 0) {
+		return -1;
+	}
+
+	try {
+		std::ifstream input(matrix_file, std::ios::binary);
+		if(!input) {
+			throw IOError("Could not open matrix " + matrix_file + " for reading.");
+		}
+
+		DenseMatrixReader reader;
+		DenseMatrix matrix = reader.read(input);
+
+		if(absolute) {
+			matrix.matrix() = matrix.matrix().array().abs().matrix();
+		}
+
+		auto db = std::make_shared<EntityDatabase>();
+		Scores genes(db);
+		for(const auto& name : matrix.rowNames()) {
+			genes.emplace_back(name, 0.0);
+		}
+		genes.sortByIndex();
+
+		CategoryIndex index(genes, cat_list, p);
+
+		MultiSampleEnrichment enrichment(index, getAlgorithm(p.pValueMode, method), p);
+		enrichment.setNumberOfThreads(num_threads);
+		enrichment.setBlockSize(block_size);
+		enrichment.run(matrix, genes, p.out(),
+		               binary ? MultiSampleEnrichment::Format::Binary
+		                      : MultiSampleEnrichment::Format::Text);
+	} catch(const IOError& e) {
+		std::cerr << "ERROR: " << e.what() << std::endl;
+		return -1;
+	} catch(const NotImplemented& e) {
+		std::cerr << "ERROR: " << e.what() << std::endl;
+		return -1;
+	}
+
+	return 0;
+}
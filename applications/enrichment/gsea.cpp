@@ -1,4 +1,4 @@
-#include <genetrail2/core/GeneSet.h>
+#include <genetrail2/core/Scores.h>
 
 #include <genetrail2/enrichment/common.h>
 #include <genetrail2/enrichment/CommandLineInterface.h>
@@ -65,16 +65,13 @@ int main(int argc, char* argv[])
 		return -1;
 	}
 
-	GeneSet test_set;
+	Scores scores(std::make_shared<EntityDatabase>());
 	CategoryList cat_list;
 
-	if(init(test_set, cat_list, p) != 0) {
+	if(init(scores, cat_list, p) != 0) {
 		return -1;
 	}
 
-	auto db = std::make_shared<EntityDatabase>();
-	Scores scores(test_set, db);
-
 	if(p.identifier() == "") {
 		prepareScores(scores);
 	}
@@ -1,5 +1,5 @@
 #include <genetrail2/core/EntityDatabase.h>
-#include <genetrail2/core/GeneSet.h>
+#include <genetrail2/core/Scores.h>
 #include <genetrail2/core/WilcoxonRankSumTest.h>
 #include <genetrail2/core/OneSampleTTest.h>
 #include <genetrail2/core/IndependentTTest.h>
@@ -63,16 +63,13 @@ int main(int argc, char* argv[])
 		return -1;
 	}
 
-	GeneSet test_set;
+	Scores scores(std::make_shared<EntityDatabase>());
 	CategoryList cat_list;
-	if(init(test_set,cat_list,p) != 0)
+	if(init(scores, cat_list, p) != 0)
 	{
 		return -1;
 	}
 
-	auto db = std::make_shared<EntityDatabase>();
-	Scores scores(test_set, db);
-
 	auto algorithm = getAlgorithm(method, scores, p.pValueMode);
 
 	run(scores, cat_list, algorithm, p, true);
@@ -1,11 +1,11 @@
 #include <genetrail2/core/DenseMatrix.h>
 #include <genetrail2/core/DenseMatrixReader.h>
 #include <genetrail2/core/EntityDatabase.h>
-#include <genetrail2/core/GMTFile.h>
+#include <genetrail2/core/CompiledCategoryFile.h>
 #include <genetrail2/core/Exception.h>
-#include <genetrail2/core/GeneSet.h>
 #include <genetrail2/core/GeneSetReader.h>
 #include <genetrail2/core/OverRepresentationAnalysis.h>
+#include <genetrail2/core/Scores.h>
 
 #include <genetrail2/enrichment/common.h>
 #include <genetrail2/enrichment/EnrichmentAlgorithm.h>
@@ -113,38 +113,35 @@ void thread_job(const DenseMatrix& p_values, const CategoryDBList& cat_list,
 		p.out_ = DirectoryPath(fields[1]);
 		
 		
-		GeneSet test_set;
-		if(initTestSet(test_set, p) != 0) continue;
+		Scores scores(db);
+		if(initTestSet(scores, p) != 0) continue;
 		
 		try{
-			Scores scores(test_set, db);
 			if(method == "ora"){
 				auto enrichmentAlgorithm = createEnrichmentAlgorithm<Ora>(
-					p.pValueMode, reference_set, test_set.toCategory(db, "test"),
+					p.pValueMode, reference_set, scores.toCategory("test"),
 					hypothesis_
 				);
 				run(scores, cat_list, enrichmentAlgorithm, p, true);
 			} else if(method == "parallel_ora"){
 				auto enrichmentAlgorithm = createEnrichmentAlgorithm<PreprocessedORA>(
-					p.pValueMode, reference_set, test_set.toCategory(db, "test"),
+					p.pValueMode, reference_set, scores.toCategory("test"),
 					hypothesis_, p_values, p.justScores, p.justPvalues
 				);
 				run(scores, cat_list, enrichmentAlgorithm, p, true);
 			} else if(method == "percentage"){
 				auto enrichmentAlgorithm = createEnrichmentAlgorithm<IntersectionPercentage>(
-					p.pValueMode, reference_set, test_set.toCategory(db, "test"),
+					p.pValueMode, reference_set, scores.toCategory("test"),
 					hypothesis_, p.justScores, p.justPvalues
 				);
 				run(scores, cat_list, enrichmentAlgorithm, p, true);
 			} else if(method == "wilcoxon"){
-				auto db = std::make_shared<EntityDatabase>();
-				GeneSet test_set;
+				Scores scores(std::make_shared<EntityDatabase>());
 				CategoryList cat_list;
 
-				if(init(test_set, cat_list, p) != 0) {
+				if(init(scores, cat_list, p) != 0) {
 					return;
 				}
-				Scores scores(test_set, db);
 				prepareScores(scores);
 				
 				Order order = increasing ? Order::Increasing : Order::Decreasing;
@@ -192,19 +189,19 @@ int main(int argc, char* argv[]){
 	if(!parseArguments(argc, argv, p)) return -1;
 	p.verbose = false;
 	
-	GeneSet reference_set;
+	auto db = std::make_shared<EntityDatabase>();
+	Scores reference_set(db);
 	CategoryList cat_list;
 	if(initCategories(cat_list, p) != 0) return -1;
 
 	GeneSetReader reader;
 	try{
-		reference_set = reader.readGeneList(reference);
+		reference_set = reader.readGeneList(reference, db);
 	} catch(IOError& exn){
 		std::cerr << "ERROR: Failed to read reference set. Reason: " << exn.what() << std::endl;
 		return -1;
 	}
 
-	auto db = std::make_shared<EntityDatabase>();
 	NullHypothesis hypothesis_ = getHypothesis(hypothesis);
 	
 	DenseMatrix p_values(1,1);
@@ -221,20 +218,12 @@ int main(int argc, char* argv[]){
 		file.close();
 	}
 	
-	Category ref = reference_set.toCategory(db, "reference");
+	Category ref = reference_set.toCategory("reference");
 	
 	CategoryDBList category_dbs;
 	for(const auto& cat: cat_list){
 		try {
-			GMTFile gmt(db, cat.second);
-			if(!gmt) {
-				std::cerr << "WARNING: Could not open database " + cat.first +
-									" for reading! Skipping database."
-							<< std::endl;
-				continue;
-			}
-
-			CategoryDatabase b = gmt.read();
+			CategoryDatabase b = readCategoryDatabase(db, cat.second);
 			b.setName(cat.first);
 			category_dbs.push_back(b);
 		} catch(IOError& exn) {
@@ -2,9 +2,9 @@
 #include <genetrail2/core/DenseMatrixReader.h>
 #include <genetrail2/core/EntityDatabase.h>
 #include <genetrail2/core/Exception.h>
-#include <genetrail2/core/GeneSet.h>
 #include <genetrail2/core/GeneSetReader.h>
 #include <genetrail2/core/OverRepresentationAnalysis.h>
+#include <genetrail2/core/Scores.h>
 
 #include <genetrail2/enrichment/common.h>
 #include <genetrail2/enrichment/EnrichmentAlgorithm.h>
@@ -57,11 +57,12 @@ int main(int argc, char* argv[])
 		return -1;
 	}
 
-	GeneSet test_set;
-	GeneSet reference_set;
+	auto db = std::make_shared<EntityDatabase>();
+	Scores scores(db);
+	Scores reference_set(db);
 	CategoryList cat_list;
 
-	if(init(test_set, cat_list, p) != 0)
+	if(init(scores, cat_list, p) != 0)
 	{
 		return -1;
 	}
@@ -69,7 +70,7 @@ int main(int argc, char* argv[])
 	GeneSetReader reader;
 	try
 	{
-		reference_set = reader.readGeneList(reference);
+		reference_set = reader.readGeneList(reference, db);
 	}
 	catch(IOError& exn)
 	{
@@ -77,7 +78,6 @@ int main(int argc, char* argv[])
 		return -1;
 	}
 
-	auto db = std::make_shared<EntityDatabase>();
 	NullHypothesis hypothesis_;
 	if (hypothesis == "upper-tailed") {
 		hypothesis_ = NullHypothesis::UPPER_TAILED;
@@ -88,8 +88,7 @@ int main(int argc, char* argv[])
 	}
 
     if (!usePreComputedPValues) {
-		auto enrichmentAlgorithm = createEnrichmentAlgorithm<Ora>(p.pValueMode, reference_set.toCategory(db, "reference"), test_set.toCategory(db, "test"), hypothesis_);
-		Scores scores(test_set, db);
+		auto enrichmentAlgorithm = createEnrichmentAlgorithm<Ora>(p.pValueMode, reference_set.toCategory("reference"), scores.toCategory("test"), hypothesis_);
 		run(scores, cat_list, enrichmentAlgorithm, p, true);
 	} else {
 		//auto start = std::chrono::high_resolution_clock::now();
@@ -109,8 +108,7 @@ int main(int argc, char* argv[])
 
 		p.verbose = false;
                 //start = std::chrono::high_resolution_clock::now();
-		auto enrichmentAlgorithm = createEnrichmentAlgorithm<PreprocessedORA>(p.pValueMode, reference_set.toCategory(db, "reference"), test_set.toCategory(db, "test"), hypothesis_, p_values, p.justScores, p.justPvalues);
-		Scores scores(test_set, db);
+		auto enrichmentAlgorithm = createEnrichmentAlgorithm<PreprocessedORA>(p.pValueMode, reference_set.toCategory("reference"), scores.toCategory("test"), hypothesis_, p_values, p.justScores, p.justPvalues);
 		run(scores, cat_list, enrichmentAlgorithm, p, true);
 		//finish = std::chrono::high_resolution_clock::now();
 		//elapsed = finish - start;
@@ -4,7 +4,7 @@
 #include <genetrail2/enrichment/Parameters.h>
 
 #include <genetrail2/core/EntityDatabase.h>
-#include <genetrail2/core/GeneSet.h>
+#include <genetrail2/core/Scores.h>
 
 #include <iostream>
 #include <memory>
@@ -56,15 +56,12 @@ int main(int argc, char* argv[])
 		return -1;
 	}
 
-	GeneSet test_set;
+	Scores scores(std::make_shared<EntityDatabase>());
 	CategoryList cat_list;
-	if(init(test_set, cat_list, p) != 0) {
+	if(init(scores, cat_list, p) != 0) {
 		return -1;
 	}
 
-	auto db = std::make_shared<EntityDatabase>();
-	Scores scores(test_set, db);
-
 	auto order = increasing ? Order::Increasing : Order::Decreasing;
 	
 	std::unique_ptr<EnrichmentAlgorithm> algorithm;
@@ -1,5 +1,9 @@
 #include "common.h"
 
+#include <genetrail2/core/DenseMatrixWriter.h>
+
+#include <fstream>
+
 bool parseArguments(int argc, char* argv[], Params& p)
 {
 	bpo::variables_map vm;
@@ -10,7 +14,9 @@ bool parseArguments(int argc, char* argv[], Params& p)
 		("geo_dir,l", bpo::value<std::string>(&p.geo_dir)->required(), "Path to the geo directory.")
 		("duplicates,d", bpo::value<std::string>(&p.methodToHandleDuplicates)->required(), "Method to handle duplicates.")
 		("output,o", bpo::value<std::string>(&p.output_file)->required(), "Name of the output file.")
-		("gds,s", bpo::value(&p.gds)->zero_tokens(), "Flag indicating if the input is a GDS file. (default is GSE)");
+		("gds,s", bpo::value(&p.gds)->zero_tokens(), "Flag indicating if the input is a GDS file. (default is GSE)")
+		("binary,b", bpo::value(&p.binary)->zero_tokens(), "Write the matrix in binary format.")
+		("threads,j", bpo::value<unsigned int>(&p.num_threads)->default_value(0), "Number of threads. 0 uses all available cores.");
 
 	try
 	{
@@ -30,7 +36,25 @@ bool parseArguments(int argc, char* argv[], Params& p)
 void annotateAndWriteGEO(GeneTrail::GEOMap& geo, const Params& p)
 {
 	GeneTrail::GPL_Parser gpl_;
-	std::map<std::string, std::string> mappings = gpl_.annotate(p.geo_dir, geo.platform);
+	GeneTrail::GEO::ProbeMap mappings = gpl_.annotate(p.geo_dir, geo.platform);
 	geo.gene2exprs = gpl_.mapAndRemoveDuplicates(geo.gene2exprs, mappings, p.methodToHandleDuplicates);
 	gpl_.writeGEOMap(p.output_file, geo);
 }
+
+void annotateAndWriteGEO(const GeneTrail::GEOMatrix& geo, const Params& p)
+{
+	GeneTrail::GPL_Parser gpl_;
+	auto reducer = GeneTrail::GEO::compileReducer(p.methodToHandleDuplicates);
+	GeneTrail::GEO::ProbeMap mappings = gpl_.annotate(p.geo_dir, geo.platform);
+	GeneTrail::DenseMatrix genes = gpl_.mapAndRemoveDuplicates(geo.values, mappings, reducer, p.num_threads);
+
+	GeneTrail::DenseMatrixWriter writer;
+	if(p.binary) {
+		std::ofstream out(p.output_file, std::ios_base::out | std::ios_base::binary);
+		writer.writeBinary(out, genes);
+	} else {
+		std::ofstream out(p.output_file);
+		writer.writeText(out, genes);
+		out << "\n";
+	}
+}
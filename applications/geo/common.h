@@ -7,6 +7,7 @@
 
 #include <genetrail2/core/GEO.h>
 #include <genetrail2/core/GEOGPLParser.h>
+#include <genetrail2/core/GEOSoftParser.h>
 
 namespace bpo = boost::program_options;
 
@@ -17,10 +18,14 @@ struct Params
 	std::string methodToHandleDuplicates;
 	std::string output_file;
 	bool gds = false;
+	bool binary = false;
+	unsigned int num_threads = 0;
 };
 
 bool parseArguments(int argc, char* argv[], Params& p);
 
 void annotateAndWriteGEO(GeneTrail::GEOMap& geo, const Params& p);
 
+void annotateAndWriteGEO(const GeneTrail::GEOMatrix& geo, const Params& p);
+
 #endif //GT2_APPLICATIONS_COMPUTE_SCORES_COMMON_H
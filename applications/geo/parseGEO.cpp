@@ -1,10 +1,9 @@
+#include <genetrail2/core/Exception.h>
 #include <genetrail2/core/GEO.h>
-#include <genetrail2/core/GEOGDSParser.h>
-#include <genetrail2/core/GEOGSEParser.h>
+#include <genetrail2/core/GEOSoftParser.h>
 
 #include <iostream>
-#include <map>
-#include <vector>
+#include <stdexcept>
 
 #include "common.h"
 
@@ -14,26 +13,30 @@ Params p;
 
 int main(int argc, char* argv[])
 {
-	GEOGDSParser gds;
-	GEOGSEParser gse;
-
 	if(!parseArguments(argc, argv, p))
 	{
 		return -1;
 	}
 
+	GEOSoftParser parser;
+	parser.setNumberOfThreads(p.num_threads);
+
 	std::string path = p.geo_dir +  "/" + p.geo;
-	GEOMap geo;
-	if(p.gds)
+	try
 	{
-		geo = gds.readGDSFile(path);
+		GEOMatrix geo = p.gds ? parser.readGDSFile(path) : parser.readGSEFile(path);
+		annotateAndWriteGEO(geo, p);
 	}
-	else
+	catch(const IOError& e)
 	{
-		geo = gse.readGSEFile(path);
+		std::cerr << "ERROR: " << e.what() << std::endl;
+		return -1;
+	}
+	catch(const std::invalid_argument& e)
+	{
+		std::cerr << "ERROR: " << e.what() << std::endl;
+		return -1;
 	}
-
-	annotateAndWriteGEO(geo,p);
 
 	return 0;
 }
@@ -1,11 +1,16 @@
-#include "glasso.h"
-
 #include <genetrail2/core/DenseMatrix.h>
 #include <genetrail2/core/DenseMatrixReader.h>
 #include <genetrail2/core/DenseMatrixWriter.h>
+#include <genetrail2/core/GraphicalLasso.h>
+#include <genetrail2/core/SparseMatrix.h>
+#include <genetrail2/core/SparseMatrixWriter.h>
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #include <boost/program_options.hpp>
 
@@ -18,18 +23,22 @@ int main(int argc, char* argv[])
 	bpo::options_description desc;
 
 	std::string infile, outfile;
-	float rho, thr;
-	int maxit;
-	bool transpose, text_out;
+	std::vector<double> rhos;
+	double thr;
+	size_t maxit;
+	unsigned int num_threads;
+	bool transpose, text_out, dense_out;
 
 	desc.add_options()
 		("help,h", "Display this message")
 		("in,i",    bpo::value<std::string>(&infile)->required(), "Input file")
-		("out,o",   bpo::value<std::string>(&outfile)->required(), "Output file")
-		("rho,r",   bpo::value<float>(&rho)->required(), "The regularization parameter")
-		("thr,t",   bpo::value<float>(&thr)->default_value(1.0e-6), "Convergence threshold")
-		("maxit,m", bpo::value<int>(&maxit)->default_value(10000), "Maximum number of iterations")
+		("out,o",   bpo::value<std::string>(&outfile)->required(), "Output file. If several regularization parameters are given, \".rho_<rho>\" is appended for each of them.")
+		("rho,r",   bpo::value<std::vector<double>>(&rhos)->required()->multitoken(), "The regularization parameter(s). Several values are solved as a path with warm starts.")
+		("thr",     bpo::value<double>(&thr)->default_value(1.0e-4), "Convergence threshold")
+		("maxit,m", bpo::value<size_t>(&maxit)->default_value(10000), "Maximum number of iterations")
+		("threads,j", bpo::value<unsigned int>(&num_threads)->default_value(0), "Number of threads. 0 uses all available cores.")
 		("transpose,t", bpo::bool_switch(&transpose)->default_value(false), "Should the input matrix be transposed.")
+		("dense,d", bpo::bool_switch(&dense_out)->default_value(false), "Write the precision matrix as dense matrix.")
 		("text,a", bpo::bool_switch(&text_out)->default_value(false), "Write the output as a text file.");
 
 	try {
@@ -64,7 +73,6 @@ int main(int argc, char* argv[])
 
 	std::cout << "Reading data ..." << std::endl;
 
-	//TODO: See if we can make this casting business less wasteful
 	DenseMatrix mat = reader.read(input, opt);
 
 	auto mu = mat.matrix().rowwise().mean();
@@ -72,54 +80,68 @@ int main(int argc, char* argv[])
 
 	std::cout << "Computing covariance matrix ..." << std::endl;
 	// Compute the covariance matrix
-	Eigen::MatrixXf cov = (mat.matrix() * mat.matrix().transpose() / (mat.cols() - 1)).cast<float>();
-
-	// The glasso driver part. Mainly the creation of lots and lots of variables
-	// in order to interface with Fortran...
-	Eigen::MatrixXf www(mat.rows(), mat.rows());
-	Eigen::MatrixXf wwwi(mat.rows(), mat.rows());
-
-	// Wow! This is really a waste!
-	// This code requires four times the memory of the input matrix...
-	std::vector<float> rho_mem(mat.rows() * mat.rows(), 0.001);
+	Eigen::MatrixXd cov = mat.matrix() * mat.matrix().transpose() / (mat.cols() - 1);
+
+	// We only need the names from here on
+	std::vector<std::string> names = mat.rowNames();
+	mat.matrix().resize(0, 0);
+
+	GraphicalLasso glasso;
+	glasso.setThreshold(thr);
+	glasso.setMaxIterations(maxit);
+	glasso.setNumberOfThreads(num_threads);
+
+	auto write = [&](const GraphicalLassoResult& result) {
+		std::cout << "rho = " << result.rho << ": " << result.num_components
+		          << " components, " << result.iterations << " iterations";
+		if(!result.converged) {
+			std::cout << " (not converged)";
+		}
+		std::cout << std::endl;
 
-	int nn = cov.rows();
+		std::string filename = outfile;
+		if(rhos.size() > 1) {
+			std::ostringstream suffix;
+			suffix << ".rho_" << result.rho;
+			filename += suffix.str();
+		}
 
-	int ia = 0;
-	int is = 0;
-	int itr = 0;
-	int ipen = 1;
+		std::ofstream out(filename);
+		if(!out) {
+			throw std::runtime_error("Could not open " + filename + " for writing.");
+		}
 
-	int nniter;
-	float ddel;
-	int jerr;
+		if(dense_out) {
+			DenseMatrix tmp(names, names);
+			tmp.matrix() = result.precision;
+
+			DenseMatrixWriter writer;
+			if(text_out) {
+				writer.writeText(out, tmp);
+				out << '\n';
+			} else {
+				writer.writeBinary(out, tmp);
+			}
+		} else {
+			SparseMatrix tmp = result.sparsePrecision(names);
+
+			SparseMatrixWriter writer;
+			if(text_out) {
+				writer.writeText(out, tmp);
+			} else {
+				writer.writeBinary(out, tmp);
+			}
+		}
+	};
 
 	std::cout << "Approximating precision matrix ..." << std::endl;
 
-	glasso_(&nn, cov.data(), &rho_mem[0], &ia, &is, &itr, &ipen, &thr, &maxit,
-	        www.data(), wwwi.data(), &nniter, &ddel, &jerr);
-
-	std::ofstream out(outfile);
-	if(!out) {
-		std::cerr << "Could not open " << outfile << " for reading." << std::endl;
+	try {
+		glasso.path(cov, rhos, write);
+	} catch(const std::exception& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
 		return -1;
 	}
 
-	// We no longer need this stuff...
-	cov.resize(0,0);
-	www.resize(0,0);
-
-	//TODO: Think about specializations for the matrix writer...
-	//      OR make glasso double precision...
-	DenseMatrix tmp(mat.rowNames(), mat.rowNames());
-	tmp.matrix() = wwwi.cast<double>();
-
-	DenseMatrixWriter writer;
-	if(text_out) {
-		writer.writeText(out, tmp);
-	} else {
-		writer.writeBinary(out, tmp);
-	}
-
 	return 0;
 }
@@ -2,6 +2,9 @@
 
 #include <genetrail2/core/DenseMatrix.h>
 #include <genetrail2/core/DenseMatrixReader.h>
+#include <genetrail2/core/Exception.h>
+#include <genetrail2/core/SparseMatrix.h>
+#include <genetrail2/core/SparseMatrixReader.h>
 
 #include <iostream>
 #include <fstream>
@@ -10,7 +13,7 @@ namespace GeneTrail
 {
 
 	std::vector<unsigned int>
-	getIndices(const DenseMatrix& matrix,
+	getIndices(const Matrix& matrix,
 	           const std::vector<std::string>& colnames,
 	           const std::string& groupname)
 	{
@@ -38,8 +41,7 @@ namespace GeneTrail
 		return m1;
 	}
 
-	DenseMatrix readDenseMatrix(const std::string& matrix,
-	                            const MatrixReaderOptions& options)
+	unsigned int matrixReaderFlags(const MatrixReaderOptions& options)
 	{
 		unsigned int opts = DenseMatrixReader::NO_OPTIONS;
 
@@ -59,9 +61,37 @@ namespace GeneTrail
 			opts |= DenseMatrixReader::SPLIT_ONLY_TAB;
 		}
 
+		return opts;
+	}
+
+	DenseMatrix readDenseMatrix(const std::string& matrix,
+	                            const MatrixReaderOptions& options)
+	{
 		DenseMatrixReader reader;
 
 		std::ifstream strm(matrix, std::ios::binary);
+		return reader.read(strm, matrixReaderFlags(options));
+	}
+
+	SparseMatrix readSparseMatrix(const std::string& matrix,
+	                              const MatrixReaderOptions& options)
+	{
+		unsigned int opts = SparseMatrixReader::NO_OPTIONS;
+		if(!options.no_rownames) {
+			opts |= SparseMatrixReader::READ_ROW_NAMES;
+		}
+		if(!options.no_colnames) {
+			opts |= SparseMatrixReader::READ_COL_NAMES;
+		}
+		if(options.additional_colname) {
+			opts |= SparseMatrixReader::ADDITIONAL_COL_NAME;
+		}
+
+		SparseMatrixReader reader;
+		std::ifstream strm(matrix, std::ios::binary);
+		if(!strm) {
+			throw IOError("Could not open " + matrix + " for reading");
+		}
 		return reader.read(strm, opts);
 	}
 }
@@ -11,6 +11,7 @@
 namespace GeneTrail
 {
 	class DenseMatrix;
+	class SparseMatrix;
 
 	struct GT2_EXPORT MatrixReaderOptions
 	{
@@ -26,9 +27,14 @@ namespace GeneTrail
 	GT2_EXPORT DenseMatrix buildDenseMatrix(const std::string& expr1,
 	                                        const std::string& expr2,
 	                                        const MatrixReaderOptions& options);
+	/// Translates the options into DenseMatrixReader::ReaderOptions flags
+	GT2_EXPORT unsigned int matrixReaderFlags(const MatrixReaderOptions& options);
 	GT2_EXPORT DenseMatrix readDenseMatrix(const std::string& matrix,
 	                                       const MatrixReaderOptions& options);
-	std::vector<unsigned int> getIndices(const DenseMatrix& matrix, const std::vector<std::string>& colnames, const std::string& groupname);
+	GT2_EXPORT SparseMatrix readSparseMatrix(const std::string& matrix,
+	                                         const MatrixReaderOptions& options);
+
+	std::vector<unsigned int> getIndices(const Matrix& matrix, const std::vector<std::string>& colnames, const std::string& groupname);
 }
 
 #endif // MATRIX_TOOLS_H
@@ -8,6 +8,7 @@ using namespace GeneTrail;
 namespace bpo = boost::program_options;
 
 std::string in_, out_, adjust_, aggregate_;
+unsigned int num_threads_ = 0;
 
 bool parseArguments(int argc, char* argv[])
 {
@@ -19,6 +20,7 @@ bool parseArguments(int argc, char* argv[])
 	("output,o", bpo::value(&out_)->required(), "Path of output file.")
 	("adjust,a", bpo::value(&adjust_)->required(), "Method to adjust p-values.")
 	("aggregate,g", bpo::value(&aggregate_)->required(), "Method to aggregate p-values.")
+	("threads,j", bpo::value(&num_threads_)->default_value(0), "Number of threads used for aggregation. 0 uses all available cores.")
 	;
 
 	try {
@@ -41,6 +43,7 @@ int main(int argc, char* argv[])
 	}
 	
 	RegulatorEffectResultAggregator aggregator;
+	aggregator.setNumberOfThreads(num_threads_);
 	aggregator.read_results(in_);
 	std::string rank_aggregator = "sum";
 	aggregator.aggregateRanks(rank_aggregator);
@@ -1,8 +1,12 @@
+#include <genetrail2/core/CompiledCategoryDatabase.h>
+#include <genetrail2/core/CompiledCategoryFile.h>
 #include <genetrail2/core/EntityDatabase.h>
+#include <genetrail2/core/Exception.h>
 #include <genetrail2/core/File.h>
 #include <genetrail2/core/GMTFile.h>
 #include <genetrail2/core/JsonCategoryFile.h>
 
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/program_options.hpp>
 
 #include <iostream>
@@ -66,6 +70,7 @@ int main(int argc, char* argv[])
 		("source-url,u",    bpo::value<std::string>(), "Set the source URL.")
 		("name,n",          bpo::value<std::string>(), "Set the database name.")
 		("identifier,d",    bpo::value<std::string>(), "Set the identifier.")
+		("compile,b",       "Write a compiled, memory-mappable database. This is the default for outputs ending in .gtcat. Compiled inputs are detected automatically.")
 	;
 
 	try {
@@ -77,10 +82,28 @@ int main(int argc, char* argv[])
 		return -1;
 	}
 
-	if(input.substr(input.length() - 5) == ".json") {
-		readWriteCategoryDatabase<JsonCategoryFile, GMTFile>(input, output, vm);
-	} else {
-		readWriteCategoryDatabase<GMTFile, JsonCategoryFile>(input, output, vm);
+	const bool compile = vm.count("compile") || boost::ends_with(output, ".gtcat");
+	const bool json_input = boost::ends_with(input, ".json");
+
+	try {
+		if(CompiledCategoryDatabase::isCompiled(input)) {
+			if(boost::ends_with(output, ".json")) {
+				readWriteCategoryDatabase<CompiledCategoryFile, JsonCategoryFile>(input, output, vm);
+			} else {
+				readWriteCategoryDatabase<CompiledCategoryFile, GMTFile>(input, output, vm);
+			}
+		} else if(compile && json_input) {
+			readWriteCategoryDatabase<JsonCategoryFile, CompiledCategoryFile>(input, output, vm);
+		} else if(compile) {
+			readWriteCategoryDatabase<GMTFile, CompiledCategoryFile>(input, output, vm);
+		} else if(json_input) {
+			readWriteCategoryDatabase<JsonCategoryFile, GMTFile>(input, output, vm);
+		} else {
+			readWriteCategoryDatabase<GMTFile, JsonCategoryFile>(input, output, vm);
+		}
+	} catch(IOError& e) {
+		std::cerr << "ERROR: " << e.what() << std::endl;
+		return -1;
 	}
 
 	return 0;
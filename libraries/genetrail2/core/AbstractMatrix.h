@@ -23,8 +23,8 @@
 #include "macros.h"
 
 #include "Matrix.h"
+#include "NameIndex.h"
 
-#include <map>
 #include <vector>
 #include <string>
 
@@ -197,26 +197,10 @@ namespace GeneTrail
 			///@}
 
 		protected:
-			// Containers for mapping row names
-			std::vector<std::string> index_to_rowname_;
-			std::map<std::string, index_type> rowname_to_index_;
-
-			// Containers for mapping column names
-			std::vector<std::string> index_to_colname_;
-			std::map<std::string, index_type> colname_to_index_;
-
-			void updateRowAndColNames_();
-
-			// Helper for renaming rows or columns
-			void setName_(index_type j,
-			              const std::string& new_name,
-			              std::map<std::string, index_type>& name_to_index,
-			              std::vector<std::string>& index_to_name);
-
-			void setName_(const std::string& old_name,
-			              const std::string& new_name,
-			              std::map<std::string, index_type>& name_to_index,
-			              std::vector<std::string>& index_to_name);
+			// Row and column names. The storage is shared between
+			// copies of a matrix until one of them is modified.
+			NameIndex row_names_;
+			NameIndex col_names_;
 	};
 }
 
@@ -30,6 +30,7 @@
 #include <sstream>
 
 #include "BoostGraph.h"
+#include "CompressedGraph.h"
 #include "macros.h"
 
 #include <boost/algorithm/string/trim.hpp>
@@ -129,6 +130,44 @@ namespace GeneTrail {
             }
         }
 
+        /**
+         * This method constructs a compressed graph from a cytoscape .sif file.
+         * The vertex identifiers are interned in the given EntityDatabase.
+         * FORMAT: ID &lt;tab&gt; REGULATION_TYPE &lt;tab&gt; ID &lt;newline&gt;
+         *
+         * @param filename [.sif] file specifying a network structure
+         * @param db EntityDatabase used for the vertex identifiers
+         * @return The compressed graph
+         */
+        CompressedGraph readCompressedGraph(const std::string& filename, const std::shared_ptr<EntityDatabase>& db) {
+            std::ifstream input_sif(filename.c_str());
+            std::string current;
+            std::vector<std::string> entries;
+
+            CompressedGraph::Builder builder(db);
+
+            if (!input_sif) {
+                std::cerr << "ERROR: Cannot open: " << filename << std::endl;
+                return builder.build();
+            }
+
+            while (std::getline(input_sif, current)) {
+                if (current != "") {
+                    boost::split(entries, current, boost::is_any_of("\t "));
+
+                    if (entries.size() > 2) {
+                        boost::trim(entries[0]); //source node
+                        boost::trim(entries[1]); //edge regulation
+                        boost::trim(entries[2]); //target node
+
+                        builder.addEdge(entries[0], entries[2], entries[1]);
+                    }
+                }
+            }
+
+            return builder.build();
+        }
+
         /**
          * This method saves a given graph as a cytoscape .sif file.
          * FORMAT: ID &lt;tab&gt; REGULATION_TYPE &lt;tab&gt; ID &lt;newline&gt;
@@ -104,4 +104,9 @@ size_t CategoryDatabase::size() const { return categories_.size(); }
 const Metadata& CategoryDatabase::metadata() const { return metadata_; }
 
 Metadata& CategoryDatabase::metadata() { return metadata_; }
+
+const std::shared_ptr<EntityDatabase>& CategoryDatabase::entityDatabase() const
+{
+	return entity_database_;
+}
 }
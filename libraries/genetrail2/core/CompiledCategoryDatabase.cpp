@@ -0,0 +1,622 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "CompiledCategoryDatabase.h"
+
+#include "EntityDatabase.h"
+#include "Exception.h"
+
+#include <boost/variant/apply_visitor.hpp>
+#include <boost/variant/static_visitor.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace GeneTrail
+{
+	namespace
+	{
+		const char MAGIC[8] = {'G', 'T', '2', 'C', 'A', 'T', 'D', 'B'};
+		const uint32_t VERSION = 1;
+		// Used to detect files written on a machine with different endianness
+		const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+		struct Header
+		{
+			char magic[8];
+			uint32_t version;
+			uint32_t byte_order;
+
+			uint64_t num_identifiers;
+			uint64_t num_categories;
+			uint64_t num_members;
+
+			// Byte offsets of the sections
+			uint64_t identifiers;
+			uint64_t member_offsets;
+			uint64_t members;
+			uint64_t names;
+			uint64_t references;
+			uint64_t metadata;
+			uint64_t database;
+
+			uint64_t file_size;
+		};
+
+		// Entries of the database section
+		enum DatabaseEntry {
+			DB_NAME,
+			DB_EDITOR_NAME,
+			DB_EDITOR_EMAIL,
+			DB_CREATION_DATE,
+			DB_SOURCE_URL,
+			DB_IDENTIFIER,
+			DB_METADATA,
+			DB_NUM_ENTRIES
+		};
+
+		// Type tags of encoded metadata values
+		enum MetadataTag : uint8_t {
+			TAG_STRING,
+			TAG_INT,
+			TAG_DOUBLE,
+			TAG_OBJECT,
+			TAG_ARRAY,
+			TAG_BOOL,
+			TAG_NULL
+		};
+
+		uint64_t align(uint64_t offset) { return (offset + 7) & ~uint64_t(7); }
+
+		template <typename T> void append(std::string& buffer, const T& value)
+		{
+			buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+		}
+
+		void appendString(std::string& buffer, const std::string& str)
+		{
+			append(buffer, uint64_t(str.size()));
+			buffer.append(str);
+		}
+
+		class MetadataEncoder : public boost::static_visitor<void>
+		{
+			public:
+			explicit MetadataEncoder(std::string& buffer) : buffer_(buffer) {}
+
+			void operator()(const std::string& value) const
+			{
+				append(buffer_, TAG_STRING);
+				appendString(buffer_, value);
+			}
+
+			void operator()(int64_t value) const
+			{
+				append(buffer_, TAG_INT);
+				append(buffer_, value);
+			}
+
+			void operator()(double value) const
+			{
+				append(buffer_, TAG_DOUBLE);
+				append(buffer_, value);
+			}
+
+			void operator()(const Metadata::Object& value) const
+			{
+				append(buffer_, TAG_OBJECT);
+				encodeEntries(value.begin(), value.end(), value.size());
+			}
+
+			void operator()(const Metadata::Array& value) const
+			{
+				append(buffer_, TAG_ARRAY);
+				append(buffer_, uint64_t(value.size()));
+				for(const auto& v : value) {
+					boost::apply_visitor(*this, *v);
+				}
+			}
+
+			void operator()(bool value) const
+			{
+				append(buffer_, TAG_BOOL);
+				append(buffer_, uint8_t(value));
+			}
+
+			void operator()(std::nullptr_t) const { append(buffer_, TAG_NULL); }
+
+			template <typename Iterator>
+			void encodeEntries(Iterator begin, Iterator end, size_t size) const
+			{
+				append(buffer_, uint64_t(size));
+				for(; begin != end; ++begin) {
+					appendString(buffer_, begin->first);
+					boost::apply_visitor(*this, *begin->second);
+				}
+			}
+
+			private:
+			std::string& buffer_;
+		};
+
+		std::string encodeMetadata(const Metadata& metadata)
+		{
+			std::string result;
+			if(!metadata.empty()) {
+				MetadataEncoder(result).encodeEntries(metadata.begin(), metadata.end(), metadata.size());
+			}
+			return result;
+		}
+
+		class MetadataDecoder
+		{
+			public:
+			explicit MetadataDecoder(boost::string_ref blob)
+			    : pos_(blob.data()), end_(blob.data() + blob.size())
+			{
+			}
+
+			Metadata decode()
+			{
+				Metadata result;
+				if(pos_ == end_) {
+					return result;
+				}
+
+				for(uint64_t n = read<uint64_t>(); n > 0; --n) {
+					std::string key = readString();
+					result[key] = readValue();
+				}
+
+				return result;
+			}
+
+			private:
+			template <typename T> T read()
+			{
+				if(static_cast<size_t>(end_ - pos_) < sizeof(T)) {
+					throw IOError("Corrupt metadata in compiled category database");
+				}
+
+				T value;
+				std::memcpy(&value, pos_, sizeof(T));
+				pos_ += sizeof(T);
+				return value;
+			}
+
+			std::string readString()
+			{
+				const uint64_t length = read<uint64_t>();
+				if(static_cast<uint64_t>(end_ - pos_) < length) {
+					throw IOError("Corrupt metadata in compiled category database");
+				}
+
+				std::string result(pos_, length);
+				pos_ += length;
+				return result;
+			}
+
+			Metadata::Value readValue()
+			{
+				switch(read<uint8_t>()) {
+					case TAG_STRING:
+						return readString();
+					case TAG_INT:
+						return read<int64_t>();
+					case TAG_DOUBLE:
+						return read<double>();
+					case TAG_OBJECT: {
+						Metadata::Object object;
+						for(uint64_t n = read<uint64_t>(); n > 0; --n) {
+							std::string key = readString();
+							object.emplace(std::move(key), readValue());
+						}
+						return object;
+					}
+					case TAG_ARRAY: {
+						Metadata::Array array;
+						for(uint64_t n = read<uint64_t>(); n > 0; --n) {
+							array.push_back(readValue());
+						}
+						return array;
+					}
+					case TAG_BOOL:
+						return read<uint8_t>() != 0;
+					case TAG_NULL:
+						return nullptr;
+					default:
+						throw IOError("Corrupt metadata in compiled category database");
+				}
+			}
+
+			const char* pos_;
+			const char* end_;
+		};
+
+		/**
+		 * A string table in the format expected by
+		 * CompiledCategoryDatabase::StringTable.
+		 */
+		class StringTableBuilder
+		{
+			public:
+			void add(const std::string& str)
+			{
+				offsets_.push_back(chars_.size());
+				chars_ += str;
+			}
+
+			uint64_t bytes() const { return sizeof(uint64_t) * (offsets_.size() + 1) + chars_.size(); }
+
+			void write(std::ostream& output) const
+			{
+				output.write(reinterpret_cast<const char*>(offsets_.data()), sizeof(uint64_t) * offsets_.size());
+				const uint64_t end = chars_.size();
+				output.write(reinterpret_cast<const char*>(&end), sizeof(uint64_t));
+				output.write(chars_.data(), chars_.size());
+			}
+
+			private:
+			std::vector<uint64_t> offsets_;
+			std::string chars_;
+		};
+
+		void pad(std::ostream& output, uint64_t& pos)
+		{
+			const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+			const uint64_t aligned = align(pos);
+			output.write(zeros, aligned - pos);
+			pos = aligned;
+		}
+	}
+
+	const size_t CompiledCategoryDatabase::npos = std::numeric_limits<size_t>::max();
+
+	CompiledCategoryDatabase::CompiledCategoryDatabase(const std::string& path)
+	{
+		try {
+			file_.open(path);
+		} catch(const std::exception& e) {
+			throw IOError("Could not map category database " + path + ": " + e.what());
+		}
+
+		if(!file_.is_open() || file_.size() < sizeof(Header)) {
+			throw IOError(path + " is not a compiled category database");
+		}
+
+		Header header;
+		std::memcpy(&header, file_.data(), sizeof(Header));
+
+		if(std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+			throw IOError(path + " is not a compiled category database");
+		}
+
+		if(header.version != VERSION || header.byte_order != BYTE_ORDER_MARK) {
+			throw IOError("Unsupported version or byte order of compiled category database " + path);
+		}
+
+		if(header.file_size != file_.size()) {
+			throw IOError("Compiled category database " + path + " is truncated");
+		}
+
+		num_identifiers_ = header.num_identifiers;
+		num_categories_ = header.num_categories;
+		num_members_ = header.num_members;
+
+		identifiers_ = stringTable_(header.identifiers, num_identifiers_);
+		names_ = stringTable_(header.names, num_categories_);
+		references_ = stringTable_(header.references, num_categories_);
+		metadata_ = stringTable_(header.metadata, num_categories_);
+		database_ = stringTable_(header.database, DB_NUM_ENTRIES);
+
+		member_offsets_ = reinterpret_cast<const uint64_t*>(
+		    section_(header.member_offsets, sizeof(uint64_t) * (num_categories_ + 1)));
+		members_ = reinterpret_cast<const uint32_t*>(
+		    section_(header.members, sizeof(uint32_t) * num_members_));
+
+		for(size_t i = 0; i < num_categories_; ++i) {
+			if(member_offsets_[i] > member_offsets_[i + 1]) {
+				throw IOError("Corrupt member offsets in compiled category database " + path);
+			}
+		}
+
+		if(member_offsets_[0] != 0 || member_offsets_[num_categories_] != num_members_) {
+			throw IOError("Corrupt member offsets in compiled category database " + path);
+		}
+
+		if(std::any_of(members_, members_ + num_members_,
+		               [this](uint32_t m) { return m >= num_identifiers_; })) {
+			throw IOError("Corrupt members in compiled category database " + path);
+		}
+	}
+
+	const char* CompiledCategoryDatabase::section_(uint64_t offset, uint64_t length) const
+	{
+		if(offset % 8 != 0 || offset > file_.size() || length > file_.size() - offset) {
+			throw IOError("Corrupt section in compiled category database");
+		}
+
+		return file_.data() + offset;
+	}
+
+	CompiledCategoryDatabase::StringTable
+	CompiledCategoryDatabase::stringTable_(uint64_t offset, size_t count) const
+	{
+		const uint64_t offsets_size = sizeof(uint64_t) * (count + 1);
+
+		StringTable result;
+		result.offsets = reinterpret_cast<const uint64_t*>(section_(offset, offsets_size));
+
+		for(size_t i = 0; i < count; ++i) {
+			if(result.offsets[i] > result.offsets[i + 1]) {
+				throw IOError("Corrupt string table in compiled category database");
+			}
+		}
+
+		if(result.offsets[0] != 0) {
+			throw IOError("Corrupt string table in compiled category database");
+		}
+
+		// Characters are not aligned
+		const uint64_t chars = offset + offsets_size;
+		if(result.offsets[count] > file_.size() - chars) {
+			throw IOError("Corrupt string table in compiled category database");
+		}
+		result.chars = file_.data() + chars;
+
+		return result;
+	}
+
+	bool CompiledCategoryDatabase::isCompiled(const std::string& path)
+	{
+		std::ifstream input(path, std::ios::binary);
+
+		char magic[sizeof(MAGIC)];
+		if(!input.read(magic, sizeof(MAGIC))) {
+			return false;
+		}
+
+		return std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+	}
+
+	void CompiledCategoryDatabase::write(std::ostream& output, const CategoryDatabase& db)
+	{
+		const EntityDatabase& entities = *db.entityDatabase();
+
+		// Intern all identifiers in lexicographical order
+		std::vector<size_t> ids;
+		for(const auto& c : db) {
+			ids.insert(ids.end(), c.begin(), c.end());
+		}
+
+		std::sort(ids.begin(), ids.end());
+		ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+		if(ids.size() >= std::numeric_limits<uint32_t>::max()) {
+			throw IOError("Too many identifiers for a compiled category database");
+		}
+
+		std::sort(ids.begin(), ids.end(), [&entities](size_t a, size_t b) {
+			return entities.name(a) < entities.name(b);
+		});
+
+		std::vector<uint32_t> local(ids.empty() ? 0 : *std::max_element(ids.begin(), ids.end()) + 1);
+		StringTableBuilder identifiers;
+		for(size_t i = 0; i < ids.size(); ++i) {
+			local[ids[i]] = static_cast<uint32_t>(i);
+			identifiers.add(entities.name(ids[i]));
+		}
+
+		std::vector<uint64_t> member_offsets(1, 0);
+		std::vector<uint32_t> members;
+		StringTableBuilder names, references, metadata;
+
+		member_offsets.reserve(db.size() + 1);
+		for(const auto& c : db) {
+			const size_t first = members.size();
+			for(size_t id : c) {
+				members.push_back(local[id]);
+			}
+			std::sort(members.begin() + first, members.end());
+			member_offsets.push_back(members.size());
+
+			names.add(c.name());
+			references.add(c.reference());
+			metadata.add(encodeMetadata(c.metadata()));
+		}
+
+		StringTableBuilder database;
+		database.add(db.name());
+		database.add(db.editor().name);
+		database.add(db.editor().email);
+		database.add(db.creationDate());
+		database.add(db.sourceUrl());
+		database.add(db.identifier());
+		database.add(encodeMetadata(db.metadata()));
+
+		Header header;
+		std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+		header.version = VERSION;
+		header.byte_order = BYTE_ORDER_MARK;
+		header.num_identifiers = ids.size();
+		header.num_categories = db.size();
+		header.num_members = members.size();
+
+		uint64_t pos = align(sizeof(Header));
+		auto place = [&pos](uint64_t bytes) {
+			const uint64_t offset = pos;
+			pos = align(pos + bytes);
+			return offset;
+		};
+
+		header.identifiers = place(identifiers.bytes());
+		header.member_offsets = place(sizeof(uint64_t) * member_offsets.size());
+		header.members = place(sizeof(uint32_t) * members.size());
+		header.names = place(names.bytes());
+		header.references = place(references.bytes());
+		header.metadata = place(metadata.bytes());
+		header.database = place(database.bytes());
+		header.file_size = pos;
+
+		pos = 0;
+		output.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+		pos += sizeof(Header);
+		pad(output, pos);
+
+		auto writeTable = [&](const StringTableBuilder& table) {
+			table.write(output);
+			pos += table.bytes();
+			pad(output, pos);
+		};
+
+		writeTable(identifiers);
+
+		output.write(reinterpret_cast<const char*>(member_offsets.data()), sizeof(uint64_t) * member_offsets.size());
+		pos += sizeof(uint64_t) * member_offsets.size();
+		pad(output, pos);
+
+		output.write(reinterpret_cast<const char*>(members.data()), sizeof(uint32_t) * members.size());
+		pos += sizeof(uint32_t) * members.size();
+		pad(output, pos);
+
+		writeTable(names);
+		writeTable(references);
+		writeTable(metadata);
+		writeTable(database);
+
+		if(!output) {
+			throw IOError("Could not write compiled category database");
+		}
+	}
+
+	boost::string_ref CompiledCategoryDatabase::identifier(size_t i) const
+	{
+		return identifiers_[i];
+	}
+
+	size_t CompiledCategoryDatabase::findIdentifier(boost::string_ref identifier) const
+	{
+		size_t first = 0;
+		size_t last = num_identifiers_;
+		while(first < last) {
+			const size_t mid = first + (last - first) / 2;
+			if(identifiers_[mid] < identifier) {
+				first = mid + 1;
+			} else {
+				last = mid;
+			}
+		}
+
+		return first < num_identifiers_ && identifiers_[first] == identifier ? first : npos;
+	}
+
+	boost::string_ref CompiledCategoryDatabase::categoryName(size_t i) const
+	{
+		return names_[i];
+	}
+
+	boost::string_ref CompiledCategoryDatabase::categoryReference(size_t i) const
+	{
+		return references_[i];
+	}
+
+	Metadata CompiledCategoryDatabase::categoryMetadata(size_t i) const
+	{
+		return MetadataDecoder(metadata_[i]).decode();
+	}
+
+	CompiledCategoryDatabase::Members CompiledCategoryDatabase::categoryMembers(size_t i) const
+	{
+		return Members(members_ + member_offsets_[i], members_ + member_offsets_[i + 1]);
+	}
+
+	bool CompiledCategoryDatabase::contains(size_t i, uint32_t identifier) const
+	{
+		const auto members = categoryMembers(i);
+		return std::binary_search(members.begin(), members.end(), identifier);
+	}
+
+	std::string CompiledCategoryDatabase::name() const
+	{
+		return database_[DB_NAME].to_string();
+	}
+
+	Editor CompiledCategoryDatabase::editor() const
+	{
+		Editor result;
+		result.name = database_[DB_EDITOR_NAME].to_string();
+		result.email = database_[DB_EDITOR_EMAIL].to_string();
+		return result;
+	}
+
+	std::string CompiledCategoryDatabase::creationDate() const
+	{
+		return database_[DB_CREATION_DATE].to_string();
+	}
+
+	std::string CompiledCategoryDatabase::sourceUrl() const
+	{
+		return database_[DB_SOURCE_URL].to_string();
+	}
+
+	std::string CompiledCategoryDatabase::identifier() const
+	{
+		return database_[DB_IDENTIFIER].to_string();
+	}
+
+	Metadata CompiledCategoryDatabase::metadata() const
+	{
+		return MetadataDecoder(database_[DB_METADATA]).decode();
+	}
+
+	CategoryDatabase CompiledCategoryDatabase::toCategoryDatabase(const std::shared_ptr<EntityDatabase>& db) const
+	{
+		CategoryDatabase result(db);
+		result.setName(name());
+		result.setEditor(editor());
+		result.setCreationDate(creationDate());
+		result.setSourceUrl(sourceUrl());
+		result.setIdentifier(identifier());
+		result.metadata() = metadata();
+
+		std::vector<size_t> ids(num_identifiers_);
+		for(size_t i = 0; i < num_identifiers_; ++i) {
+			ids[i] = db->index(identifiers_[i].to_string());
+		}
+
+		std::vector<size_t> members;
+		result.reserve(num_categories_);
+		for(size_t i = 0; i < num_categories_; ++i) {
+			members.clear();
+			for(uint32_t m : categoryMembers(i)) {
+				members.push_back(ids[m]);
+			}
+
+			auto& c = result.addCategory(members.begin(), members.end());
+			c.setName(categoryName(i).to_string());
+			c.setReference(categoryReference(i).to_string());
+			if(!metadata_[i].empty()) {
+				c.metadata() = categoryMetadata(i);
+			}
+		}
+
+		return result;
+	}
+}
@@ -0,0 +1,166 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_CORE_COMPILED_CATEGORY_DATABASE_H
+#define GT2_CORE_COMPILED_CATEGORY_DATABASE_H
+
+#include "CategoryDatabase.h"
+#include "Editor.h"
+#include "Metadata.h"
+
+#include "macros.h"
+
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/range/iterator_range.hpp>
+#include <boost/utility/string_ref.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <string>
+
+namespace GeneTrail
+{
+	/**
+	 * Read-only view of a compiled category database.
+	 *
+	 * The compiled format is produced once from a GMT or JSON file (see
+	 * category_convert) and is memory mapped on construction, so that
+	 * opening a database neither parses nor copies its content and all
+	 * processes using the same file share it via the page cache.
+	 *
+	 * The file consists of a fixed header followed by 8-byte aligned
+	 * sections:
+	 *  - the sorted table of all identifiers; identifiers are referred to
+	 *    by their index in this table,
+	 *  - the members of every category in CSR layout (one offset per
+	 *    category into an array of sorted 32 bit identifier indices),
+	 *  - side tables with names, references and encoded Metadata of the
+	 *    categories as well as the information about the database.
+	 *
+	 * String tables store count + 1 offsets followed by the characters,
+	 * so that every string is accessible in O(1) without copying.
+	 */
+	class GT2_EXPORT CompiledCategoryDatabase
+	{
+		public:
+		using Members = boost::iterator_range<const uint32_t*>;
+
+		/// Returned by findIdentifier for unknown identifiers
+		static const size_t npos;
+
+		/**
+		 * Memory maps the compiled database at path.
+		 *
+		 * @throws IOError if the file cannot be mapped or is not a valid
+		 *         compiled category database.
+		 */
+		explicit CompiledCategoryDatabase(const std::string& path);
+
+		/**
+		 * Returns true if path starts with the header of a compiled
+		 * category database.
+		 */
+		static bool isCompiled(const std::string& path);
+
+		/**
+		 * Writes db in the compiled format.
+		 *
+		 * @throws IOError if the database contains more than 2^32 - 1
+		 *         distinct identifiers.
+		 */
+		static void write(std::ostream& output, const CategoryDatabase& db);
+
+		/// The number of categories
+		size_t size() const { return num_categories_; }
+
+		/// The number of distinct identifiers
+		size_t numIdentifiers() const { return num_identifiers_; }
+
+		/// The total number of category members
+		size_t numMembers() const { return num_members_; }
+
+		/// The identifier with index i
+		boost::string_ref identifier(size_t i) const;
+
+		/**
+		 * Returns the index of an identifier using binary search or npos
+		 * if it does not occur in any category.
+		 */
+		size_t findIdentifier(boost::string_ref identifier) const;
+
+		boost::string_ref categoryName(size_t i) const;
+		boost::string_ref categoryReference(size_t i) const;
+
+		/// Decodes the metadata of the i-th category
+		Metadata categoryMetadata(size_t i) const;
+
+		/// The sorted identifier indices of the i-th category
+		Members categoryMembers(size_t i) const;
+
+		/// Returns true if the i-th category contains the identifier index
+		bool contains(size_t i, uint32_t identifier) const;
+
+		std::string name() const;
+		Editor editor() const;
+		std::string creationDate() const;
+		std::string sourceUrl() const;
+		std::string identifier() const;
+		Metadata metadata() const;
+
+		/**
+		 * Creates a CategoryDatabase using db. Every identifier is looked
+		 * up in db only once, independently of the number of categories
+		 * it occurs in.
+		 */
+		CategoryDatabase toCategoryDatabase(const std::shared_ptr<EntityDatabase>& db) const;
+
+		private:
+		struct StringTable
+		{
+			const uint64_t* offsets = nullptr;
+			const char* chars = nullptr;
+
+			boost::string_ref operator[](size_t i) const
+			{
+				return boost::string_ref(chars + offsets[i], offsets[i + 1] - offsets[i]);
+			}
+		};
+
+		StringTable stringTable_(uint64_t offset, size_t count) const;
+		const char* section_(uint64_t offset, uint64_t length) const;
+
+		boost::iostreams::mapped_file_source file_;
+
+		size_t num_identifiers_ = 0;
+		size_t num_categories_ = 0;
+		size_t num_members_ = 0;
+
+		StringTable identifiers_;
+		StringTable names_;
+		StringTable references_;
+		StringTable metadata_;
+		StringTable database_;
+
+		const uint64_t* member_offsets_ = nullptr;
+		const uint32_t* members_ = nullptr;
+	};
+}
+
+#endif // GT2_CORE_COMPILED_CATEGORY_DATABASE_H
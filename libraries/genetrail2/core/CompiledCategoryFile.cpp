@@ -0,0 +1,69 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "CompiledCategoryFile.h"
+
+#include "CompiledCategoryDatabase.h"
+#include "Exception.h"
+#include "GMTFile.h"
+
+namespace GeneTrail
+{
+	CompiledCategoryFile::CompiledCategoryFile(const std::shared_ptr<EntityDatabase>& db,
+	                                           const std::string& path,
+	                                           FileOpenMode mode)
+	    : CategoryDatabaseFile(path, mode), path_(path), entity_database_(db)
+	{
+	}
+
+	CategoryDatabase CompiledCategoryFile::read()
+	{
+		if(!isValid_() || !isReading()) {
+			throw IOError("File is not open for reading");
+		}
+
+		// The content is accessed via the mapping, not via the stream
+		return CompiledCategoryDatabase(path_).toCategoryDatabase(entity_database_);
+	}
+
+	bool CompiledCategoryFile::write(const CategoryDatabase& db)
+	{
+		if(!isValid_() || !isWriting()) {
+			throw IOError("File is not open for writing");
+		}
+
+		CompiledCategoryDatabase::write(*out_strm_, db);
+
+		return true;
+	}
+
+	CategoryDatabase readCategoryDatabase(const std::shared_ptr<EntityDatabase>& db,
+	                                      const std::string& path)
+	{
+		if(CompiledCategoryDatabase::isCompiled(path)) {
+			return CompiledCategoryDatabase(path).toCategoryDatabase(db);
+		}
+
+		GMTFile input(db, path);
+		if(!input) {
+			throw IOError("Could not open database " + path + " for reading");
+		}
+
+		return input.read();
+	}
+}
@@ -0,0 +1,70 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_CORE_COMPILED_CATEGORY_FILE_H
+#define GT2_CORE_COMPILED_CATEGORY_FILE_H
+
+#include "CategoryDatabaseFile.h"
+#include "CategoryDatabase.h"
+
+#include "macros.h"
+
+namespace GeneTrail
+{
+	/**
+	 * Reads and writes category databases in the compiled format.
+	 *
+	 * \see CompiledCategoryDatabase
+	 */
+	class GT2_EXPORT CompiledCategoryFile : public CategoryDatabaseFile
+	{
+	  public:
+		CompiledCategoryFile(const std::shared_ptr<EntityDatabase>& db,
+		                     const std::string& path,
+		                     FileOpenMode mode = FileOpenMode::READ);
+
+		CompiledCategoryFile(CompiledCategoryFile&&) = default;
+		CompiledCategoryFile& operator=(CompiledCategoryFile&&) = default;
+
+		CompiledCategoryFile(const CompiledCategoryFile&) = delete;
+		CompiledCategoryFile& operator=(const CompiledCategoryFile&) = delete;
+
+		/**
+		 * Memory maps the file and converts it to a CategoryDatabase.
+		 *
+		 * @throws IOError if the file is not a valid compiled database.
+		 */
+		CategoryDatabase read() override;
+		bool write(const CategoryDatabase& db) override;
+
+	  private:
+		std::string path_;
+		std::shared_ptr<EntityDatabase> entity_database_;
+	};
+
+	/**
+	 * Reads a category database that is either compiled or stored in the
+	 * GMT format. Compiled databases are recognized by their header.
+	 *
+	 * @throws IOError if the file cannot be read.
+	 */
+	GT2_EXPORT CategoryDatabase readCategoryDatabase(const std::shared_ptr<EntityDatabase>& db,
+	                                                 const std::string& path);
+}
+
+#endif // GT2_CORE_COMPILED_CATEGORY_FILE_H
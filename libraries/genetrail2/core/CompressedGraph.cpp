@@ -0,0 +1,302 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "CompressedGraph.h"
+
+#include "Exception.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace GeneTrail
+{
+	namespace
+	{
+		const std::vector<std::string>& predefinedEdgeTypeNames()
+		{
+			static const std::vector<std::string> names{
+			    "pp",              "activation",       "inhibition",
+			    "expression",      "repression",       "indirect effect",
+			    "state change",    "binding",          "dissociation",
+			    "phosphorylation", "dephosphorylation", "glycosylation",
+			    "ubiquitination",  "methylation",      "compound"};
+			return names;
+		}
+
+		const size_t NUM_PREDEFINED_TYPES =
+		    static_cast<size_t>(EdgeType::FIRST_CUSTOM_EDGE_TYPE);
+
+		// Stable counting sort of the edges into CSR arrays. key selects the
+		// vertex the edge is grouped by, value the vertex that is stored.
+		template <typename Edges, typename Key, typename Value>
+		void buildCSR(size_t num_vertices, const Edges& edges, Key key,
+		              Value value, std::vector<uint32_t>& offsets,
+		              std::vector<uint32_t>& adjacent,
+		              std::vector<EdgeType>& types)
+		{
+			offsets.assign(num_vertices + 1, 0);
+			for(const auto& e : edges) {
+				++offsets[key(e) + 1];
+			}
+
+			std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+			adjacent.resize(edges.size());
+			types.resize(edges.size());
+
+			std::vector<uint32_t> pos(offsets.begin(), offsets.end() - 1);
+			for(const auto& e : edges) {
+				auto& p = pos[key(e)];
+				adjacent[p] = value(e);
+				types[p] = std::get<2>(e);
+				++p;
+			}
+		}
+	}
+
+	const uint32_t CompressedGraph::NOT_FOUND;
+
+	CompressedGraph::Builder::Builder(const std::shared_ptr<EntityDatabase>& db)
+	    : db_(db)
+	{
+	}
+
+	CompressedGraph::vertex_type
+	CompressedGraph::Builder::addVertex(const std::string& name)
+	{
+		const size_t entity = db_->index(name);
+
+		if(entity >= entity_to_vertex_.size()) {
+			entity_to_vertex_.resize(entity + 1, NOT_FOUND);
+		}
+
+		auto& v = entity_to_vertex_[entity];
+		if(v == NOT_FOUND) {
+			v = static_cast<vertex_type>(entities_.size());
+			entities_.push_back(entity);
+		}
+
+		return v;
+	}
+
+	void CompressedGraph::Builder::addEdge(vertex_type source,
+	                                       vertex_type target,
+	                                       const std::string& type)
+	{
+		EdgeType t = predefinedEdgeType(type);
+
+		if(t == EdgeType::FIRST_CUSTOM_EDGE_TYPE) {
+			auto it = std::find(custom_types_.begin(), custom_types_.end(), type);
+			t = static_cast<EdgeType>(NUM_PREDEFINED_TYPES +
+			                          (it - custom_types_.begin()));
+			if(it == custom_types_.end()) {
+				custom_types_.push_back(type);
+			}
+		}
+
+		edges_.emplace_back(source, target, t);
+	}
+
+	void CompressedGraph::Builder::addEdge(const std::string& source,
+	                                       const std::string& target,
+	                                       const std::string& type)
+	{
+		const auto s = addVertex(source);
+		addEdge(s, addVertex(target), type);
+	}
+
+	CompressedGraph CompressedGraph::Builder::build()
+	{
+		using Edge = std::tuple<vertex_type, vertex_type, EdgeType>;
+
+		CompressedGraph result;
+		result.db_ = db_;
+
+		buildCSR(entities_.size(), edges_,
+		         [](const Edge& e) { return std::get<0>(e); },
+		         [](const Edge& e) { return std::get<1>(e); },
+		         result.out_offsets_, result.out_targets_, result.out_types_);
+
+		buildCSR(entities_.size(), edges_,
+		         [](const Edge& e) { return std::get<1>(e); },
+		         [](const Edge& e) { return std::get<0>(e); },
+		         result.in_offsets_, result.in_sources_, result.in_types_);
+
+		result.entities_ = std::move(entities_);
+		result.entity_to_vertex_ = std::move(entity_to_vertex_);
+		result.custom_types_ = std::move(custom_types_);
+
+		entities_.clear();
+		entity_to_vertex_.clear();
+		custom_types_.clear();
+		edges_.clear();
+
+		return result;
+	}
+
+	CompressedGraph::CompressedGraph()
+	    : db_(std::make_shared<EntityDatabase>()),
+	      out_offsets_(1, 0),
+	      in_offsets_(1, 0)
+	{
+	}
+
+	CompressedGraph::CompressedGraph(const std::shared_ptr<EntityDatabase>& db,
+	                                 const GraphType& graph)
+	{
+		Builder builder(db);
+
+		std::unordered_map<vertex_descriptor, vertex_type> vertex_map;
+		vertex_map.reserve(boost::num_vertices(graph));
+
+		boost::graph_traits<GraphType>::vertex_iterator vi, vi_end;
+		for(std::tie(vi, vi_end) = boost::vertices(graph); vi != vi_end; ++vi) {
+			vertex_map[*vi] =
+			    builder.addVertex(boost::get(vertex_identifier, graph, *vi));
+		}
+
+		// Collect the edges in the order of the out-edge lists. The builder
+		// takes care of the types and the forward CSR.
+		boost::graph_traits<GraphType>::out_edge_iterator oei, oei_end;
+		for(std::tie(vi, vi_end) = boost::vertices(graph); vi != vi_end; ++vi) {
+			for(std::tie(oei, oei_end) = boost::out_edges(*vi, graph);
+			    oei != oei_end; ++oei) {
+				builder.addEdge(
+				    vertex_map[*vi], vertex_map[boost::target(*oei, graph)],
+				    boost::get(edge_regulation_type, graph, *oei));
+			}
+		}
+
+		*this = builder.build();
+
+		// The in-edge lists of a boost graph are not necessarily ordered like
+		// its out-edge lists, thus the reverse CSR is rebuilt from them.
+		boost::graph_traits<GraphType>::in_edge_iterator iei, iei_end;
+		size_t pos = 0;
+		for(std::tie(vi, vi_end) = boost::vertices(graph); vi != vi_end; ++vi) {
+			for(std::tie(iei, iei_end) = boost::in_edges(*vi, graph);
+			    iei != iei_end; ++iei) {
+				const auto s = vertex_map[boost::source(*iei, graph)];
+				in_sources_[pos] = s;
+				in_types_[pos] =
+				    edgeType_(boost::get(edge_regulation_type, graph, *iei));
+				++pos;
+			}
+		}
+	}
+
+	GraphType CompressedGraph::toBoostGraph() const
+	{
+		GraphType graph;
+
+		std::vector<vertex_descriptor> vertices(numberOfVertices());
+		for(vertex_type v = 0; v < numberOfVertices(); ++v) {
+			vertices[v] = boost::add_vertex(graph);
+			boost::put(vertex_identifier, graph, vertices[v], name(v));
+		}
+
+		for(vertex_type v = 0; v < numberOfVertices(); ++v) {
+			for(edge_type e = out_offsets_[v]; e < out_offsets_[v + 1]; ++e) {
+				auto ed = boost::add_edge(vertices[v], vertices[out_targets_[e]], graph).first;
+				boost::put(edge_regulation_type, graph, ed, edgeTypeName(out_types_[e]));
+			}
+		}
+
+		return graph;
+	}
+
+	CompressedGraph::vertex_type
+	CompressedGraph::vertexForEntity(size_t entity) const
+	{
+		if(entity >= entity_to_vertex_.size()) {
+			return NOT_FOUND;
+		}
+
+		return entity_to_vertex_[entity];
+	}
+
+	CompressedGraph::vertex_type
+	CompressedGraph::vertex(const std::string& name) const
+	{
+		const EntityDatabase& db = *db_;
+
+		try {
+			return vertexForEntity(db.index(name));
+		} catch(UnknownEntry&) {
+			return NOT_FOUND;
+		}
+	}
+
+	CompressedGraph::edge_type CompressedGraph::findEdge(vertex_type source,
+	                                                     vertex_type target) const
+	{
+		auto begin = outBegin(source);
+		auto it = std::find(begin, outEnd(source), target);
+
+		if(it == outEnd(source)) {
+			return NOT_FOUND;
+		}
+
+		return out_offsets_[source] + static_cast<edge_type>(it - begin);
+	}
+
+	const std::string& CompressedGraph::edgeTypeName(EdgeType type) const
+	{
+		const auto t = static_cast<size_t>(type);
+
+		if(t < NUM_PREDEFINED_TYPES) {
+			return predefinedEdgeTypeNames()[t];
+		}
+
+		return custom_types_[t - NUM_PREDEFINED_TYPES];
+	}
+
+	EdgeType CompressedGraph::edgeType_(const std::string& type) const
+	{
+		EdgeType t = predefinedEdgeType(type);
+
+		if(t == EdgeType::FIRST_CUSTOM_EDGE_TYPE) {
+			auto it = std::find(custom_types_.begin(), custom_types_.end(), type);
+			if(it == custom_types_.end()) {
+				throw std::invalid_argument("Unknown edge type " + type);
+			}
+
+			t = static_cast<EdgeType>(NUM_PREDEFINED_TYPES +
+			                          (it - custom_types_.begin()));
+		}
+
+		return t;
+	}
+
+	std::vector<size_t> CompressedGraph::vertexSet() const
+	{
+		std::vector<size_t> result(entities_);
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+
+	EdgeType CompressedGraph::predefinedEdgeType(const std::string& type)
+	{
+		const auto& names = predefinedEdgeTypeNames();
+		auto it = std::find(names.begin(), names.end(), type);
+
+		return static_cast<EdgeType>(it - names.begin());
+	}
+}
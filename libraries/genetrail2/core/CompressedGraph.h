@@ -0,0 +1,219 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_CORE_COMPRESSED_GRAPH_H
+#define GT2_CORE_COMPRESSED_GRAPH_H
+
+#include "macros.h"
+
+#include "BoostGraph.h"
+#include "EntityDatabase.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace GeneTrail
+{
+	/**
+	 * Regulation types of the edges of a CompressedGraph. Types that are
+	 * not known in advance are interned by the graph and receive ids
+	 * starting at FIRST_CUSTOM_EDGE_TYPE.
+	 */
+	enum class EdgeType : uint16_t {
+		PROTEIN_PROTEIN = 0,
+		ACTIVATION,
+		INHIBITION,
+		EXPRESSION,
+		REPRESSION,
+		INDIRECT_EFFECT,
+		STATE_CHANGE,
+		BINDING,
+		DISSOCIATION,
+		PHOSPHORYLATION,
+		DEPHOSPHORYLATION,
+		GLYCOSYLATION,
+		UBIQUITINATION,
+		METHYLATION,
+		COMPOUND,
+		FIRST_CUSTOM_EDGE_TYPE
+	};
+
+	/**
+	 * An immutable directed graph stored as forward and reverse compressed
+	 * sparse row (CSR) arrays.
+	 *
+	 * Vertices are numbered densely from 0 to numberOfVertices() - 1 in the
+	 * order in which they were first encountered. Every vertex refers to an
+	 * entity of the EntityDatabase the graph has been built with, so vertex
+	 * names are not stored in the graph. Edges keep the order in which they
+	 * were added, both in the outgoing and the ingoing lists.
+	 */
+	class GT2_EXPORT CompressedGraph
+	{
+		public:
+		using vertex_type = uint32_t;
+		using edge_type = uint32_t;
+
+		/// Marks a vertex or edge that could not be found.
+		static const uint32_t NOT_FOUND = static_cast<uint32_t>(-1);
+
+		/**
+		 * Helper that collects vertices and edges and creates the
+		 * compressed representation once all edges are known.
+		 */
+		class GT2_EXPORT Builder
+		{
+			public:
+			explicit Builder(const std::shared_ptr<EntityDatabase>& db);
+
+			/**
+			 * Returns the id of the vertex with the given name. If the
+			 * vertex does not exist yet, it is created.
+			 */
+			vertex_type addVertex(const std::string& name);
+
+			/**
+			 * Adds an edge from source to target. Parallel edges are
+			 * allowed, mirroring the behaviour of GraphType.
+			 */
+			void addEdge(vertex_type source, vertex_type target, const std::string& type);
+
+			/**
+			 * Convenience overload that creates missing vertices.
+			 */
+			void addEdge(const std::string& source, const std::string& target, const std::string& type);
+
+			/**
+			 * Creates the graph. The builder is left empty.
+			 */
+			CompressedGraph build();
+
+			private:
+			std::shared_ptr<EntityDatabase> db_;
+			std::vector<size_t> entities_;
+			std::vector<vertex_type> entity_to_vertex_;
+			std::vector<std::string> custom_types_;
+			std::vector<std::tuple<vertex_type, vertex_type, EdgeType>> edges_;
+		};
+
+		CompressedGraph();
+
+		/**
+		 * Adapter that converts a boost graph into the compressed
+		 * representation. The order of the in- and out-edges of every
+		 * vertex is preserved.
+		 */
+		CompressedGraph(const std::shared_ptr<EntityDatabase>& db, const GraphType& graph);
+
+		/**
+		 * Adapter that converts the compressed graph back into a boost graph.
+		 */
+		GraphType toBoostGraph() const;
+
+		size_t numberOfVertices() const { return entities_.size(); }
+		size_t numberOfEdges() const { return out_targets_.size(); }
+
+		const std::shared_ptr<EntityDatabase>& entityDatabase() const { return db_; }
+
+		/// The EntityDatabase id of vertex v.
+		size_t entity(vertex_type v) const { return entities_[v]; }
+
+		/// The name of vertex v.
+		const std::string& name(vertex_type v) const { return db_->name(entities_[v]); }
+
+		/**
+		 * Returns the vertex for the given name or NOT_FOUND if the name is
+		 * not part of the graph.
+		 */
+		vertex_type vertex(const std::string& name) const;
+
+		/**
+		 * Returns the vertex for the given EntityDatabase id or NOT_FOUND if
+		 * the entity is not part of the graph.
+		 */
+		vertex_type vertexForEntity(size_t entity) const;
+
+		bool hasVertex(const std::string& name) const { return vertex(name) != NOT_FOUND; }
+
+		size_t outDegree(vertex_type v) const { return out_offsets_[v + 1] - out_offsets_[v]; }
+		size_t inDegree(vertex_type v) const { return in_offsets_[v + 1] - in_offsets_[v]; }
+
+		/// Targets of the outgoing edges of v as a contiguous range.
+		const vertex_type* outBegin(vertex_type v) const { return out_targets_.data() + out_offsets_[v]; }
+		const vertex_type* outEnd(vertex_type v) const { return out_targets_.data() + out_offsets_[v + 1]; }
+
+		/// Sources of the ingoing edges of v as a contiguous range.
+		const vertex_type* inBegin(vertex_type v) const { return in_sources_.data() + in_offsets_[v]; }
+		const vertex_type* inEnd(vertex_type v) const { return in_sources_.data() + in_offsets_[v + 1]; }
+
+		/// Index of the first outgoing edge of v. Edge ids are positions in the forward CSR.
+		edge_type firstOutEdge(vertex_type v) const { return out_offsets_[v]; }
+
+		/// Index of the first ingoing edge of v in the reverse CSR.
+		edge_type firstInEdge(vertex_type v) const { return in_offsets_[v]; }
+
+		vertex_type target(edge_type e) const { return out_targets_[e]; }
+		EdgeType outEdgeType(edge_type e) const { return out_types_[e]; }
+		EdgeType inEdgeType(edge_type e) const { return in_types_[e]; }
+
+		/**
+		 * Returns the first edge from source to target or NOT_FOUND.
+		 */
+		edge_type findEdge(vertex_type source, vertex_type target) const;
+
+		/**
+		 * Returns the textual representation of an edge type.
+		 */
+		const std::string& edgeTypeName(EdgeType type) const;
+
+		/**
+		 * Returns the EntityDatabase ids of all vertices, sorted ascendingly.
+		 */
+		std::vector<size_t> vertexSet() const;
+
+		/**
+		 * Converts a textual regulation type into one of the predefined
+		 * edge types. Returns FIRST_CUSTOM_EDGE_TYPE for unknown types.
+		 */
+		static EdgeType predefinedEdgeType(const std::string& type);
+
+		private:
+		// Looks up an edge type that has already been added by the builder
+		EdgeType edgeType_(const std::string& type) const;
+
+		std::shared_ptr<EntityDatabase> db_;
+
+		std::vector<size_t> entities_;
+		std::vector<vertex_type> entity_to_vertex_;
+
+		std::vector<edge_type> out_offsets_;
+		std::vector<vertex_type> out_targets_;
+		std::vector<EdgeType> out_types_;
+
+		std::vector<edge_type> in_offsets_;
+		std::vector<vertex_type> in_sources_;
+		std::vector<EdgeType> in_types_;
+
+		std::vector<std::string> custom_types_;
+	};
+}
+
+#endif // GT2_CORE_COMPRESSED_GRAPH_H
@@ -23,6 +23,7 @@
 #include "Exception.h"
 
 #include <algorithm>
+#include <limits>
 
 namespace GeneTrail
 {
@@ -52,8 +53,11 @@ namespace GeneTrail
 
 	DenseColumnSubset::DenseColumnSubset(DenseColumnSubset&& subs)
 		: mat_(subs.mat_),
-		  col_subset_(std::move(subs.col_subset_))
+		  col_subset_(std::move(subs.col_subset_)),
+		  col_index_(std::move(subs.col_index_)),
+		  col_index_valid_(subs.col_index_valid_)
 	{
+		subs.col_index_valid_ = false;
 	}
 
 	/*
@@ -65,6 +69,9 @@ namespace GeneTrail
 
 		mat_ = subs.mat_;
 		col_subset_ = std::move(subs.col_subset_);
+		col_index_ = std::move(subs.col_index_);
+		col_index_valid_ = subs.col_index_valid_;
+		subs.col_index_valid_ = false;
 
 		return *this;
 	}
@@ -86,13 +93,7 @@ namespace GeneTrail
 
 	bool DenseColumnSubset::hasCol(const std::string& name) const
 	{
-		for(auto i : col_subset_) {
-			if(mat_->colName(i) == name) {
-				return true;
-			}
-		}
-
-		return false;
+		return colIndex(name) != std::numeric_limits<index_type>::max();
 	}
 
 	Matrix::index_type DenseColumnSubset::rowIndex(const std::string& row) const
@@ -112,17 +113,43 @@ namespace GeneTrail
 
 	Matrix::index_type DenseColumnSubset::colIndex(const std::string& col) const
 	{
-		int idx = 0;
+		if(!col_index_valid_) {
+			updateColIndex_();
+		}
+
+		const index_type i = mat_->colIndex(col);
+		const auto it = col_index_.find(i);
 
-		for(auto i : col_subset_) {
+		if(it == col_index_.end()) {
+			return std::numeric_limits<index_type>::max();
+		}
 
-			if(mat_->colName(i) == col) {
-				return idx;
+		// Renaming might have invalidated the entry of a duplicated name
+		if(mat_->colName(col_subset_[it->second]) != col) {
+			return std::numeric_limits<index_type>::max();
+		}
+
+		return it->second;
+	}
+
+	void DenseColumnSubset::updateColIndex_() const
+	{
+		col_index_.clear();
+		col_index_.reserve(col_subset_.size());
+
+		for(index_type k = 0; k < col_subset_.size(); ++k) {
+			const index_type i = col_subset_[k];
+			col_index_.emplace(i, k);
+
+			// The matrix resolves a duplicated name to its first occurrence,
+			// which need not be part of the subset.
+			const index_type first = mat_->colIndex(mat_->colName(i));
+			if(first != i && first != std::numeric_limits<index_type>::max()) {
+				col_index_.emplace(first, k);
 			}
-			++idx;
 		}
 
-		return -1;
+		col_index_valid_ = true;
 	}
 
 	const std::string& DenseColumnSubset::colName(Matrix::index_type j) const
@@ -201,6 +228,7 @@ namespace GeneTrail
 	void DenseColumnSubset::removeCols(const std::vector< Matrix::index_type >& indices)
 	{
 		remove_(indices, col_subset_);
+		col_index_valid_ = false;
 	}
 
 	void DenseColumnSubset::removeRows(const std::vector< Matrix::index_type >& indices)
@@ -217,6 +245,7 @@ namespace GeneTrail
 		}
 
 		std::swap(col_subset_, tmp);
+		col_index_valid_ = false;
 	}
 
 	void DenseColumnSubset::shuffleRows(const std::vector< Matrix::index_type >& perm)
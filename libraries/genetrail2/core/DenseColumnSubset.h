@@ -25,6 +25,8 @@
 #include <iostream>
 #include "macros.h"
 
+#include <unordered_map>
+
 #include <boost/range/irange.hpp>
 
 namespace GeneTrail
@@ -121,11 +123,18 @@ namespace GeneTrail
 			DenseMatrix* mat_;
 			ISubset col_subset_;
 
+			// Maps cols of the matrix to their first position in the subset.
+			// It is built on the first name lookup, as subsets are often
+			// modified many times without looking up a single name.
+			mutable std::unordered_map<index_type, index_type> col_index_;
+			mutable bool col_index_valid_ = false;
+
 			// TODO: Think of something smart to fix the hack below
 			mutable SSubset row_names_cache_;
 			mutable SSubset col_names_cache_;
 
 			void remove_(const std::vector<Matrix::index_type>& indices, ISubset& subset);
+			void updateColIndex_() const;
 	};
 
 	template<typename Iterator>
@@ -139,6 +148,7 @@ namespace GeneTrail
 	void DenseColumnSubset::assign(InputIterator first, InputIterator last)
 	{
 		col_subset_.assign(first, last);
+		col_index_valid_ = false;
 	}
 
 }
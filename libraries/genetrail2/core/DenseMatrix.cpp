@@ -20,6 +20,7 @@
 
 #include "DenseMatrix.h"
 
+#include <algorithm>
 #include <limits>
 #include <cassert>
 #include <iostream>
@@ -87,40 +88,26 @@ namespace GeneTrail
 
 	void DenseMatrix::rbind(const DenseMatrix& m){
 		assert(cols() == m.cols());
-		auto r1 = rowNames();
-		auto r2 = m.rowNames();
 		DMatrix tmp(rows() + m.rows(),cols());
 		tmp << m_,m.matrix();
 		std::swap(tmp,m_);
-		std::vector<std::string> new_row_names;
-		new_row_names.reserve(r1.size() + r2.size());
-		new_row_names.insert(new_row_names.end(), r1.begin(), r1.end());
-		new_row_names.insert(new_row_names.end(), r2.begin(), r2.end());
-		index_to_rowname_ = new_row_names;
-		this->updateRowAndColNames_();
+		row_names_.append(m.rowNames());
 	}
 
 	void DenseMatrix::cbind(const DenseMatrix& m){
 		assert(rows() == m.rows());
-		auto c1 = colNames();
-		auto c2 = m.colNames();
 		DMatrix tmp(rows(),cols() + m.cols());
 		tmp << m_, m.matrix();
 		std::swap(tmp,m_);
-		std::vector<std::string> new_col_names;
-		new_col_names.reserve(c1.size() + c2.size());
-		new_col_names.insert(new_col_names.end(), c1.begin(), c1.end());
-		new_col_names.insert(new_col_names.end(), c2.begin(), c2.end());
-		index_to_colname_ = new_col_names;
-		this->updateRowAndColNames_();
+		col_names_.append(m.colNames());
 	}
 
 	void DenseMatrix::setCol(const std::string& name, const DenseMatrix::Vector& v)
 	{
-		auto res = colname_to_index_.find(name);
+		auto res = col_names_.find(name);
 
-		if(res != colname_to_index_.end()) {
-			m_.col(res->second) = v;
+		if(res != NameIndex::NOT_FOUND) {
+			m_.col(res) = v;
 		}
 	}
 
@@ -129,89 +116,92 @@ namespace GeneTrail
 		m_.col(j) = v;
 	}
 
-	void DenseMatrix::remove_(const std::vector<index_type>& indices,
-	                                std::map<std::string, index_type>& name_to_index,
-	                                std::vector<std::string>& index_to_name,
-	                                std::function<void(index_type, index_type)> copy)
+	void DenseMatrix::removeCols(const std::vector< index_type >& indices)
 	{
-		size_t next_idx = 1;
+		if(indices.empty()) {
+			return;
+		}
+
+		// The columns are contiguous, so the kept columns are moved
+		// to the front in a single pass of block copies.
+		const size_t rows = m_.rows();
+		double* data = m_.data();
+
 		size_t write_idx = indices[0];
-		name_to_index.erase(index_to_name[write_idx]);
-
-		for(size_t read_idx = indices[0] + 1; read_idx < index_to_name.size(); ++read_idx)
-		{
-			// If we reached another column that should be deleted, just advance the read pointer
-			// to the next index
-			if(next_idx < indices.size() && read_idx == indices[next_idx])
-			{
+		size_t next_idx = 1;
+		for(size_t read_idx = indices[0] + 1; read_idx < (size_t)m_.cols(); ++read_idx) {
+			if(next_idx < indices.size() && read_idx == indices[next_idx]) {
 				assert(indices[next_idx - 1] < indices[next_idx]);
-				// Update the name <-> index mapping
-				name_to_index.erase(index_to_name[read_idx]);
 				++next_idx;
+				continue;
 			}
-			else
-			{
-				// Update the name <-> index mapping
-				auto it = name_to_index.find(index_to_name[write_idx]);
-
-				if(it != name_to_index.end() && it->second == write_idx) {
-					name_to_index.erase(it);
-				}
-
-				const std::string name = index_to_name[read_idx];
-				index_to_name[write_idx] = name;
-				name_to_index[name] = write_idx;
-
-				copy(write_idx, read_idx);
-				++write_idx;
-			}
-		}
 
-		// Check consistency of the name maps
-		assert(name_to_index.size() == index_to_name.size() - indices.size());
-	}
-
-	void DenseMatrix::removeCols(const std::vector< index_type >& indices)
-	{
-		//TODO consolidate with removeRows
-		if(indices.empty()) {
-			return;
+			std::copy(data + read_idx * rows, data + (read_idx + 1) * rows, data + write_idx * rows);
+			++write_idx;
 		}
 
-		// Call the generalized remove function
-		remove_(indices, colname_to_index_, index_to_colname_, [this](index_type i, index_type j) {
-			m_.col(i) = m_.col(j);
-		});
-
 		// Free the memory of the unneeded columns
 		m_.conservativeResize(Eigen::NoChange, m_.cols() - indices.size());
-		index_to_colname_.resize(m_.cols());
+		col_names_.remove(indices);
 	}
 
-
 	void DenseMatrix::removeRows(const std::vector< index_type >& indices)
 	{
-		//TODO consolidate with removeRows
 		if(indices.empty()) {
 			return;
 		}
 
-		// Call the generalized remove function
-		remove_(indices, rowname_to_index_, index_to_rowname_, [this](index_type i, index_type j) {
-			m_.row(i) = m_.row(j);
-		});
+		// Compute the runs of consecutive rows that are kept
+		std::vector<std::pair<index_type, index_type>> runs;
+		index_type first = 0;
+		for(size_t i = 0; i < indices.size(); ++i) {
+			assert(i == 0 || indices[i - 1] < indices[i]);
+			if(first < indices[i]) {
+				runs.emplace_back(first, indices[i]);
+			}
+			first = indices[i] + 1;
+		}
+		if(first < m_.rows()) {
+			runs.emplace_back(first, m_.rows());
+		}
 
-		// Free the memory of the unneeded columns
-		m_.conservativeResize(m_.rows() - indices.size(), Eigen::NoChange);
-		index_to_rowname_.resize(m_.rows());
+		// Compact the runs of every column to the front of the storage. The
+		// target of a column never lies behind its source, so processing
+		// the columns in order does not overwrite unread values.
+		const size_t old_rows = m_.rows();
+		const size_t new_rows = old_rows - indices.size();
+		const size_t cols = m_.cols();
+
+		double* data = m_.data();
+		double* dst = data;
+		for(size_t c = 0; c < cols; ++c) {
+			const double* col = data + c * old_rows;
+			for(const auto& run : runs) {
+				if(dst == col + run.first) {
+					dst += run.second - run.first;
+				} else {
+					dst = std::copy(col + run.first, col + run.second, dst);
+				}
+			}
+		}
+
+		// Eigen only shrinks column-major storage without copying if the
+		// number of rows is kept. Thus, the storage is viewed as a single
+		// row while it is shrunk. Resizing to the same number of
+		// coefficients merely changes the dimensions.
+		m_.resize(1, old_rows * cols);
+		m_.conservativeResize(1, new_rows * cols);
+		m_.resize(new_rows, cols);
+
+		row_names_.remove(indices);
 	}
 
 	void DenseMatrix::setRow(const std::string& name, const DenseMatrix::Vector& v)
 	{
-		auto res = rowname_to_index_.find(name);
+		auto res = row_names_.find(name);
 
-		if(res != rowname_to_index_.end()) {
-			m_.row(res->second) = v.transpose();
+		if(res != NameIndex::NOT_FOUND) {
+			m_.row(res) = v.transpose();
 		}
 	}
 
@@ -237,43 +227,57 @@ namespace GeneTrail
 	    setColNames(orientation);
 	  }
 	
-	void DenseMatrix::shuffle_(std::vector<index_type> perm,
-	                           std::map<std::string, index_type>& name_to_index,
-	                           std::vector<std::string>& index_to_name,
-	                           std::function<void(index_type, index_type)> swap)
+	void DenseMatrix::shuffleCols(const std::vector< index_type >& perm)
 	{
-		for(size_t i = 0; i < perm.size(); ++i) {
-			// Push the data through one cycle of the permutation
-			index_type next = i;
+		assert(perm.size() == (size_t)m_.cols());
 
-			// Invariant: Everything below i is shuffled correctly
-			while(perm[next] > i) {
-				// Swap names and data
-				swap(perm[next], next);
-				std::swap(name_to_index[index_to_name[perm[next]]], name_to_index[index_to_name[next]]);
-				std::swap(index_to_name[perm[next]], index_to_name[next]);
+		// Follow the cycles of the permutation and move whole columns.
+		// One column of scratch space is needed per cycle.
+		std::vector<char> done(perm.size(), 0);
+		Vector tmp(m_.rows());
 
-				// Get the next target we swap to
-				std::swap(next, perm[next]);
+		for(index_type i = 0; i < perm.size(); ++i) {
+			if(done[i] || perm[i] == i) {
+				continue;
 			}
 
-			// The last part of the cycle is ordered too
-			perm[next] = next;
+			tmp = m_.col(i);
+
+			index_type next = i;
+			while(perm[next] != i) {
+				m_.col(next) = m_.col(perm[next]);
+				done[next] = 1;
+				next = perm[next];
+			}
+
+			m_.col(next) = tmp;
+			done[next] = 1;
 		}
-	}
 
-	void DenseMatrix::shuffleCols(const std::vector< index_type >& perm)
-	{
-		shuffle_(perm, colname_to_index_, index_to_colname_, [this](index_type i, index_type j) {
-			m_.col(i).swap(m_.col(j));
-		});
+		col_names_.permute(perm);
 	}
 
 	void DenseMatrix::shuffleRows(const std::vector< index_type >& perm)
 	{
-		shuffle_(perm, rowname_to_index_, index_to_rowname_, [this](index_type i, index_type j) {
-			m_.row(i).swap(m_.row(j));
-		});
+		assert(perm.size() == (size_t)m_.rows());
+
+		// Rows are strided in column-major storage. Instead of swapping
+		// single entries, every column is gathered into a buffer and
+		// copied back. This runs sequentially, as callers such as the
+		// permutation tests already work in parallel.
+		const size_t rows = m_.rows();
+		double* data = m_.data();
+
+		std::vector<double> buffer(rows);
+		for(size_t c = 0; c < (size_t)m_.cols(); ++c) {
+			double* col = data + c * rows;
+			for(size_t i = 0; i < rows; ++i) {
+				buffer[i] = col[perm[i]];
+			}
+			std::copy(buffer.begin(), buffer.end(), col);
+		}
+
+		row_names_.permute(perm);
 	}
 
 	void DenseMatrix::transpose()
@@ -224,18 +224,6 @@ namespace GeneTrail
 		private:
 			// Actual matrix payload
 			DMatrix m_;
-
-
-			// Helper for removing rows or columns
-			void remove_(const std::vector<index_type>& indices,
-			                   std::map<std::string, index_type>& name_to_index,
-			                   std::vector<std::string>& index_to_name,
-			                   std::function<void(index_type, index_type)> copy);
-
-			void shuffle_(std::vector<index_type> perm,
-			              std::map<std::string, index_type>& name_to_index,
-			              std::vector<std::string>& index_to_name,
-			              std::function<void(index_type, index_type)> swap);
 			
 // 			struct MyComparator{
 // 			    const std::vector<int> order;
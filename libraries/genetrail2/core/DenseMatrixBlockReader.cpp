@@ -0,0 +1,371 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "DenseMatrixBlockReader.h"
+
+#include "DenseMatrix.h"
+#include "Exception.h"
+
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace GeneTrail
+{
+	namespace
+	{
+		const char* const nan_like_symbols[] = {"NA",  "NaN",  "NAN",
+		                                        "nan", "null", "NULL"};
+
+		enum ChunkType : uint8_t {
+			HEADER = 0x00,
+			ROWNAMES = 0x01,
+			COLNAMES = 0x02,
+			DATA = 0x03
+		};
+	}
+
+	DenseMatrixBlockReader::DenseMatrixBlockReader(const std::string& path,
+	                                               unsigned int opts)
+	    : input_(path, std::ios::binary), opts_(opts)
+	{
+		if(!input_) {
+			throw IOError("Could not open " + path + " for reading");
+		}
+
+		if(opts & DenseMatrixReader::TRANSPOSE) {
+			throw NotImplemented(__FILE__, __LINE__,
+			                     "Transposed matrices cannot be read in blocks");
+		}
+
+		char magic[12];
+		input_.read(magic, 12);
+		binary_ = input_.gcount() == 12 && strncmp(magic, "BINARYMATRIX", 12) == 0;
+
+		if(binary_) {
+			openBinary_();
+		} else {
+			input_.clear();
+			input_.seekg(0, std::ios::beg);
+			openText_();
+		}
+	}
+
+	size_t DenseMatrixBlockReader::rowsForBudget(size_t memory_budget,
+	                                             size_t cols,
+	                                             size_t blocks_in_flight)
+	{
+		// Account for the values and (roughly) for the row name
+		const size_t bytes_per_row =
+		    std::max(cols, size_t(1)) * sizeof(DenseMatrix::value_type) +
+		    sizeof(std::string);
+
+		// The reader holds another copy of a block while parsing it
+		const size_t copies = std::max(blocks_in_flight, size_t(1)) + 1;
+
+		return std::max(memory_budget / (copies * bytes_per_row), size_t(1));
+	}
+
+	bool DenseMatrixBlockReader::next(DenseMatrix& block, size_t max_rows)
+	{
+		if(max_rows == 0) {
+			throw std::invalid_argument("Blocks need to contain at least one row");
+		}
+
+		return binary_ ? nextBinary_(block, max_rows)
+		               : nextText_(block, max_rows);
+	}
+
+	void DenseMatrixBlockReader::prepareBlock_(DenseMatrix& block,
+	                                           size_t rows) const
+	{
+		if(block.rows() != rows || block.cols() != num_cols_) {
+			block = DenseMatrix(rows, num_cols_);
+		}
+
+		if(col_names_.size() == num_cols_ && block.colNames() != col_names_) {
+			block.setColNames(col_names_);
+		}
+	}
+
+	void DenseMatrixBlockReader::openText_()
+	{
+		if(!nextLine_()) {
+			return;
+		}
+
+		if(opts_ & DenseMatrixReader::READ_COL_NAMES) {
+			const size_t offset =
+			    (opts_ & DenseMatrixReader::ADDITIONAL_COL_NAME) ? 1 : 0;
+
+			for(size_t i = offset; i < fields_.size(); ++i) {
+				col_names_.emplace_back(fields_[i]);
+			}
+
+			num_cols_ = col_names_.size();
+
+			if(!nextLine_()) {
+				return;
+			}
+		}
+
+		const size_t start = (opts_ & DenseMatrixReader::READ_ROW_NAMES) ? 1 : 0;
+
+		num_fields_ = fields_.size();
+		num_cols_ = num_fields_ - std::min(start, num_fields_);
+
+		// As DenseMatrixReader we silently drop names that do not match
+		if(col_names_.size() != num_cols_) {
+			col_names_.clear();
+		}
+	}
+
+	bool DenseMatrixBlockReader::nextLine_()
+	{
+		const bool split_only_tab = opts_ & DenseMatrixReader::SPLIT_ONLY_TAB;
+
+		while(std::getline(input_, line_)) {
+			++line_number_;
+
+			// If only tabs separate the fields, a leading tab is an empty
+			// first field, which would be lost by trimming.
+			const size_t first = line_.find_first_not_of(' ');
+			empty_first_field_ = split_only_tab && first != std::string::npos &&
+			                     line_[first] == '\t';
+
+			boost::trim(line_);
+
+			if(line_.empty()) {
+				continue;
+			}
+
+			// Split the line in place, consecutive delimiters are merged
+			fields_.clear();
+			char* field = &line_[0];
+			for(char& c : line_) {
+				if(c == '\t' || (!split_only_tab && c == ' ')) {
+					c = '\0';
+					if(field != &c) {
+						fields_.push_back(field);
+					}
+					field = &c + 1;
+				}
+			}
+			fields_.push_back(field);
+
+			has_line_ = true;
+			return true;
+		}
+
+		has_line_ = false;
+		return false;
+	}
+
+	double DenseMatrixBlockReader::parseValue_(char* field) const
+	{
+		char* end = nullptr;
+		const double value = std::strtod(field, &end);
+
+		if(end != field && *end == '\0') {
+			return value;
+		}
+
+		for(const char* symbol : nan_like_symbols) {
+			if(strcmp(field, symbol) == 0) {
+				return std::numeric_limits<double>::quiet_NaN();
+			}
+		}
+
+		throw IOError("Invalid value '" + std::string(field) + "' in line " +
+		              boost::lexical_cast<std::string>(line_number_));
+	}
+
+	bool DenseMatrixBlockReader::nextText_(DenseMatrix& block, size_t max_rows)
+	{
+		if(!has_line_) {
+			return false;
+		}
+
+		const size_t start = (opts_ & DenseMatrixReader::READ_ROW_NAMES) ? 1 : 0;
+
+		// Parse row-major into the buffer, as the number of rows is not
+		// known in advance.
+		buffer_.clear();
+		row_names_.clear();
+
+		size_t rows = 0;
+		for(; rows < max_rows && has_line_; ++rows) {
+			if(start && empty_first_field_) {
+				throw IOError("Empty row name in line " +
+				              boost::lexical_cast<std::string>(line_number_));
+			}
+
+			if(fields_.size() != num_fields_) {
+				throw IOError(
+				    "Expected " + boost::lexical_cast<std::string>(num_fields_) +
+				    " columns in line " +
+				    boost::lexical_cast<std::string>(line_number_) + ", got " +
+				    boost::lexical_cast<std::string>(fields_.size()));
+			}
+
+			if(start) {
+				row_names_.emplace_back(fields_[0]);
+			}
+
+			for(size_t i = start; i < fields_.size(); ++i) {
+				buffer_.push_back(parseValue_(fields_[i]));
+			}
+
+			nextLine_();
+		}
+
+		prepareBlock_(block, rows);
+
+		block.matrix() = Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>(
+		    buffer_.data(), rows, num_cols_);
+
+		if(start) {
+			block.setRowNames(row_names_);
+		}
+
+		return true;
+	}
+
+	void DenseMatrixBlockReader::openBinary_()
+	{
+		uint8_t chunk_type = 0;
+		uint64_t chunk_size = 0;
+
+		auto readChunkHeader = [this, &chunk_type, &chunk_size]() {
+			input_.read((char*)&chunk_type, 1);
+			input_.read((char*)&chunk_size, 8);
+			return static_cast<bool>(input_);
+		};
+
+		if(!readChunkHeader() || chunk_type != HEADER) {
+			throw IOError("Unexpected chunk: expected 0 (matrix header)");
+		}
+
+		if(chunk_size != 9) {
+			throw IOError("Inconsistent header size: expected 9 got " +
+			              boost::lexical_cast<std::string>(chunk_size));
+		}
+
+		uint32_t num_cols = 0;
+		input_.read((char*)&num_rows_, 4);
+		input_.read((char*)&num_cols, 4);
+		input_.read((char*)&storage_order_, 1);
+		num_cols_ = num_cols;
+
+		while(readChunkHeader()) {
+			switch(chunk_type) {
+				case HEADER:
+					throw IOError("Unexpected chunk: did not expect header chunk!");
+				case ROWNAMES:
+					row_names_.assign(num_rows_, std::string());
+					readNames_(chunk_size, row_names_);
+
+					if(std::find(row_names_.begin(), row_names_.end(), "") != row_names_.end()) {
+						throw IOError("Binary matrix contains an empty row name");
+					}
+					break;
+				case COLNAMES:
+					col_names_.assign(num_cols_, std::string());
+					readNames_(chunk_size, col_names_);
+					break;
+				case DATA:
+					if(sizeof(DenseMatrix::value_type) * num_rows_ * num_cols_ !=
+					   chunk_size) {
+						throw IOError("Inconsistent data chunk size!");
+					}
+
+					data_offset_ = input_.tellg();
+					input_.seekg(chunk_size, std::ios::cur);
+					break;
+				default:
+					input_.seekg(chunk_size, std::ios::cur);
+			}
+		}
+
+		input_.clear();
+
+		if(data_offset_ < 0) {
+			throw IOError("Binary matrix does not contain a data chunk");
+		}
+	}
+
+	void DenseMatrixBlockReader::readNames_(uint64_t chunk_size,
+	                                        std::vector<std::string>& names)
+	{
+		const std::streamoff end = input_.tellg() + std::streamoff(chunk_size);
+
+		for(auto& name : names) {
+			if(input_.tellg() >= end || !std::getline(input_, name, '\0')) {
+				throw IOError("Binary matrix contains too few names");
+			}
+		}
+
+		input_.seekg(end, std::ios::beg);
+	}
+
+	bool DenseMatrixBlockReader::nextBinary_(DenseMatrix& block, size_t max_rows)
+	{
+		if(next_row_ >= num_rows_) {
+			return false;
+		}
+
+		const size_t rows = std::min(max_rows, num_rows_ - next_row_);
+		const size_t value_size = sizeof(DenseMatrix::value_type);
+
+		prepareBlock_(block, rows);
+
+		if(storage_order_ == 0) {
+			// Consecutive rows are contiguous
+			buffer_.resize(rows * num_cols_);
+			input_.seekg(data_offset_ + std::streamoff(next_row_ * num_cols_ * value_size));
+			input_.read((char*)buffer_.data(), buffer_.size() * value_size);
+
+			block.matrix() = Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>(
+			    buffer_.data(), rows, num_cols_);
+		} else {
+			// Read the part of every column directly into the block
+			for(size_t j = 0; j < num_cols_; ++j) {
+				input_.seekg(data_offset_ + std::streamoff((j * num_rows_ + next_row_) * value_size));
+				input_.read((char*)block.matrix().col(j).data(), rows * value_size);
+			}
+		}
+
+		if(!input_) {
+			throw IOError("Unexpected end of binary matrix");
+		}
+
+		if(!row_names_.empty()) {
+			block.setRowNames(std::vector<std::string>(
+			    row_names_.begin() + next_row_,
+			    row_names_.begin() + next_row_ + rows));
+		}
+
+		next_row_ += rows;
+
+		return true;
+	}
+}
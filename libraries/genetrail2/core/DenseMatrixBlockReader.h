@@ -0,0 +1,129 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_CORE_DENSE_MATRIX_BLOCK_READER_H
+#define GT2_CORE_DENSE_MATRIX_BLOCK_READER_H
+
+#include "DenseMatrixReader.h"
+
+#include "macros.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace GeneTrail
+{
+	class DenseMatrix;
+
+	/**
+	 * Reads a matrix in blocks of consecutive rows, so that only a single
+	 * block has to be kept in memory. Both, the text and the binary format
+	 * of DenseMatrixReader are supported. The options have the same meaning
+	 * as for DenseMatrixReader, except for TRANSPOSE, which is not
+	 * supported.
+	 *
+	 * Text files are parsed line by line. For binary files only the names
+	 * are read on construction, blocks are read directly from the DATA
+	 * chunk. For column major files this requires one seek per column and
+	 * block.
+	 *
+	 * The reader is not thread safe, but it may be used from a different
+	 * thread than the one that created it, e.g. to prefetch the next block.
+	 */
+	class GT2_EXPORT DenseMatrixBlockReader
+	{
+		public:
+		/**
+		 * Opens the matrix stored at path and reads its column names.
+		 *
+		 * @throws IOError if the file cannot be opened or is invalid.
+		 * @throws NotImplemented if TRANSPOSE is passed.
+		 */
+		explicit DenseMatrixBlockReader(
+		    const std::string& path,
+		    unsigned int opts = DenseMatrixReader::defaultOptions());
+
+		/**
+		 * The number of rows per block such that blocks_in_flight blocks
+		 * with cols columns, and the buffer the reader parses a block
+		 * into, fit into memory_budget bytes. At least one row is
+		 * returned.
+		 */
+		static size_t rowsForBudget(size_t memory_budget, size_t cols,
+		                            size_t blocks_in_flight = 2);
+
+		/// True if the matrix is stored in the binary format
+		bool isBinary() const { return binary_; }
+
+		/// The number of columns of the matrix
+		size_t cols() const { return num_cols_; }
+
+		/// The column names. Empty if the file does not contain any.
+		const std::vector<std::string>& colNames() const { return col_names_; }
+
+		/**
+		 * Reads up to max_rows rows into block. The storage of block is
+		 * reused if it already has the required size.
+		 *
+		 * @return False if all rows have been read, in which case block
+		 *         is left untouched.
+		 * @throws IOError if a row is malformed or its name is empty.
+		 */
+		bool next(DenseMatrix& block, size_t max_rows);
+
+		private:
+		void openText_();
+		void openBinary_();
+		void readNames_(uint64_t chunk_size, std::vector<std::string>& names);
+
+		bool nextLine_();
+		double parseValue_(char* field) const;
+		void prepareBlock_(DenseMatrix& block, size_t rows) const;
+
+		bool nextText_(DenseMatrix& block, size_t max_rows);
+		bool nextBinary_(DenseMatrix& block, size_t max_rows);
+
+		std::ifstream input_;
+		unsigned int opts_;
+		bool binary_ = false;
+
+		size_t num_cols_ = 0;
+		std::vector<std::string> col_names_;
+		std::vector<std::string> row_names_;
+
+		// Text format: the current line and its fields, which point into
+		// the line.
+		std::string line_;
+		std::vector<char*> fields_;
+		size_t num_fields_ = 0;
+		size_t line_number_ = 0;
+		bool has_line_ = false;
+		bool empty_first_field_ = false;
+
+		// Binary format
+		uint32_t num_rows_ = 0;
+		uint8_t storage_order_ = 0;
+		std::streamoff data_offset_ = -1;
+		size_t next_row_ = 0;
+		std::vector<double> buffer_;
+	};
+}
+
+#endif // GT2_CORE_DENSE_MATRIX_BLOCK_READER_H
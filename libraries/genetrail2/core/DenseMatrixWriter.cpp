@@ -48,6 +48,25 @@ namespace GeneTrail
 		return total;
 	}
 
+	uint64_t DenseMatrixWriter::writeBinaryHeader(std::ostream& output, const std::vector<std::string>& rowNames, const std::vector<std::string>& colNames) const
+	{
+		const uint64_t n = rowNames.size() * colNames.size() * sizeof(DenseMatrix::value_type);
+
+		uint64_t
+		total  = writeBinary_(output, rowNames, colNames);
+		total += writeChunkHeader_(output, 0x3, n);
+
+		return total;
+	}
+
+	uint64_t DenseMatrixWriter::writeBinaryColumn(std::ostream& output, const double* column, size_t rows) const
+	{
+		const uint64_t n = rows * sizeof(DenseMatrix::value_type);
+		output.write((const char*)column, n);
+
+		return n;
+	}
+
 	void DenseMatrixWriter::writeText(std::ostream& output, const Matrix& matrix) const
 	{
 		writeText_(output, matrix);
@@ -25,6 +25,7 @@
 #include "MatrixWriter.h"
 
 #include <ostream>
+#include <string>
 #include <vector>
 
 namespace GeneTrail
@@ -45,6 +46,20 @@ namespace GeneTrail
 			uint64_t writeBinary(std::ostream& output, const DenseMatrix& matrix) const;
 			uint64_t writeBinary(std::ostream& output, const Matrix& matrix) const;
 
+			/**
+			 * Writes the header of a binary matrix with the given row and
+			 * column names, including the header of the data chunk. The
+			 * values have to be appended column by column using
+			 * writeBinaryColumn. This allows to stream matrices that are
+			 * computed column-wise without keeping them in memory.
+			 */
+			uint64_t writeBinaryHeader(std::ostream& output, const std::vector<std::string>& rowNames, const std::vector<std::string>& colNames) const;
+
+			/**
+			 * Appends a column of a matrix started with writeBinaryHeader.
+			 */
+			uint64_t writeBinaryColumn(std::ostream& output, const double* column, size_t rows) const;
+
 		private:
 			uint64_t writeData_(std::ostream& output, const DenseMatrix& matrix) const;
 			uint64_t writeData_(std::ostream& output, const Matrix& matrix) const;
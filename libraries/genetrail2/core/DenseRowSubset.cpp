@@ -23,6 +23,7 @@
 #include "Exception.h"
 
 #include <algorithm>
+#include <limits>
 
 namespace GeneTrail
 {
@@ -52,8 +53,11 @@ namespace GeneTrail
 
 	DenseRowSubset::DenseRowSubset(DenseRowSubset&& subs)
 		: mat_(subs.mat_),
-		  row_subset_(std::move(subs.row_subset_))
+		  row_subset_(std::move(subs.row_subset_)),
+		  row_index_(std::move(subs.row_index_)),
+		  row_index_valid_(subs.row_index_valid_)
 	{
+		subs.row_index_valid_ = false;
 	}
 
 	/*
@@ -65,6 +69,9 @@ namespace GeneTrail
 
 		mat_ = subs.mat_;
 		row_subset_ = std::move(subs.row_subset_);
+		row_index_ = std::move(subs.row_index_);
+		row_index_valid_ = subs.row_index_valid_;
+		subs.row_index_valid_ = false;
 
 		return *this;
 	}
@@ -86,28 +93,48 @@ namespace GeneTrail
 
 	bool DenseRowSubset::hasRow(const std::string& name) const
 	{
-		for(auto i : row_subset_) {
-			if(mat_->rowName(i) == name) {
-				return true;
-			}
-		}
-
-		return false;
+		return rowIndex(name) != std::numeric_limits<index_type>::max();
 	}
 
 	Matrix::index_type DenseRowSubset::rowIndex(const std::string& row) const
 	{
-		int idx = 0;
+		if(!row_index_valid_) {
+			updateRowIndex_();
+		}
+
+		const index_type i = mat_->rowIndex(row);
+		const auto it = row_index_.find(i);
 
-		for(auto i : row_subset_) {
+		if(it == row_index_.end()) {
+			return std::numeric_limits<index_type>::max();
+		}
 
-			if(mat_->rowName(i) == row) {
-				return idx;
+		// Renaming might have invalidated the entry of a duplicated name
+		if(mat_->rowName(row_subset_[it->second]) != row) {
+			return std::numeric_limits<index_type>::max();
+		}
+
+		return it->second;
+	}
+
+	void DenseRowSubset::updateRowIndex_() const
+	{
+		row_index_.clear();
+		row_index_.reserve(row_subset_.size());
+
+		for(index_type k = 0; k < row_subset_.size(); ++k) {
+			const index_type i = row_subset_[k];
+			row_index_.emplace(i, k);
+
+			// The matrix resolves a duplicated name to its first occurrence,
+			// which need not be part of the subset.
+			const index_type first = mat_->rowIndex(mat_->rowName(i));
+			if(first != i && first != std::numeric_limits<index_type>::max()) {
+				row_index_.emplace(first, k);
 			}
-			++idx;
 		}
 
-		return -1;
+		row_index_valid_ = true;
 	}
 
 	const std::string& DenseRowSubset::rowName(Matrix::index_type i) const
@@ -210,6 +237,7 @@ namespace GeneTrail
 	void DenseRowSubset::removeRows(const std::vector< Matrix::index_type >& indices)
 	{
 		remove_(indices, row_subset_);
+		row_index_valid_ = false;
 	}
 
 	void DenseRowSubset::shuffleCols(const std::vector< Matrix::index_type >& perm)
@@ -226,6 +254,7 @@ namespace GeneTrail
 		}
 
 		std::swap(row_subset_, tmp);
+		row_index_valid_ = false;
 	}
 
 	void DenseRowSubset::transpose()
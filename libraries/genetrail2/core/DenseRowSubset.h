@@ -25,6 +25,8 @@
 
 #include "macros.h"
 
+#include <unordered_map>
+
 namespace GeneTrail
 {
 	/**
@@ -117,10 +119,17 @@ namespace GeneTrail
 			DenseMatrix* mat_;
 			ISubset row_subset_;
 
+			// Maps rows of the matrix to their first position in the subset.
+			// It is built on the first name lookup, as subsets are often
+			// modified many times without looking up a single name.
+			mutable std::unordered_map<index_type, index_type> row_index_;
+			mutable bool row_index_valid_ = false;
+
 			// TODO: Think of something smart to fix the hack below
 			mutable SSubset row_names_cache_;
 
 			void remove_(const std::vector<Matrix::index_type>& indices, ISubset& subset);
+			void updateRowIndex_() const;
 	};
 
 	template<typename Iterator>
@@ -134,6 +143,7 @@ namespace GeneTrail
 	void DenseRowSubset::assign(InputIterator first, InputIterator last)
 	{
 		row_subset_.assign(first, last);
+		row_index_valid_ = false;
 	}
 
 }
@@ -29,6 +29,7 @@
 #include <utility>  
 
 #include "macros.h"
+#include "misc_algorithms.h"
 
 #include <boost/numeric/conversion/cast.hpp>
 
@@ -238,19 +239,24 @@ namespace Entropy
 		return entropy;
 	}
 
-
 	struct SquaredDistance
 	{
-		template <typename value_type> 
-		value_type operator()(std::vector<value_type> a, std::vector<value_type> b)
+		template <typename value_type>
+		value_type operator()(const value_type* a, const value_type* b, size_t d) const
 		{
 			value_type dist = value_type(0);
-			for(size_t i=0; i<a.size(); ++i) {
+			for(size_t i=0; i<d; ++i) {
 				value_type diff = (a[i]-b[i]);
 				dist += diff * diff;
 			}
 			return dist;
 		}
+
+		template <typename value_type>
+		value_type operator()(const std::vector<value_type>& a, const std::vector<value_type>& b) const
+		{
+			return (*this)(a.data(), b.data(), a.size());
+		}
 	};
 
 	template <typename value_type, typename DistanceMeasure>
@@ -269,166 +275,299 @@ namespace Entropy
 			}
 			return std::get<3>(a) < std::get<3>(b);
 		});
-		return std::move(distances);
+		return distances;
 	}
 
-	/**
-	* This method calculates the conditional cummulative entropy h(X|Y).
-	*
-	* @param X Vector of scores.
-	* @param Y Vector of vector of scores.
-	*
-	* @return conditional cummulative entropy h(X|Y)
-	*/
-	template <typename value_type>
-	std::vector<value_type> conditional_cummulative_entropy_estimator_for_sorted_vectors(std::vector<value_type>& X, std::vector<std::vector<value_type> >& Y)
+	namespace internal
 	{
-		//Sort indices according to Y
-		SquaredDistance dist;
-		std::vector<size_t> indices(X.size());	
-		std::vector<value_type> nullv(Y[0].size(), value_type(0));
-		std::iota(indices.begin(), indices.end(), 0);
-		std::sort(indices.begin(), indices.end(), [&](size_t a, size_t b){
-			auto da = dist(Y[a], nullv); 
-			auto db = dist(Y[b], nullv);
-			if(da == db) {
-				return X[a] < X[b];
+		/**
+		 * Computes z/m * h(X|Z) for the bin Z that results from merging the
+		 * two increasingly sorted index ranges [a, a_end) and [b, b_end).
+		 * The merged bin is never materialized.
+		 */
+		template <typename value_type>
+		value_type merged_bin_entropy(const std::vector<value_type>& X, const size_t* a, const size_t* a_end, const size_t* b, const size_t* b_end)
+		{
+			const size_t z = (a_end - a) + (b_end - b);
+			if(z < 2) {
+				return value_type(0);
 			}
-			return da < db;
-		});
 
-		/*std::cout << "================================" << std::endl  << "Sorted with respect to Y:" << std::endl;
-		for(size_t i=0; i<indices.size();++i){
-			std::cout << "X[" << i << "]=" << X[indices[i]] << " - Y[" << i << "]=" << Y[indices[i]][0] << std::endl; 
-		}
-		std::cout << "================================" << std::endl;*/
-
-		//Initial bins
-		std::vector<value_type> bin_entropy(Y.size());
-		for(size_t i=0; i<Y.size(); ++i) {
-			bin_entropy[i] = value_type(0);
-		}
+			auto next = [&]() {
+				if(b == b_end || (a != a_end && *a < *b)) {
+					return *a++;
+				}
+				return *b++;
+			};
+
+			value_type entropy = value_type(0);
+			size_t prev = next();
+			for(size_t i=1; i<z; ++i){
+				size_t cur = next();
+				value_type i_z = boost::numeric_cast<value_type>(i)/boost::numeric_cast<value_type>(z);
+				entropy += (X[cur] - X[prev]) * i_z * log(i_z);
+				prev = cur;
+			}
 
-		//Calculate entropy of neighbours
-		std::vector<std::tuple<size_t, size_t, std::vector<size_t>, value_type, value_type>> entropy_between_neighbors(Y.size()-1);
-		for(size_t i=1; i<Y.size(); ++i){
-			std::vector<size_t> nbins(2);
-			nbins[0] = indices[i];
-			nbins[1] = indices[i-1];
-			std::sort(nbins.begin(), nbins.end());
-			value_type z_n = boost::numeric_cast<value_type>(nbins.size()) / boost::numeric_cast<value_type>(X.size());
-			value_type e = z_n * conditional_cummulative_entropy_for_sorted_vectors(X, nbins);
-			entropy_between_neighbors[i-1] = std::make_tuple(i-1, i, nbins, e, e);
+			value_type z_m = boost::numeric_cast<value_type>(z)/boost::numeric_cast<value_type>(X.size());
+			return -z_m * entropy;
 		}
 
-		std::sort(entropy_between_neighbors.begin(), entropy_between_neighbors.end(), [&](const auto& a, const auto& b){
-			return std::get<4>(a) < std::get<4>(b);
-		});
+		/**
+		 * Greedy estimator working on the sorted target X and the row-major
+		 * samples Y (one row of dimension d per entry of X).
+		 *
+		 * The samples are ordered by their squared norm. Every bin is a
+		 * contiguous range of this order and its members (indices into X)
+		 * are kept sorted in place, so merging two neighbouring bins is a
+		 * single std::merge. The candidate merges are kept in a heap that is
+		 * keyed by the increase of the total entropy. Outdated heap entries
+		 * are skipped lazily.
+		 *
+		 * Every merge costs O(log n) heap operations, but merging the members
+		 * and re-evaluating the two neighbouring candidates is linear in the
+		 * sizes of the involved bins. If one bin keeps growing, the total
+		 * worst case is thus O(n^2), the same as for the old implementation.
+		 * The heap only removes the repeated sorting of all candidates.
+		 */
+		template <typename value_type>
+		std::vector<value_type> greedy_estimator(const std::vector<value_type>& X, const std::vector<value_type>& Y, size_t d)
+		{
+			const size_t n = X.size();
+			std::vector<value_type> entropies;
+			entropies.reserve(n);
+			entropies.emplace_back(value_type(0));
+			if(n < 2) {
+				return entropies;
+			}
 
-		/*std::cout << std::endl << "##############################################" << std::endl;
-		for(auto& e: entropy_between_neighbors) {
-			std::cout << "Entropy(" << std::get<0>(e) << ", " << std::get<1>(e) << ") - [";
-			for(size_t i=0; i<std::get<2>(e).size(); ++i) {
-				std::cout << std::get<2>(e)[i] << ", ";
+			//Sort indices according to Y
+			SquaredDistance dist;
+			std::vector<value_type> norms(n);
+			std::vector<value_type> nullv(d, value_type(0));
+			for(size_t i=0; i<n; ++i) {
+				norms[i] = dist(Y.data() + i*d, nullv.data(), d);
 			}
-			std::cout << "] - " << std::get<3>(e) << std::endl;
-		}*/
 
-		std::string tmp;
-		value_type entropy = 0.0;
-		std::vector<value_type> entropies;
-		entropies.reserve(X.size());
-		entropies.emplace_back(value_type(0));
-		//std::vector<std::vector<size_t>> bins;
-		for(size_t i=0; i<entropy_between_neighbors.size(); ++i){
-			size_t left = std::get<0>(entropy_between_neighbors[i]);
-			size_t right = std::get<1>(entropy_between_neighbors[i]);
-			
-			//Update entropy
-			entropy -= bin_entropy[left];
-			entropy -= bin_entropy[right];
-			entropy += std::get<3>(entropy_between_neighbors[i]);
-			//std::cout << std::endl << "---------------------------------------" << std::endl;
-			//std::cout << std::endl << "-> Entropy: " << entropy << std::endl;
-
-			for(size_t j=left; j<=right; ++j) {
-				bin_entropy[j] = std::get<3>(entropy_between_neighbors[i]);
+			// X is sorted, thus ties are resolved by X
+			std::vector<size_t> members(n);
+			std::iota(members.begin(), members.end(), 0);
+			std::stable_sort(members.begin(), members.end(), [&](size_t a, size_t b){
+				return norms[a] < norms[b];
+			});
+
+			// Bin [lo, hi] is stored as bin_end[lo] = hi and bin_start[hi] = lo.
+			// Its entropy is stored in bin_entropy[lo].
+			std::vector<size_t> bin_end(n), bin_start(n);
+			std::iota(bin_end.begin(), bin_end.end(), 0);
+			std::iota(bin_start.begin(), bin_start.end(), 0);
+			std::vector<value_type> bin_entropy(n, value_type(0));
+
+			// The candidate b merges the bin ending at b-1 with the bin starting at b.
+			std::vector<value_type> merged_entropy(n, value_type(0));
+			std::vector<size_t> version(n, 0);
+
+			using Candidate = std::tuple<value_type, size_t, size_t>;
+			std::vector<Candidate> heap;
+			heap.reserve(2*n);
+			auto cmp = [](const Candidate& a, const Candidate& b) {
+				if(std::get<0>(a) == std::get<0>(b)) {
+					return std::get<1>(a) > std::get<1>(b);
+				}
+				return std::get<0>(a) > std::get<0>(b);
+			};
+
+			auto update_candidate = [&](size_t b) {
+				size_t lo = bin_start[b-1];
+				size_t hi = bin_end[b];
+				const size_t* m = members.data();
+				value_type e = merged_bin_entropy(X, m + lo, m + b, m + b, m + hi + 1);
+				merged_entropy[b] = e;
+				++version[b];
+				heap.emplace_back(e - bin_entropy[lo] - bin_entropy[b], b, version[b]);
+				std::push_heap(heap.begin(), heap.end(), cmp);
+			};
+
+			for(size_t b=1; b<n; ++b) {
+				update_candidate(b);
 			}
 
-			/*for(size_t j=0; j<bin_entropy.size(); ++j) {
-				std::cout << "be[" << j << "]=" << bin_entropy[j] << std::endl;
-			}*/
-
-			//Update neighbors
-			for(size_t j=i+1;j < entropy_between_neighbors.size();++j) {
-				size_t l = std::get<0>(entropy_between_neighbors[j]);
-				size_t r = std::get<1>(entropy_between_neighbors[j]);
-				if(left > l && left <= r) {
-					//Merge bins
-					std::vector<size_t>& nbins = std::get<2>(entropy_between_neighbors[j]);
-					nbins.insert(nbins.end(), std::get<2>(entropy_between_neighbors[i]).begin(), std::get<2>(entropy_between_neighbors[i]).end());
-					std::sort(nbins.begin(), nbins.end());
-					auto last = std::unique(nbins.begin(), nbins.end());
-					nbins.erase(last, nbins.end());		
-
-					//Update border
-					std::get<1>(entropy_between_neighbors[j]) = right;
-
-					//Update entropy			
-					value_type z_n = boost::numeric_cast<value_type>(nbins.size()) / boost::numeric_cast<value_type>(X.size());
-					value_type e = z_n * conditional_cummulative_entropy_for_sorted_vectors(X, nbins);
-					std::get<3>(entropy_between_neighbors[j]) = e;
-					e -= bin_entropy[l];
-					e -= bin_entropy[right];
-					std::get<4>(entropy_between_neighbors[j]) = e;
-				} else if(right >= l && right < r) {
-					//Merge bins
-					std::vector<size_t>& nbins = std::get<2>(entropy_between_neighbors[j]);
-					nbins.insert(nbins.end(), std::get<2>(entropy_between_neighbors[i]).begin(), std::get<2>(entropy_between_neighbors[i]).end());
-					std::sort(nbins.begin(), nbins.end());
-					auto last = std::unique(nbins.begin(), nbins.end());
-					nbins.erase(last, nbins.end());
-					
-					//Update border
-					std::get<0>(entropy_between_neighbors[j]) = left;
-
-					//Update entropy
-					value_type z_n = boost::numeric_cast<value_type>(nbins.size()) / boost::numeric_cast<value_type>(X.size());
-					value_type e = z_n * conditional_cummulative_entropy_for_sorted_vectors(X, nbins);
-					std::get<3>(entropy_between_neighbors[j]) = e;
-					e -= bin_entropy[l];
-					e -= bin_entropy[right];
-					std::get<4>(entropy_between_neighbors[j]) = e;
+			std::vector<size_t> buffer(n);
+			value_type entropy = 0.0;
+			while(!heap.empty()) {
+				std::pop_heap(heap.begin(), heap.end(), cmp);
+				Candidate c = heap.back();
+				heap.pop_back();
+
+				size_t b = std::get<1>(c);
+				if(std::get<2>(c) != version[b]) {
+					continue;
+				}
+				// The boundary vanishes with the merge
+				++version[b];
+
+				size_t lo = bin_start[b-1];
+				size_t hi = bin_end[b];
+
+				//Update entropy
+				entropy -= bin_entropy[lo];
+				entropy -= bin_entropy[b];
+				entropy += merged_entropy[b];
+				entropies.emplace_back(entropy);
+
+				//Merge bins
+				auto it = members.begin();
+				std::merge(it + lo, it + b, it + b, it + hi + 1, buffer.begin());
+				std::copy(buffer.begin(), buffer.begin() + (hi - lo + 1), it + lo);
+				bin_end[lo] = hi;
+				bin_start[hi] = lo;
+				bin_entropy[lo] = merged_entropy[b];
+
+				//Update neighbors
+				if(lo > 0) {
+					update_candidate(lo);
+				}
+				if(hi + 1 < n) {
+					update_candidate(hi + 1);
 				}
 			}
 
-			if(i+1 < entropy_between_neighbors.size()){
-				std::sort(entropy_between_neighbors.begin()+(i+1), entropy_between_neighbors.end(), [&](const auto& a, const auto& b){
-					return std::get<4>(a) < std::get<4>(b);
-				});
-				/*std::cout << std::endl << "##############################################" << std::endl;
-				for(size_t j=i+1; j<entropy_between_neighbors.size(); ++j) {
-					auto& e = entropy_between_neighbors[j];
-					std::cout << "Entropy(" << std::get<0>(e) << ", " << std::get<1>(e) << ") - [";
-					for(size_t i=0; i<std::get<2>(e).size(); ++i) {
-						std::cout << std::get<2>(e)[i] << ", ";
+			return entropies;
+		}
+
+		/**
+		 * Single-linkage (Kruskal) estimator working on the sorted target X
+		 * and the row-major samples Y.
+		 *
+		 * The merge order of Kruskal's algorithm is given by the edges of the
+		 * minimum spanning tree, which are computed with Prim's algorithm in
+		 * O(n^2 d) time and O(n) memory. The bins are maintained in a
+		 * union-find structure and the total entropy is updated incrementally.
+		 * Updating the entropy of a merged bin is linear in its size, so the
+		 * merges take O(n^2) time in the worst case as well.
+		 */
+		template <typename value_type>
+		std::vector<value_type> kruskall_estimator(const std::vector<value_type>& X, const std::vector<value_type>& Y, size_t d)
+		{
+			const size_t n = X.size();
+			std::vector<value_type> entropies;
+			entropies.reserve(n);
+			entropies.emplace_back(value_type(0));
+			if(n < 2) {
+				return entropies;
+			}
+
+			// Edges are ordered by the distance of the samples and
+			// afterwards by the distance of the targets.
+			using Weight = std::pair<value_type, value_type>;
+			auto weight = [&](size_t i, size_t j) {
+				value_type dx = X[i] - X[j];
+				return Weight(SquaredDistance()(Y.data() + i*d, Y.data() + j*d, d), dx*dx);
+			};
+
+			//Prim
+			std::vector<std::tuple<Weight, size_t, size_t>> edges;
+			edges.reserve(n - 1);
+			std::vector<char> in_tree(n, 0);
+			std::vector<Weight> best(n);
+			std::vector<size_t> parent(n, 0);
+			in_tree[0] = 1;
+			for(size_t i=1; i<n; ++i) {
+				best[i] = weight(0, i);
+			}
+			for(size_t k=1; k<n; ++k) {
+				size_t next = n;
+				for(size_t i=1; i<n; ++i) {
+					if(!in_tree[i] && (next == n || best[i] < best[next])) {
+						next = i;
+					}
+				}
+				in_tree[next] = 1;
+				edges.emplace_back(best[next], std::min(parent[next], next), std::max(parent[next], next));
+				for(size_t i=1; i<n; ++i) {
+					if(!in_tree[i]) {
+						Weight w = weight(next, i);
+						if(w < best[i]) {
+							best[i] = w;
+							parent[i] = next;
+						}
 					}
-					std::cout << "] - " << std::get<3>(e) << std::endl;
-				}*/
+				}
 			}
+			std::sort(edges.begin(), edges.end());
+
+			//Kruskall
+			std::vector<size_t> root(n);
+			std::iota(root.begin(), root.end(), 0);
+			auto find = [&](size_t i) {
+				while(root[i] != i) {
+					root[i] = root[root[i]];
+					i = root[i];
+				}
+				return i;
+			};
+
+			std::vector<std::vector<size_t>> bins(n);
+			std::vector<value_type> bin_entropy(n, value_type(0));
+			for(size_t i=0; i<n; ++i) {
+				bins[i].emplace_back(i);
+			}
+
+			std::vector<size_t> buffer;
+			buffer.reserve(n);
+			value_type entropy = value_type(0);
+			for(const auto& e : edges) {
+				size_t left = find(std::get<1>(e));
+				size_t right = find(std::get<2>(e));
+				if(bins[left].size() < bins[right].size()) {
+					std::swap(left, right);
+				}
 
-			if(i >= entropy_between_neighbors.size()-2){
-				std::cout << "[" << std::get<0>(entropy_between_neighbors[i]) << ", " << std::get<1>(entropy_between_neighbors[i]) << "]" << std::endl;
-				//bins.emplace_back(std::get<2>(entropy_between_neighbors[i]));
+				buffer.resize(bins[left].size() + bins[right].size());
+				std::merge(bins[left].begin(), bins[left].end(), bins[right].begin(), bins[right].end(), buffer.begin());
+				std::swap(bins[left], buffer);
+				std::vector<size_t>().swap(bins[right]);
+				root[right] = left;
+
+				const size_t* m = bins[left].data();
+				value_type merged = merged_bin_entropy(X, m, m + bins[left].size(), m, m);
+				entropy += merged - bin_entropy[left] - bin_entropy[right];
+				bin_entropy[left] = merged;
+				entropies.emplace_back(entropy);
 			}
 
-			entropies.emplace_back(entropy);
+			return entropies;
 		}
 
-		return entropies;
+		// Copies the samples given as vectors of rows into one row-major buffer.
+		template <typename value_type>
+		std::vector<value_type> pack_rows(const std::vector<std::vector<value_type> >& Y)
+		{
+			size_t d = Y.empty() ? 0 : Y[0].size();
+			std::vector<value_type> packed;
+			packed.reserve(Y.size() * d);
+			for(const auto& y : Y) {
+				packed.insert(packed.end(), y.begin(), y.end());
+			}
+			return packed;
+		}
 	}
 
-		/**
+	/**
+	* This method calculates the conditional cummulative entropy h(X|Y).
+	*
+	* @param X Vector of scores.
+	* @param Y Vector of vector of scores.
+	*
+	* @return conditional cummulative entropy h(X|Y)
+	*/
+	template <typename value_type>
+	std::vector<value_type> conditional_cummulative_entropy_estimator_for_sorted_vectors(std::vector<value_type>& X, std::vector<std::vector<value_type> >& Y)
+	{
+		return internal::greedy_estimator(X, internal::pack_rows(Y), Y.empty() ? 0 : Y[0].size());
+	}
+
+	/**
 	* This method calculates the conditional cummulative entropy h(X|Y).
 	*
 	* @param X Vector of scores.
@@ -438,41 +577,103 @@ namespace Entropy
 	*/
 	template <typename value_type>
 	std::vector<value_type> conditional_cummulative_entropy_kruskall_estimator_for_sorted_vectors(std::vector<value_type>& X, std::vector<std::vector<value_type> >& Y)
-	{	
-		// Compute paiwise distances
-		std::vector<std::tuple<size_t, size_t, value_type, value_type> > distances = compute_pairwise_distances(X, Y, SquaredDistance());
-		std::vector<std::vector<size_t> > bins(Y.size());
-		std::vector<std::vector<size_t>* > bin_ptr(Y.size());
-		for(size_t i=0; i<bins.size(); ++i) {
-			//Maximal size?
-			bins[i].reserve(Y.size()-i);
-			//Indices of Xs
-			bins[i].emplace_back(i);
-			bin_ptr[i] = &bins[i];
+	{
+		return internal::kruskall_estimator(X, internal::pack_rows(Y), Y.empty() ? 0 : Y[0].size());
+	}
+
+	/**
+	 * Estimates the conditional cummulative entropy h(X|Y) of a fixed target
+	 * X for arbitrary groups of regulators Y.
+	 *
+	 * X is sorted only once. For every group the regulator scores are
+	 * gathered into a contiguous row-major buffer in the order of X, which
+	 * is all the estimators work on. Groups can be evaluated in parallel.
+	 */
+	template <typename value_type>
+	class ConditionalCummulativeEntropyEstimator
+	{
+		public:
+		using Group = std::vector<std::vector<value_type>>;
+
+		/**
+		 * @param X Vector of scores of the target.
+		 */
+		explicit ConditionalCummulativeEntropyEstimator(const std::vector<value_type>& X)
+			: order_(X.size()),
+			  X_(X.size())
+		{
+			std::iota(order_.begin(), order_.end(), 0);
+			std::stable_sort(order_.begin(), order_.end(), [&](size_t a, size_t b){return X[a] < X[b];});
+			for(size_t i=0; i<order_.size(); ++i) {
+				X_[i] = X[order_[i]];
+			}
+		}
+
+		/**
+		 * Greedy estimator that merges neighbouring samples.
+		 *
+		 * @param Y Vector of regulators, each containing one score per sample.
+		 * @return conditional cummulative entropy h(X|Y) after every merge
+		 */
+		std::vector<value_type> greedy(const Group& Y) const
+		{
+			return internal::greedy_estimator(X_, gather(Y), Y.size());
 		}
 
-		//Kruskall
-		std::vector<value_type> entropies;
-		entropies.reserve(X.size());
-		//Do not forget the first step
-		entropies.emplace_back(value_type(0));
-		for(size_t i=0; i<distances.size(); ++i){
-			size_t left = std::get<0>(distances[i]);
-			size_t right = std::get<1>(distances[i]);
-			if(bin_ptr[left] == bin_ptr[right] || bin_ptr[left]->size() == 0 || bin_ptr[right]->size() == 0) {
-				continue;
+		/**
+		 * Estimator that merges the samples in the order of Kruskal's algorithm.
+		 *
+		 * @param Y Vector of regulators, each containing one score per sample.
+		 * @return conditional cummulative entropy h(X|Y) after every merge
+		 */
+		std::vector<value_type> kruskall(const Group& Y) const
+		{
+			return internal::kruskall_estimator(X_, gather(Y), Y.size());
+		}
+
+		/**
+		 * Evaluates the greedy estimator for every group.
+		 *
+		 * @param groups Groups of regulators
+		 * @param num_threads Number of threads. 0 uses all available cores.
+		 */
+		std::vector<std::vector<value_type>> greedy(const std::vector<Group>& groups, unsigned int num_threads = 0) const
+		{
+			std::vector<std::vector<value_type>> result(groups.size());
+			parallel_for(size_t(0), groups.size(), [&](size_t i) { result[i] = greedy(groups[i]); }, num_threads);
+			return result;
+		}
+
+		/**
+		 * Evaluates the Kruskal estimator for every group.
+		 *
+		 * @param groups Groups of regulators
+		 * @param num_threads Number of threads. 0 uses all available cores.
+		 */
+		std::vector<std::vector<value_type>> kruskall(const std::vector<Group>& groups, unsigned int num_threads = 0) const
+		{
+			std::vector<std::vector<value_type>> result(groups.size());
+			parallel_for(size_t(0), groups.size(), [&](size_t i) { result[i] = kruskall(groups[i]); }, num_threads);
+			return result;
+		}
+
+		private:
+		// Combine all Ys into one row-major buffer sorted with respect to X.
+		std::vector<value_type> gather(const Group& Y) const
+		{
+			const size_t d = Y.size();
+			std::vector<value_type> packed(order_.size() * d);
+			for(size_t j=0; j<d; ++j) {
+				for(size_t i=0; i<order_.size(); ++i) {
+					packed[i*d + j] = Y[j][order_[i]];
+				}
 			}
-			bin_ptr[left]->insert(bin_ptr[left]->end(), bin_ptr[right]->begin(), bin_ptr[right]->end());
-			bin_ptr[right]->clear();
-			//This might actually be a problem
-			std::sort(bin_ptr[left]->begin(), bin_ptr[left]->end());
-			
-			bin_ptr[right]=bin_ptr[left];
-			entropies.emplace_back(conditional_cummulative_entropy_for_sorted_vectors(X, bins));
+			return packed;
 		}
 
-		return entropies;
-	}
+		std::vector<size_t> order_;
+		std::vector<value_type> X_;
+	};
 
 	/**
 	* This method calculates the conditional cummulative entropy h(X|Y).
@@ -485,31 +686,10 @@ namespace Entropy
 	template <typename value_type>
 	std::vector<value_type> conditional_cummulative_entropy_estimator(const std::vector<value_type>& X, const std::vector<std::vector<value_type> >& Y)
 	{
-		//Sort vector X
-		std::vector<value_type> Xs(std::distance(X.begin(),X.end()));
-		std::copy(X.begin(), X.end(), Xs.begin());
-		std::sort(Xs.begin(), Xs.end());
-		
-		//Sort indices according to X
-		std::vector<size_t> indices(X.size());	
-		std::iota(indices.begin(), indices.end(), 0);
-		std::sort(indices.begin(), indices.end(), [&](size_t a, size_t b){return X[a] < X[b];});
-
-		// Combine all Ys into one vector and sort this vector with respect to X.
-		std::vector<std::vector<value_type> > Y_transformed;
-		Y_transformed.reserve(Y[0].size());
-		for(size_t i : indices){
-			std::vector<value_type> Yi(Y.size());
-			for(size_t j=0; j<Y.size(); ++j) {
-				Yi[j]=Y[j][i]; 
-			}
-			Y_transformed.emplace_back(std::move(Yi));
-		}
-		
-		return conditional_cummulative_entropy_estimator_for_sorted_vectors(Xs, Y_transformed);
+		return ConditionalCummulativeEntropyEstimator<value_type>(X).greedy(Y);
 	}
 
-		/**
+	/**
 	* This method calculates the conditional cummulative entropy h(X|Y).
 	*
 	* @param X Vector of scores.
@@ -520,28 +700,7 @@ namespace Entropy
 	template <typename value_type>
 	std::vector<value_type> conditional_cummulative_entropy_kruskall_estimator(const std::vector<value_type>& X, const std::vector<std::vector<value_type> >& Y)
 	{
-		//Sort vector X
-		std::vector<value_type> Xs(std::distance(X.begin(),X.end()));
-		std::copy(X.begin(), X.end(), Xs.begin());
-		std::sort(Xs.begin(), Xs.end());
-		
-		//Sort indices according to X
-		std::vector<size_t> indices(X.size());	
-		std::iota(indices.begin(), indices.end(), 0);
-		std::sort(indices.begin(), indices.end(), [&](size_t a, size_t b){return X[a] < X[b];});
-
-		// Combine all Ys into one vector and sort this vector with respect to X.
-		std::vector<std::vector<value_type> > Y_transformed;
-		Y_transformed.reserve(Y[0].size());
-		for(size_t i : indices){
-			std::vector<value_type> Yi(Y.size());
-			for(size_t j=0; j<Y.size(); ++j) {
-				Yi[j]=Y[j][i]; 
-			}
-			Y_transformed.emplace_back(std::move(Yi));
-		}
-		
-		return conditional_cummulative_entropy_kruskall_estimator_for_sorted_vectors(Xs, Y_transformed);
+		return ConditionalCummulativeEntropyEstimator<value_type>(X).kruskall(Y);
 	}
 }
 }
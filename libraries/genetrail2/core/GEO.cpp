@@ -23,19 +23,71 @@
 #include <boost/algorithm/string/finder.hpp>
 #include <boost/algorithm/string/iter_find.hpp>
 
+#include "misc_algorithms.h"
+
+#include <algorithm>
+#include <stdexcept>
+
 using namespace GeneTrail;
 
 GEO::GEO() {}
 
 GEO::~GEO() {}
 
+namespace
+{
+	double reduceMean(std::vector<double>& values)
+	{
+		return statistic::mean<double>(values.begin(), values.end());
+	}
+
+	double reduceMedian(std::vector<double>& values)
+	{
+		return statistic::median<double>(values.begin(), values.end());
+	}
+
+	double reduceMax(std::vector<double>& values)
+	{
+		return statistic::max<double>(values.begin(), values.end());
+	}
+
+	double reduceMin(std::vector<double>& values)
+	{
+		return statistic::min<double>(values.begin(), values.end());
+	}
+
+	// The id that is used for unmapped probes
+	const std::string& geneOf(const GEO::ProbeMap& mapping, const std::string& probe)
+	{
+		static const std::string empty;
+		auto it = mapping.find(probe);
+		return it == mapping.end() ? empty : it->second;
+	}
+}
+
+GEO::Reducer GEO::compileReducer(const std::string& method)
+{
+	if(method == "mean") {
+		return &reduceMean;
+	} else if(method == "median") {
+		return &reduceMedian;
+	} else if(method == "max") {
+		return &reduceMax;
+	} else if(method == "min") {
+		return &reduceMin;
+	}
+
+	throw std::invalid_argument("Unknown method for merging duplicates: " + method);
+}
+
 std::vector<double>
-GEO::mergeDuplicatedVectors(std::vector<std::vector<double>> matrix,
-                            std::string method)
+GEO::mergeDuplicatedVectors(const std::vector<std::vector<double>>& matrix,
+                            const std::string& method)
 {
 	std::vector<double> merged;
+	std::vector<double> tmp;
 	for(unsigned int i = 0; i < matrix[0].size(); ++i) {
-		std::vector<double> tmp;
+		tmp.clear();
 		for(unsigned int j = 0; j < matrix.size(); ++j) {
 			tmp.push_back(matrix[j][i]);
 		}
@@ -46,34 +98,82 @@ GEO::mergeDuplicatedVectors(std::vector<std::vector<double>> matrix,
 }
 
 std::map<std::string, std::vector<double>> GEO::mapAndRemoveDuplicates(
-    std::map<std::string, std::vector<double>> gene2expression_values_,
-    std::map<std::string, std::string> cloneid2otherid_, std::string method)
+    const std::map<std::string, std::vector<double>>& gene2expression_values_,
+    const ProbeMap& cloneid2otherid_, const std::string& method)
 {
-	std::map<std::string, std::vector<std::vector<double>>> matrix;
-	for(std::map<std::string, std::vector<double>>::iterator it =
-	        gene2expression_values_.begin();
-	    it != gene2expression_values_.end(); ++it) {
-		if(matrix.find(cloneid2otherid_[it->first]) == matrix.end()) {
-			std::vector<std::vector<double>> new_tmp;
-			new_tmp.push_back(it->second);
-			matrix[cloneid2otherid_[it->first]] = new_tmp;
-		} else {
-			matrix[cloneid2otherid_[it->first]].push_back(it->second);
-		}
+	std::map<std::string, std::vector<const std::vector<double>*>> matrix;
+	for(const auto& entry : gene2expression_values_) {
+		matrix[geneOf(cloneid2otherid_, entry.first)].push_back(&entry.second);
 	}
+
 	std::map<std::string, std::vector<double>> return_map;
-	for(std::map<std::string, std::vector<std::vector<double>>>::iterator it =
-	        matrix.begin();
-	    it != matrix.end(); ++it) {
-		if(it->second.size() == 1) {
-			return_map[it->first] = it->second[0];
+	std::vector<std::vector<double>> duplicates;
+	for(const auto& entry : matrix) {
+		if(entry.second.size() == 1) {
+			return_map[entry.first] = *entry.second[0];
 		} else {
-			return_map[it->first] = mergeDuplicatedVectors(it->second, method);
+			duplicates.clear();
+			for(const auto* values : entry.second) {
+				duplicates.push_back(*values);
+			}
+			return_map[entry.first] = mergeDuplicatedVectors(duplicates, method);
 		}
 	}
 	return return_map;
 }
 
+DenseMatrix GEO::mapAndRemoveDuplicates(const DenseMatrix& probes,
+                                        const ProbeMap& mapping,
+                                        Reducer reducer,
+                                        unsigned int num_threads) const
+{
+	// Collect the probes of every gene
+	std::unordered_map<std::string, std::vector<DenseMatrix::index_type>> gene2probes;
+	for(DenseMatrix::index_type r = 0; r < probes.rows(); ++r) {
+		const std::string& gene = geneOf(mapping, probes.rowName(r));
+		if(gene != "") {
+			gene2probes[gene].push_back(r);
+		}
+	}
+
+	std::vector<std::pair<std::string, std::vector<DenseMatrix::index_type>>> genes(
+	    std::make_move_iterator(gene2probes.begin()),
+	    std::make_move_iterator(gene2probes.end()));
+	gene2probes.clear();
+
+	std::sort(genes.begin(), genes.end(), [](const auto& a, const auto& b) {
+		return a.first < b.first;
+	});
+
+	std::vector<std::string> row_names;
+	row_names.reserve(genes.size());
+	for(const auto& gene : genes) {
+		std::vector<std::string> strs;
+		boost::algorithm::iter_split(strs, gene.first, boost::first_finder("///"));
+		row_names.push_back(strs[0]);
+	}
+
+	DenseMatrix result(std::move(row_names), probes.colNames());
+
+	parallel_for(size_t(0), genes.size(), [&](size_t i) {
+		const auto& rows = genes[i].second;
+		if(rows.size() == 1) {
+			result.matrix().row(i) = probes.matrix().row(rows[0]);
+			return;
+		}
+
+		std::vector<double> values(rows.size());
+		for(DenseMatrix::index_type j = 0; j < probes.cols(); ++j) {
+			for(size_t k = 0; k < rows.size(); ++k) {
+				values[k] = probes(rows[k], j);
+			}
+			result(i, j) = reducer(values);
+		}
+	}, num_threads, size_t(64));
+
+	return result;
+}
+
 double GEO::apply(std::string method, std::vector<double> values)
 {
 	if(method == "mean") {
@@ -32,9 +32,11 @@
 #include <limits>
 #include <functional>
 #include <initializer_list>
+#include <unordered_map>
 
 #include <boost/algorithm/string.hpp>
 
+#include "DenseMatrix.h"
 #include "Statistic.h"
 #include "macros.h"
 
@@ -49,17 +51,54 @@ namespace GeneTrail
 		std::string platform = "";
 	};
 
+	/**
+	 * A probes x samples expression matrix together with the
+	 * information from the header of the SOFT file.
+	 */
+	struct GT2_EXPORT GEOMatrix
+	{
+		DenseMatrix values = DenseMatrix(0, 0);
+		std::string dataset = "";
+		std::string platform = "";
+	};
+
 	class GT2_EXPORT GEO
 	{
 		public:
+		/// Maps probe ids to gene ids.
+		using ProbeMap = std::unordered_map<std::string, std::string>;
+
+		/// Merges the values of duplicated probes. The values may be reordered.
+		using Reducer = double (*)(std::vector<double>& values);
 
 		GEO();
 
 		~GEO();
 
-		std::vector<double> mergeDuplicatedVectors(std::vector<std::vector<double>>, std::string);
+		/**
+		 * Returns the reducer for method (mean, median, max or min), so
+		 * that the method name does not need to be dispatched per value.
+		 *
+		 * @throws std::invalid_argument if the method is unknown.
+		 */
+		static Reducer compileReducer(const std::string& method);
+
+		std::vector<double> mergeDuplicatedVectors(const std::vector<std::vector<double>>&, const std::string&);
+
+		std::map<std::string, std::vector<double>> mapAndRemoveDuplicates(const std::map<std::string, std::vector<double>>&, const ProbeMap&, const std::string&);
 
-		std::map<std::string, std::vector<double>> mapAndRemoveDuplicates(std::map<std::string, std::vector<double>>, std::map<std::string, std::string>, std::string);
+		/**
+		 * Maps the rows of a probes x samples matrix to genes and merges
+		 * the probes of every gene using reducer. Probes without gene are
+		 * dropped. The rows of the result are sorted by gene id. Of ids
+		 * consisting of several genes separated by "///", only the first
+		 * gene is used as row name.
+		 *
+		 * The genes are merged in parallel using num_threads threads.
+		 * 0 uses all available cores.
+		 */
+		DenseMatrix mapAndRemoveDuplicates(const DenseMatrix& probes, const ProbeMap& mapping,
+		                                   Reducer reducer, unsigned int num_threads = 0) const;
 
 		double apply(std::string method, std::vector<double> tmp);
 
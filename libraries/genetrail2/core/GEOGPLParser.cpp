@@ -43,14 +43,14 @@ void GPL_Parser::downloadGPLFile(const std::string& platform,
 	}
 }
 
-std::map<std::string, std::string>
+GEO::ProbeMap
 GPL_Parser::readGPLFile(const std::string& filename,
                         const std::string& mappingColumn)
 {
 	bool within_platform_table = false;
 	uint index_col = 999;
 
-	std::map<std::string, std::string> cloneid2otherid_;
+	GEO::ProbeMap cloneid2otherid_;
 
 	std::ifstream file(filename.c_str(),
 	                   std::ios_base::in | std::ios_base::binary);
@@ -97,7 +97,7 @@ GPL_Parser::readGPLFile(const std::string& filename,
 			if(within_platform_table) {
 				std::vector<std::string> entries;
 				boost::split(entries, line, boost::is_any_of("\t"));
-				if(entries.size() >= index_col) {
+				if(entries.size() > index_col) {
 					if((boost::trim_copy(entries[0]) != "") &&
 					   (boost::trim_copy(entries[index_col]) != "")) {
 						if(cloneid2otherid_.find(entries[0]) ==
@@ -122,7 +122,7 @@ GPL_Parser::readGPLFile(const std::string& filename,
 	return cloneid2otherid_;
 }
 
-std::map<std::string, std::string>
+GEO::ProbeMap
 GPL_Parser::annotate(const std::string& geo_dir,
 					 const std::string& platform,
                      const std::string& mappingColumn)
@@ -48,12 +48,12 @@ namespace GeneTrail
 		void downloadGPLFile(const std::string& filename,
 		                     const std::string& geo_dir);
 
-		std::map<std::string, std::string>
+		ProbeMap
 		annotate(const std::string& geo_dir,
 				 const std::string& platform,
 		         const std::string& mappingColumn = "Gene ID");
 
-		std::map<std::string, std::string>
+		ProbeMap
 		readGPLFile(const std::string& filename,
 		            const std::string& mappingColumn = "Gene ID");
 	};
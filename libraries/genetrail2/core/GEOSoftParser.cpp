@@ -0,0 +1,404 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "GEOSoftParser.h"
+
+#include "Exception.h"
+#include "misc_algorithms.h"
+
+#include <boost/algorithm/string.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <limits>
+#include <unordered_map>
+
+namespace GeneTrail
+{
+	namespace
+	{
+		using Range = std::pair<const char*, const char*>;
+
+		const size_t NO_ROW = std::numeric_limits<size_t>::max();
+
+		// Number of GDS table lines that are parsed together
+		const size_t GDS_BLOCK_SIZE = 16 * 1024;
+
+		/**
+		 * Opens a possibly gzip compressed file. The file stream has to
+		 * outlive the filtering stream.
+		 */
+		void openSoftFile(const std::string& filename, std::ifstream& file,
+		                  boost::iostreams::filtering_istream& input)
+		{
+			file.open(filename, std::ios_base::in | std::ios_base::binary);
+			if(!file) {
+				throw IOError("Cannot open GEO file: " + filename);
+			}
+
+			if(filename.find(".gz") != std::string::npos) {
+				input.push(boost::iostreams::gzip_decompressor());
+			}
+			input.push(file);
+		}
+
+		bool getLine(std::istream& input, std::string& line)
+		{
+			if(!std::getline(input, line)) {
+				return false;
+			}
+
+			if(!line.empty() && line.back() == '\r') {
+				line.pop_back();
+			}
+
+			return true;
+		}
+
+		// Splits a line at tabs without merging consecutive tabs
+		void splitTabs(const char* begin, const char* end, std::vector<Range>& fields)
+		{
+			fields.clear();
+			for(const char* p = begin;; ++p) {
+				const char* q = std::find(p, end, '\t');
+				fields.emplace_back(p, q);
+				if(q == end) {
+					break;
+				}
+				p = q;
+			}
+		}
+
+		// Values that cannot be parsed are treated as missing
+		double parseValue(const Range& field)
+		{
+			if(field.first == field.second) {
+				return std::numeric_limits<double>::quiet_NaN();
+			}
+
+			char* end = nullptr;
+			const double value = std::strtod(field.first, &end);
+			if(end != field.second) {
+				return std::numeric_limits<double>::quiet_NaN();
+			}
+
+			return value;
+		}
+
+		bool isBlank(const Range& field)
+		{
+			return std::all_of(field.first, field.second, [](char c) {
+				return std::isspace(static_cast<unsigned char>(c));
+			});
+		}
+
+		// The data lines of a single GSE sample table
+		struct SampleTable
+		{
+			explicit SampleTable(size_t column) : column(column) {}
+
+			size_t column;
+			int value_idx = -1;
+			std::string text;
+
+			std::vector<std::string> probes;
+			std::vector<double> values;
+			std::vector<size_t> rows;
+		};
+
+		class ProbeIndex
+		{
+			public:
+			size_t find(const std::string& probe) const
+			{
+				auto it = rows_.find(probe);
+				return it == rows_.end() ? NO_ROW : it->second;
+			}
+
+			size_t insert(const std::string& probe)
+			{
+				auto res = rows_.emplace(probe, names_.size());
+				if(res.second) {
+					names_.push_back(probe);
+				}
+				return res.first->second;
+			}
+
+			size_t size() const { return names_.size(); }
+			std::vector<std::string>& names() { return names_; }
+
+			private:
+			std::unordered_map<std::string, size_t> rows_;
+			std::vector<std::string> names_;
+		};
+	}
+
+	void GEOSoftParser::setNumberOfThreads(unsigned int num_threads)
+	{
+		num_threads_ = num_threads;
+	}
+
+	void GEOSoftParser::setBatchSize(size_t batch_size)
+	{
+		batch_size_ = batch_size;
+	}
+
+	unsigned int GEOSoftParser::numberOfThreads_() const
+	{
+		return num_threads_ == 0 ? default_num_threads() : num_threads_;
+	}
+
+	GEOMatrix GEOSoftParser::readGSEFile(const std::string& filename) const
+	{
+		std::ifstream file;
+		boost::iostreams::filtering_istream input;
+		openSoftFile(filename, file, input);
+
+		const unsigned int num_threads = numberOfThreads_();
+		const size_t batch_size = batch_size_ == 0 ? 4 * size_t(num_threads) : batch_size_;
+
+		GEOMatrix result;
+		std::vector<std::string> samples;
+		std::vector<std::vector<double>> columns;
+		ProbeIndex index;
+
+		std::vector<SampleTable> batch;
+
+		// Parses the tables of the batch in parallel and stores their
+		// values in the respective columns.
+		auto flush = [&]() {
+			parallel_for(size_t(0), batch.size(), [&](size_t t) {
+				SampleTable& table = batch[t];
+				const size_t value_idx = table.value_idx;
+
+				std::vector<Range> fields;
+				const char* p = table.text.data();
+				const char* end = p + table.text.size();
+				while(p < end) {
+					const char* eol = std::find(p, end, '\n');
+					splitTabs(p, eol, fields);
+					p = eol + 1;
+
+					if(fields.size() <= value_idx || isBlank(fields[0])) {
+						continue;
+					}
+
+					table.probes.emplace_back(fields[0].first, fields[0].second);
+					table.values.push_back(parseValue(fields[value_idx]));
+				}
+
+				std::string().swap(table.text);
+
+				// Most probes are already known from previous samples
+				table.rows.resize(table.probes.size());
+				for(size_t k = 0; k < table.probes.size(); ++k) {
+					table.rows[k] = index.find(table.probes[k]);
+				}
+			}, num_threads);
+
+			for(auto& table : batch) {
+				for(size_t k = 0; k < table.probes.size(); ++k) {
+					if(table.rows[k] == NO_ROW) {
+						table.rows[k] = index.insert(table.probes[k]);
+					}
+				}
+			}
+
+			parallel_for(size_t(0), batch.size(), [&](size_t t) {
+				const SampleTable& table = batch[t];
+				auto& column = columns[table.column];
+				column.assign(index.size(), std::numeric_limits<double>::quiet_NaN());
+				for(size_t k = 0; k < table.rows.size(); ++k) {
+					column[table.rows[k]] = table.values[k];
+				}
+			}, num_threads);
+
+			batch.clear();
+		};
+
+		bool within_sample_table = false;
+		for(std::string line; getLine(input, line);) {
+			if(line.empty()) {
+				continue;
+			}
+
+			if(boost::starts_with(line, "!Series_platform_id")) {
+				result.platform = line.substr(line.find("GPL"));
+				std::cout << "INFO: Platform: " << result.platform << std::endl;
+			}
+
+			if(boost::starts_with(line, "^SAMPLE") && line.find("GSM") != std::string::npos) {
+				samples.push_back(line.substr(line.find("GSM")));
+				columns.emplace_back();
+				batch.emplace_back(samples.size() - 1);
+				std::cout << "INFO: Parsing - " << samples.back() << std::endl;
+				continue;
+			}
+
+			if(boost::starts_with(line, "!sample_table_begin")) {
+				within_sample_table = true;
+				continue;
+			}
+
+			if(boost::starts_with(line, "!sample_table_end")) {
+				within_sample_table = false;
+				if(batch.size() >= batch_size) {
+					flush();
+				}
+				continue;
+			}
+
+			if(!within_sample_table || batch.empty() || line[0] == '#') {
+				continue;
+			}
+
+			SampleTable& table = batch.back();
+			if(boost::starts_with(line, "ID_REF")) {
+				// Empty columns are kept, as in the data lines
+				std::vector<Range> entries;
+				splitTabs(line.data(), line.data() + line.size(), entries);
+				auto it = std::find_if(entries.begin(), entries.end(), [](const Range& r) {
+					return std::string(r.first, r.second) == "VALUE";
+				});
+
+				if(it == entries.end()) {
+					throw IOError("Sample table of " + samples[table.column] +
+					              " does not contain a VALUE column");
+				}
+
+				table.value_idx = it - entries.begin();
+				continue;
+			}
+
+			if(table.value_idx != -1) {
+				table.text += line;
+				table.text += '\n';
+			}
+		}
+
+		flush();
+
+		// Probes that were first seen in later samples are missing in
+		// the earlier columns.
+		result.values = DenseMatrix(std::move(index.names()), std::move(samples));
+		for(size_t j = 0; j < columns.size(); ++j) {
+			auto col = result.values.matrix().col(j);
+			col.setConstant(std::numeric_limits<double>::quiet_NaN());
+			std::copy(columns[j].begin(), columns[j].end(), col.data());
+			std::vector<double>().swap(columns[j]);
+		}
+
+		return result;
+	}
+
+	GEOMatrix GEOSoftParser::readGDSFile(const std::string& filename) const
+	{
+		std::ifstream file;
+		boost::iostreams::filtering_istream input;
+		openSoftFile(filename, file, input);
+
+		std::cout << "INFO: Parsing - " << filename << std::endl;
+
+		const unsigned int num_threads = numberOfThreads_();
+
+		GEOMatrix result;
+		std::vector<std::string> samples;
+
+		std::string line;
+		bool header_done = false;
+		while(getLine(input, line)) {
+			if(line.find("dataset_platform =") != std::string::npos) {
+				result.platform = line.substr(line.find("GPL"));
+				std::cout << "INFO: Platform: " << result.platform << std::endl;
+			} else if(line.find("dataset_sample_count") != std::string::npos) {
+				std::cout << "INFO: Number of samples: "
+				          << boost::trim_copy(line.substr(line.find('=') + 1))
+				          << std::endl;
+			} else if(line.find("DATASET") != std::string::npos) {
+				result.dataset = boost::trim_copy(line.substr(line.find('=') + 1));
+			} else if(line.find("ID_REF\tIDENTIFIER") != std::string::npos) {
+				boost::split(samples, line, boost::is_any_of(" \t"));
+				samples.erase(samples.begin(), samples.begin() + 2);
+				header_done = true;
+				break;
+			}
+		}
+
+		if(!header_done) {
+			throw IOError("GDS file " + filename + " does not contain a data table");
+		}
+
+		const size_t num_samples = samples.size();
+
+		std::vector<std::string> probes;
+		std::vector<double> values; // row-major
+
+		std::vector<std::string> lines;
+		lines.reserve(GDS_BLOCK_SIZE);
+
+		auto flush = [&]() {
+			const size_t first = probes.size();
+			probes.resize(first + lines.size());
+			values.resize(probes.size() * num_samples);
+
+			parallel_for(size_t(0), lines.size(), [&](size_t l) {
+				std::vector<Range> fields;
+				splitTabs(lines[l].data(), lines[l].data() + lines[l].size(), fields);
+
+				if(fields.size() < num_samples + 2) {
+					throw IOError("Malformed line in GDS file: " + lines[l]);
+				}
+
+				probes[first + l].assign(fields[0].first, fields[0].second);
+
+				double* row = values.data() + (first + l) * num_samples;
+				for(size_t j = 0; j < num_samples; ++j) {
+					row[j] = parseValue(fields[j + 2]);
+				}
+			}, num_threads, size_t(256));
+
+			lines.clear();
+		};
+
+		while(getLine(input, line)) {
+			if(line.find("_table_end") != std::string::npos) {
+				break;
+			}
+
+			if(line.empty()) {
+				continue;
+			}
+
+			lines.push_back(std::move(line));
+			if(lines.size() == GDS_BLOCK_SIZE) {
+				flush();
+			}
+		}
+
+		flush();
+
+		using RowMajor = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+		result.values = DenseMatrix(std::move(probes), std::move(samples));
+		result.values.matrix() = Eigen::Map<const RowMajor>(values.data(), result.values.rows(), num_samples);
+
+		return result;
+	}
+}
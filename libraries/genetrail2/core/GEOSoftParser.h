@@ -0,0 +1,79 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_GEO_SOFT_PARSER_H
+#define GT2_GEO_SOFT_PARSER_H
+
+#include "GEO.h"
+#include "macros.h"
+
+#include <string>
+
+namespace GeneTrail
+{
+	/**
+	 * Streaming parser for GEO SOFT files that produces a probes x samples
+	 * DenseMatrix.
+	 *
+	 * In contrast to GEOGSEParser and GEOGDSParser, the values are never
+	 * stored in a map from probes to vectors. The (optionally gzip
+	 * compressed) file is read once. The sample tables of a GSE series are
+	 * collected in batches that are parsed in parallel; the data table of a
+	 * GDS dataset is parsed in parallel blocks of lines. Probes are mapped
+	 * to rows via a hash table. Probes that are missing in a sample are
+	 * NaN.
+	 */
+	class GT2_EXPORT GEOSoftParser : public GEO
+	{
+		public:
+		GEOSoftParser() = default;
+
+		/**
+		 * Sets the number of threads. 0 uses all available cores.
+		 */
+		void setNumberOfThreads(unsigned int num_threads);
+
+		/**
+		 * Sets the number of GSE sample tables that are kept in memory
+		 * and parsed together. 0 uses four tables per thread.
+		 */
+		void setBatchSize(size_t batch_size);
+
+		/**
+		 * Reads a GSE series. Files ending in .gz are decompressed.
+		 *
+		 * @throws IOError if the file cannot be read.
+		 */
+		GEOMatrix readGSEFile(const std::string& filename) const;
+
+		/**
+		 * Reads a GDS dataset. Files ending in .gz are decompressed.
+		 *
+		 * @throws IOError if the file cannot be read or is malformed.
+		 */
+		GEOMatrix readGDSFile(const std::string& filename) const;
+
+		private:
+		unsigned int numberOfThreads_() const;
+
+		unsigned int num_threads_ = 0;
+		size_t batch_size_ = 0;
+	};
+}
+
+#endif // GT2_GEO_SOFT_PARSER_H
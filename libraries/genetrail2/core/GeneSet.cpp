@@ -24,40 +24,74 @@
 
 #include <algorithm>
 #include <cmath>
+#include <numeric>
 
 namespace GeneTrail
 {
-	GeneSet::Container GeneSet::getSortedScores(bool decreasing) const
+	namespace
+	{
+		template <typename Key>
+		std::vector<size_t> sortIndices(const std::vector<GeneSet::Element>& c, Key key)
+		{
+			std::vector<double> keys(c.size());
+			for(size_t i = 0; i < c.size(); ++i) {
+				keys[i] = key(c[i].second);
+			}
+
+			// Sorting the indices with the keys in a separate vector
+			// keeps the comparisons within contiguous memory.
+			std::vector<size_t> p(c.size());
+			std::iota(p.begin(), p.end(), size_t(0));
+			std::stable_sort(p.begin(), p.end(), [&keys](size_t i, size_t j) {
+				return keys[i] < keys[j];
+			});
+
+			return p;
+		}
+	}
+
+	std::vector<size_t> GeneSet::sortedIndices(bool decreasing) const
 	{
 		if(decreasing) {
-			return getDecreasinglySortedScores();
+			return sortIndices(container_, [](double d) { return -d; });
+		}
+
+		return sortIndices(container_, [](double d) { return d; });
+	}
+
+	std::vector<size_t> GeneSet::absoluteSortedIndices() const
+	{
+		return sortIndices(container_, [](double d) { return -std::abs(d); });
+	}
+
+	GeneSet::Container GeneSet::permute(const std::vector<size_t>& permutation) const
+	{
+		Container result;
+		result.reserve(permutation.size());
+		for(size_t i : permutation) {
+			result.push_back(container_[i]);
 		}
+		return result;
+	}
 
-		return getIncreasinglySortedScores();
+	GeneSet::Container GeneSet::getSortedScores(bool decreasing) const
+	{
+		return permute(sortedIndices(decreasing));
 	}
 
 	GeneSet::Container GeneSet::getIncreasinglySortedScores() const
 	{
-		Container sorted_scores(container_);
-		std::sort(sorted_scores.begin(), sorted_scores.end(),
-		          increasing_compare());
-		return sorted_scores;
+		return permute(sortedIndices(false));
 	}
 
 	GeneSet::Container GeneSet::getDecreasinglySortedScores() const
 	{
-		Container sorted_scores(container_);
-		std::sort(sorted_scores.begin(), sorted_scores.end(),
-		          decreasing_compare());
-		return sorted_scores;
+		return permute(sortedIndices(true));
 	}
 
 	GeneSet::Container GeneSet::getAbsoluteSortedScores() const
 	{
-		Container sorted_scores(container_);
-		std::sort(sorted_scores.begin(), sorted_scores.end(),
-		          absolute_compare());
-		return sorted_scores;
+		return permute(absoluteSortedIndices());
 	}
 
 	GeneSet::Container
@@ -88,7 +122,15 @@ namespace GeneTrail
 	GeneSet::sortAndIntersect(const std::set<std::string>& set,
 	                          bool decreasing) const
 	{
-		return intersect(getSortedScores(decreasing), set);
+		Container inter;
+
+		for(size_t i : sortedIndices(decreasing)) {
+			if(set.find(container_[i].first) != set.end()) {
+				inter.push_back(container_[i]);
+			}
+		}
+
+		return inter;
 	}
 
 	std::vector<std::string>
@@ -103,6 +145,19 @@ namespace GeneTrail
 		return s;
 	}
 
+	std::vector<std::string>
+	GeneSet::getIdentifier(const std::vector<size_t>& permutation) const
+	{
+		std::vector<std::string> s;
+		s.reserve(permutation.size());
+
+		for(size_t i : permutation) {
+			s.push_back(container_[i].first);
+		}
+
+		return s;
+	}
+
 	std::vector<std::string> GeneSet::getIdentifier() const
 	{
 		return getIdentifier(container_);
@@ -110,22 +165,22 @@ namespace GeneTrail
 
 	std::vector<std::string> GeneSet::getSortedIdentifier(bool decreasing) const
 	{
-		return getIdentifier(getSortedScores(decreasing));
+		return getIdentifier(sortedIndices(decreasing));
 	}
 
 	std::vector<std::string> GeneSet::getDecreasinglySortedIdentifier() const
 	{
-		return getIdentifier(getSortedScores(true));
+		return getIdentifier(sortedIndices(true));
 	}
 
 	std::vector<std::string> GeneSet::getIncreasinglySortedIdentifier() const
 	{
-		return getIdentifier(getSortedScores(false));
+		return getIdentifier(sortedIndices(false));
 	}
 
 	std::vector<std::string> GeneSet::getAbsoluteSortedIdentifier() const
 	{
-		return getIdentifier(getAbsoluteSortedScores());
+		return getIdentifier(absoluteSortedIndices());
 	}
 
 	Category GeneSet::toCategory(const std::shared_ptr<EntityDatabase>& db, const std::string& name) const
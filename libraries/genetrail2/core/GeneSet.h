@@ -102,7 +102,12 @@ class GT2_EXPORT GeneSet
 	 *
 	 * @return Container container_
 	 */
-	Container getScores() const { return container_; }
+	const Container& getScores() const { return container_; }
+
+	/**
+	 * Reserves memory for n elements.
+	 */
+	void reserve(size_t n) { container_.reserve(n); }
 
 	/**
 	 * Insert function
@@ -125,6 +130,17 @@ class GT2_EXPORT GeneSet
 		container_.push_back(std::make_pair(element_name, element));
 	}
 
+	/**
+	 * Insert function
+	 *
+	 * @param element_name Name of the new score
+	 * @param element The new score
+	 */
+	void insert(std::string&& element_name, double element)
+	{
+		container_.emplace_back(std::move(element_name), element);
+	}
+
 	/**
 	 * Getter for the size of the GeneSet
 	 *
@@ -139,6 +155,25 @@ class GT2_EXPORT GeneSet
 	 */
 	bool empty() const { return container_.empty(); }
 
+	/**
+	 * Returns the positions of the elements sorted by their scores. Ties
+	 * are kept in the order of insertion. In contrast to the getters
+	 * below, neither identifiers nor scores are copied.
+	 *
+	 * @param decreasing Boolean flag indication how to sort the scores (true =
+	 *decreasing).
+	 * @return Permutation of [0, size()).
+	 */
+	std::vector<size_t> sortedIndices(bool decreasing) const;
+
+	/**
+	 * Returns the positions of the elements sorted decreasingly by the
+	 * absolute values of their scores.
+	 *
+	 * @return Permutation of [0, size()).
+	 */
+	std::vector<size_t> absoluteSortedIndices() const;
+
 	/**
 	 * Getter for the scores object.
 	 *
@@ -272,6 +307,23 @@ class GT2_EXPORT GeneSet
 	 */
 	std::vector<std::string> getAbsoluteSortedIdentifier() const;
 
+	/**
+	 * Returns the elements at the given positions.
+	 *
+	 * @param permutation Positions, e.g. obtained from sortedIndices().
+	 * @return Vector of identifier/score pairs.
+	 */
+	Container permute(const std::vector<size_t>& permutation) const;
+
+	/**
+	 * Returns the identifiers at the given positions.
+	 *
+	 * @param permutation Positions, e.g. obtained from sortedIndices().
+	 * @return Vector of identifiers.
+	 */
+	std::vector<std::string>
+	getIdentifier(const std::vector<size_t>& permutation) const;
+
 	/**
 	 * Access the i-th element.
 	 *
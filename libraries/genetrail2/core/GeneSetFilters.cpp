@@ -21,12 +21,34 @@
 
 #include "GeneSet.h"
 
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
+#include <vector>
 
 namespace GeneTrail
 {
 	namespace GeneSetFilter
 	{
+		namespace
+		{
+			/**
+			 * Returns the k-th smallest score. Only the scores are copied
+			 * and partially ordered.
+			 */
+			double kthScore(const GeneSet& gene_set, size_t k)
+			{
+				std::vector<double> scores(gene_set.size());
+				for(size_t i = 0; i < gene_set.size(); ++i) {
+					scores[i] = gene_set[i].second;
+				}
+
+				k = std::min(k, scores.size() - 1);
+				std::nth_element(scores.begin(), scores.begin() + k, scores.end());
+				return scores[k];
+			}
+		}
+
 		UpperQuantileFilter::UpperQuantileFilter(double quantile)
 		    : quantile_(quantile), threshold_(0.0)
 		{
@@ -41,10 +63,8 @@ namespace GeneTrail
 				return;
 			}
 
-			auto sorted = gene_set.getDecreasinglySortedScores();
-
-			int i = std::floor(sorted.size() * quantile_);
-			threshold_ = sorted[i].second;
+			size_t i = std::floor(gene_set.size() * quantile_);
+			threshold_ = kthScore(gene_set, gene_set.size() - std::min(i, gene_set.size() - 1) - 1);
 		}
 
 		LowerQuantileFilter::LowerQuantileFilter(double quantile)
@@ -61,10 +81,8 @@ namespace GeneTrail
 				return;
 			}
 
-			auto sorted = gene_set.getIncreasinglySortedScores();
-
-			int i = std::floor(sorted.size() * quantile_);
-			threshold_ = sorted[i].second;
+			size_t i = std::floor(gene_set.size() * quantile_);
+			threshold_ = kthScore(gene_set, i);
 		}
 
 		QuantileFilter::QuantileFilter(double quantile)
@@ -81,11 +99,9 @@ namespace GeneTrail
 				return;
 			}
 
-			auto sorted = gene_set.getIncreasinglySortedScores();
-
-			int i = std::floor(sorted.size() * quantile_ * 0.5);
-			lower_threshold_ = sorted[i].second;
-			upper_threshold_ = sorted[sorted.size() - i - 1].second;
+			size_t i = std::floor(gene_set.size() * quantile_ * 0.5);
+			lower_threshold_ = kthScore(gene_set, i);
+			upper_threshold_ = kthScore(gene_set, gene_set.size() - i - 1);
 		}
 	}
 }
@@ -20,83 +20,219 @@
  */
 #include "GeneSetReader.h"
 
+#include "EntityDatabase.h"
 #include "Exception.h"
 #include "GeneSet.h"
+#include "Scores.h"
 
-#include <boost/algorithm/string/trim.hpp>
-#include <boost/algorithm/string.hpp>
-#include <boost/algorithm/string/predicate.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/utility/string_ref.hpp>
 
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
+#include <vector>
 
 namespace GeneTrail
 {
+	namespace
+	{
+		const size_t CHUNK_SIZE = 1 << 20;
+
+		bool isSpace(char c)
+		{
+			return std::isspace(static_cast<unsigned char>(c)) != 0;
+		}
+
+		boost::string_ref trim(boost::string_ref s)
+		{
+			while(!s.empty() && isSpace(s.front())) {
+				s.remove_prefix(1);
+			}
+
+			while(!s.empty() && isSpace(s.back())) {
+				s.remove_suffix(1);
+			}
+
+			return s;
+		}
+
+		/**
+		 * Splits line at every run of delimiter characters and stores at
+		 * most max_fields fields.
+		 *
+		 * @return The total number of fields.
+		 */
+		size_t split(boost::string_ref line, const char* delimiter,
+		             boost::string_ref* fields, size_t max_fields)
+		{
+			auto is_delimiter = [delimiter](char c) {
+				return std::strchr(delimiter, c) != nullptr;
+			};
+
+			size_t n = 0;
+			const char* p = line.begin();
+			while(true) {
+				const char* q = std::find_if(p, line.end(), is_delimiter);
+				if(n < max_fields) {
+					fields[n] = boost::string_ref(p, q - p);
+				}
+				++n;
+
+				if(q == line.end()) {
+					return n;
+				}
+
+				p = std::find_if_not(q, line.end(), is_delimiter);
+			}
+		}
+
+		std::string lineError(size_t l, const std::string& msg)
+		{
+			return "Wrong file format: Line " +
+			       boost::lexical_cast<std::string>(l) + " " + msg;
+		}
+
+		double parseScore(boost::string_ref field, size_t l, std::string& buffer)
+		{
+			// The copy is needed to terminate the field. It is small
+			// enough to not require an allocation.
+			buffer.assign(field.begin(), field.end());
+
+			char* end = nullptr;
+			const double value = std::strtod(buffer.c_str(), &end);
+			if(buffer.empty() || end != buffer.c_str() + buffer.size()) {
+				throw IOError(lineError(l, "contains an invalid score: " + buffer));
+			}
+
+			return value;
+		}
+	}
+
 	template <typename Processor>
-	GeneSet GeneSetReader::read(const std::string& path, Processor p,
-	                            size_t numberOfElementPerLine,
-	                            const std::string& delimiter) const
+	void GeneSetReader::read_(const std::string& path, Processor p,
+	                          size_t numberOfElementPerLine,
+	                          const char* delimiter) const
 	{
-		GeneSet gene_set;
-		std::ifstream input(path);
+		std::ifstream input(path, std::ios::in | std::ios::binary);
 		if(!input) {
 			throw IOError("File (" + path + ") is not open for reading");
 		}
 
-		std::vector<std::string> sline;
-		int l = 1;
-		for(std::string line; getline(input, line); ++l) {
-			boost::trim(line);
+		boost::string_ref fields[2];
+		size_t l = 1;
+
+		auto process_line = [&](boost::string_ref line) {
+			line = trim(line);
+
+			if(line.empty() || line.find("(class=") != boost::string_ref::npos) {
+				++l;
+				return;
+			}
+
+			const size_t n = split(line, delimiter, fields, numberOfElementPerLine);
+			if(n != numberOfElementPerLine) {
+				std::string err = (n > numberOfElementPerLine) ? "many" : "few";
+				throw IOError(lineError(l, "contains too " + err + " elements"));
+			}
 
-			if(line == "") {
-				continue;
+			for(size_t i = 0; i < n; ++i) {
+				fields[i] = trim(fields[i]);
 			}
 
-			if(line.find("(class=") != std::string::npos) {
-				continue;
+			p(fields, l);
+			++l;
+		};
+
+		// Lines are processed directly in the buffer. Only an incomplete
+		// line at the end of a chunk is moved to the front.
+		std::vector<char> buffer(CHUNK_SIZE);
+		size_t size = 0;
+		while(input) {
+			if(buffer.size() - size < CHUNK_SIZE / 2) {
+				buffer.resize(buffer.size() * 2);
 			}
 
-			boost::split(sline, line, boost::is_any_of(delimiter),
-			             boost::token_compress_on);
-			if(sline.size() == numberOfElementPerLine) {
-				gene_set.insert(p(sline));
-			} else {
-				std::string err =
-				    (sline.size() > numberOfElementPerLine) ? "many" : "few";
-				throw IOError("Wrong file format: Line " +
-				              boost::lexical_cast<std::string>(l) +
-				              " contains too " + err + " elements");
+			input.read(buffer.data() + size, buffer.size() - size);
+			size += input.gcount();
+
+			const char* begin = buffer.data();
+			const char* end = begin + size;
+			for(const char* eol; (eol = std::find(begin, end, '\n')) != end; begin = eol + 1) {
+				process_line(boost::string_ref(begin, eol - begin));
 			}
+
+			size = end - begin;
+			std::copy(begin, end, buffer.data());
+		}
+
+		if(size > 0) {
+			process_line(boost::string_ref(buffer.data(), size));
 		}
-		return gene_set;
 	}
 
-	GeneSet::Element scoringFileProcessor(std::vector<std::string>& sline)
+	GeneSet GeneSetReader::readScoringFile(const std::string& path) const
 	{
-		boost::trim(sline[0]);
-		boost::trim(sline[1]);
-		return std::make_pair(sline[0],
-		                      boost::lexical_cast<double>(sline[1]));
+		GeneSet gene_set;
+		std::string number;
+		read_(path,
+		      [&](const boost::string_ref* fields, size_t l) {
+			      gene_set.insert(fields[0].to_string(), parseScore(fields[1], l, number));
+		      },
+		      2, " \t");
+		return gene_set;
 	}
 
-	GeneSet::Element geneListProcessor(std::vector<std::string>& sline)
+	Scores GeneSetReader::readScoringFile(const std::string& path,
+	                                      const std::shared_ptr<EntityDatabase>& db) const
 	{
-		return std::make_pair(sline[0], 0.0);
+		Scores scores(db);
+		std::string name, number;
+		read_(path,
+		      [&](const boost::string_ref* fields, size_t l) {
+			      name.assign(fields[0].begin(), fields[0].end());
+			      scores.emplace_back(db->index(name), parseScore(fields[1], l, number));
+		      },
+		      2, " \t");
+		return scores;
 	}
 
-	GeneSet GeneSetReader::readScoringFile(const std::string& path) const
+	GeneSet GeneSetReader::readGeneList(const std::string& path) const
 	{
-		return read(path, scoringFileProcessor, 2, " \t");
+		GeneSet gene_set;
+		read_(path,
+		      [&](const boost::string_ref* fields, size_t) {
+			      gene_set.insert(fields[0].to_string(), 0.0);
+		      },
+		      1, " \t");
+		return gene_set;
 	}
 
-	GeneSet GeneSetReader::readGeneList(const std::string& path) const
+	Scores GeneSetReader::readGeneList(const std::string& path,
+	                                   const std::shared_ptr<EntityDatabase>& db) const
 	{
-		return read(path, geneListProcessor, 1, " \t");
+		Scores scores(db);
+		std::string name;
+		read_(path,
+		      [&](const boost::string_ref* fields, size_t) {
+			      name.assign(fields[0].begin(), fields[0].end());
+			      scores.emplace_back(db->index(name), 0.0);
+		      },
+		      1, " \t");
+		return scores;
 	}
 
 	GeneSet GeneSetReader::readNAFile(const std::string& path) const
 	{
-		return read(path, scoringFileProcessor, 2, "=");
+		GeneSet gene_set;
+		std::string number;
+		read_(path,
+		      [&](const boost::string_ref* fields, size_t l) {
+			      gene_set.insert(fields[0].to_string(), parseScore(fields[1], l, number));
+		      },
+		      2, "=");
+		return gene_set;
 	}
 }
-
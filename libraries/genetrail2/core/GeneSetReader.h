@@ -21,14 +21,24 @@
 #ifndef GT2_CORE_GENE_SET_READER_H
 #define GT2_CORE_GENE_SET_READER_H
 
+#include <memory>
 #include <string>
 
 #include "macros.h"
 
 namespace GeneTrail
 {
+	class EntityDatabase;
 	class GeneSet;
+	class Scores;
 
+	/**
+	 * Reader for scoring files, gene lists and NA files.
+	 *
+	 * Files are read in large chunks and split into fields in place.
+	 * Neither lines nor fields are copied before the identifier is stored,
+	 * and scores are converted directly from the buffer.
+	 */
 	class GT2_EXPORT GeneSetReader
 	{
 		public:
@@ -36,38 +46,56 @@ namespace GeneTrail
 		GeneSetReader(){};
 
 		/**
-		 * Generic function to parse all kinds of files.
+		 * Reads a scoring file containing identifier/score pairs
+		 * separated by spaces or tabs.
 		 *
-		 * @param path Path to file
-		 * @param p Function to process each line of the file
-		 * @param numberOfElementPerLine Allowed number of elements per line
-		 * @param delimiter The delimiter to split each line (default is " \t")
+		 * @param path Path to the file
+		 * @throws IOError if the file cannot be read or a line is malformed.
 		 */
-		template <typename Processor>
-		GeneSet read(const std::string& path, Processor p,
-		             size_t numberOfElementPerLine,
-		             const std::string& delimiter) const;
+		GeneSet readScoringFile(const std::string& path) const;
 
 		/**
-		 * Specialization of the generic read function for scoring files
+		 * Reads a scoring file and directly stores the identifiers as
+		 * indices of db.
 		 *
 		 * @param path Path to the file
+		 * @param db The database in which the identifiers are registered
+		 * @throws IOError if the file cannot be read or a line is malformed.
 		 */
-		GeneSet readScoringFile(const std::string& path) const;
+		Scores readScoringFile(const std::string& path,
+		                       const std::shared_ptr<EntityDatabase>& db) const;
 
 		/**
-		 * Specialization of the generic read function for gene lists
+		 * Reads a list of identifiers. All scores are 0.0.
 		 *
 		 * @param path Path to the file
+		 * @throws IOError if the file cannot be read or a line is malformed.
 		 */
 		GeneSet readGeneList(const std::string& path) const;
 
 		/**
-		 * Specialization of the generic read function for na files
+		 * Reads a list of identifiers and directly stores them as indices
+		 * of db. All scores are 0.0.
 		 *
 		 * @param path Path to the file
+		 * @param db The database in which the identifiers are registered
+		 * @throws IOError if the file cannot be read or a line is malformed.
+		 */
+		Scores readGeneList(const std::string& path,
+		                    const std::shared_ptr<EntityDatabase>& db) const;
+
+		/**
+		 * Reads a Cytoscape NA file with lines of the form "name = score".
+		 *
+		 * @param path Path to the file
+		 * @throws IOError if the file cannot be read or a line is malformed.
 		 */
 		GeneSet readNAFile(const std::string& path) const;
+
+		private:
+		template <typename Processor>
+		void read_(const std::string& path, Processor p,
+		           size_t numberOfElementPerLine, const char* delimiter) const;
 	};
 }
 
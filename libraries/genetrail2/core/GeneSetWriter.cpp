@@ -58,5 +58,17 @@ namespace GeneTrail
 	{
 		write(gene_set, path, "\t");
 	}
+
+	void GeneSetWriter::writeScoringFile(const Scores& gene_set,
+	                                     std::ostream& output) const
+	{
+		for(const auto& p : gene_set) {
+			output << p.name(*gene_set.db()) << '\t' << p.score() << '\n';
+		}
+
+		if(!output) {
+			throw IOError("Could not write scoring file");
+		}
+	}
 }
 
@@ -47,6 +47,13 @@ namespace GeneTrail
 
 		void writeScoringFile(const Scores& gene_set,
 		                      const std::string& path) const;
+
+		/**
+		 * Appends the scores to an open stream. This allows to write a
+		 * scoring file in several parts, e.g. block by block.
+		 */
+		void writeScoringFile(const Scores& gene_set,
+		                      std::ostream& output) const;
 	};
 }
 
@@ -0,0 +1,352 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "GraphicalLasso.h"
+
+#include "SparseMatrix.h"
+#include "misc_algorithms.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace GeneTrail
+{
+	namespace
+	{
+		struct BlockResult
+		{
+			size_t iterations = 0;
+			bool converged = true;
+		};
+
+		double softThreshold(double x, double t)
+		{
+			if(x > t) {
+				return x - t;
+			}
+
+			if(x < -t) {
+				return x + t;
+			}
+
+			return 0.0;
+		}
+
+		/**
+		 * Block coordinate descent for a single connected component as
+		 * in the glasso Fortran code. W holds the (warm) start, B the lasso
+		 * coefficients of every column, which are derived from the warm
+		 * start of the precision matrix.
+		 */
+		BlockResult solveBlock(const Eigen::MatrixXd& S, double rho,
+		                       double threshold, size_t max_iterations,
+		                       Eigen::MatrixXd& W, Eigen::MatrixXd& B,
+		                       Eigen::MatrixXd& Theta)
+		{
+			const Eigen::Index m = S.rows();
+
+			const double off_diagonal = S.cwiseAbs().sum() - S.diagonal().cwiseAbs().sum();
+			const double shr = threshold * off_diagonal / (m - 1);
+
+			BlockResult result;
+			result.converged = false;
+
+			Eigen::VectorXd b(m);
+			Eigen::VectorXd Wb(m);
+
+			while(result.iterations < max_iterations) {
+				++result.iterations;
+
+				const double total = W.cwiseAbs().sum();
+				double dlx = 0.0;
+
+				for(Eigen::Index j = 0; j < m; ++j) {
+					b = B.col(j);
+					b[j] = 0.0;
+
+					Wb.setZero();
+					for(Eigen::Index k = 0; k < m; ++k) {
+						if(b[k] != 0.0) {
+							Wb += b[k] * W.col(k);
+						}
+					}
+
+					// The lasso threshold is relative to the sum of W11
+					const double w11 = total - 2.0 * W.col(j).cwiseAbs().sum() + std::abs(W(j, j));
+					const double inner_shr = shr / std::max(w11, std::numeric_limits<double>::min());
+
+					for(size_t it = 0; it < max_iterations; ++it) {
+						double delta = 0.0;
+						for(Eigen::Index k = 0; k < m; ++k) {
+							if(k == j) {
+								continue;
+							}
+
+							const double old = b[k];
+							const double r = S(k, j) - Wb[k] + W(k, k) * old;
+							b[k] = softThreshold(r, rho) / W(k, k);
+
+							if(b[k] != old) {
+								const double d = b[k] - old;
+								Wb += d * W.col(k);
+								delta = std::max(delta, std::abs(d));
+							}
+						}
+
+						if(delta < inner_shr) {
+							break;
+						}
+					}
+
+					double change = 0.0;
+					for(Eigen::Index k = 0; k < m; ++k) {
+						if(k == j) {
+							continue;
+						}
+
+						change += std::abs(Wb[k] - W(k, j));
+						W(k, j) = Wb[k];
+						W(j, k) = Wb[k];
+					}
+
+					dlx = std::max(dlx, change);
+					B.col(j) = b;
+				}
+
+				if(dlx < shr) {
+					result.converged = true;
+					break;
+				}
+			}
+
+			// Theta_jj = 1 / (W_jj - w12'b) and Theta_12 = -b Theta_jj
+			for(Eigen::Index j = 0; j < m; ++j) {
+				const double theta_jj = 1.0 / (W(j, j) - W.col(j).dot(B.col(j)));
+				Theta.col(j) = -theta_jj * B.col(j);
+				Theta(j, j) = theta_jj;
+			}
+
+			Theta = 0.5 * (Theta + Theta.transpose()).eval();
+
+			return result;
+		}
+	}
+
+	SparseMatrix GraphicalLassoResult::sparsePrecision(const std::vector<std::string>& names) const
+	{
+		if(names.size() != static_cast<size_t>(precision.rows())) {
+			throw std::invalid_argument("Number of names does not match the size of the precision matrix");
+		}
+
+		std::vector<Eigen::Triplet<double>> entries;
+		for(Eigen::Index j = 0; j < precision.cols(); ++j) {
+			for(Eigen::Index i = 0; i < precision.rows(); ++i) {
+				if(precision(i, j) != 0.0) {
+					entries.emplace_back(i, j, precision(i, j));
+				}
+			}
+		}
+
+		SparseMatrix result(names, names);
+		result.matrix().setFromTriplets(entries.begin(), entries.end());
+		result.matrix().makeCompressed();
+
+		return result;
+	}
+
+	void GraphicalLasso::setThreshold(double threshold)
+	{
+		threshold_ = threshold;
+	}
+
+	void GraphicalLasso::setMaxIterations(size_t max_iterations)
+	{
+		max_iterations_ = max_iterations;
+	}
+
+	void GraphicalLasso::setPenalizeDiagonal(bool penalize)
+	{
+		penalize_diagonal_ = penalize;
+	}
+
+	void GraphicalLasso::setNumberOfThreads(unsigned int num_threads)
+	{
+		num_threads_ = num_threads;
+	}
+
+	size_t GraphicalLasso::components(const Eigen::MatrixXd& S, double rho,
+	                                  std::vector<size_t>& component)
+	{
+		const size_t p = S.rows();
+
+		// Union-find with path halving
+		std::vector<size_t> parent(p);
+		std::iota(parent.begin(), parent.end(), size_t(0));
+
+		auto find = [&parent](size_t i) {
+			while(parent[i] != i) {
+				parent[i] = parent[parent[i]];
+				i = parent[i];
+			}
+			return i;
+		};
+
+		for(size_t j = 0; j < p; ++j) {
+			for(size_t i = j + 1; i < p; ++i) {
+				if(std::abs(S(i, j)) > rho) {
+					const size_t a = find(i);
+					const size_t b = find(j);
+					if(a != b) {
+						parent[std::max(a, b)] = std::min(a, b);
+					}
+				}
+			}
+		}
+
+		// Roots are the smallest variables of their components
+		component.assign(p, 0);
+		size_t num_components = 0;
+		for(size_t i = 0; i < p; ++i) {
+			const size_t root = find(i);
+			component[i] = root == i ? num_components++ : component[root];
+		}
+
+		return num_components;
+	}
+
+	GraphicalLassoResult GraphicalLasso::fit(const Eigen::MatrixXd& S, double rho) const
+	{
+		GraphicalLassoResult result;
+		solve_(S, rho, result, false);
+		return result;
+	}
+
+	void GraphicalLasso::path(const Eigen::MatrixXd& S, std::vector<double> rhos,
+	                          const Callback& callback) const
+	{
+		std::sort(rhos.begin(), rhos.end(), std::greater<double>());
+
+		if(!rhos.empty() && rhos.back() < 0.0) {
+			throw std::invalid_argument("The penalty has to be non-negative");
+		}
+
+		GraphicalLassoResult result;
+		for(size_t i = 0; i < rhos.size(); ++i) {
+			solve_(S, rhos[i], result, i != 0);
+			callback(result);
+		}
+	}
+
+	void GraphicalLasso::solve_(const Eigen::MatrixXd& S, double rho,
+	                            GraphicalLassoResult& result, bool warm_start) const
+	{
+		if(S.rows() != S.cols()) {
+			throw std::invalid_argument("The covariance matrix has to be square");
+		}
+
+		if(rho < 0.0) {
+			throw std::invalid_argument("The penalty has to be non-negative");
+		}
+
+		const Eigen::Index p = S.rows();
+		const double diagonal_penalty = penalize_diagonal_ ? rho : 0.0;
+
+		std::vector<size_t> component;
+		const size_t num_components = components(S, rho, component);
+
+		std::vector<std::vector<Eigen::Index>> members(num_components);
+		for(Eigen::Index i = 0; i < p; ++i) {
+			members[component[i]].push_back(i);
+		}
+
+		// Solve large components first for better load balancing
+		std::stable_sort(members.begin(), members.end(),
+		                 [](const std::vector<Eigen::Index>& a,
+		                    const std::vector<Eigen::Index>& b) {
+			                 return a.size() > b.size();
+		                 });
+
+		Eigen::MatrixXd W = Eigen::MatrixXd::Zero(p, p);
+		Eigen::MatrixXd Theta = Eigen::MatrixXd::Zero(p, p);
+		std::vector<BlockResult> block_results(num_components);
+
+		parallel_for(size_t(0), num_components, [&](size_t c) {
+			const auto& idx = members[c];
+			const Eigen::Index m = idx.size();
+
+			if(m == 1) {
+				const Eigen::Index i = idx[0];
+				W(i, i) = S(i, i) + diagonal_penalty;
+				Theta(i, i) = 1.0 / W(i, i);
+				return;
+			}
+
+			Eigen::MatrixXd Sc(m, m);
+			Eigen::MatrixXd Wc(m, m);
+			Eigen::MatrixXd Bc = Eigen::MatrixXd::Zero(m, m);
+			for(Eigen::Index l = 0; l < m; ++l) {
+				for(Eigen::Index k = 0; k < m; ++k) {
+					Sc(k, l) = S(idx[k], idx[l]);
+				}
+			}
+
+			if(warm_start) {
+				// The previous solution is block diagonal w.r.t. the
+				// (coarser) previous components.
+				for(Eigen::Index l = 0; l < m; ++l) {
+					const double theta_ll = result.precision(idx[l], idx[l]);
+					for(Eigen::Index k = 0; k < m; ++k) {
+						Wc(k, l) = result.covariance(idx[k], idx[l]);
+						Bc(k, l) = -result.precision(idx[k], idx[l]) / theta_ll;
+					}
+					Bc(l, l) = 0.0;
+				}
+			} else {
+				Wc = Sc;
+			}
+
+			for(Eigen::Index k = 0; k < m; ++k) {
+				Wc(k, k) = Sc(k, k) + diagonal_penalty;
+			}
+
+			Eigen::MatrixXd Thetac(m, m);
+			block_results[c] = solveBlock(Sc, rho, threshold_, max_iterations_, Wc, Bc, Thetac);
+
+			for(Eigen::Index l = 0; l < m; ++l) {
+				for(Eigen::Index k = 0; k < m; ++k) {
+					W(idx[k], idx[l]) = Wc(k, l);
+					Theta(idx[k], idx[l]) = Thetac(k, l);
+				}
+			}
+		}, num_threads_);
+
+		result.rho = rho;
+		result.covariance = std::move(W);
+		result.precision = std::move(Theta);
+		result.num_components = num_components;
+		result.iterations = 0;
+		result.converged = true;
+		for(const auto& block : block_results) {
+			result.iterations = std::max(result.iterations, block.iterations);
+			result.converged = result.converged && block.converged;
+		}
+	}
+}
@@ -0,0 +1,146 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_CORE_GRAPHICAL_LASSO_H
+#define GT2_CORE_GRAPHICAL_LASSO_H
+
+#include "macros.h"
+
+#include <Eigen/Core>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace GeneTrail
+{
+	class SparseMatrix;
+
+	/**
+	 * The solution of the graphical lasso for a single penalty.
+	 */
+	struct GT2_EXPORT GraphicalLassoResult
+	{
+		/// The penalty
+		double rho = 0.0;
+
+		/// The estimated covariance matrix W
+		Eigen::MatrixXd covariance;
+
+		/// The estimated precision matrix Theta = W^-1
+		Eigen::MatrixXd precision;
+
+		/// The number of connected components of the thresholded covariance
+		size_t num_components = 0;
+
+		/// The maximal number of sweeps needed by any component
+		size_t iterations = 0;
+
+		/// False if any component did not converge
+		bool converged = true;
+
+		/**
+		 * Returns the non-zero entries of the precision matrix. Both, the
+		 * rows and the columns are named by names.
+		 */
+		SparseMatrix sparsePrecision(const std::vector<std::string>& names) const;
+	};
+
+	/**
+	 * Graphical lasso (Friedman, Hastie and Tibshirani, 2008) estimating a
+	 * sparse precision matrix from a covariance matrix S by block coordinate
+	 * descent in double precision.
+	 *
+	 * Before solving, the variables are split into the connected components
+	 * of the graph with edges |S_ij| > rho (Witten et al., 2011; Mazumder
+	 * and Hastie, 2012). The solution is block diagonal with respect to
+	 * these components, so that every component is solved independently and
+	 * in parallel. Singletons are solved in closed form.
+	 *
+	 * A regularization path is computed from the largest to the smallest
+	 * penalty. As components only merge with decreasing penalty, every
+	 * solution is used as warm start for the next one.
+	 */
+	class GT2_EXPORT GraphicalLasso
+	{
+		public:
+		using Callback = std::function<void(const GraphicalLassoResult&)>;
+
+		/**
+		 * Sets the convergence threshold. A component converged if the
+		 * mean absolute change of W during a sweep is below threshold times
+		 * the mean absolute off-diagonal entry of S.
+		 */
+		void setThreshold(double threshold);
+
+		/**
+		 * Sets the maximal number of sweeps per component.
+		 */
+		void setMaxIterations(size_t max_iterations);
+
+		/**
+		 * If true (default), the diagonal of the precision matrix is
+		 * penalized as well, i.e. W_ii = S_ii + rho.
+		 */
+		void setPenalizeDiagonal(bool penalize);
+
+		/**
+		 * Sets the number of threads. 0 uses all available cores.
+		 */
+		void setNumberOfThreads(unsigned int num_threads);
+
+		/**
+		 * Solves the graphical lasso for a single penalty.
+		 *
+		 * @throws std::invalid_argument if S is not square or rho is negative.
+		 */
+		GraphicalLassoResult fit(const Eigen::MatrixXd& S, double rho) const;
+
+		/**
+		 * Solves the graphical lasso for all penalties, starting with the
+		 * largest one. The solutions are passed to callback in this order,
+		 * so that only one solution has to be kept in memory.
+		 *
+		 * @throws std::invalid_argument if S is not square or a penalty is
+		 *         negative.
+		 */
+		void path(const Eigen::MatrixXd& S, std::vector<double> rhos,
+		          const Callback& callback) const;
+
+		/**
+		 * Assigns every variable to a connected component of the graph
+		 * with edges |S_ij| > rho. Components are numbered in order of
+		 * their smallest variable.
+		 *
+		 * @return The number of components.
+		 */
+		static size_t components(const Eigen::MatrixXd& S, double rho,
+		                         std::vector<size_t>& component);
+
+		private:
+		void solve_(const Eigen::MatrixXd& S, double rho,
+		            GraphicalLassoResult& result, bool warm_start) const;
+
+		double threshold_ = 1e-4;
+		size_t max_iterations_ = 10000;
+		bool penalize_diagonal_ = true;
+		unsigned int num_threads_ = 0;
+	};
+}
+
+#endif // GT2_CORE_GRAPHICAL_LASSO_H
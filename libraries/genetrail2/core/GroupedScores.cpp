@@ -20,6 +20,8 @@
 
 #include "GroupedScores.h"
 #include "MatrixTools.h"
+#include "SparseMatrixHTest.h"
+#include "misc_algorithms.h"
 
 using namespace GeneTrail;
 
@@ -56,6 +58,48 @@ void GroupedScores::calculateGroupedScores(
 	return;
 }
 
+void GroupedScores::calculateGroupedScores(
+	const SparseMatrix& matrix,
+	const std::vector<Metadata>& meta,
+	const std::string& method,
+	DenseMatrix& result,
+	unsigned int num_threads
+) const{
+	MatrixHTestFactory factory;
+	const MatrixHTests id = factory.getDescriptor(method).id;
+	if(!SparseMatrixHTest::supports(id)){
+		throw NotImplemented(__FILE__, __LINE__, method + " for sparse matrices");
+	}
+	
+	std::map<std::string, std::vector<unsigned int>> group_indices;
+	ORAGroupPreference::parseGroups(matrix, meta, group_indices);
+	
+	std::vector<std::string> groups;
+	std::vector<size_t> column_groups(matrix.cols(), SparseGroupMoments::NO_GROUP);
+	for(const auto& entry: group_indices){
+		for(auto j: entry.second) column_groups[j] = groups.size();
+		groups.push_back(entry.first);
+	}
+	
+	result = DenseMatrix(matrix.rows()+1, group_indices.size());
+	result.setColNames(groups);
+	std::vector<std::string> row_names(matrix.rowNames());
+	row_names.insert(row_names.begin(), "GroupSizes");
+	result.setRowNames(row_names);
+	addGroupSizeToResult(result, group_indices);
+	
+	SparseGroupMoments moments(matrix, column_groups, groups.size(), num_threads);
+	parallel_for(size_t(0), size_t(matrix.rows()), [&](size_t r){
+		const GroupMoments total = moments.total(r);
+		for(size_t g=0; g < groups.size(); g++){
+			const GroupMoments group = moments(r, g);
+			GroupMoments rest = total;
+			rest -= group;
+			result(r+1, g) = SparseMatrixHTest::score(id, group, rest);
+		}
+	}, num_threads, size_t(256));
+}
+
 void GroupedScores::createSamples(
 	const DenseMatrix& matrix,
 	const std::map<std::string, std::vector<unsigned int>>& group_indices,
@@ -24,6 +24,7 @@
 #include "ORAGroupPreference.h"
 #include "DenseMatrix.h"
 #include "DenseColumnSubset.h"
+#include "SparseMatrix.h"
 #include "Metadata.h"
 #include "MatrixHTest.h"
 
@@ -52,6 +53,21 @@ namespace GeneTrail {
 				const std::string method, DenseMatrix& result
 			) const;
 			
+			/**
+			 * Sparse version of the method above. Instead of splitting the
+			 * matrix for every group, the moments of all groups are
+			 * collected in a single pass over the stored entries. The
+			 * moments of the remaining columns are obtained by subtracting
+			 * those of a group from the row totals. Only the methods of
+			 * SparseMatrixHTest are supported.
+			 */
+			void calculateGroupedScores(
+				const SparseMatrix& matrix,
+				const std::vector<Metadata>& metadata,
+				const std::string& method, DenseMatrix& result,
+				unsigned int num_threads = 0
+			) const;
+			
 			/**
 			 * Use this method if mean-fold-quotient is to be calculated and the group
 			 * means are already precomputed. The first row in the matrix is interpreted
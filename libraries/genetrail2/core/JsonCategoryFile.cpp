@@ -21,250 +21,479 @@
 
 #include "Exception.h"
 
-#include <rapidjson/document.h>
+#include <rapidjson/reader.h>
 #include <rapidjson/writer.h>
 
-#include <cassert>
+#include <algorithm>
+#include <array>
 #include <cstring>
+#include <vector>
 
 namespace GeneTrail
 {
-// This code is taken from the RapidJSON documentation
-class IStreamWrapper
+// Size of the chunks in which files are read and written
+static const size_t BUFFER_SIZE = 1 << 16;
+
+/**
+ * RapidJSON output stream that collects the output in a fixed buffer
+ * instead of putting every character into the std::ostream.
+ */
+class OStreamBuffer
 {
   public:
 	typedef char Ch;
-	IStreamWrapper(std::istream& is) : is_(is) {}
-	Ch Peek() const
-	{
-		int c = is_.peek();
-		return c == std::char_traits<char>::eof() ? '\0' : (Ch)c;
-	}
-	Ch Take()
-	{
-		int c = is_.get();
-		return c == std::char_traits<char>::eof() ? '\0' : (Ch)c;
-	}
-	size_t Tell() const { return (size_t)is_.tellg(); }
-	Ch* PutBegin()
+
+	OStreamBuffer(std::ostream& os) : os_(os), size_(0) {}
+	~OStreamBuffer() { drain_(); }
+
+	void Put(Ch c)
 	{
-		assert(false);
-		return 0;
+		if(size_ == buffer_.size()) {
+			drain_();
+		}
+
+		buffer_[size_++] = c;
 	}
-	void Put(Ch) { assert(false); }
-	void Flush() { assert(false); }
-	size_t PutEnd(Ch*)
+
+	void Flush()
 	{
-		assert(false);
-		return 0;
+		drain_();
+		os_.flush();
 	}
 
   private:
-	IStreamWrapper(const IStreamWrapper&);
-	IStreamWrapper& operator=(const IStreamWrapper&);
-	std::istream& is_;
-};
+	OStreamBuffer(const OStreamBuffer&);
+	OStreamBuffer& operator=(const OStreamBuffer&);
 
-class OStreamWrapper
-{
-  public:
-	typedef char Ch;
-	OStreamWrapper(std::ostream& os) : os_(os) {}
-	Ch Peek() const
-	{
-		assert(false);
-		return '\0';
-	}
-	Ch Take()
-	{
-		assert(false);
-		return '\0';
-	}
-	size_t Tell() const { return 0; }
-	Ch* PutBegin()
+	void drain_()
 	{
-		assert(false);
-		return 0;
-	}
-	void Put(Ch c) { os_.put(c); }
-	void Flush() { os_.flush(); }
-	size_t PutEnd(Ch*)
-	{
-		assert(false);
-		return 0;
+		os_.write(buffer_.data(), size_);
+		size_ = 0;
 	}
 
-  private:
-	OStreamWrapper(const OStreamWrapper&);
-	OStreamWrapper& operator=(const OStreamWrapper&);
 	std::ostream& os_;
+	std::array<Ch, BUFFER_SIZE> buffer_;
+	size_t size_;
 };
 
+using Writer = rapidjson::Writer<OStreamBuffer>;
+
+/**
+ * Reads the remaining content of the stream in large chunks and appends
+ * the terminating null character needed for in-situ parsing.
+ */
+static std::vector<char> readAll(std::istream& input)
+{
+	std::vector<char> buffer;
+	size_t size = 0;
+
+	while(input) {
+		buffer.resize(size + std::max(BUFFER_SIZE, size));
+		input.read(buffer.data() + size, buffer.size() - size);
+		size += input.gcount();
+	}
+
+	buffer.resize(size);
+	buffer.push_back('\0');
 
-using Writer = rapidjson::Writer<OStreamWrapper>;
+	return buffer;
+}
 
-static const char* getString(const rapidjson::Value& member, const char* memberName)
+/**
+ * Estimates the number of categories by the occurrences of the "members"
+ * key, so that the categories can be reserved before parsing.
+ */
+static size_t countCategories(const char* json)
 {
-	if(!member.IsString()) {
-		throw IOError(std::string("Category field '") + memberName +
-		              "' is not a string.");
+	size_t count = 0;
+	while((json = std::strstr(json, "\"members\"")) != nullptr) {
+		++count;
+		json += 9;
 	}
 
-	return member.GetString();
+	return count;
 }
 
-static Metadata::Value toMetadata(const rapidjson::Value& value)
+/**
+ * SAX handler that builds the CategoryDatabase while parsing. In contrast
+ * to building a rapidjson::Document first, no intermediate copy of the
+ * file content is created and every member identifier is translated to
+ * its index right away.
+ *
+ * Metadata values are assembled on a stack of arrays and objects. Errors
+ * are reported by throwing an IOError.
+ */
+class CategoryDatabaseHandler
+    : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, CategoryDatabaseHandler>
 {
-	if(value.IsNull()) {
-		return Metadata::Value(nullptr);
-	} else if(value.IsString()) {
-		return Metadata::Value(value.GetString());
-	} else if(value.IsDouble()) {
-		return Metadata::Value(value.GetDouble());
-	} else if(value.IsBool()) {
-		return Metadata::Value(value.GetBool());
-	} else if(value.IsInt()) {
-		return Metadata::Value(value.GetInt());
-	} else if(value.IsInt64()) {
-		return Metadata::Value(value.GetInt64());
-	} else if(value.IsUint()) {
-		return Metadata::Value(value.GetUint());
-	} else if(value.IsUint64()) {
-		return Metadata::Value(value.GetUint64());
-	} else if(value.IsArray()) {
-		Metadata::Array values;
-		values.reserve(value.Size());
-		for(auto it = value.Begin(); it != value.End(); ++it) {
-			values.emplace_back(toMetadata(*it));
+  public:
+	CategoryDatabaseHandler(CategoryDatabase& database)
+	    : database_(database),
+	      entities_(*database.entityDatabase()),
+	      state_(State::DOCUMENT),
+	      category_(nullptr),
+	      num_categories_(0),
+	      fields_(0),
+	      database_fields_(0)
+	{
+	}
+
+	bool finished() const { return state_ == State::DONE; }
+
+	bool Null() { return scalar_(Metadata::Value(nullptr)); }
+	bool Bool(bool b) { return scalar_(Metadata::Value(b)); }
+	bool Int(int i) { return scalar_(Metadata::Value(i)); }
+	bool Uint(unsigned u) { return scalar_(Metadata::Value(u)); }
+	bool Int64(int64_t i) { return scalar_(Metadata::Value(i)); }
+	bool Uint64(uint64_t u) { return scalar_(Metadata::Value(u)); }
+	bool Double(double d) { return scalar_(Metadata::Value(d)); }
+
+	bool String(const char* str, rapidjson::SizeType length, bool)
+	{
+		if(!values_.empty()) {
+			return value_(Metadata::Value(std::string(str, length)));
 		}
 
-		return Metadata::Value(std::move(values));
-	} else if(value.IsObject()) {
-		Metadata::Object values;
-		values.reserve(value.MemberCount());
-		for(auto it = value.MemberBegin(); it != value.MemberEnd(); ++it) {
-			values.emplace(it->name.GetString(), toMetadata(it->value));
+		switch(state_) {
+			case State::MEMBERS:
+				member_.assign(str, length);
+				members_.push_back(entities_.index(member_));
+				return true;
+			case State::EDITOR:
+				if(key_ == "name") {
+					database_.editor().name.assign(str, length);
+				} else if(key_ == "email") {
+					database_.editor().email.assign(str, length);
+				}
+				return true;
+			case State::ROOT:
+			case State::CATEGORY:
+				if(isStringField_()) {
+					setStringField_(std::string(str, length));
+					return true;
+				}
+				break;
+			default:
+				break;
 		}
 
-		return Metadata::Value(std::move(values));
-	} else {
-		throw NotImplemented(__FILE__, __LINE__, "Unhandled case for JSON Value.");
+		return scalar_(Metadata::Value(std::string(str, length)));
 	}
-}
 
-static void readCategoryFields(const rapidjson::Value& category, Category& cat)
-{
-	if(!category.HasMember("name")) {
-		throw IOError("Found category without name.");
+	bool Key(const char* str, rapidjson::SizeType length, bool)
+	{
+		if(values_.empty()) {
+			key_.assign(str, length);
+		} else {
+			keys_.back().assign(str, length);
+		}
+
+		return true;
 	}
 
-	if(!category.HasMember("reference")) {
-		throw IOError("Found category without reference.");
+	bool StartObject()
+	{
+		if(!values_.empty()) {
+			return push_(Metadata::Object());
+		}
+
+		switch(state_) {
+			case State::DOCUMENT:
+				state_ = State::ROOT;
+				return true;
+			case State::ROOT:
+				if(key_ == "editor") {
+					database_fields_ |= EDITOR;
+					state_ = State::EDITOR;
+					return true;
+				}
+				break;
+			case State::CATEGORIES:
+				startCategory_();
+				return true;
+			default:
+				break;
+		}
+
+		checkField_();
+		return push_(Metadata::Object());
 	}
 
-	for(auto it = category.MemberBegin(); it != category.MemberEnd(); ++it) {
-		const char* name = it->name.GetString();
-		if(std::strcmp(name, "name") == 0) {
-			cat.setName(getString(it->value, "name"));
-		} else if(std::strcmp(name, "reference") == 0) {
-			cat.setReference(getString(it->value, "reference"));
-		} else if(std::strcmp(name, "members") != 0) {
-			cat.metadata().add(name, toMetadata(it->value));
+	bool EndObject(rapidjson::SizeType)
+	{
+		if(!values_.empty()) {
+			return pop_();
+		}
+
+		switch(state_) {
+			case State::EDITOR:
+				state_ = State::ROOT;
+				break;
+			case State::CATEGORY:
+				endCategory_();
+				break;
+			default:
+				endDatabase_();
+				break;
 		}
+
+		return true;
 	}
-}
 
-static void readMembers(const rapidjson::Value& members, Category& cat)
-{
-	for(auto it = members.Begin(); it != members.End(); ++it) {
-		if(!it->IsString()) {
-			throw IOError("Found a non-string element im members array.");
+	bool StartArray()
+	{
+		if(!values_.empty()) {
+			return push_(Metadata::Array());
 		}
 
-		cat.insert(it->GetString());
+		if(state_ == State::ROOT && key_ == "categories") {
+			database_fields_ |= CATEGORIES;
+			state_ = State::CATEGORIES;
+			return true;
+		}
+
+		if(state_ == State::CATEGORY && key_ == "members") {
+			fields_ |= MEMBERS;
+			state_ = State::MEMBERS;
+			return true;
+		}
+
+		checkField_();
+		return push_(Metadata::Array());
 	}
-}
 
-static void readCategory(const rapidjson::Value& category, Category& cat)
-{
-	if(!category.HasMember("members") || !category["members"].IsArray()) {
-		throw IOError("Category does not have a member array.");
+	bool EndArray(rapidjson::SizeType)
+	{
+		if(!values_.empty()) {
+			return pop_();
+		}
+
+		if(state_ == State::MEMBERS) {
+			category_->replaceAll(members_.begin(), members_.end());
+			members_.clear();
+			state_ = State::CATEGORY;
+		} else {
+			state_ = State::ROOT;
+		}
+
+		return true;
 	}
 
-	readCategoryFields(category, cat);
-	readMembers(category["members"], cat);
-}
+  private:
+	enum class State { DOCUMENT, ROOT, EDITOR, CATEGORIES, CATEGORY, MEMBERS, DONE };
+
+	// Bits for the mandatory fields that have been seen
+	enum Field : unsigned {
+		NAME = 1,
+		REFERENCE = 2,
+		MEMBERS = 4,
+		EDITOR = 8,
+		CREATION_DATE = 16,
+		SOURCE_URL = 32,
+		IDENTIFIER = 64,
+		CATEGORIES = 128
+	};
+
+	bool isStringField_() const
+	{
+		if(state_ == State::CATEGORY) {
+			return key_ == "name" || key_ == "reference";
+		}
 
-static void readCategories(const rapidjson::Value& categories,
-                           CategoryDatabase& database)
-{
-	database.reserve(categories.Size());
+		return key_ == "name" || key_ == "creationDate" ||
+		       key_ == "sourceUrl" || key_ == "identifier";
+	}
 
-	for(rapidjson::SizeType i = 0; i < categories.Size(); ++i) {
-		if(!categories[i].IsObject()) {
-			throw IOError("Entry " + std::to_string(i) + " is not an object.");
+	void setStringField_(std::string&& value)
+	{
+		if(state_ == State::CATEGORY) {
+			if(key_ == "name") {
+				fields_ |= NAME;
+				category_->setName(std::move(value));
+			} else {
+				fields_ |= REFERENCE;
+				category_->setReference(std::move(value));
+			}
+			return;
 		}
 
-		Category& cat = database.addCategory();
-		readCategory(categories[i], cat);
+		if(key_ == "name") {
+			database_fields_ |= NAME;
+			database_.setName(std::move(value));
+		} else if(key_ == "creationDate") {
+			database_fields_ |= CREATION_DATE;
+			database_.setCreationDate(std::move(value));
+		} else if(key_ == "sourceUrl") {
+			database_fields_ |= SOURCE_URL;
+			database_.setSourceUrl(std::move(value));
+		} else {
+			database_fields_ |= IDENTIFIER;
+			database_.setIdentifier(std::move(value));
+		}
 	}
-}
 
+	/**
+	 * Throws if a value that is not a free (metadata) field has the
+	 * wrong type.
+	 */
+	void checkField_() const
+	{
+		switch(state_) {
+			case State::DOCUMENT:
+				throw IOError("Invalid Json file!");
+			case State::CATEGORIES:
+				throw IOError("Entry " + std::to_string(num_categories_) +
+				              " is not an object.");
+			case State::MEMBERS:
+				throw IOError("Found a non-string element im members array.");
+			case State::EDITOR:
+				if(key_ == "name" || key_ == "email") {
+					throw IOError("Category field 'editor." + key_ +
+					              "' is not a string.");
+				}
+				return;
+			case State::ROOT:
+				if(key_ == "editor") {
+					throw IOError("Database does not have an editor.");
+				}
+				if(key_ == "categories") {
+					throw IOError("Provided category database does not contain "
+					              "a list of categories.");
+				}
+				break;
+			case State::CATEGORY:
+				if(key_ == "members") {
+					throw IOError("Category does not have a member array.");
+				}
+				break;
+			default:
+				return;
+		}
 
-static void readDatabaseFields(const rapidjson::Document& document,
-                               CategoryDatabase& database)
-{
-	if(!document.HasMember("name")) {
-		throw IOError("Database does not have a name.");
+		if(isStringField_()) {
+			throw IOError("Category field '" + key_ + "' is not a string.");
+		}
 	}
 
-	if(!document.HasMember("editor") || !document["editor"].IsObject()) {
-		throw IOError("Database does not have an editor.");
+	bool scalar_(Metadata::Value&& value)
+	{
+		if(values_.empty()) {
+			checkField_();
+		}
+
+		return value_(std::move(value));
 	}
 
-	if(!document.HasMember("creationDate")) {
-		throw IOError("Database does not have a creation date.");
+	// Stores a complete value in the enclosing array, object or Metadata
+	bool value_(Metadata::Value&& value)
+	{
+		if(!values_.empty()) {
+			auto& parent = *values_.back();
+			if(auto array = boost::get<Metadata::Array>(&parent)) {
+				array->push_back(std::move(value));
+			} else {
+				boost::get<Metadata::Object>(parent).emplace(keys_.back(), std::move(value));
+			}
+		} else if(state_ == State::ROOT) {
+			database_.metadata().add(key_, std::move(value));
+		} else if(state_ == State::CATEGORY) {
+			category_->metadata().add(key_, std::move(value));
+		}
+
+		// Unknown fields of the editor are dropped
+		return true;
 	}
 
-	if(!document.HasMember("sourceUrl")) {
-		throw IOError("Database does not have a source url.");
+	bool push_(Metadata::Value&& value)
+	{
+		values_.push_back(std::move(value));
+		keys_.emplace_back();
+		return true;
 	}
 
-	if(!document.HasMember("identifier")) {
-		throw IOError("Database does not have a identifier.");
+	bool pop_()
+	{
+		Metadata::Value value(std::move(values_.back()));
+		values_.pop_back();
+		keys_.pop_back();
+		return value_(std::move(value));
 	}
 
-	for(auto it = document.MemberBegin(); it != document.MemberEnd(); ++it) {
-		const auto* name = it->name.GetString();
+	void startCategory_()
+	{
+		category_ = &database_.addCategory();
+		fields_ = 0;
+		state_ = State::CATEGORY;
+	}
+
+	void endCategory_()
+	{
+		if(!(fields_ & MEMBERS)) {
+			throw IOError("Category does not have a member array.");
+		}
 
-		if(std::strcmp(name, "name") == 0) {
-			database.setName(getString(it->value, "name"));
-		} else if(std::strcmp(name, "editor") == 0) {
-			database.editor().name = getString(it->value["name"], "editor.name");
-			database.editor().email = getString(it->value["email"], "editor.email");
-		} else if(std::strcmp(name, "creationDate") == 0) {
-			database.setCreationDate(getString(it->value, "creationDate"));
-		} else if(std::strcmp(name, "sourceUrl") == 0) {
-			database.setSourceUrl(getString(it->value, "sourceUrl"));
-		} else if(std::strcmp(name, "identifier") == 0) {
-			database.setIdentifier(getString(it->value, "identifier"));
-		} else if(std::strcmp(name, "categories") != 0) {
-			database.metadata().add(name, toMetadata(it->value));
+		if(!(fields_ & NAME)) {
+			throw IOError("Found category without name.");
 		}
+
+		if(!(fields_ & REFERENCE)) {
+			throw IOError("Found category without reference.");
+		}
+
+		++num_categories_;
+		state_ = State::CATEGORIES;
 	}
-}
 
-static void buildDatabase(const rapidjson::Document& document,
-                          CategoryDatabase& database)
-{
-	if(!document.HasMember("categories") || !document["categories"].IsArray()) {
-		throw IOError("Provided category database does not contain a list of "
-		              "categories.");
+	void endDatabase_()
+	{
+		const unsigned fields = database_fields_;
+
+		if(!(fields & CATEGORIES)) {
+			throw IOError("Provided category database does not contain a list of "
+			              "categories.");
+		}
+
+		if(!(fields & NAME)) {
+			throw IOError("Database does not have a name.");
+		}
+
+		if(!(fields & EDITOR)) {
+			throw IOError("Database does not have an editor.");
+		}
+
+		if(!(fields & CREATION_DATE)) {
+			throw IOError("Database does not have a creation date.");
+		}
+
+		if(!(fields & SOURCE_URL)) {
+			throw IOError("Database does not have a source url.");
+		}
+
+		if(!(fields & IDENTIFIER)) {
+			throw IOError("Database does not have a identifier.");
+		}
+
+		state_ = State::DONE;
 	}
 
-	readDatabaseFields(document, database);
-	readCategories(document["categories"], database);
-}
+	CategoryDatabase& database_;
+	EntityDatabase& entities_;
+
+	State state_;
+	std::string key_;
+
+	Category* category_;
+	size_t num_categories_;
+	std::vector<size_t> members_;
+	std::string member_;
+
+	unsigned fields_;
+	unsigned database_fields_;
+
+	// Partially read metadata arrays and objects
+	std::vector<Metadata::Value> values_;
+	std::vector<std::string> keys_;
+};
 
 static void writeString(Writer& writer, const std::string& key)
 {
@@ -347,8 +576,11 @@ static void writeCategory(Writer& writer, const Category& cat)
 	writer.EndObject();
 }
 
-static void writeDatabaseFields(Writer& writer, const CategoryDatabase& db)
+// Writes the fields of the database up to the opened list of categories
+static void writeDatabaseHeader(Writer& writer, const CategoryDatabase& db)
 {
+	writer.StartObject();
+
 	writer.Key("name", 4);
 	writeString(writer, db.name());
 
@@ -371,12 +603,49 @@ static void writeDatabaseFields(Writer& writer, const CategoryDatabase& db)
 
 	writer.Key("categories", 10);
 	writer.StartArray();
-	for(const auto& cat : db) {
-		writeCategory(writer, cat);
+}
+
+struct JsonCategoryWriter::Impl
+{
+	Impl(std::ostream& out, const Metadata& md)
+	    : stream(out), writer(stream), metadata(md), finished(false)
+	{
+	}
+
+	OStreamBuffer stream;
+	Writer writer;
+	Metadata metadata;
+	bool finished;
+};
+
+JsonCategoryWriter::JsonCategoryWriter(std::ostream& out,
+                                       const CategoryDatabase& header)
+    : impl_(new Impl(out, header.metadata()))
+{
+	writeDatabaseHeader(impl_->writer, header);
+}
+
+JsonCategoryWriter::~JsonCategoryWriter() { finish(); }
+
+void JsonCategoryWriter::write(const Category& cat)
+{
+	if(impl_->finished) {
+		throw IOError("Cannot write a category after finishing the database.");
+	}
+
+	writeCategory(impl_->writer, cat);
+}
+
+void JsonCategoryWriter::finish()
+{
+	if(impl_->finished) {
+		return;
 	}
-	writer.EndArray();
 
-	writeFreeFields(writer, db.metadata());
+	impl_->writer.EndArray();
+	writeFreeFields(impl_->writer, impl_->metadata);
+	impl_->writer.EndObject();
+	impl_->finished = true;
 }
 
 JsonCategoryFile::JsonCategoryFile(const std::shared_ptr<EntityDatabase>& db,
@@ -391,12 +660,11 @@ bool JsonCategoryFile::write(const CategoryDatabase& db)
 		throw IOError("The file object is not in a valid state to write.");
 	}
 
-	OStreamWrapper strm(*out_strm_);
-	Writer writer(strm);
-
-	writer.StartObject();
-	writeDatabaseFields(writer, db);
-	writer.EndObject();
+	JsonCategoryWriter writer(*out_strm_, db);
+	for(const auto& cat : db) {
+		writer.write(cat);
+	}
+	writer.finish();
 
 	return true;
 }
@@ -405,16 +673,18 @@ CategoryDatabase JsonCategoryFile::read()
 {
 	CategoryDatabase database(entity_database_);
 
-	rapidjson::Document document;
-	IStreamWrapper strm(*in_strm_);
-	document.ParseStream(strm);
+	std::vector<char> buffer = readAll(*in_strm_);
+	database.reserve(countCategories(buffer.data()));
 
-	if(document.GetParseError() != rapidjson::kParseErrorNone) {
+	CategoryDatabaseHandler handler(database);
+	rapidjson::InsituStringStream strm(buffer.data());
+	rapidjson::Reader reader;
+	reader.Parse<rapidjson::kParseInsituFlag>(strm, handler);
+
+	if(reader.HasParseError() || !handler.finished()) {
 		throw IOError("Invalid Json file!");
 	}
 
-	buildDatabase(document, database);
-
 	return database;
 }
 }
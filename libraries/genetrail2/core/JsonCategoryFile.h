@@ -26,11 +26,47 @@
 #include "macros.h"
 
 #include <memory>
+#include <ostream>
 #include <string>
 
 namespace GeneTrail
 {
 
+/**
+ * Writes a category database in the JSON format one category at a time.
+ * This allows to write large databases while they are created, without
+ * keeping all categories in memory.
+ */
+class GT2_EXPORT JsonCategoryWriter
+{
+  public:
+	/**
+	 * Writes the name, editor, etc. of header. The categories of header
+	 * are not written, its metadata is written by finish().
+	 */
+	JsonCategoryWriter(std::ostream& out, const CategoryDatabase& header);
+
+	/// Calls finish()
+	~JsonCategoryWriter();
+
+	JsonCategoryWriter(const JsonCategoryWriter&) = delete;
+	JsonCategoryWriter& operator=(const JsonCategoryWriter&) = delete;
+
+	/**
+	 * Appends a category to the database.
+	 *
+	 * @throws IOError if finish() has already been called.
+	 */
+	void write(const Category& cat);
+
+	/// Closes the database. Subsequent calls have no effect.
+	void finish();
+
+  private:
+	struct Impl;
+	std::unique_ptr<Impl> impl_;
+};
+
 class GT2_EXPORT JsonCategoryFile : public CategoryDatabaseFile
 {
   public:
@@ -58,7 +94,10 @@ class GT2_EXPORT JsonCategoryFile : public CategoryDatabaseFile
 	/// Get the used EntityDatabase
 	const std::shared_ptr<EntityDatabase>& getEntityDatabase() const;
 
-	/// Read a CategoryDatabase
+	/**
+	 * Read a CategoryDatabase. The file is read in one go and parsed in
+	 * place, adding the categories while parsing.
+	 */
 	CategoryDatabase read() override;
 	/// Write a CategoryDatabase to file
 	bool write(const CategoryDatabase& cat) override;
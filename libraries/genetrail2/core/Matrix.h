@@ -135,12 +135,16 @@ namespace GeneTrail
 			/**
 			 * Return true if the matrix contains a row with row name
 			 * "name". False otherwise.
+			 *
+			 * Empty names mark unnamed rows and are never found.
 			 */
 			virtual bool hasRow(const std::string& name) const = 0;
 
 			/**
 			 * Return true if the matrix contains a column with column name
 			 * "name". False otherwise.
+			 *
+			 * Empty names mark unnamed columns and are never found.
 			 */
 			virtual bool hasCol(const std::string& name) const = 0;
 
@@ -26,7 +26,7 @@
 
 using namespace GeneTrail;
 
-std::vector<unsigned int> MatrixTools::getIndices(const DenseMatrix& matrix, const std::vector<std::string>& colnames, const std::string& groupname)
+std::vector<unsigned int> MatrixTools::getIndices(const Matrix& matrix, const std::vector<std::string>& colnames, const std::string& groupname)
 {
 	std::vector<unsigned int> indices;
 	indices.reserve(colnames.size());
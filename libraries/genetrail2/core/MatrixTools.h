@@ -47,7 +47,7 @@ namespace GeneTrail{
 	public:
 		MatrixTools() = default;
 		
-		std::vector<unsigned int> getIndices(const DenseMatrix& matrix, const std::vector<std::string>& colnames,
+		std::vector<unsigned int> getIndices(const Matrix& matrix, const std::vector<std::string>& colnames,
 											 const std::string& groupname);
 
 		std::tuple<DenseColumnSubset, DenseColumnSubset> splitMatrix(DenseMatrix& matrix,
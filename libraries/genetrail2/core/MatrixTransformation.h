@@ -22,20 +22,60 @@
 #ifndef GT2_MATRIX_TRANSFORMATION_H
 #define GT2_MATRIX_TRANSFORMATION_H
 
+#include <algorithm>
 #include <numeric> 
 #include <cmath>
+#include <vector>
 
 #include "macros.h"
+#include "DenseMatrix.h"
 #include "Matrix.h"
 #include "Statistic.h"
 #include "MatrixIterator.h"
+#include "misc_algorithms.h"
 
 namespace GeneTrail
 {	
 	  
+	namespace internal
+	{
+		/**
+		 * Computes the ranks of n values that are accessed via get(i).
+		 * Ranks start with 1 for the largest value, tied values receive
+		 * the average of their ranks. order is used as scratch space.
+		 */
+		template <typename Get, typename Set>
+		void columnRanks(size_t n, Get get, Set set, std::vector<size_t>& order)
+		{
+			order.resize(n);
+			std::iota(order.begin(), order.end(), 0);
+			std::sort(order.begin(), order.end(),
+			          [&](size_t a, size_t b) { return get(a) > get(b); });
+
+			size_t i = 0;
+			while(i < n) {
+				size_t j = i + 1;
+				while(j < n && get(order[j]) == get(order[i])) {
+					++j;
+				}
+
+				const double rank = (i + 1 + j) * 0.5;
+				for(size_t l = i; l < j; ++l) {
+					set(order[l], rank);
+				}
+
+				i = j;
+			}
+		}
+
+		// Number of entries of a DenseMatrix that are transformed by one task
+		const size_t TRANSFORM_BLOCK_SIZE = 1 << 16;
+	}
+
 	/**
 	 * This function transforms values in a matrix to ranks for each column.
-	 * Ranks start with 1 for the largest value in the column.
+	 * Ranks start with 1 for the largest value in the column. Tied values
+	 * receive the average of their ranks.
 	 *
 	 * @param matrix The Matrix whose values should be transformed into ranks.
 	 * 
@@ -43,17 +83,44 @@ namespace GeneTrail
 	  template <typename Matrix>
 	  void valuesToRanks(Matrix& in_matrix) {
 
+	     std::vector<size_t> order;
 	     for(size_t c=0; c<in_matrix.cols(); ++c) {
-	      std::vector<size_t> rankVec(in_matrix.rows(),0);
- 	      std::iota(rankVec.begin(), rankVec.end(), 0);
-	      std::sort(rankVec.begin(), rankVec.end(),
-  	     [&](const size_t a,const size_t b)-> bool {return in_matrix(a,c) > in_matrix(b,c);});
-	      for(size_t v=0; v<rankVec.size(); ++v) {
-		in_matrix.set(rankVec[v],c,v+1);
+	      // The ranks can only be written once all values of the
+	      // column are known.
+	      std::vector<double> values(in_matrix.rows());
+	      for(size_t r=0; r<values.size(); ++r) {
+		values[r] = in_matrix(r,c);
 	      }
+	      internal::columnRanks(values.size(),
+		[&](size_t r) { return values[r]; },
+		[&](size_t r, double rank) { in_matrix.set(r,c,rank); },
+		order);
 	     }
 	     return;
 	  }
+
+	/**
+	 * Overload for DenseMatrix. The columns are ranked in parallel on
+	 * the underlying column-major storage.
+	 *
+	 * @param matrix The DenseMatrix whose values should be transformed into ranks.
+	 * @param num_threads Number of threads. 0 uses all available cores.
+	 */
+	  inline void valuesToRanks(DenseMatrix& in_matrix, unsigned int num_threads = 0) {
+	    auto& m = in_matrix.matrix();
+	    const size_t rows = m.rows();
+
+	    parallel_for(DenseMatrix::index_type(0), in_matrix.cols(), [&](DenseMatrix::index_type c) {
+	      std::vector<double> values(m.col(c).data(), m.col(c).data() + rows);
+	      std::vector<size_t> order;
+	      double* out = m.col(c).data();
+
+	      internal::columnRanks(rows,
+		[&](size_t r) { return values[r]; },
+		[out](size_t r, double rank) { out[r] = rank; },
+		order);
+	    }, num_threads);
+	  }
 	  
 	/**
 	 * This function applies a function to each value of the Matrix
@@ -71,6 +138,30 @@ namespace GeneTrail
 		}
 	      }
 	  }
+
+	/**
+	 * Overload for DenseMatrix that applies the function to the
+	 * contiguous storage of the matrix. Large matrices are processed
+	 * in parallel blocks, so f is called concurrently from several
+	 * threads and must be thread-safe.
+	 *
+	 * @param matrix The DenseMatrix to which the function should be applied.
+	 * @param f The function that should be applied.
+	 */
+	  template <typename Func>
+	  void transformMatrix(DenseMatrix& matrix, Func f){
+	    double* data = matrix.matrix().data();
+	    const size_t size = matrix.matrix().size();
+	    const size_t blocks = (size + internal::TRANSFORM_BLOCK_SIZE - 1) / internal::TRANSFORM_BLOCK_SIZE;
+
+	    parallel_for(size_t(0), blocks, [&](size_t b) {
+	      const size_t first = b * internal::TRANSFORM_BLOCK_SIZE;
+	      const size_t last = std::min(size, first + internal::TRANSFORM_BLOCK_SIZE);
+	      for(size_t i = first; i < last; ++i) {
+		data[i] = f(data[i]);
+	      }
+	    });
+	  }
 	  
  
 	/**
@@ -180,9 +271,63 @@ namespace GeneTrail
 	void pow2(Matrix& matrix) {
 	  pow(matrix,2);
 	}
-  
-  
-  
+
+	/**
+	 * Overload of upweightEnds for DenseMatrix that uses a vectorized
+	 * Eigen array expression.
+	 *
+	 * @param matrix The DenseMatrix to which the function should be applied.
+	 */
+	inline void upweightEnds(DenseMatrix& matrix) {
+	  const double center = (matrix.rows()/2) + 0.5;
+	  auto a = matrix.matrix().array();
+	  a = (center - a).abs();
+	}
+
+	/**
+	 * Overload of upweightTail for DenseMatrix that uses a vectorized
+	 * Eigen array expression.
+	 *
+	 * @param matrix The DenseMatrix to which the function should be applied.
+	 */
+	inline void upweightTail(DenseMatrix& matrix) {
+	  const double center = (matrix.rows()/2) + 0.5;
+	  auto a = matrix.matrix().array();
+	  a = center - a;
+	}
+
+	/**
+	 * Overload of abs for DenseMatrix that uses a vectorized Eigen array
+	 * expression.
+	 *
+	 * @param matrix The DenseMatrix to which the function should be applied.
+	 */
+	inline void abs(DenseMatrix& matrix) {
+	  auto a = matrix.matrix().array();
+	  a = a.abs();
+	}
+
+	/**
+	 * Overload of sqrt for DenseMatrix that uses a vectorized Eigen array
+	 * expression.
+	 *
+	 * @param matrix The DenseMatrix to which the function should be applied.
+	 */
+	inline void sqrt(DenseMatrix& matrix) {
+	  auto a = matrix.matrix().array();
+	  a = a.sqrt();
+	}
+
+	/**
+	 * Overload of pow2 for DenseMatrix that squares all values with a
+	 * vectorized Eigen array expression.
+	 *
+	 * @param matrix The DenseMatrix to which the function should be applied.
+	 */
+	inline void pow2(DenseMatrix& matrix) {
+	  auto a = matrix.matrix().array();
+	  a = a.square();
+	}
 }
 
 #endif //GT2_MATRIX_TRANSFORMATION_H
\ No newline at end of file
@@ -39,6 +39,20 @@ namespace GeneTrail
 		return total;
 	}
 
+	uint64_t MatrixWriter::writeBinary_(std::ostream& output, const std::vector<std::string>& rowNames, const std::vector<std::string>& colNames) const
+	{
+		output.write("BINARYMATRIX", 12);
+
+		uint64_t total = 12;
+		total += writeHeader_(output, rowNames.size(), colNames.size());
+		total += writeChunkHeader_(output, 0x1, 0x0);
+		total += writeNames_(output, rowNames);
+		total += writeChunkHeader_(output, 0x2, 0x0);
+		total += writeNames_(output, colNames);
+
+		return total;
+	}
+
 	void MatrixWriter::writeText_(std::ostream& output, const Matrix& matrix) const
 	{
 		if(matrix.cols() == 0) {
@@ -85,12 +99,15 @@ namespace GeneTrail
 	}
 
 	uint64_t MatrixWriter::writeHeader_(std::ostream& output, const Matrix& matrix) const
+	{
+		return writeHeader_(output, matrix.rows(), matrix.cols());
+	}
+
+	uint64_t MatrixWriter::writeHeader_(std::ostream& output, uint32_t row_count, uint32_t col_count) const
 	{
 		uint64_t total = 0;
 
 		total += writeChunkHeader_(output, 0x0, 0x9);
-		uint32_t row_count = matrix.rows();
-		uint32_t col_count = matrix.cols();
 		uint8_t storage_order = 0x1;
 
 		output.write((char*)&row_count, 4);
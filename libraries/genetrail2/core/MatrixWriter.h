@@ -23,7 +23,9 @@
 
 #include "macros.h"
 
+#include <cstdint>
 #include <ostream>
+#include <string>
 #include <vector>
 
 namespace GeneTrail
@@ -35,9 +37,11 @@ namespace GeneTrail
 		protected:
 			void     writeText_       (std::ostream& output, const Matrix& matrix) const;
 			uint64_t writeBinary_     (std::ostream& output, const Matrix& matrix) const;
+			uint64_t writeBinary_     (std::ostream& output, const std::vector<std::string>& rowNames, const std::vector<std::string>& colNames) const;
 			uint64_t writeChunkHeader_(std::ostream& output, uint8_t type, uint64_t size) const;
 			uint64_t writeNames_      (std::ostream& output, const std::vector<std::string>& names) const;
 			uint64_t writeHeader_     (std::ostream& output, const Matrix& matrix) const;
+			uint64_t writeHeader_     (std::ostream& output, uint32_t rows, uint32_t cols) const;
 			uint64_t writeRowNames_   (std::ostream& output, const Matrix& matrix) const;
 			uint64_t writeColNames_   (std::ostream& output, const Matrix& matrix) const;
 	};
@@ -0,0 +1,196 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "NAHandler.h"
+
+#include <limits>
+#include <numeric>
+
+namespace GeneTrail
+{
+	NAMask::NAMask(const DenseMatrix::DMatrix& m)
+	    : offsets_(m.rows() + 1, 0)
+	{
+		const size_t rows = m.rows();
+		const size_t cols = m.cols();
+		const double* data = m.data();
+
+		// Collect the NaNs in storage order. As the matrix is stored
+		// column-major, the columns of each row are increasing.
+		std::vector<std::pair<unsigned int, unsigned int>> nans;
+		for(size_t c = 0; c < cols; ++c) {
+			const double* col = data + c * rows;
+			for(size_t r = 0; r < rows; ++r) {
+				if(std::isnan(col[r])) {
+					nans.emplace_back(r, c);
+					++offsets_[r + 1];
+				}
+			}
+		}
+
+		std::partial_sum(offsets_.begin(), offsets_.end(), offsets_.begin());
+
+		cols_.resize(nans.size());
+		std::vector<size_t> pos(offsets_.begin(), offsets_.end() - 1);
+		for(const auto& p : nans) {
+			cols_[pos[p.first]++] = p.second;
+		}
+
+		for(size_t r = 0; r < rows; ++r) {
+			if(count(r) > 0) {
+				rows_.push_back(r);
+			}
+		}
+	}
+
+	PairwiseCompleteKernel::PairwiseCompleteKernel(const DMatrix& m)
+	{
+		const auto nan = m.array().isNaN();
+		values_ = nan.select(0.0, m.array()).matrix();
+		squares_ = values_.array().square().matrix();
+		mask_ = (!nan).cast<double>().matrix();
+	}
+
+	void PairwiseCompleteKernel::distances(const std::vector<unsigned int>& query,
+	                                       NAStrategyKNN::Metric metric,
+	                                       DMatrix& result, unsigned int tile) const
+	{
+		const Eigen::Index q = query.size();
+		const Eigen::Index n = rows();
+		const Eigen::Index cols = values_.cols();
+		const double inf = std::numeric_limits<double>::infinity();
+
+		DMatrix qv(q, cols), qs(q, cols), qm(q, cols);
+		for(Eigen::Index i = 0; i < q; ++i) {
+			qv.row(i) = values_.row(query[i]);
+			qs.row(i) = squares_.row(query[i]);
+			qm.row(i) = mask_.row(query[i]);
+		}
+
+		result.resize(q, n);
+
+		tile = std::max(tile, 1u);
+		for(Eigen::Index t = 0; t < n; t += tile) {
+			const Eigen::Index m = std::min<Eigen::Index>(tile, n - t);
+			const auto rv = values_.middleRows(t, m);
+			const auto rs = squares_.middleRows(t, m);
+			const auto rm = mask_.middleRows(t, m);
+
+			// Sums over the commonly observed columns
+			const DMatrix common = qm * rm.transpose();
+			const DMatrix sxy = qv * rv.transpose();
+			const DMatrix sxx = qs * rm.transpose();
+			const DMatrix syy = qm * rs.transpose();
+
+			const auto nc = common.array();
+			auto out = result.middleCols(t, m).array();
+
+			if(metric == NAStrategyKNN::Metric::Euclidean) {
+				const auto ssd = (sxx + syy - 2.0 * sxy).array().max(0.0);
+				out = (nc > 0.0).select(ssd / nc, inf);
+			} else {
+				const DMatrix sx = qv * rm.transpose();
+				const DMatrix sy = qm * rv.transpose();
+
+				const auto cov = nc * sxy.array() - sx.array() * sy.array();
+				const auto var = (nc * sxx.array() - sx.array().square()) *
+				                 (nc * syy.array() - sy.array().square());
+				out = (nc > 1.0 && var > 0.0).select(1.0 - cov / var.sqrt(), inf);
+			}
+		}
+	}
+
+	void NAHandler::handle(DenseMatrix& input, const NAStrategyKNN& strategy)
+	{
+		auto& m = input.matrix();
+
+		NAMask mask(m);
+		if(mask.empty()) {
+			return;
+		}
+
+		// The kernel keeps a copy of the original values, so imputed
+		// values are never used for imputing other rows.
+		PairwiseCompleteKernel kernel(m);
+
+		const auto& rows = mask.rows();
+		const size_t n = kernel.rows();
+		const size_t block_size = 64;
+		const size_t num_blocks = (rows.size() + block_size - 1) / block_size;
+
+		parallel_for(size_t(0), num_blocks, [&](size_t b) {
+			const auto first = rows.begin() + b * block_size;
+			const auto last = rows.begin() + std::min(rows.size(), (b + 1) * block_size);
+			const std::vector<unsigned int> query(first, last);
+
+			DenseMatrix::DMatrix dist;
+			kernel.distances(query, strategy.metric, dist);
+
+			std::vector<unsigned int> order;
+			order.reserve(n);
+
+			for(size_t i = 0; i < query.size(); ++i) {
+				const unsigned int r = query[i];
+
+				order.clear();
+				for(unsigned int j = 0; j < n; ++j) {
+					if(j != r && std::isfinite(dist(i, j))) {
+						order.push_back(j);
+					}
+				}
+
+				const auto closer = [&](unsigned int a, unsigned int c) {
+					return dist(i, a) < dist(i, c) || (dist(i, a) == dist(i, c) && a < c);
+				};
+
+				// Neighbours are only ordered as far as they are needed.
+				// The front of order is sorted, the rest is not closer.
+				size_t sorted = 0;
+
+				for(auto it = mask.begin(r); it != mask.end(r); ++it) {
+					double sum = 0.0;
+					unsigned int count = 0;
+					for(size_t pos = 0; pos < order.size() && count < strategy.k; ++pos) {
+						if(pos == sorted) {
+							sorted = std::min(order.size(), std::max<size_t>(2 * sorted, 2 * strategy.k));
+							std::partial_sort(order.begin() + pos, order.begin() + sorted, order.end(), closer);
+						}
+
+						const unsigned int j = order[pos];
+						if(kernel.observed(j, *it)) {
+							sum += kernel.value(j, *it);
+							++count;
+						}
+					}
+
+					// Fall back to the row mean
+					if(count == 0) {
+						for(unsigned int c = 0; c < m.cols(); ++c) {
+							if(kernel.observed(r, c)) {
+								sum += kernel.value(r, c);
+								++count;
+							}
+						}
+					}
+
+					m(r, *it) = sum / count;
+				}
+			}
+		}, num_threads_);
+	}
+}
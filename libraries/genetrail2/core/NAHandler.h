@@ -21,9 +21,13 @@
 #define GT2_CORE_NA_HANDLER_H
 
 #include "DenseMatrix.h"
+#include "misc_algorithms.h"
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <set>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
@@ -31,6 +35,44 @@
 
 namespace GeneTrail{
 
+/**
+ * The positions of the NaNs in a DenseMatrix.
+ *
+ * The mask is built with a single scan over the column-major storage of
+ * the matrix. For every row it stores the (increasing) columns that
+ * contain a NaN.
+ */
+class GT2_EXPORT NAMask{
+	public:
+	explicit NAMask(const DenseMatrix::DMatrix& m);
+
+	/// The number of NaNs in the matrix.
+	size_t size() const { return cols_.size(); }
+	bool empty() const { return cols_.empty(); }
+
+	/// The number of NaNs in row r.
+	unsigned int count(unsigned int r) const { return offsets_[r + 1] - offsets_[r]; }
+
+	/// The columns of row r that contain a NaN.
+	const unsigned int* begin(unsigned int r) const { return cols_.data() + offsets_[r]; }
+	const unsigned int* end(unsigned int r) const { return cols_.data() + offsets_[r + 1]; }
+
+	/// The rows containing at least one NaN in increasing order.
+	const std::vector<unsigned int>& rows() const { return rows_; }
+
+	private:
+	std::vector<size_t> offsets_;
+	std::vector<unsigned int> cols_;
+	std::vector<unsigned int> rows_;
+};
+
+/*
+ * Every strategy provides two entry points. handle(m, r) works on any
+ * Matrix using element access. handleRow(m, r, mask, buffer) is used by
+ * NAHandler for DenseMatrix objects. It is only called for rows that
+ * contain NaNs and may use buffer as scratch space.
+ */
+
 struct GT2_EXPORT NAStrategyZero{
 	template <typename Matrix> bool handle(Matrix& m, unsigned int r) const{
 		using T = typename std::remove_reference<decltype (m(0,0))>::type;
@@ -39,6 +81,13 @@ struct GT2_EXPORT NAStrategyZero{
 		}
 		return true;
 	}
+
+	bool handleRow(DenseMatrix::DMatrix& m, unsigned int r, const NAMask& mask, std::vector<double>&) const{
+		for(auto it = mask.begin(r); it != mask.end(r); ++it){
+			m(r, *it) = 0.0;
+		}
+		return true;
+	}
 };
 
 struct GT2_EXPORT NAStrategyMean{
@@ -60,6 +109,20 @@ struct GT2_EXPORT NAStrategyMean{
 		}
 		return true;
 	}
+
+	bool handleRow(DenseMatrix::DMatrix& m, unsigned int r, const NAMask& mask, std::vector<double>&) const{
+		double mean = 0.0;
+		const unsigned int c = m.cols();
+		for(unsigned int i=0; i < c; i++){
+			if(!std::isnan(m(r,i))) mean += m(r,i);
+		}
+		mean /= c - mask.count(r);
+
+		for(auto it = mask.begin(r); it != mask.end(r); ++it){
+			m(r, *it) = mean;
+		}
+		return true;
+	}
 };
 
 struct GT2_EXPORT NAStrategyMedian{
@@ -82,6 +145,29 @@ struct GT2_EXPORT NAStrategyMedian{
 		}
 		return true;
 	}
+
+	bool handleRow(DenseMatrix::DMatrix& m, unsigned int r, const NAMask& mask, std::vector<double>& buffer) const{
+		buffer.clear();
+		for(unsigned int i=0; i < m.cols(); i++){
+			if(!std::isnan(m(r,i))) buffer.push_back(m(r,i));
+		}
+
+		// Rows consisting of NaNs only are left untouched
+		if(buffer.empty()) return true;
+
+		const size_t size = buffer.size();
+		auto mid = buffer.begin() + size/2;
+		std::nth_element(buffer.begin(), mid, buffer.end());
+		double median = *mid;
+		if(size % 2 == 0){
+			median = (*std::max_element(buffer.begin(), mid) + median) / 2.0;
+		}
+
+		for(auto it = mask.begin(r); it != mask.end(r); ++it){
+			m(r, *it) = median;
+		}
+		return true;
+	}
 };
 
 struct GT2_EXPORT NAStrategyRemove{
@@ -91,9 +177,93 @@ struct GT2_EXPORT NAStrategyRemove{
 		}
 		return true;
 	}
+
+	bool handleRow(DenseMatrix::DMatrix&, unsigned int r, const NAMask& mask, std::vector<double>&) const{
+		return mask.count(r) == 0;
+	}
 };
 
-struct GT2_EXPORT NAHandler{
+/**
+ * Imputes the NaNs of a row using its k nearest neighbours.
+ *
+ * The distance of two rows is the mean squared difference over the
+ * columns observed in both rows, as in the impute.knn method of the R
+ * package impute. Alternatively, rows can be compared via their Pearson
+ * correlation on the commonly observed columns. A missing value is
+ * replaced by the mean of the k nearest rows that contain a value for
+ * the respective column. If no such row exists, the row mean is used.
+ *
+ * This strategy is only available for DenseMatrix objects.
+ */
+struct GT2_EXPORT NAStrategyKNN{
+	enum class Metric { Euclidean, Correlation };
+
+	/**
+	 * @throws std::invalid_argument if k is zero.
+	 */
+	explicit NAStrategyKNN(unsigned int k = 10, Metric metric = Metric::Euclidean)
+		: k(k), metric(metric)
+	{
+		if(k == 0) {
+			throw std::invalid_argument("The number of neighbours must be positive.");
+		}
+	}
+
+	unsigned int k;
+	Metric metric;
+};
+
+/**
+ * Computes the statistics of pairs of rows on the columns that are
+ * observed in both rows.
+ *
+ * The statistics of all pairs of a block of query rows and a block of
+ * reference rows are obtained from matrix products of the zero-filled
+ * data, the squared data, and the observation mask. From these the
+ * mean squared difference and the Pearson correlation of the rows are
+ * derived.
+ */
+class GT2_EXPORT PairwiseCompleteKernel{
+	public:
+	using DMatrix = DenseMatrix::DMatrix;
+
+	explicit PairwiseCompleteKernel(const DMatrix& m);
+
+	size_t rows() const { return values_.rows(); }
+
+	/// Returns true if entry (r, c) of the original matrix is not NaN.
+	bool observed(unsigned int r, unsigned int c) const { return mask_(r, c) != 0.0; }
+
+	/// The entry (r, c) of the original matrix. NaNs are replaced by 0.
+	double value(unsigned int r, unsigned int c) const { return values_(r, c); }
+
+	/**
+	 * Computes the distance (smaller is closer) of the query rows to all
+	 * rows of the matrix. The result is stored in a query.size() x rows()
+	 * matrix. Pairs without common observations receive an infinite
+	 * distance.
+	 *
+	 * @param tile Number of reference rows processed at once.
+	 */
+	void distances(const std::vector<unsigned int>& query, NAStrategyKNN::Metric metric, DMatrix& result, unsigned int tile = 2048) const;
+
+	private:
+	// Zero-filled values, their squares, and the observation mask
+	DMatrix values_;
+	DMatrix squares_;
+	DMatrix mask_;
+};
+
+class GT2_EXPORT NAHandler{
+	public:
+	NAHandler() : num_threads_(0) {}
+
+	/**
+	 * Sets the number of threads used for DenseMatrix objects.
+	 * 0 uses all available cores.
+	 */
+	void setNumberOfThreads(unsigned int num_threads) { num_threads_ = num_threads; }
+
 	/**
 	 * Removes NAs in a file by applying the given removal
 	 * strategy.
@@ -109,6 +279,43 @@ struct GT2_EXPORT NAHandler{
 		if(!toBeRemoved.empty()) input.removeRows(toBeRemoved);
 	}
 
+	/**
+	 * Overload for DenseMatrix. The NaNs are located in a single pass
+	 * over the matrix and only the affected rows are processed, in
+	 * parallel.
+	 */
+	template <typename Strategy>
+	void handle(DenseMatrix& input, const Strategy& strategy){
+		NAMask mask(input.matrix());
+		if(mask.empty()) return;
+
+		const auto& rows = mask.rows();
+		std::vector<char> keep(rows.size());
+
+		const size_t block_size = 256;
+		const size_t num_blocks = (rows.size() + block_size - 1) / block_size;
+		parallel_for(size_t(0), num_blocks, [&](size_t b) {
+			std::vector<double> buffer;
+			const size_t last = std::min(rows.size(), (b + 1) * block_size);
+			for(size_t i = b * block_size; i < last; ++i){
+				keep[i] = strategy.handleRow(input.matrix(), rows[i], mask, buffer);
+			}
+		}, num_threads_);
+
+		std::vector<unsigned int> toBeRemoved;
+		for(size_t i = 0; i < rows.size(); ++i){
+			if(!keep[i]) toBeRemoved.push_back(rows[i]);
+		}
+		if(!toBeRemoved.empty()) input.removeRows(toBeRemoved);
+	}
+
+	/**
+	 * Imputes the NAs of a DenseMatrix using k-nearest-neighbours.
+	 */
+	void handle(DenseMatrix& input, const NAStrategyKNN& strategy);
+
+	private:
+	unsigned int num_threads_;
 };
 } // namespace GeneTrail
 
@@ -21,73 +21,163 @@
 #ifndef GT2_CORE_NAME_DATABASES_H
 #define GT2_CORE_NAME_DATABASES_H
 
-#include <boost/filesystem.hpp>
 #include <boost/lexical_cast.hpp>
-#include <boost/algorithm/string.hpp>
+#include <boost/utility/string_ref.hpp>
 
 #include "macros.h"
 
 #include "DenseMatrix.h"
+#include "Exception.h"
+#include "NameIndex.h"
 
-#include <string>
-#include <iostream>
+#include <algorithm>
 #include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
 
 namespace GeneTrail
 {
-	
+
+/**
+ * Splits line at runs of spaces, tabs and carriage returns. Leading and
+ * trailing whitespace is ignored. The first max_fields fields are stored in fields.
+ *
+ * @return The number of fields in line, which may exceed max_fields.
+ */
+inline size_t splitFields(boost::string_ref line, boost::string_ref* fields,
+                          size_t max_fields)
+{
+	const auto is_space = [](char c) { return c == ' ' || c == '\t' || c == '\r'; };
+
+	size_t n = 0;
+	auto it = line.begin();
+	while(true) {
+		it = std::find_if_not(it, line.end(), is_space);
+		if(it == line.end()) {
+			return n;
+		}
+
+		auto end = std::find_if(it, line.end(), is_space);
+		if(n < max_fields) {
+			fields[n] = boost::string_ref(it, end - it);
+		}
+
+		++n;
+		it = end;
+	}
+}
+
+/**
+ * Calls f(regulator, target, value) for every line of a regulation file.
+ * Lines without a value use default_value. The fields are split without
+ * allocating and passed in reused strings.
+ *
+ * @throws IOError if the file cannot be opened or a line does not have
+ *         two or three fields.
+ */
+template <typename ValueType, typename F>
+void forEachRegulation(const std::string& file, ValueType default_value, F f)
+{
+	std::ifstream input(file);
+	if(!input) {
+		throw GeneTrail::IOError("File (" + file + ") is not open for reading");
+	}
+
+	std::string regulator, target;
+	boost::string_ref fields[3];
+	for(std::string line; getline(input, line);) {
+		const size_t n = splitFields(line, fields, 3);
+		if(n != 2 && n != 3) {
+			throw GeneTrail::IOError("Wrong file format.");
+		}
+
+		regulator.assign(fields[0].data(), fields[0].size());
+		target.assign(fields[1].data(), fields[1].size());
+
+		if(n == 2) {
+			f(regulator, target, default_value);
+		} else {
+			f(regulator, target, boost::lexical_cast<ValueType>(
+			                         fields[2].data(), fields[2].size()));
+		}
+	}
+}
+
 struct GT2_EXPORT MatrixNameDatabase
 {
 	MatrixNameDatabase(DenseMatrix* matrix) : matrix_(matrix) {}
 
-	std::string operator()(size_t index) { return matrix_->rowNames()[index]; }
+	const std::string& operator()(size_t index) const { return matrix_->rowName(index); }
 
-	size_t operator()(std::string name) { return matrix_->rowIndex(name); }
+	size_t operator()(const std::string& name) const { return matrix_->rowIndex(name); }
 
-	size_t size() { return matrix_->rows(); }
+	size_t size() const { return matrix_->rows(); }
 
 	DenseMatrix* matrix_;
 };
-	
+
+/**
+ * Assigns consecutive indices to the regulators and targets of a
+ * regulation file. Names are interned in a hashed NameIndex, so that
+ * lookups neither copy the name nor the result.
+ */
 struct GT2_EXPORT MapNameDatabase
 {
 	MapNameDatabase() {}
 
-	MapNameDatabase(std::string file) { initialize(file); }
+	MapNameDatabase(const std::string& file) { initialize(file); }
 
-	std::string operator()(size_t index) { return index2name[index]; }
+	// Not const: a const overload would make calls with the literal 0 on
+	// a non-const database ambiguous, as 0 also converts to string_ref
+	const std::string& operator()(size_t index) { return names_[index]; }
 
-	size_t operator()(std::string name)
-	{
-		std::map<std::string, size_t>::iterator iter = name2index.find(name);
-		if(iter == name2index.end()) {
-			index2name.emplace_back(name);
-			name2index[name] = index2name.size() - 1;
-		}
-		return name2index[name];
-	}
+	/// Returns the index of name, adding it if it is unknown.
+	size_t operator()(boost::string_ref name) { return names_.insert(name); }
 
-	size_t size() { return index2name.size(); }
+	size_t size() const { return names_.size(); }
 
-	void initialize(std::string file)
+	/**
+	 * Adds the regulators and targets of the regulation file. The file is
+	 * read in one go and the index is reserved by its number of lines.
+	 */
+	void initialize(const std::string& file)
 	{
 		std::cout << "INFO: Initializing name database" << std::endl;
-		std::ifstream input(file);
+		std::ifstream input(file, std::ios::binary);
 		if(!input) {
 			throw GeneTrail::IOError("File (" + file +
 			                         ") is not open for reading");
 		}
 
-		std::vector<std::string> sline(2);
-		for(std::string line; getline(input, line);) {
-			boost::split(sline, line, boost::is_any_of(" \t"), boost::token_compress_on);
-			(*this)(sline[0]);
-			(*this)(sline[1]);
+		const std::string content((std::istreambuf_iterator<char>(input)),
+		                          std::istreambuf_iterator<char>());
+
+		// Regulation files mention the same few thousand names over
+		// and over, so the number of lines is only an upper bound.
+		const size_t lines = std::count(content.begin(), content.end(), '\n');
+		names_.reserve(names_.size() + std::min<size_t>(2 * lines + 2, 1 << 16));
+
+		boost::string_ref fields[2];
+		for(size_t pos = 0; pos < content.size();) {
+			size_t eol = content.find('\n', pos);
+			if(eol == std::string::npos) {
+				eol = content.size();
+			}
+
+			boost::string_ref line(content.data() + pos, eol - pos);
+			pos = eol + 1;
+
+			const size_t n = std::min<size_t>(splitFields(line, fields, 2), 2);
+			for(size_t i = 0; i < n; ++i) {
+				names_.insert(fields[i]);
+			}
 		}
 	}
 
-	std::map<std::string, size_t> name2index;
-	std::vector<std::string> index2name;
+	private:
+	NameIndex names_;
 };
 }
 
@@ -0,0 +1,423 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "NameIndex.h"
+
+#include <cassert>
+#include <algorithm>
+#include <utility>
+
+namespace GeneTrail
+{
+	const NameIndex::index_type NameIndex::NOT_FOUND =
+	    std::numeric_limits<NameIndex::index_type>::max();
+
+	// Initial number of slots of a non-empty index
+	static const size_t MIN_CAPACITY = 16;
+
+	NameIndex::NameIndex(size_t n)
+	{
+		if(n == 0) {
+			data_ = empty_();
+		} else {
+			data_ = std::make_shared<Data>();
+			data_->names.resize(n);
+		}
+	}
+
+	NameIndex::NameIndex(std::vector<std::string> names)
+	    : data_(std::make_shared<Data>())
+	{
+		data_->names = std::move(names);
+		rebuild_(*data_);
+	}
+
+	NameIndex::NameIndex(NameIndex&& other) : data_(std::move(other.data_))
+	{
+		other.data_ = empty_();
+	}
+
+	NameIndex& NameIndex::operator=(NameIndex&& other)
+	{
+		assert(this != &other);
+
+		data_ = std::move(other.data_);
+		other.data_ = empty_();
+
+		return *this;
+	}
+
+	std::shared_ptr<NameIndex::Data> NameIndex::empty_()
+	{
+		// Shared by all empty objects. As this pointer holds a reference,
+		// write_() never modifies the object in place.
+		static const std::shared_ptr<Data> empty = std::make_shared<Data>();
+		return empty;
+	}
+
+	uint32_t NameIndex::hash_(boost::string_ref name)
+	{
+		// FNV-1a, which can be computed on a string_ref directly
+		uint64_t h = 14695981039346656037ull;
+		for(char c : name) {
+			h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+		}
+
+		return static_cast<uint32_t>(h ^ (h >> 32));
+	}
+
+	NameIndex::Data& NameIndex::write_()
+	{
+		if(data_.use_count() != 1) {
+			data_ = std::make_shared<Data>(*data_);
+		}
+
+		return *data_;
+	}
+
+	NameIndex::index_type NameIndex::find(boost::string_ref name) const
+	{
+		const auto& slots = data_->slots;
+		if(slots.empty() || name.empty()) {
+			return NOT_FOUND;
+		}
+
+		const uint32_t h = hash_(name);
+		const size_t mask = slots.size() - 1;
+
+		for(size_t pos = h & mask;; pos = (pos + 1) & mask) {
+			const Slot& s = slots[pos];
+
+			if(s.index == NOT_FOUND) {
+				return NOT_FOUND;
+			}
+
+			if(s.hash == h && data_->names[s.index] == name) {
+				return s.index;
+			}
+		}
+	}
+
+	size_t NameIndex::findSlot_(const Data& data, index_type i) const
+	{
+		const auto& slots = data.slots;
+		if(slots.empty() || data.names[i].empty()) {
+			return slots.size();
+		}
+
+		const size_t mask = slots.size() - 1;
+		for(size_t pos = hash_(data.names[i]) & mask;; pos = (pos + 1) & mask) {
+			if(slots[pos].index == NOT_FOUND) {
+				return slots.size();
+			}
+
+			if(slots[pos].index == i) {
+				return pos;
+			}
+		}
+	}
+
+	void NameIndex::rebuild_(Data& data)
+	{
+		size_t capacity = MIN_CAPACITY;
+		while(capacity < 2 * data.names.size()) {
+			capacity *= 2;
+		}
+
+		data.slots.assign(capacity, Slot{NOT_FOUND, 0});
+		data.num_indexed = 0;
+		data.num_named = 0;
+
+		for(index_type i = 0; i < data.names.size(); ++i) {
+			if(!data.names[i].empty()) {
+				++data.num_named;
+			}
+
+			insert_(data, i);
+		}
+	}
+
+	bool NameIndex::insert_(Data& data, index_type i)
+	{
+		const std::string& name = data.names[i];
+		if(name.empty()) {
+			return false;
+		}
+
+		// Keep the load factor below 1/2
+		if(2 * (data.num_indexed + 1) > data.slots.size()) {
+			grow_(data, std::max(MIN_CAPACITY, 2 * data.slots.size()));
+		}
+
+		const uint32_t h = hash_(name);
+		const size_t mask = data.slots.size() - 1;
+
+		size_t pos = h & mask;
+		for(; data.slots[pos].index != NOT_FOUND; pos = (pos + 1) & mask) {
+			const Slot& s = data.slots[pos];
+			if(s.hash == h && data.names[s.index] == name) {
+				return false;
+			}
+		}
+
+		data.slots[pos] = Slot{i, h};
+		++data.num_indexed;
+
+		return true;
+	}
+
+	void NameIndex::grow_(Data& data, size_t capacity)
+	{
+		// The slots are moved based on their stored hash, so no string
+		// needs to be rehashed.
+		std::vector<Slot> old(capacity, Slot{NOT_FOUND, 0});
+		old.swap(data.slots);
+
+		const size_t mask = data.slots.size() - 1;
+		for(const Slot& s : old) {
+			if(s.index == NOT_FOUND) {
+				continue;
+			}
+
+			size_t pos = s.hash & mask;
+			while(data.slots[pos].index != NOT_FOUND) {
+				pos = (pos + 1) & mask;
+			}
+			data.slots[pos] = s;
+		}
+	}
+
+	void NameIndex::eraseSlot_(Data& data, size_t pos)
+	{
+		auto& slots = data.slots;
+		const size_t mask = slots.size() - 1;
+
+		// Backward shift deletion: move entries of the same probe
+		// sequence into the hole, so no tombstones are needed.
+		size_t hole = pos;
+		for(size_t j = (pos + 1) & mask; slots[j].index != NOT_FOUND; j = (j + 1) & mask) {
+			const size_t ideal = slots[j].hash & mask;
+
+			const bool in_between = hole <= j ? (hole < ideal && ideal <= j)
+			                                  : (hole < ideal || ideal <= j);
+
+			if(!in_between) {
+				slots[hole] = slots[j];
+				hole = j;
+			}
+		}
+
+		slots[hole] = Slot{NOT_FOUND, 0};
+		--data.num_indexed;
+	}
+
+	void NameIndex::assign(std::vector<std::string> names)
+	{
+		data_ = std::make_shared<Data>();
+		data_->names = std::move(names);
+		rebuild_(*data_);
+	}
+
+	void NameIndex::append(const std::vector<std::string>& names)
+	{
+		Data& data = write_();
+
+		data.names.reserve(data.names.size() + names.size());
+		for(const auto& name : names) {
+			data.names.push_back(name);
+			if(!name.empty()) {
+				++data.num_named;
+			}
+
+			insert_(data, data.names.size() - 1);
+		}
+	}
+
+	NameIndex::index_type NameIndex::insert(boost::string_ref name)
+	{
+		const index_type i = find(name);
+		if(i != NOT_FOUND) {
+			return i;
+		}
+
+		Data& data = write_();
+		data.names.emplace_back(name.data(), name.size());
+		if(!name.empty()) {
+			++data.num_named;
+		}
+
+		insert_(data, data.names.size() - 1);
+
+		return data.names.size() - 1;
+	}
+
+	void NameIndex::reserve(size_t n)
+	{
+		Data& data = write_();
+		data.names.reserve(n);
+
+		size_t capacity = MIN_CAPACITY;
+		while(capacity < 2 * n) {
+			capacity *= 2;
+		}
+
+		if(capacity > data.slots.size()) {
+			grow_(data, capacity);
+		}
+	}
+
+	void NameIndex::rename(index_type i, const std::string& new_name)
+	{
+		Data& data = write_();
+		assert(i < data.names.size());
+
+		rename_(data, i, new_name);
+
+		// The next occurrence of the old name has not been indexed yet
+		if(hasDuplicates_(data)) {
+			rebuild_(data);
+		}
+	}
+
+	void NameIndex::rename_(Data& data, index_type i, const std::string& new_name)
+	{
+		const size_t old = findSlot_(data, i);
+		if(old < data.slots.size()) {
+			eraseSlot_(data, old);
+		}
+
+		if(!data.names[i].empty()) {
+			--data.num_named;
+		}
+
+		if(!new_name.empty()) {
+			++data.num_named;
+		}
+
+		data.names[i] = new_name;
+
+		if(new_name.empty() || data.slots.empty()) {
+			insert_(data, i);
+			return;
+		}
+
+		// Steal the name from a possible previous assignment
+		const uint32_t h = hash_(new_name);
+		const size_t mask = data.slots.size() - 1;
+		for(size_t pos = h & mask; data.slots[pos].index != NOT_FOUND; pos = (pos + 1) & mask) {
+			Slot& s = data.slots[pos];
+			if(s.hash == h && s.index != i && data.names[s.index] == new_name) {
+				data.names[s.index] = "";
+				--data.num_named;
+				s.index = i;
+				return;
+			}
+		}
+
+		insert_(data, i);
+	}
+
+	void NameIndex::rename(const std::string& old_name, const std::string& new_name)
+	{
+		const index_type i = find(old_name);
+
+		if(i != NOT_FOUND) {
+			rename(i, new_name);
+		}
+	}
+
+	void NameIndex::remove(const std::vector<index_type>& indices)
+	{
+		if(indices.empty()) {
+			return;
+		}
+
+		Data& data = write_();
+
+		for(index_type i : indices) {
+			const size_t pos = findSlot_(data, i);
+			if(pos < data.slots.size()) {
+				eraseSlot_(data, pos);
+			}
+
+			if(!data.names[i].empty()) {
+				--data.num_named;
+			}
+		}
+
+		// Compact the names and remember where every entry moved to
+		std::vector<index_type> new_index(data.names.size(), NOT_FOUND);
+
+		size_t next = 0;
+		index_type write = 0;
+		for(index_type read = 0; read < data.names.size(); ++read) {
+			if(next < indices.size() && indices[next] == read) {
+				assert(next == 0 || indices[next - 1] < indices[next]);
+				++next;
+				continue;
+			}
+
+			if(write != read) {
+				data.names[write] = std::move(data.names[read]);
+			}
+
+			new_index[read] = write++;
+		}
+
+		data.names.resize(write);
+
+		// A removed first occurrence hands its name on to the next one
+		if(hasDuplicates_(data)) {
+			rebuild_(data);
+			return;
+		}
+
+		for(Slot& s : data.slots) {
+			if(s.index != NOT_FOUND) {
+				s.index = new_index[s.index];
+			}
+		}
+	}
+
+	void NameIndex::permute(const std::vector<index_type>& perm)
+	{
+		Data& data = write_();
+		assert(perm.size() == data.names.size());
+
+		std::vector<index_type> inverse(perm.size());
+		std::vector<std::string> names(perm.size());
+		for(index_type i = 0; i < perm.size(); ++i) {
+			inverse[perm[i]] = i;
+			names[i] = std::move(data.names[perm[i]]);
+		}
+
+		data.names.swap(names);
+
+		// Which occurrence of a duplicated name comes first may change
+		if(hasDuplicates_(data)) {
+			rebuild_(data);
+			return;
+		}
+
+		for(Slot& s : data.slots) {
+			if(s.index != NOT_FOUND) {
+				s.index = inverse[s.index];
+			}
+		}
+	}
+}
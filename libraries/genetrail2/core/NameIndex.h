@@ -0,0 +1,171 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_CORE_NAME_INDEX_H
+#define GT2_CORE_NAME_INDEX_H
+
+#include "macros.h"
+
+#include <boost/utility/string_ref.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace GeneTrail
+{
+	/**
+	 * An ordered list of names together with a hash index mapping each
+	 * name to its position.
+	 *
+	 * The index uses open addressing with linear probing. Every slot
+	 * stores the position of the name and a part of its hash, so most
+	 * unsuccessful probes do not need to compare strings.
+	 *
+	 * Copies of a NameIndex share their storage until one of them is
+	 * modified (copy-on-write). Copying a matrix thus does not copy the
+	 * names of its rows and columns. Reordering and removing entries
+	 * moves the strings and remaps the index without rehashing.
+	 *
+	 * If a name occurs more than once, lookups return its first
+	 * occurrence, also after renaming, removing or reordering entries.
+	 * As only the first occurrence is indexed, these operations rebuild
+	 * the index if duplicates exist. Empty names are not indexed.
+	 */
+	class GT2_EXPORT NameIndex
+	{
+		public:
+		using index_type = unsigned int;
+
+		static const index_type NOT_FOUND;
+
+		/// Creates n empty names.
+		explicit NameIndex(size_t n = 0);
+		explicit NameIndex(std::vector<std::string> names);
+
+		NameIndex(const NameIndex&) = default;
+		NameIndex(NameIndex&& other);
+
+		NameIndex& operator=(const NameIndex&) = default;
+		NameIndex& operator=(NameIndex&& other);
+
+		size_t size() const { return data_->names.size(); }
+
+		const std::vector<std::string>& names() const { return data_->names; }
+		const std::string& operator[](index_type i) const { return data_->names[i]; }
+
+		/**
+		 * Returns the position of name or NOT_FOUND. Looking up a part of
+		 * a larger buffer does not allocate.
+		 */
+		index_type find(boost::string_ref name) const;
+
+		bool contains(boost::string_ref name) const { return find(name) != NOT_FOUND; }
+
+		/**
+		 * Returns the position of name and appends it if it is not yet
+		 * contained. Empty names are appended every time.
+		 */
+		index_type insert(boost::string_ref name);
+
+		/**
+		 * Reserves memory and slots for n names.
+		 */
+		void reserve(size_t n);
+
+		/**
+		 * Replaces all names.
+		 */
+		void assign(std::vector<std::string> names);
+
+		/**
+		 * Appends names to the end of the list.
+		 */
+		void append(const std::vector<std::string>& names);
+
+		/**
+		 * Renames entry i. If new_name is already used by another entry,
+		 * the name of that entry is set to the empty string.
+		 */
+		void rename(index_type i, const std::string& new_name);
+
+		/**
+		 * Renames the entry called old_name. This is a noop if old_name
+		 * does not exist.
+		 */
+		void rename(const std::string& old_name, const std::string& new_name);
+
+		/**
+		 * Removes the entries at the given, strictly increasing,
+		 * positions.
+		 */
+		void remove(const std::vector<index_type>& indices);
+
+		/**
+		 * Reorders the entries such that entry i is the former entry
+		 * perm[i].
+		 */
+		void permute(const std::vector<index_type>& perm);
+
+		void swap(NameIndex& other) { data_.swap(other.data_); }
+
+		private:
+		struct Slot
+		{
+			index_type index;
+			uint32_t hash;
+		};
+
+		struct Data
+		{
+			std::vector<std::string> names;
+			std::vector<Slot> slots;
+			size_t num_indexed = 0;
+			// Number of non-empty names, which exceeds num_indexed if
+			// there are duplicates
+			size_t num_named = 0;
+		};
+
+		static std::shared_ptr<Data> empty_();
+		static bool hasDuplicates_(const Data& data)
+		{
+			return data.num_named > data.num_indexed;
+		}
+
+		static uint32_t hash_(boost::string_ref name);
+
+		// Returns storage that is not shared with other objects
+		Data& write_();
+
+		// Returns the slot holding position i or slots.size()
+		size_t findSlot_(const Data& data, index_type i) const;
+
+		void rename_(Data& data, index_type i, const std::string& new_name);
+
+		static void rebuild_(Data& data);
+		static void grow_(Data& data, size_t capacity);
+		static bool insert_(Data& data, index_type i);
+		static void eraseSlot_(Data& data, size_t pos);
+
+		std::shared_ptr<Data> data_;
+	};
+}
+
+#endif // GT2_CORE_NAME_INDEX_H
@@ -20,14 +20,18 @@
 
 #include "ORAGroupPreference.h"
 #include "Exception.h"
+#include "misc_algorithms.h"
 
 #include <iostream>
 #include <set>
 #include <vector>
 #include <algorithm>
+#include <cmath>
 
 using namespace GeneTrail;
 
+// Number of rows whose group counts are collected together
+static const size_t ROW_BLOCK_SIZE = 256;
 
 void ORAGroupPreference::calculatePreference(
 	const DenseMatrix& matrix,
@@ -36,32 +40,65 @@ void ORAGroupPreference::calculatePreference(
 ) const{
 	std::map<std::string, std::vector<unsigned int>> group_indices;
 	ORAGroupPreference::parseGroups(matrix, metadata, group_indices);
+
 	std::vector<std::string> groups;
-	for(const auto& entry: group_indices) groups.push_back(entry.first);
-	
-	result = DenseMatrix(matrix.rows(), group_indices.size());
+	std::vector<size_t> group_sizes;
+	std::vector<uint32_t> column_group(matrix.cols());
+	for(const auto& entry: group_indices){
+		for(const auto column_index: entry.second){
+			column_group[column_index] = groups.size();
+		}
+		groups.push_back(entry.first);
+		group_sizes.push_back(entry.second.size());
+	}
+
+	const size_t rows = matrix.rows();
+	const size_t cols = matrix.cols();
+	const size_t num_groups = groups.size();
+
+	result = DenseMatrix(rows, num_groups);
 	result.setColNames(groups);
 	result.setRowNames(matrix.rowNames());
-	
-	for(size_t row_index=0; row_index < matrix.rows(); ++row_index){
-		size_t idx_non_empty = -1;
-		for(const auto& current_entry: group_indices){
-			if(current_entry.second.empty()) continue;
-			idx_non_empty++;
-			std::vector<size_t> table(4, 0);
-			for(const auto& other_entry: group_indices){
-				for(const auto column_index: other_entry.second){
-					addToTable(table, matrix(row_index, column_index),
-							   current_entry.first == other_entry.first);
-				}
+
+	const auto& values = matrix.matrix();
+	auto& p_values = result.matrix();
+
+	const size_t num_blocks = (rows + ROW_BLOCK_SIZE - 1) / ROW_BLOCK_SIZE;
+	parallel_for(size_t(0), num_blocks, [&](size_t block){
+		const size_t first = block * ROW_BLOCK_SIZE;
+		const size_t last = std::min(rows, first + ROW_BLOCK_SIZE);
+		const size_t block_rows = last - first;
+
+		// Significant entries per (row, group), filled column by column
+		// to follow the column-major storage of the matrix.
+		std::vector<uint32_t> counts(block_rows * num_groups, 0);
+		for(size_t j = 0; j < cols; ++j){
+			const double* column = values.data() + j * rows + first;
+			uint32_t* count = counts.data() + column_group[j];
+			for(size_t i = 0; i < block_rows; ++i){
+				count[i * num_groups] += column[i] < threshold_;
 			}
-			result(row_index, idx_non_empty) = computePValue_(table);
 		}
-	}
+
+		std::vector<double> row_p_values(num_groups);
+		for(size_t i = 0; i < block_rows; ++i){
+			const uint32_t* k = counts.data() + i * num_groups;
+
+			size_t l = 0;
+			for(size_t g = 0; g < num_groups; ++g){
+				l += k[g];
+			}
+
+			computePValues_(cols, l, group_sizes, k, row_p_values.data());
+			for(size_t g = 0; g < num_groups; ++g){
+				p_values(first + i, g) = row_p_values[g];
+			}
+		}
+	}, num_threads_);
 }
 
 void ORAGroupPreference::parseGroups(
-	const DenseMatrix& matrix,
+	const Matrix& matrix,
 	const std::vector<Metadata>& metadata,
 	std::map<std::string, std::vector<unsigned int>>& group_indices)
 {
@@ -88,48 +125,41 @@ void ORAGroupPreference::parseGroups(
 	}
 }
 
-void ORAGroupPreference::addToTable(std::vector<size_t>& table, double p_value, bool is_current_group) const{
-	if(is_current_group){
-		table[NINDEX]++;
+void ORAGroupPreference::computePValues_(size_t m, size_t l,
+                                         const std::vector<size_t>& n,
+                                         const uint32_t* k, double* p_values)
+{
+	const size_t num_groups = n.size();
+
+	// Ensures that E != 0
+	if(l == 0){
+		std::fill(p_values, p_values + num_groups, -1.0);
+		return;
 	}
-	if(p_value < threshold_){
-		table[LINDEX]++;
-		if(is_current_group){
-			table[KINDEX]++;
-		}
+
+	if(l == m){
+		std::fill(p_values, p_values + num_groups, 1.0);
+		return;
 	}
-	table[MINDEX]++;
-}
 
-double ORAGroupPreference::computePValue_(const std::vector<size_t>& table) const{
-	return computePValue_(table[MINDEX], table[LINDEX], table[NINDEX], table[KINDEX]);
-}
+	// For a 2x2 table with m entries, l of them significant, n in the
+	// group and k in both, Pearson's chi^2 statistic simplifies to
+	// m (km - ln)^2 / (l (m-l) n (m-n)). With one degree of freedom its
+	// upper tail is erfc(sqrt(chi^2 / 2)).
+	const double dm = m, dl = l;
+	for(size_t g = 0; g < num_groups; ++g){
+		const double dn = n[g];
+		const double d = k[g] * dm - dl * dn;
+		const double chi = dm * d * d / (dl * (dm - dl) * dn * (dm - dn));
+		p_values[g] = std::erfc(std::sqrt(0.5 * chi));
+	}
 
-double ORAGroupPreference::computePValue_(size_t m, size_t l, size_t n, size_t k) const {
-	// Ensures that E != 0
-	if(l == 0) return -1.0;
-	if(l == m) return 1.0;
-	if(n == 0) return 1.0;
-	if(n == m) return 1.0;
-	
-	// Calculate E and chi^2
-	auto p_11 = (l*n)/((double)m*m), p_12 = ((m-l)*n)/((double)m*m);
-	auto p_21 = (l*(m-n))/((double)m*m), p_22 = ((m-l)*(m-n))/((double)m*m);
-	auto E_11 = m*p_11, E_12 = m*p_12;
-	auto E_21 = m*p_21, E_22 = m*p_22;
-	auto o_11 = (double)k,   o_12 = (double)n-k;
-	auto o_21 = (double)l-k, o_22 = (m-l)-o_12;
-	auto chi = (o_11-E_11)*(o_11-E_11)/E_11 +
-			   (o_12-E_12)*(o_12-E_12)/E_12 +
-			   (o_21-E_21)*(o_21-E_21)/E_21 +
-			   (o_22-E_22)*(o_22-E_22)/E_22;
-	
-	// Calculate p-value from chi^2
-	double res = boost::math::cdf(complement(test_, chi));
-	if(o_11 < E_11){
-		res = -1*res;
+	// Signs mark groups with fewer significant entries than expected
+	for(size_t g = 0; g < num_groups; ++g){
+		if(n[g] == 0 || n[g] == m){
+			p_values[g] = 1.0;
+		} else if(k[g] * dm < dl * n[g]){
+			p_values[g] = -p_values[g];
+		}
 	}
-	return res;
 }
-
-
@@ -23,22 +23,23 @@
 #include "macros.h"
 #include "DenseMatrix.h"
 #include "Metadata.h"
-#include <boost/math/distributions/chi_squared.hpp>
-#include "multiprecision.h"
-
 
+#include <cstdint>
+#include <map>
 #include <utility>
 #include <tuple>
 
-#include <boost/math/special_functions/binomial.hpp>
-
-using boost::math::chi_squared;
 namespace GeneTrail {
 
     class GT2_EXPORT ORAGroupPreference {
 		public:
-			ORAGroupPreference():test_(1){};
-			ORAGroupPreference(double threshold): threshold_(threshold), test_(1){};
+			ORAGroupPreference():threshold_(0.05){};
+			ORAGroupPreference(double threshold): threshold_(threshold){};
+
+			/**
+			 * Sets the number of threads. 0 uses all available cores.
+			 */
+			void setNumberOfThreads(unsigned int num_threads) { num_threads_ = num_threads; }
 
 			/**
 			 * This method accepts a (category x sample) matrix file containing p-values
@@ -48,6 +49,11 @@ namespace GeneTrail {
 			 * group combination on how significant a category is only present in the
 			 * respective group.
 			 *
+			 * The significant entries of every group are counted in a single
+			 * pass over a block of rows. All 2x2 contingency tables of a row
+			 * are derived from these counts and blocks are processed in
+			 * parallel.
+			 *
 			 * @param matrix a (category x sample) matrix with column- and row names.
 			 * @param metadata a Metadata object having a key for each sample.
 			 * @param result an empty DenseMatrix that is used to store the resulting 
@@ -60,7 +66,7 @@ namespace GeneTrail {
 			) const;
 			
 			static void parseGroups(
-				const DenseMatrix& matrix,
+				const Matrix& matrix,
 				const std::vector<Metadata>& metadata,
 				std::map<std::string, std::vector<unsigned int>>& group_indices
 			);
@@ -70,16 +76,17 @@ namespace GeneTrail {
 				const std::vector<std::string>& groups);
 			
 		private:
-			unsigned int MINDEX = 0;
-			unsigned int LINDEX = 1;
-			unsigned int NINDEX = 2;
-			unsigned int KINDEX = 3;
 			double threshold_;
-			chi_squared test_;
-			
-			void addToTable(std::vector<size_t>& table, double p_value, bool is_current_group) const;
-			double computePValue_(const std::vector<size_t>& table) const;
-			double computePValue_(size_t m, size_t l, size_t n, size_t k) const;
+			unsigned int num_threads_ = 0;
+
+			/**
+			 * Computes the signed chi-squared p-values of all groups of a row
+			 * with l significant entries out of m. The group sizes are given
+			 * by n and the significant entries per group by k.
+			 */
+			static void computePValues_(size_t m, size_t l,
+			                            const std::vector<size_t>& n,
+			                            const uint32_t* k, double* p_values);
 	};
 	
 }
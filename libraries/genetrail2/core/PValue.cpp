@@ -19,6 +19,12 @@
  */
 #include "PValue.h"
 
+#include "misc_algorithms.h"
+
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
 namespace GeneTrail
 {
 namespace pvalue
@@ -72,5 +78,123 @@ getCorrectionMethod(const std::string& method)
 	return boost::none;
 }
 
+namespace
+{
+// Cumulative max over the p-values in ascending order (see stepDown)
+template <typename Func>
+void stepDownInPlace(double* pvalues, const std::vector<size_t>& order, Func f)
+{
+	const int n = order.size();
+	double running = -std::numeric_limits<double>::infinity();
+	for(int i = 0; i < n; ++i) {
+		double& p = pvalues[order[i]];
+		running = std::max(running, f(p, n, i + 1));
+		p = std::min(running, 1.0);
+	}
+}
+
+// Cumulative min over the p-values in descending order (see stepUp)
+template <typename Func>
+void stepUpInPlace(double* pvalues, const std::vector<size_t>& order, Func f)
+{
+	const int n = order.size();
+	double running = std::numeric_limits<double>::infinity();
+	for(int i = n - 1; i >= 0; --i) {
+		double& p = pvalues[order[i]];
+		running = std::min(running, f(p, n, i + 1));
+		p = std::min(running, 1.0);
+	}
+}
+}
+
+bool requiresOrder(MultipleTestingCorrection method)
+{
+	switch(method) {
+		case MultipleTestingCorrection::Bonferroni:
+		case MultipleTestingCorrection::Sidak:
+		case MultipleTestingCorrection::GSEA:
+			return false;
+		default:
+			return true;
+	}
+}
+
+std::vector<size_t> ascendingOrder(const double* pvalues, size_t n,
+                                   unsigned int num_threads)
+{
+	std::vector<size_t> order(n);
+	std::iota(order.begin(), order.end(), size_t(0));
+	parallel_sort(order.begin(), order.end(),
+	              [pvalues](size_t i, size_t j) { return pvalues[i] < pvalues[j]; },
+	              num_threads);
+
+	return order;
+}
+
+void adjustInPlace(double* pvalues, size_t n, const std::vector<size_t>& order,
+                   MultipleTestingCorrection method)
+{
+	if(requiresOrder(method) && order.size() != n) {
+		throw std::invalid_argument("The order does not match the number of p-values");
+	}
+
+	switch(method) {
+		case MultipleTestingCorrection::Bonferroni:
+			for(size_t i = 0; i < n; ++i) {
+				pvalues[i] = std::min(bonferroni_func(pvalues[i], n), 1.0);
+			}
+			return;
+		case MultipleTestingCorrection::Sidak:
+			for(size_t i = 0; i < n; ++i) {
+				pvalues[i] = std::min(sidak_func(pvalues[i], n), 1.0);
+			}
+			return;
+		case MultipleTestingCorrection::Holm:
+			stepDownInPlace(pvalues, order, hochberg_func);
+			return;
+		case MultipleTestingCorrection::HolmSidak:
+			stepDownInPlace(pvalues, order, holm_sidak_func);
+			return;
+		case MultipleTestingCorrection::Finner:
+			stepDownInPlace(pvalues, order, finner_func);
+			return;
+		case MultipleTestingCorrection::BenjaminiHochberg:
+		case MultipleTestingCorrection::Simes:
+			stepUpInPlace(pvalues, order, fdr_func);
+			return;
+		case MultipleTestingCorrection::BenjaminiYekutieli: {
+			double q = 0.0;
+			for(size_t i = 0; i < n; ++i) {
+				q += 1 / (i + 1.0);
+			}
+
+			stepUpInPlace(pvalues, order, [q](double p, int n, int i) {
+				return fdr_func(p, n, i) * q;
+			});
+			return;
+		}
+		case MultipleTestingCorrection::Hochberg:
+			stepUpInPlace(pvalues, order, hochberg_func);
+			return;
+		case MultipleTestingCorrection::GSEA:
+			return;
+		default:
+			throw NotImplemented(__FILE__, __LINE__, "The requested correction "
+			                                         "method has not yet been "
+			                                         "implemented.");
+	}
+}
+
+void adjustInPlace(double* pvalues, size_t n, MultipleTestingCorrection method,
+                   unsigned int num_threads)
+{
+	std::vector<size_t> order;
+	if(requiresOrder(method)) {
+		order = ascendingOrder(pvalues, n, num_threads);
+	}
+
+	adjustInPlace(pvalues, n, order, method);
+}
+
 } // namespace pvalue
 } // namespace GeneTrail2
@@ -29,6 +29,7 @@
 #include <utility>
 #include <tuple>
 #include <type_traits>
+#include <vector>
 
 #include <boost/math/distributions/chi_squared.hpp>
 #include <boost/math/distributions/normal.hpp>
@@ -488,6 +489,68 @@ rcref<PValues> adjustPValues(PValues&& pvalues, Access&& access,
 	}
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Index based adjustment
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The container based methods above sort (copies of) the objects holding
+ * the p-values, so callers have to identify the adjusted p-values by a
+ * key. The following methods instead adjust a contiguous array of
+ * p-values in place, every p-value keeps its position.
+ *
+ * Methods that depend on the rank of a p-value (Holm, Holm-Sidak,
+ * Finner, Hochberg, Benjamini-Hochberg, Benjamini-Yekutieli and Simes)
+ * take the permutation that sorts the p-values in ascending order. Given
+ * this permutation, every method is a single pass over the p-values.
+ */
+
+/**
+ * Returns true if method depends on the rank of the p-values and thus
+ * requires the ascending order.
+ */
+GT2_EXPORT bool requiresOrder(MultipleTestingCorrection method);
+
+/**
+ * Computes the permutation that sorts the n p-values in ascending order,
+ * i.e. pvalues[order[0]] is the smallest p-value. Large inputs are sorted
+ * in parallel.
+ *
+ * @param num_threads Number of threads. 0 uses all available cores.
+ */
+GT2_EXPORT std::vector<size_t> ascendingOrder(const double* pvalues, size_t n,
+                                              unsigned int num_threads = 0);
+
+/**
+ * Adjusts the n p-values in place.
+ *
+ * @param order The result of ascendingOrder(pvalues, n). May be empty if
+ *              requiresOrder(method) is false.
+ *
+ * @throws std::invalid_argument if the order is required but does not
+ *         have n entries.
+ */
+GT2_EXPORT void adjustInPlace(double* pvalues, size_t n,
+                              const std::vector<size_t>& order,
+                              MultipleTestingCorrection method);
+
+/**
+ * Adjusts the n p-values in place, computing the order if necessary.
+ *
+ * @param num_threads Number of threads used for sorting. 0 uses all
+ *                    available cores.
+ */
+GT2_EXPORT void adjustInPlace(double* pvalues, size_t n,
+                              MultipleTestingCorrection method,
+                              unsigned int num_threads = 0);
+
+inline void adjustInPlace(std::vector<double>& pvalues,
+                          MultipleTestingCorrection method,
+                          unsigned int num_threads = 0)
+{
+	adjustInPlace(pvalues.data(), pvalues.size(), method, num_threads);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // P-value aggregation
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1,7 +1,6 @@
 /*
  * GeneTrail2 - An efficient library for interpreting genetic data
  * Copyright (C) 2013 Tim Kehl <tkehl@bioinf.uni-sb.de>
- *               2014 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the Lesser GNU General Public License as
@@ -20,22 +19,34 @@
  */
 #include "Pathfinder.h"
 
+#include "misc_algorithms.h"
+
+#include <cassert>
+#include <iostream>
+
 using namespace GeneTrail;
 
-// If true the matrix in every step is printed
+// If true the paths of every layer are printed
 bool debug = false;
 
-void Pathfinder::printMatrix(const std::vector<std::vector<int> >& m) {
-    for (std::vector<int> row : m) {
-        for (int v : row) {
-            std::string s = (v < 0) ? "" : " ";
-            std::cout << s << v << ", ";
+void Pathfinder::setNumberOfThreads(unsigned int num_threads) {
+    num_threads_ = num_threads;
+}
+
+void Pathfinder::printLayer(int l) const {
+    const int numberOfGeneIds = nodes.size();
+    for (int k = 0; k < numberOfGeneIds; ++k) {
+        std::cout << k << ":";
+        if (cur_valid[k]) {
+            for (int i = 0; i < l; ++i) {
+                std::cout << " " << cur_members[k * l + i];
+            }
         }
         std::cout << std::endl;
     }
 }
 
-int Pathfinder::computeRunningSum(int bpi, int n, int i, int l) {
+int Pathfinder::computeRunningSum(int bpi, int n, int i, int l) const {
     return bpi*n - i*l;
 }
 
@@ -49,181 +60,174 @@ bool geneListValid(const std::vector<std::string>& sorted_gene_list) {
     return sorted.size() == sorted_gene_list.size();
 }
 
-void Pathfinder::initializeFields(const GraphType& graph, const std::vector<std::string>& sorted_gene_list, const int& length) {
+void Pathfinder::initializeFields(const CompressedGraph& graph, const std::vector<std::string>& sorted_gene_list, const int& length) {
     assert(geneListValid(sorted_gene_list));
-    assert(boost::num_vertices(graph) == sorted_gene_list.size());
+    assert(graph.numberOfVertices() == sorted_gene_list.size());
 
     //The number of genes in the list
     const int numberOfGeneIds = sorted_gene_list.size();
 
     //Map from name to rank in gene list
+    name2rank.clear();
+    name2rank.reserve(numberOfGeneIds);
     for (int i = 0; i < numberOfGeneIds; ++i) {
         name2rank[sorted_gene_list[i]] = i;
     }
 
-    nodes.clear();
-    nodes.resize(boost::num_vertices(graph));
-
-    for (tie(vi, vi_end) = vertices(graph); vi != vi_end; vi++) {
-        vertex_descriptor vd = *vi;
+    nodes.assign(numberOfGeneIds, CompressedGraph::NOT_FOUND);
 
-        auto vertex_id = boost::get(vertex_identifier, graph, vd);
-
-        nodes[name2rank[vertex_id]] = vd;
-        vertex_map[vd] = name2rank[vertex_id];
+    std::vector<int> vertex_to_rank(graph.numberOfVertices());
+    for (CompressedGraph::vertex_type v = 0; v < graph.numberOfVertices(); ++v) {
+        const int rank = name2rank[graph.name(v)];
+        nodes[rank] = v;
+        vertex_to_rank[v] = rank;
     }
 
-    // Initialize first layer
-    M_1.assign(numberOfGeneIds, std::vector<int>(numberOfGeneIds, 0));
+    // Remap the ingoing adjacency of the graph to ranks. The order of the
+    // edges is preserved, so ties are resolved as before.
+    pred_offsets.assign(numberOfGeneIds + 1, 0);
+    pred_sources.clear();
+    pred_sources.reserve(graph.numberOfEdges());
 
-    // Fill the first layer
-    // This is very simple as the gene list is sorted and we have a bijective mapping
     for (int k = 0; k < numberOfGeneIds; ++k) {
-        for (int i = k; i < numberOfGeneIds; ++i) {
-            M_1[k][i] = 1;
+        for (auto it = graph.inBegin(nodes[k]); it != graph.inEnd(nodes[k]); ++it) {
+            pred_sources.push_back(vertex_to_rank[*it]);
         }
+        pred_offsets[k + 1] = pred_sources.size();
     }
 
-    // Only needed for debugging
-    if (debug) {
-        printMatrix(M_1);
+    // Fill the first layer
+    // This is very simple as the gene list is sorted and every path
+    // consists of its end vertex only.
+    cur_members.resize(numberOfGeneIds);
+    cur_valid.assign(numberOfGeneIds, 1);
+    cur_running_sums.resize(numberOfGeneIds);
+
+    for (int k = 0; k < numberOfGeneIds; ++k) {
+        cur_members[k] = k;
+        cur_running_sums[k] = computeRunningSum(1, numberOfGeneIds, k + 1, 1);
     }
 
-    // Compute RS for all paths of length 1
-    std::vector < std::vector<int >> rs(std::vector<std::vector<int> > (length, std::vector<int> (numberOfGeneIds, 0)));
-    running_sums = rs;
+    best_preds.assign(std::max(length - 1, 0) * numberOfGeneIds, -1);
 
-    for (int i = 0; i < numberOfGeneIds; ++i) {
-        running_sums[0][i] = computeRunningSum(1, numberOfGeneIds, i + 1, 1);
+    // Only needed for debugging
+    if (debug) {
+        printLayer(1);
     }
 
     std::cout << "Layer 1" << std::endl;
 }
 
-void Pathfinder::findBestPredecessor(const GraphType& graph, int& best_pred_k, int& best_pred_k_running_sum, int& pred_flag, int l, const vertex_descriptor& vd) {
-    for (; iei != iei_end; iei++) {
-        vertex_descriptor vd_source = source(*iei, graph);
-        int source_kv = vertex_map[vd_source];
-        int tmp_rs = running_sums[l - 2][source_kv];
+bool Pathfinder::isOnPath(int source, int k, int l) const {
+    auto begin = prev_members.begin() + source * l;
+    return std::binary_search(begin, begin + l, k);
+}
 
-        if (pred_flag == 0 || tmp_rs > best_pred_k_running_sum) {
-            int kv = vertex_map[vd];
+int Pathfinder::findBestPredecessor(int k, int l) const {
+    int best_pred_k = -1;
+    int best_pred_k_running_sum = 0;
 
+    for (int e = pred_offsets[k]; e < pred_offsets[k + 1]; ++e) {
+        const int source_kv = pred_sources[e];
+        const int tmp_rs = prev_running_sums[source_kv];
+
+        if (best_pred_k == -1 || tmp_rs > best_pred_k_running_sum) {
             // Check if k is already on the path
             // We have to avoid cycles
-            if (((kv == 0 && M_1[source_kv][kv] == 0) || (kv != 0 && M_1[source_kv][kv - 1] == M_1[source_kv][kv])) && M_1[source_kv][kv] != -1) {
+            if (prev_valid[source_kv] && !isOnPath(source_kv, k, l - 1)) {
                 best_pred_k = source_kv;
                 best_pred_k_running_sum = tmp_rs;
-                ++pred_flag;
             }
         }
     }
-}
 
-void Pathfinder::fillNextLayer(int best_pred_k, int k) {
-    const int numberOfGeneIds = nodes.size();
-    for (int i = 0; i < numberOfGeneIds; ++i) {
-        if (k <= i) {
-            M_2[k][i] = M_1[best_pred_k][i] + 1;
-        } else {
-            M_2[k][i] = M_1[best_pred_k][i];
-        }
-    }
+    return best_pred_k;
 }
 
-void Pathfinder::computeRunningSum(int k, int l, int& max_runnig_sum_k) {
+int Pathfinder::fillNextLayer(int best_pred_k, int k, int l) {
     const int numberOfGeneIds = nodes.size();
-    int bpi = 1;
 
-    if (M_2[k][0] == 1) {
-        max_runnig_sum_k = computeRunningSum(bpi, numberOfGeneIds, 1, l);
-        ++bpi;
-    }
+    // Insert k into the sorted path of the predecessor
+    auto pred_begin = prev_members.begin() + best_pred_k * (l - 1);
+    auto pred_end = pred_begin + (l - 1);
+    auto pos = std::upper_bound(pred_begin, pred_end, k);
 
-    for (int i = 0; i < numberOfGeneIds - 1; ++i) {
-        if (M_2[k][i] < M_2[k][i + 1]) {
-            int running_sum_k = computeRunningSum(bpi, numberOfGeneIds, i + 2, l);
+    auto out = cur_members.begin() + k * l;
+    out = std::copy(pred_begin, pos, out);
+    *out++ = k;
+    std::copy(pos, pred_end, out);
 
-            if (bpi == 1 || running_sum_k > max_runnig_sum_k) {
-                max_runnig_sum_k = running_sum_k;
-            }
+    // The running sum only changes at the ranks that are part of the path
+    int max_runnig_sum_k = 0;
+    for (int bpi = 1; bpi <= l; ++bpi) {
+        int running_sum_k = computeRunningSum(bpi, numberOfGeneIds, cur_members[k * l + bpi - 1] + 1, l);
 
-            ++bpi;
+        if (bpi == 1 || running_sum_k > max_runnig_sum_k) {
+            max_runnig_sum_k = running_sum_k;
         }
     }
+
+    return max_runnig_sum_k;
 }
 
 std::vector<Path> Pathfinder::computeDeregulatedPath(const GraphType& graph, const std::vector<std::string>& sorted_gene_list, const int& length) {
+    return computeDeregulatedPath(CompressedGraph(std::make_shared<EntityDatabase>(), graph), sorted_gene_list, length);
+}
 
+std::vector<Path> Pathfinder::computeDeregulatedPath(const CompressedGraph& graph, const std::vector<std::string>& sorted_gene_list, const int& length) {
+
+    // Initialize fields and first layer of the matrix
     initializeFields(graph, sorted_gene_list, length);
 
-    // Initialize fields and first layer of the matrix	
-    //initializeFields(graph, sorted_gene_list, length, best_paths, regulations);
     const int numberOfGeneIds = nodes.size();
-    
+
     //Holds the best path for each l
     std::vector<Path> best_paths;
-    
+
     //Extend the path
     //Fill the layers 2..(length)
     for (int l = 2; l <= length; ++l) {
-        int bestk = -1;
-        int bestk_running_sum = -1;
-
-        // Contains a mapping for each vertex to the best predecessor
-        std::map<int, int> best_preds;
-
-        // Initialize second layer
-        std::vector < std::vector<int >> M2(std::vector<std::vector<int> > (numberOfGeneIds, std::vector<int> (numberOfGeneIds, -1)));
-        M_2 = M2;
-        
-        for (int k = 0; k < numberOfGeneIds; ++k) {
-            // Find vertex that corresponds to k
-            vertex_descriptor vd = nodes[k];
-
-            // Get all ingoing edges
-            tie(iei, iei_end) = boost::in_edges(vd, graph);
+        // As each layer only depends on the layer before we only need to save two layers at once
+        std::swap(prev_members, cur_members);
+        std::swap(prev_valid, cur_valid);
+        std::swap(prev_running_sums, cur_running_sums);
 
-            // Continue if there are no ingoing edges
-            if (iei == iei_end) {
-                continue;
-            }
+        cur_members.resize(numberOfGeneIds * l);
+        cur_valid.assign(numberOfGeneIds, 0);
+        cur_running_sums.assign(numberOfGeneIds, 0);
 
-            // For each target
-            // Hold the best values for predecessor
-            int best_pred_k;
-            int best_pred_k_running_sum;
-            int pred_flag = 0;
+        int* layer_preds = best_preds.data() + (l - 2) * numberOfGeneIds;
 
+        // Every vertex only writes its own row, so the vertices can be
+        // processed independently.
+        parallel_for(0, numberOfGeneIds, [&](int k) {
             // Find the best predecessor
-            findBestPredecessor(graph, best_pred_k, best_pred_k_running_sum, pred_flag, l, vd);
+            int best_pred_k = findBestPredecessor(k, l);
 
-            // In case there are only cycles possible
-            if (pred_flag == 0) {
-                //std::cout << "only cycles possible" << std::endl;
-                continue;
-            }
-
-            // Save for each k the best predecessor 
-            best_preds[k] = best_pred_k;
-
-            if (debug) {
-                std::cout << sorted_gene_list[best_pred_k] << "-->" << sorted_gene_list[k] << std::endl;
+            // There are either no ingoing edges or only cycles are possible
+            if (best_pred_k == -1) {
+                return;
             }
 
-            // Fill the next layer
-            fillNextLayer(best_pred_k, k);
+            // Save for each k the best predecessor
+            layer_preds[k] = best_pred_k;
 
-            // Compute the running sum for the current path
-            int max_runnig_sum_k = 0;
-            computeRunningSum(k, l, max_runnig_sum_k);
+            // Fill the next layer and compute the running sum for the current path
+            cur_running_sums[k] = fillNextLayer(best_pred_k, k, l);
+            cur_valid[k] = 1;
+        }, num_threads_, 256);
 
-            // Save the best running sum
-            running_sums[l - 1][k] = max_runnig_sum_k;
+        int bestk = -1;
+        int bestk_running_sum = -1;
 
-            if (max_runnig_sum_k > bestk_running_sum) {
+        for (int k = 0; k < numberOfGeneIds; ++k) {
+            if (cur_valid[k] && cur_running_sums[k] > bestk_running_sum) {
                 bestk = k;
-                bestk_running_sum = max_runnig_sum_k;
+                bestk_running_sum = cur_running_sums[k];
+            }
+
+            if (debug && cur_valid[k]) {
+                std::cout << sorted_gene_list[layer_preds[k]] << "-->" << sorted_gene_list[k] << std::endl;
             }
         }
 
@@ -232,19 +236,14 @@ std::vector<Path> Pathfinder::computeDeregulatedPath(const GraphType& graph, con
             break;
         }
 
-        best_preds_v.push_back(best_preds);
-
         if (debug) {
             std::cout << std::endl;
-            printMatrix(M_2);
-        }
-    
-        if (debug) {
-            auto rsums = running_sums[l-1];
-            for(size_t r=0; r < rsums.size(); ++r){
-                std::cout << "RS* (k = " << r << "): " << running_sums[l-1][r] << std::endl;
+            printLayer(l);
+
+            for(int r=0; r < numberOfGeneIds; ++r){
+                std::cout << "RS* (k = " << r << "): " << cur_running_sums[r] << std::endl;
             }
-            std::cout << "--> Best RS* (k = " << bestk << "): " << running_sums[l-1][bestk] << std::endl;
+            std::cout << "--> Best RS* (k = " << bestk << "): " << cur_running_sums[bestk] << std::endl;
         }
 
         // Estimate the reversed order
@@ -254,52 +253,45 @@ std::vector<Path> Pathfinder::computeDeregulatedPath(const GraphType& graph, con
 
         int tmp_k = bestk;
         for (int i = l - 2; i >= 0; --i) {
-            best_preds = best_preds_v[i];
-            tmp_k = best_preds[tmp_k];
+            tmp_k = best_preds[i * numberOfGeneIds + tmp_k];
             rev_path.push_back(sorted_gene_list[tmp_k]);
         }
 
         // Revert the path
-        // std::vector<std::string> path;
         if (debug) {
             std::cout << "Best path: ";
         }
-    
+
         for (int i = rev_path.size() - 1; i >= 0; --i) {
             path.push_back(rev_path[i]);
             if (debug) {
                 std::cout << rev_path[i] << "-->";
             }
         }
-    
+
         if (debug) {
             std::cout << std::endl;
         }
 
         Path p;
-		p.setRunningSum(running_sums[l-1][bestk]);
+		p.setRunningSum(cur_running_sums[bestk]);
         // Save path
 		p.addVertex(path[0]);
         for (size_t i = 1; i < path.size(); ++i) {
             p.addVertex(path[i]);
-            vertex_descriptor vd1 = nodes[name2rank[path[i - 1]]];
-            vertex_descriptor vd2 = nodes[name2rank[path[i]]];
-
-            edge_descriptor ed;
-            bool exists;
-            boost::tie(ed, exists) = boost::edge(vd1, vd2, graph);
-            if (exists) {
-                p.addRegulation(path[i - 1], path[i], boost::get(edge_regulation_type, graph, ed));
+            auto v1 = nodes[name2rank[path[i - 1]]];
+            auto v2 = nodes[name2rank[path[i]]];
+
+            auto e = graph.findEdge(v1, v2);
+            if (e != CompressedGraph::NOT_FOUND) {
+                p.addRegulation(path[i - 1], path[i], graph.edgeTypeName(graph.outEdgeType(e)));
             } else {
-                std::cout << "ERROR: No edge between " << path[i - 1] << " " << boost::get(vertex_identifier, graph, vd1) << " and " << path[i] << " " << boost::get(vertex_identifier, graph, vd2) << std::endl;
+                std::cout << "ERROR: No edge between " << path[i - 1] << " " << graph.name(v1) << " and " << path[i] << " " << graph.name(v2) << std::endl;
             }
         }
 
         best_paths.push_back(p);
 
-        // As each layer only depends on the layer before we only need to save two layers at once
-        std::swap(M_1, M_2);
-
         std::cout << "Layer " << l << std::endl;
     }
 
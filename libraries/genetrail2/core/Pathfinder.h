@@ -1,6 +1,7 @@
 /*
  * GeneTrail2 - An efficient library for interpreting genetic data
  * Copyright (C) 2013 Tim Kehl <tkehl@bioinf.uni-sb.de>
+ *               2014 Daniel Stöckel <dstoeckel@bioinf.uni-sb.de>
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the Lesser GNU General Public License as
@@ -27,30 +28,49 @@
 #include <tuple>
 #include <vector>
 #include <algorithm>
-#include <map>
+#include <unordered_map>
 #include <set>
 #include  <cstdint>
 
 #include "BoostGraph.h"
+#include "CompressedGraph.h"
 #include "Path.h"
 
 namespace GeneTrail {
 
+    /**
+     * Implementation of the FiDePa dynamic program.
+     *
+     * Vertices are identified by their rank in the sorted gene list. The
+     * ingoing edges of the CompressedGraph are remapped to a compressed
+     * adjacency (CSR) over these ranks. Instead of the N x N prefix count matrices
+     * of the original formulation, every path of layer l is stored as the
+     * sorted list of the l ranks it visits. Only the current and the
+     * previous layer are kept in memory, the predecessors of all layers are
+     * stored in a flat (length - 1) x N table.
+     */
     class GT2_EXPORT Pathfinder {
     public:
 
-        Pathfinder() {
+        Pathfinder() : num_threads_(0) {
         };
 
         ~Pathfinder() {
         };
 
         /**
-         * Prints the given matrix
+         * Sets the number of threads used to fill a layer.
          *
-         * @param m Two dimensional vector representing a matrix
+         * @param num_threads Number of threads. 0 uses all available cores.
          */
-        void printMatrix(const std::vector<std::vector<int> >& m);
+        void setNumberOfThreads(unsigned int num_threads);
+
+        /**
+         * Prints the paths stored in the current layer
+         *
+         * @param l The length of the paths in the current layer
+         */
+        void printLayer(int l) const;
 
         /**
          * Computes the RunningSum (Simplified version of the formula from the FiDePa paper)
@@ -61,84 +81,93 @@ namespace GeneTrail {
          * @param l The current length of path
          * @return The computed Running Sum
          */
-        int computeRunningSum(int bpi, int n, int i, int l);
+        int computeRunningSum(int bpi, int n, int i, int l) const;
 
         /**
          * Initializes all fields and and the first layer of the matrix
          *
-         * @param graph KEGG network as Boost graph structure
+         * @param graph KEGG network as compressed graph
          * @param sorted_gene_list Gene list sorted by rank
          * @param length Maximal length of path
          */
-        void initializeFields(const GraphType& graph, const std::vector<std::string>& sorted_gene_list, const int& length);
+        void initializeFields(const CompressedGraph& graph, const std::vector<std::string>& sorted_gene_list, const int& length);
 
         /**
-         * Finds the predecessor with best running sum
+         * Finds the predecessor with best running sum that does not
+         * introduce a cycle.
          *
-         * @param[in] graph KEGG network as Boost graph object
-         * @param[out] best_pred_k stores the index of the best predecessor
-         * @param[out] best_pred_k_running_sum the running sum for the best predecessor
-         * @param[in,out] pred_flag Saves the number of predecessors
-         * @param[in] l The current layer
-         * @param[in] vd The current vertex
+         * @param k The current vertex
+         * @param l The current layer
+         * @return The rank of the best predecessor or -1 if none exists
          */
-        void findBestPredecessor(const GraphType& graph, int& best_pred_k, int& best_pred_k_running_sum, int& pred_flag, int l, const vertex_descriptor& vd);
+        int findBestPredecessor(int k, int l) const;
 
         /**
-         * Fills the next layer based on the best predecessor
+         * Fills the path of vertex k in the next layer by extending the
+         * path of its best predecessor and computes its running sum.
          *
          * @param best_pred_k Best predecessor of k
          * @param k Current vertex
+         * @param l Length of the path
+         * @return The maximal running sum of the new path
          */
-        void fillNextLayer(int best_pred_k, int k);
+        int fillNextLayer(int best_pred_k, int k, int l);
 
         /**
-         * Computes the running sum for a path of length l ending in vertex k
+         * Computes best possible deregulated paths according to the FiDePa algorithm.
          *
-         * @param k Current vertex
-         * @param l Length of the path
-         * @param max_runnig_sum_k Saves the running sum
+         * @param graph KEGG network as compressed graph
+         * @param sorted_gene_list Gene list sorted by rank
+         * @param length Maximal length of path
          */
-        void computeRunningSum(int k, int l, int& max_runnig_sum_k);
+        std::vector<GeneTrail::Path> computeDeregulatedPath(const CompressedGraph& graph, const std::vector<std::string>& sorted_gene_list, const int& length);
 
         /**
-         * Computes best possible deregulated paths according to the FiDePa algorithm.
+         * Overload for BOOST graph objects. The graph is converted into a
+         * CompressedGraph first.
          *
          * @param graph KEGG network as BOOST graph object
          * @param sorted_gene_list Gene list sorted by rank
          * @param length Maximal length of path
          */
         std::vector<GeneTrail::Path> computeDeregulatedPath(const GraphType& graph, const std::vector<std::string>& sorted_gene_list, const int& length);
-        
+
     private:
-        //Map from name to rank in gene list
-        std::map<std::string, int> name2rank;
+        // Returns true if vertex k is part of the path ending in source in
+        // the previous layer. The path has length l.
+        bool isOnPath(int source, int k, int l) const;
 
-        //Map from rank to vertex_descriptor
-        std::map<vertex_descriptor, int> vertex_map;
+        unsigned int num_threads_;
 
-        std::vector<vertex_descriptor> nodes;
+        //Map from name to rank in gene list
+        std::unordered_map<std::string, int> name2rank;
 
-        //Layers of the matrix 
-        std::vector<std::vector<int> > M_1;
-        std::vector<std::vector<int> > M_2;
+        //Map from rank to vertex of the compressed graph
+        std::vector<CompressedGraph::vertex_type> nodes;
 
-        // Iterator for vertices
-        boost::graph_traits<GraphType>::vertex_iterator vi, vi_end;
+        // CSR representation of the ingoing edges. The sources of the
+        // ingoing edges of vertex k are stored in
+        // pred_sources[pred_offsets[k]] ... pred_sources[pred_offsets[k + 1] - 1]
+        std::vector<int> pred_offsets;
+        std::vector<int> pred_sources;
 
-        // Iterator for all ingoing edges of a vertex
-        boost::graph_traits<GraphType>::in_edge_iterator iei, iei_end;
+        // The sorted ranks of the paths ending in each vertex. Row k of
+        // a layer of length l starts at position k * l.
+        std::vector<int> prev_members;
+        std::vector<int> cur_members;
 
-        // Iterator for all outgoing edges of a vertex
-        boost::graph_traits<GraphType>::out_edge_iterator oei, oei_end;
+        // Marks whether a path ending in vertex k exists in a layer
+        std::vector<char> prev_valid;
+        std::vector<char> cur_valid;
 
-        // This map contains for each layer a mapping for each vertex to its predecessor
-        std::vector<std::map<int, int> > best_preds_v;
+        // Running sums of the paths ending in vertex k
+        std::vector<int> prev_running_sums;
+        std::vector<int> cur_running_sums;
 
-        //Compute RS for all paths
-        std::vector<std::vector<int > > running_sums;
+        // Best predecessor of vertex k in layer l is stored in
+        // best_preds[(l - 2) * N + k]
+        std::vector<int> best_preds;
     };
 }
 
 #endif //GT2_CORE_PATHFINDER_H
-
@@ -21,27 +21,191 @@
 
 #include "SCMatrixFilter.h"
 
-#include <vector>
-#include <fstream>
-
-#include <boost/algorithm/string/split.hpp>
-#include <boost/algorithm/string/trim.hpp>
-#include <boost/algorithm/string/replace.hpp>
-#include <boost/algorithm/string/classification.hpp>
-#include <boost/algorithm/string/predicate.hpp>
-#include <boost/lexical_cast.hpp>
-
 #include "Exception.h"
+#include "SparseMatrix.h"
+#include "SparseMatrixWriter.h"
+#include "misc_algorithms.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 namespace GeneTrail
 {
-	 void SCMatrixFilter::filterMatrix(const std::string& matrix, std::set<std::string> mito_genes, const FilterParams& params){
+	namespace
+	{
+		using Range = std::pair<const char*, const char*>;
+
+		inline bool isDelimiter(char c) { return c == '\t' || c == ','; }
+
+		/**
+		 * Reads a text file in large blocks that always end at a line break
+		 * and splits them into lines. Empty lines are skipped.
+		 */
+		class LineChunkReader
+		{
+		  public:
+			LineChunkReader(const std::string& file, size_t chunk_size)
+			    : input_(file, std::ios::binary), chunk_size_(std::max(chunk_size, size_t(1)))
+			{
+				if(!input_) {
+					throw IOError("Could not open " + file);
+				}
+			}
+
+			bool next(std::vector<Range>& lines)
+			{
+				lines.clear();
+				buffer_.erase(buffer_.begin(), buffer_.begin() + consumed_);
+				consumed_ = 0;
+
+				while(lines.empty()) {
+					size_t searched = 0;
+					while(true) {
+						auto it = std::find(buffer_.rbegin(), buffer_.rend() - searched, '\n');
+						if(it != buffer_.rend() - searched) {
+							consumed_ = buffer_.rend() - it;
+							break;
+						}
+						searched = buffer_.size();
+
+						if(eof_) {
+							if(buffer_.empty()) {
+								return false;
+							}
+							buffer_.push_back('\n');
+							consumed_ = buffer_.size();
+							break;
+						}
+
+						const size_t old_size = buffer_.size();
+						buffer_.resize(old_size + chunk_size_);
+						input_.read(buffer_.data() + old_size, chunk_size_);
+						buffer_.resize(old_size + input_.gcount());
+						eof_ = !input_;
+					}
+
+					// Split into lines, the last character is always a line break
+					const char* begin = buffer_.data();
+					const char* end = begin + consumed_;
+					while(begin != end) {
+						const char* line_end = std::find(begin, end, '\n');
+						const char* content_end = line_end;
+						if(content_end != begin && *(content_end - 1) == '\r') {
+							--content_end;
+						}
+						if(content_end != begin) {
+							lines.emplace_back(begin, content_end);
+						}
+						begin = line_end + 1;
+					}
+
+					if(lines.empty()) {
+						buffer_.erase(buffer_.begin(), buffer_.begin() + consumed_);
+						consumed_ = 0;
+					}
+				}
+
+				return true;
+			}
+
+		  private:
+			std::ifstream input_;
+			size_t chunk_size_;
+			std::vector<char> buffer_;
+			size_t consumed_ = 0;
+			bool eof_ = false;
+		};
+
+		/**
+		 * Splits a line at tabs and commas. Consecutive delimiters are
+		 * treated as one.
+		 */
+		void tokenize(const Range& line, std::vector<Range>& fields)
+		{
+			fields.clear();
+			const char* start = line.first;
+			const char* p = line.first;
+			while(p != line.second) {
+				if(isDelimiter(*p)) {
+					fields.emplace_back(start, p);
+					while(p != line.second && isDelimiter(*p)) {
+						++p;
+					}
+					start = p;
+				} else {
+					++p;
+				}
+			}
+			fields.emplace_back(start, p);
+		}
+
+		// strtod skips leading whitespace including line breaks, so it could
+		// run into the next line or past the buffer for empty fields. The
+		// field is thus copied into a terminated buffer first. Fields that
+		// are empty or no number count as 0.
+		inline double parseValue(const Range& field)
+		{
+			const size_t n = field.second - field.first;
+			if(n == 0) {
+				return 0.0;
+			}
+
+			char small[64];
+			std::string large;
+			const char* str = small;
+			if(n < sizeof(small)) {
+				std::copy(field.first, field.second, small);
+				small[n] = '\0';
+			} else {
+				large.assign(field.first, field.second);
+				str = large.c_str();
+			}
+
+			char* end;
+			double v = std::strtod(str, &end);
+			return end == str ? 0.0 : v;
+		}
+
+		// Splits [0, n) into at most num_threads contiguous slices.
+		std::vector<size_t> sliceBounds(size_t n, unsigned int num_threads)
+		{
+			const size_t slices = std::max<size_t>(1, std::min<size_t>(n, num_threads));
+			std::vector<size_t> bounds(slices + 1);
+			for(size_t i = 0; i <= slices; ++i) {
+				bounds[i] = i * n / slices;
+			}
+			return bounds;
+		}
+
+		struct PartialStatistics
+		{
+			explicit PartialStatistics(size_t cols)
+			    : total_count(cols, 0.0), mito_count(cols, 0.0), nonzero_features(cols, 0.0), nonzero_entries(cols, 0)
+			{
+			}
+
+			std::vector<double> total_count;
+			std::vector<double> mito_count;
+			std::vector<double> nonzero_features;
+			std::vector<size_t> nonzero_entries;
+			std::vector<std::string> row_names;
+		};
+	}
+
+	void SCMatrixFilter::filterMatrix(const std::string& matrix, const std::set<std::string>& mito_genes, const FilterParams& params){
 		std::vector<double> total_count;
 		std::vector<double> mito_count;
 		std::vector<double> nonzero_features;
+		std::vector<size_t> nonzero_entries;
 
-		fillColumnStatistics(matrix, mito_genes, total_count, mito_count, nonzero_features, params);
+		fillColumnStatistics(matrix, mito_genes, total_count, mito_count, nonzero_features, nonzero_entries, params);
 		
 		std::cout << "Filtering cells..." << std::endl;
 		std::vector<std::string> keep;
@@ -54,56 +218,153 @@ namespace GeneTrail
 		}
 		
 		std::cout << "Writing matrix..." << std::endl;
-		writeFilteredMatrix(matrix, keep_idx, params);
+		writeFilteredMatrix(matrix, keep_idx, keep, nonzero_entries, params);
 		
 		std::cout << "Writing statistics file..." << std::endl;
 		writeStatisticsFile(total_count, mito_count, nonzero_features, keep, keep_idx, params);
 	}
 	
-	void SCMatrixFilter::fillColumnStatistics(const std::string& matrix, std::set<std::string> mito_genes, std::vector<double>& total_count, std::vector<double>& mito_count,
+	void SCMatrixFilter::filterMatrix(const SparseMatrix& matrix, const std::set<std::string>& mito_genes, const FilterParams& params){
+		std::vector<double> total_count;
+		std::vector<double> mito_count;
+		std::vector<double> nonzero_features;
+
+		fillColumnStatistics(matrix, mito_genes, total_count, mito_count, nonzero_features, params);
+
+		std::cout << "Filtering cells..." << std::endl;
+		std::vector<std::string> keep;
+		std::vector<size_t> keep_idx;
+		for(size_t idx_cell=0; idx_cell < cols; idx_cell++){
+			if(passFilter(total_count[idx_cell], nonzero_features[idx_cell], mito_count[idx_cell], params)){
+				keep.push_back(col_names[idx_cell]);
+				keep_idx.push_back(idx_cell);
+			}
+		}
+
+		std::cout << "Writing matrix..." << std::endl;
+		writeFilteredMatrix(matrix, keep_idx, keep, params);
+
+		std::cout << "Writing statistics file..." << std::endl;
+		writeStatisticsFile(total_count, mito_count, nonzero_features, keep, keep_idx, params);
+	}
+
+	void SCMatrixFilter::fillColumnStatistics(const SparseMatrix& matrix, const std::set<std::string>& mito_genes, std::vector<double>& total_count, std::vector<double>& mito_count,
 		                      std::vector<double>& nonzero_features, const FilterParams& params
 	){
-		std::ifstream reader(matrix);
-		std::vector<std::string> fields;
-		int row_count = 0;
-		
-		// parse header
-		std::string line;
-		std::getline(reader, line);
-		boost::split(col_names, line, boost::is_any_of("\t,"), boost::token_compress_on);
-		cols = col_names.size();
-		
-		total_count = std::vector<double>(cols, 0.0);
-		mito_count = std::vector<double>(cols, 0.0);
-		nonzero_features = std::vector<double>(cols, 0.0);
-		
-		while(std::getline(reader, line)){
-			boost::split(fields, line, boost::is_any_of("\t,"), boost::token_compress_on);
-			row_count++;
-			if(fields.empty()) continue;
-			
-			if(row_count % 500 == 0){
-				std::cout << "Inspecting row " << (row_count+1) << std::endl;
-			}
-			row_names.push_back(fields[0]);
-			auto it = mito_genes.find(fields[0]);
-			
-			size_t idx_col;
-			std::string name;
-			double v;
-			std::istringstream iss(line);
-			iss >> name;
-			for(size_t i=1; i < fields.size(); i++){
-				iss >> v;
-				idx_col = i-1;
-				total_count[idx_col] += v;
+		col_names = matrix.colNames();
+		row_names = matrix.rowNames();
+		cols = matrix.cols();
+
+		std::vector<char> is_mito(row_names.size());
+		for(size_t r = 0; r < row_names.size(); ++r) {
+			is_mito[r] = mito_genes.find(row_names[r]) != mito_genes.end();
+		}
+
+		total_count.assign(cols, 0.0);
+		mito_count.assign(cols, 0.0);
+		nonzero_features.assign(cols, 0.0);
+
+		// Implicit zeros neither contribute to the counts nor pass the
+		// nonzero threshold, so only the stored entries are visited.
+		const auto& m = matrix.matrix();
+		parallel_for(size_t(0), cols, [&](size_t j) {
+			for(SparseMatrix::SMatrix::InnerIterator it(m, j); it; ++it) {
+				const double v = it.value();
+				total_count[j] += v;
 				if(v > params.nonzero_threshold){
-					nonzero_features[idx_col]++;
+					nonzero_features[j]++;
 				}
-				if(it != mito_genes.end()) {
-					mito_count[idx_col] += v;
+				if(is_mito[it.row()]) {
+					mito_count[j] += v;
 				}
 			}
+		}, params.num_threads, size_t(256));
+	}
+
+	void SCMatrixFilter::fillColumnStatistics(const std::string& matrix, const std::set<std::string>& mito_genes, std::vector<double>& total_count, std::vector<double>& mito_count,
+		                      std::vector<double>& nonzero_features, std::vector<size_t>& nonzero_entries, const FilterParams& params
+	){
+		const unsigned int num_threads = params.num_threads == 0 ? default_num_threads() : params.num_threads;
+
+		LineChunkReader reader(matrix, params.chunk_size);
+		std::vector<Range> lines;
+		std::vector<Range> fields;
+
+		col_names.clear();
+		row_names.clear();
+		cols = 0;
+
+		// parse header
+		if(!reader.next(lines)) {
+			throw IOError("Matrix file " + matrix + " is empty");
+		}
+		tokenize(lines[0], fields);
+		for(const auto& f : fields) {
+			col_names.emplace_back(f.first, f.second);
+		}
+		cols = col_names.size();
+
+		// Every slice of a block accumulates into its own partial sums
+		std::vector<PartialStatistics> partial(num_threads, PartialStatistics(cols));
+
+		size_t first_line = 1;
+		do {
+			auto bounds = sliceBounds(lines.size() - first_line, num_threads);
+
+			parallel_for(size_t(0), bounds.size() - 1, [&](size_t s) {
+				PartialStatistics& stats = partial[s];
+				for(size_t l = first_line + bounds[s]; l < first_line + bounds[s + 1]; ++l) {
+					const Range& line = lines[l];
+					const char* p = std::find_if(line.first, line.second, isDelimiter);
+					stats.row_names.emplace_back(line.first, p);
+					const bool is_mito = mito_genes.find(stats.row_names.back()) != mito_genes.end();
+
+					for(size_t idx_col = 0; idx_col < cols; ++idx_col) {
+						while(p != line.second && isDelimiter(*p)) {
+							++p;
+						}
+						if(p == line.second) {
+							break;
+						}
+						const char* field_end = std::find_if(p, line.second, isDelimiter);
+						const double v = parseValue(Range(p, field_end));
+						p = field_end;
+
+						stats.total_count[idx_col] += v;
+						if(v > params.nonzero_threshold){
+							stats.nonzero_features[idx_col]++;
+						}
+						if(v != 0.0) {
+							stats.nonzero_entries[idx_col]++;
+						}
+						if(is_mito) {
+							stats.mito_count[idx_col] += v;
+						}
+					}
+				}
+			}, num_threads);
+
+			// Keep the row names in file order
+			for(auto& stats : partial) {
+				std::move(stats.row_names.begin(), stats.row_names.end(), std::back_inserter(row_names));
+				stats.row_names.clear();
+			}
+
+			std::cout << "Inspected " << row_names.size() << " rows" << std::endl;
+			first_line = 0;
+		} while(reader.next(lines));
+
+		total_count.assign(cols, 0.0);
+		mito_count.assign(cols, 0.0);
+		nonzero_features.assign(cols, 0.0);
+		nonzero_entries.assign(cols, 0);
+		for(const auto& stats : partial) {
+			for(size_t j = 0; j < cols; ++j) {
+				total_count[j] += stats.total_count[j];
+				mito_count[j] += stats.mito_count[j];
+				nonzero_features[j] += stats.nonzero_features[j];
+				nonzero_entries[j] += stats.nonzero_entries[j];
+			}
 		}
 	}
 	
@@ -116,39 +377,200 @@ namespace GeneTrail
 		return true;
 	}
 	
-	void SCMatrixFilter::writeFilteredMatrix(const std::string& matrix, const std::vector<size_t>& keep_idx, const FilterParams& params){
-		std::ifstream reader(matrix);
-		std::ofstream writer(params.out_matrix);
-		std::vector<std::string> fields;
-		std::string line;
-		int row_count = 0;
-		int col_offset = 0;
-		
+	void SCMatrixFilter::writeFilteredMatrix(const std::string& matrix, const std::vector<size_t>& keep_idx, const std::vector<std::string>& keep,
+	                                         const std::vector<size_t>& nonzero_entries, const FilterParams& params){
 		if(keep_idx.empty()) return;
-		
-		while(std::getline(reader, line)){
-			boost::split(fields, line, boost::is_any_of("\t,"), boost::token_compress_on);
-			row_count++;
-			
-			if(row_count % 1000 == 0){
-				std::cout << "Writing filtered row " << (row_count+1) << std::endl;
-			}
-			
-			// write row name if exists
-			if(row_count > 1){
-				writer << fields[0] << "\t";
-			}
-			// write remaining of the columns
-			writer << fields[keep_idx[0] + col_offset];
-			for(size_t i=1; i < keep_idx.size(); i++){
-				writer << "\t" << fields[keep_idx[i] + col_offset];
-			}
-			writer << std::endl;
-			
-			if(col_offset == 0) col_offset = 1;
+
+		const unsigned int num_threads = params.num_threads == 0 ? default_num_threads() : params.num_threads;
+		const bool write_text = !params.out_matrix.empty();
+		const bool write_sparse = !params.out_sparse_matrix.empty();
+
+		std::ofstream writer;
+		if(write_text) {
+			writer.open(params.out_matrix);
+			if(!writer) {
+				throw IOError("Could not open " + params.out_matrix + " for writing");
+			}
+		}
+
+		// The number of entries of every kept column is known from the first
+		// pass, so the CSC arrays can be filled in place.
+		using StorageIndex = SparseMatrix::SMatrix::StorageIndex;
+		SparseMatrix sparse(write_sparse ? row_names : std::vector<std::string>(), write_sparse ? keep : std::vector<std::string>());
+		std::vector<StorageIndex> cursor;
+		if(write_sparse) {
+			auto& m = sparse.matrix();
+			size_t nnz = 0;
+			for(size_t idx : keep_idx) {
+				nnz += nonzero_entries[idx];
+			}
+			m.resizeNonZeros(nnz);
+			StorageIndex* outer = m.outerIndexPtr();
+			outer[0] = 0;
+			for(size_t j = 0; j < keep_idx.size(); ++j) {
+				outer[j + 1] = outer[j] + nonzero_entries[keep_idx[j]];
+			}
+			cursor.assign(outer, outer + keep_idx.size());
+		}
+
+		struct Slice
+		{
+			std::vector<Range> fields;
+			std::string text;
+			std::vector<std::tuple<StorageIndex, StorageIndex, double>> entries;
+		};
+		std::vector<Slice> slices(num_threads);
+
+		LineChunkReader reader(matrix, params.chunk_size);
+		std::vector<Range> lines;
+		reader.next(lines);
+
+		// write the header
+		if(write_text) {
+			tokenize(lines[0], slices[0].fields);
+			const auto& fields = slices[0].fields;
+			for(size_t i=0; i < keep_idx.size(); i++){
+				writer << (i == 0 ? "" : "\t");
+				writer.write(fields[keep_idx[i]].first, fields[keep_idx[i]].second - fields[keep_idx[i]].first);
+			}
+			writer << '\n';
+		}
+
+		size_t first_line = 1;
+		size_t row = 0;
+		do {
+			auto bounds = sliceBounds(lines.size() - first_line, num_threads);
+
+			parallel_for(size_t(0), bounds.size() - 1, [&](size_t s) {
+				Slice& slice = slices[s];
+				slice.text.clear();
+				slice.entries.clear();
+				for(size_t l = bounds[s]; l < bounds[s + 1]; ++l) {
+					tokenize(lines[first_line + l], slice.fields);
+					const auto& fields = slice.fields;
+
+					if(write_text) {
+						slice.text.append(fields[0].first, fields[0].second);
+						for(size_t idx : keep_idx) {
+							slice.text += '\t';
+							if(idx + 1 < fields.size()) {
+								slice.text.append(fields[idx + 1].first, fields[idx + 1].second);
+							}
+						}
+						slice.text += '\n';
+					}
+
+					if(write_sparse) {
+						for(size_t j = 0; j < keep_idx.size(); ++j) {
+							if(keep_idx[j] + 1 >= fields.size()) {
+								break;
+							}
+							const double v = parseValue(fields[keep_idx[j] + 1]);
+							if(v != 0.0) {
+								slice.entries.emplace_back(StorageIndex(row + l), StorageIndex(j), v);
+							}
+						}
+					}
+				}
+			}, num_threads);
+
+			// Slices are processed in file order, thus the row indices of
+			// every column are increasing.
+			for(auto& slice : slices) {
+				if(write_text) {
+					writer << slice.text;
+				}
+				if(write_sparse) {
+					auto& m = sparse.matrix();
+					for(const auto& e : slice.entries) {
+						const StorageIndex pos = cursor[std::get<1>(e)]++;
+						m.innerIndexPtr()[pos] = std::get<0>(e);
+						m.valuePtr()[pos] = std::get<2>(e);
+					}
+				}
+				slice.text.clear();
+				slice.entries.clear();
+			}
+
+			row += lines.size() - first_line;
+			first_line = 0;
+		} while(reader.next(lines));
+
+		if(write_sparse) {
+			std::ofstream out(params.out_sparse_matrix, std::ios::binary);
+			if(!out) {
+				throw IOError("Could not open " + params.out_sparse_matrix + " for writing");
+			}
+			SparseMatrixWriter().writeBinary(out, sparse);
 		}
 	}
 	
+	void SCMatrixFilter::writeFilteredMatrix(const SparseMatrix& matrix, const std::vector<size_t>& keep_idx, const std::vector<std::string>& keep,
+	                                         const FilterParams& params){
+		if(keep_idx.empty()) return;
+
+		using SMatrix = SparseMatrix::SMatrix;
+		using StorageIndex = SMatrix::StorageIndex;
+
+		// Copy the kept columns into a new CSC matrix
+		const auto& m = matrix.matrix();
+		SparseMatrix sparse(row_names, keep);
+		auto& k = sparse.matrix();
+
+		StorageIndex* outer = k.outerIndexPtr();
+		outer[0] = 0;
+		for(size_t j = 0; j < keep_idx.size(); ++j) {
+			outer[j + 1] = outer[j] + m.col(keep_idx[j]).nonZeros();
+		}
+		k.resizeNonZeros(outer[keep_idx.size()]);
+
+		parallel_for(size_t(0), keep_idx.size(), [&](size_t j) {
+			StorageIndex pos = k.outerIndexPtr()[j];
+			for(SMatrix::InnerIterator it(m, keep_idx[j]); it; ++it, ++pos) {
+				k.innerIndexPtr()[pos] = it.row();
+				k.valuePtr()[pos] = it.value();
+			}
+		}, params.num_threads, size_t(256));
+
+		if(!params.out_matrix.empty()) {
+			std::ofstream writer(params.out_matrix);
+			if(!writer) {
+				throw IOError("Could not open " + params.out_matrix + " for writing");
+			}
+
+			for(size_t j = 0; j < keep.size(); ++j) {
+				writer << (j == 0 ? "" : "\t") << keep[j];
+			}
+			writer << '\n';
+
+			// Text matrices are stored row by row
+			using RowMajor = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+			const RowMajor rows(k);
+			for(size_t r = 0; r < row_names.size(); ++r) {
+				writer << row_names[r];
+				size_t next = 0;
+				for(RowMajor::InnerIterator it(rows, r); it; ++it, ++next) {
+					for(; next < size_t(it.col()); ++next) {
+						writer << "\t0";
+					}
+					writer << '\t' << it.value();
+				}
+				for(; next < keep.size(); ++next) {
+					writer << "\t0";
+				}
+				writer << '\n';
+			}
+		}
+
+		if(!params.out_sparse_matrix.empty()) {
+			std::ofstream out(params.out_sparse_matrix, std::ios::binary);
+			if(!out) {
+				throw IOError("Could not open " + params.out_sparse_matrix + " for writing");
+			}
+			SparseMatrixWriter().writeBinary(out, sparse);
+		}
+	}
+
 	void SCMatrixFilter::writeStatisticsFile(const std::vector<double>& total_count, const std::vector<double>& mito_count,
 											 const std::vector<double>& nonzero_features, const std::vector<std::string>& keep,
 											 const std::vector<size_t>& keep_idx, const FilterParams& params
@@ -34,6 +34,8 @@
 #include <limits>
 
 namespace GeneTrail{
+	class SparseMatrix;
+
 	struct GT2_EXPORT FilterParams{
 		double min_total_count = 0;
 		double max_total_count = std::numeric_limits<double>::max();
@@ -44,21 +46,46 @@ namespace GeneTrail{
 		std::string mito_genes = "";
 		
 		std::string out_matrix = "";
+		std::string out_sparse_matrix = "";
 		std::string out_statistics = "";
+
+		/// Number of threads used for parsing. 0 uses all available cores.
+		unsigned int num_threads = 0;
+		/// Size of the blocks in which the matrix file is read.
+		size_t chunk_size = 64 * 1024 * 1024;
 	};
 	
+	/**
+	 * Filters the cells (columns) of a single-cell count matrix stored as
+	 * text.
+	 *
+	 * The matrix is streamed twice in large blocks that are tokenized in
+	 * parallel. The first pass accumulates the column statistics, the second
+	 * pass writes the kept columns as text (out_matrix) and/or as a binary
+	 * sparse matrix in CSC layout (out_sparse_matrix). The matrix itself is
+	 * never held in memory as text.
+	 *
+	 * Matrices that are already available in sparse form can be filtered
+	 * directly. In this case, the column statistics are computed from the
+	 * stored entries only.
+	 */
 	class GT2_EXPORT SCMatrixFilter{
 	public:
 		SCMatrixFilter() = default;
 		
-		void filterMatrix(const std::string& matrix, std::set<std::string> mito_genes, const FilterParams& params);
+		void filterMatrix(const std::string& matrix, const std::set<std::string>& mito_genes, const FilterParams& params);
+		void filterMatrix(const SparseMatrix& matrix, const std::set<std::string>& mito_genes, const FilterParams& params);
 		
 	private:
-		void fillColumnStatistics(const std::string& matrix, std::set<std::string> mito_genes, std::vector<double>& total_count, std::vector<double>& mito_count,
+		void fillColumnStatistics(const std::string& matrix, const std::set<std::string>& mito_genes, std::vector<double>& total_count, std::vector<double>& mito_count,
+		                      std::vector<double>& nonzero_features, std::vector<size_t>& nonzero_entries, const FilterParams& params);
+		void fillColumnStatistics(const SparseMatrix& matrix, const std::set<std::string>& mito_genes, std::vector<double>& total_count, std::vector<double>& mito_count,
 		                      std::vector<double>& nonzero_features, const FilterParams& params);
 		bool passFilter(double total_count, double nonzero_features, double mito_count, const FilterParams& params);
-		void writeFilteredMatrix(const std::string& matrix, const std::vector<size_t>& keep_idx, const FilterParams& params);
-		void writeFiles(const std::string& sampleOutDirs, const std::string& matrixOutFiles);
+		void writeFilteredMatrix(const std::string& matrix, const std::vector<size_t>& keep_idx, const std::vector<std::string>& keep,
+		                         const std::vector<size_t>& nonzero_entries, const FilterParams& params);
+		void writeFilteredMatrix(const SparseMatrix& matrix, const std::vector<size_t>& keep_idx, const std::vector<std::string>& keep,
+		                         const FilterParams& params);
 		void writeStatisticsFile(const std::vector<double>& total_count, const std::vector<double>& mito_count,
 											 const std::vector<double>& nonzero_features, const std::vector<std::string>& keep,
 											 const std::vector<size_t>& keep_idx, const FilterParams& params);
@@ -73,5 +100,4 @@ namespace GeneTrail{
 	};
 }
 
-#endif //GT2_DENSE_MATRIX_READER_H
-
+#endif //GT2_SC_MATRIX_FILTER_H
@@ -116,6 +116,13 @@ namespace GeneTrail
 		data_.reserve(size);
 	}
 
+	Category Scores::toCategory(const std::string& name) const
+	{
+		Category res(db_.get(), indices().begin(), indices().end());
+		res.setName(name);
+		return res;
+	}
+
 	Scores Scores::subset(const Category& c) const
 	{
 		if(isSortedByIndex_) {
@@ -250,9 +257,7 @@ namespace GeneTrail
 
 	bool Scores::contains(const std::string& name) const
 	{
-		// TODO: This might be replaced with heterogenous lookup from
-		//      C++14
-		return contains(Score(*db_, name, 0.0));
+		return contains(Score(db_->index(name), 0.0));
 	}
 
 	bool Scores::contains(const Score& score) const
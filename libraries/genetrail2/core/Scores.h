@@ -43,7 +43,7 @@ namespace GeneTrail
 	class GT2_EXPORT Score
 	{
 		public:
-		Score(EntityDatabase& db, const std::string& n, double s) : entity_(db(n)), score_(s), db_(db) {}
+		Score(EntityDatabase& db, const std::string& n, double s) : entity_(db(n)), score_(s) {}
 		Score(size_t i, double s) : entity_(i), score_(s) {}
 
 		const std::string& name(const EntityDatabase& db) const { return db(entity_); }
@@ -55,7 +55,6 @@ namespace GeneTrail
 		private:
 		size_t entity_;
 		double score_;
-		EntityDatabase db_;
 	};
 
 	class GT2_EXPORT Scores
@@ -252,6 +251,13 @@ namespace GeneTrail
 		Scores subset(const Category& c) const;
 		std::vector<size_t> subsetIndices(const Category& c) const;
 
+		/**
+		 * Creates a category of all entities that have a score.
+		 *
+		 * @param name Name of the created category
+		 */
+		Category toCategory(const std::string& name = "") const;
+
 		const Score& set(size_t i, const Score& s) {
 			isSortedByIndex_ = false;
 			data_[i] = s;
@@ -0,0 +1,151 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "SparseMatrixHTest.h"
+
+#include "EntityDatabase.h"
+#include "Exception.h"
+#include "SparseMatrix.h"
+#include "misc_algorithms.h"
+
+#include <cmath>
+#include <memory>
+
+namespace GeneTrail
+{
+	void SparseMatrixHTest::setNumberOfThreads(unsigned int num_threads)
+	{
+		num_threads_ = num_threads;
+	}
+
+	bool SparseMatrixHTest::supports(MatrixHTests method)
+	{
+		switch(method) {
+			case MatrixHTests::IndependentTTest:
+			case MatrixHTests::LogMeanFoldQuotient:
+			case MatrixHTests::MeanFoldQuotient:
+			case MatrixHTests::MeanFoldDifference:
+			case MatrixHTests::MeanFirstGroup:
+			case MatrixHTests::MeanLargerZero:
+			case MatrixHTests::LargerZero:
+			case MatrixHTests::MeanFirstLargerZero:
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	bool SparseMatrixHTest::supports(const std::string& method) const
+	{
+		auto id = factory_.getMethod(method);
+		return id && supports(id.get());
+	}
+
+	double SparseMatrixHTest::score(MatrixHTests method, const GroupMoments& fst,
+	                                const GroupMoments& snd)
+	{
+		switch(method) {
+			case MatrixHTests::IndependentTTest: {
+				// Same tolerance as the default of IndependentTTest
+				const double std_err =
+				    std::sqrt(fst.var() / fst.size + snd.var() / snd.size);
+				if(std_err < 1e-5) {
+					return 0.0;
+				}
+				return (fst.mean() - snd.mean()) / std_err;
+			}
+			case MatrixHTests::LogMeanFoldQuotient:
+				return std::log(fst.mean()) - std::log(snd.mean());
+			case MatrixHTests::MeanFoldQuotient:
+				return fst.mean() / snd.mean();
+			case MatrixHTests::MeanFoldDifference:
+				return fst.mean() - snd.mean();
+			case MatrixHTests::MeanFirstGroup:
+				return fst.mean();
+			case MatrixHTests::MeanLargerZero:
+				return fst.meanPositive() - snd.meanPositive();
+			case MatrixHTests::LargerZero:
+				return fst.positive;
+			case MatrixHTests::MeanFirstLargerZero:
+				return fst.meanPositive();
+			default:
+				throw NotImplemented(__FILE__, __LINE__,
+				                     "Sparse score computation for this method");
+		}
+	}
+
+	Scores SparseMatrixHTest::test(const std::string& method,
+	                               const SparseMatrix& matrix,
+	                               const std::vector<unsigned int>& ref,
+	                               const std::vector<unsigned int>& sam) const
+	{
+		const MatrixHTests id = factory_.getDescriptor(method).id;
+		if(!supports(id)) {
+			throw NotImplemented(__FILE__, __LINE__,
+			                     method + " for sparse matrices");
+		}
+
+		const size_t NO_GROUP = SparseGroupMoments::NO_GROUP;
+
+		std::vector<size_t> groups(matrix.cols(), NO_GROUP);
+		for(auto j : ref) {
+			groups[j] = 0;
+		}
+
+		bool overlap = false;
+		for(auto j : sam) {
+			overlap = overlap || groups[j] == 0;
+			groups[j] = 1;
+		}
+
+		std::vector<double> values(matrix.rows());
+
+		if(!overlap) {
+			SparseGroupMoments moments(matrix, groups, 2, num_threads_);
+			parallel_for(size_t(0), values.size(), [&](size_t r) {
+				values[r] = score(id, moments(r, 0), moments(r, 1));
+			}, num_threads_, size_t(1024));
+		} else {
+			// A column may belong to both groups. Collect the moments
+			// of each group in a separate pass.
+			std::vector<size_t> ref_groups(matrix.cols(), NO_GROUP);
+			for(auto j : ref) {
+				ref_groups[j] = 0;
+			}
+
+			std::vector<size_t> sam_groups(matrix.cols(), NO_GROUP);
+			for(auto j : sam) {
+				sam_groups[j] = 0;
+			}
+
+			SparseGroupMoments ref_moments(matrix, ref_groups, 1, num_threads_);
+			SparseGroupMoments sam_moments(matrix, sam_groups, 1, num_threads_);
+			parallel_for(size_t(0), values.size(), [&](size_t r) {
+				values[r] = score(id, ref_moments(r, 0), sam_moments(r, 0));
+			}, num_threads_, size_t(1024));
+		}
+
+		auto db = std::make_shared<EntityDatabase>();
+		Scores scores(matrix.rows(), db);
+		for(size_t r = 0; r < values.size(); ++r) {
+			scores.emplace_back(matrix.rowName(r), values[r]);
+		}
+
+		return scores;
+	}
+}
@@ -0,0 +1,95 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_CORE_SPARSE_MATRIX_HTEST_H
+#define GT2_CORE_SPARSE_MATRIX_HTEST_H
+
+#include "macros.h"
+#include "MatrixHTest.h"
+#include "Scores.h"
+#include "SparseMatrixTools.h"
+
+#include <string>
+#include <vector>
+
+namespace GeneTrail
+{
+	class SparseMatrix;
+
+	/**
+	 * Row-wise scores for two groups of columns of a sparse matrix.
+	 *
+	 * In contrast to MatrixHTest, the values of a row are never
+	 * materialized. Instead, all scores are computed from the GroupMoments
+	 * of the two groups, which are collected in a single pass over the
+	 * stored entries of the matrix. Consequently, only methods that can be
+	 * expressed in terms of these moments are supported:
+	 * independent-t-test, log-mean-fold-quotient, mean-fold-quotient,
+	 * mean-fold-difference, mean-first-group, mean-larger-zero, larger-zero
+	 * and mean-first-larger-zero. The results agree with MatrixHTest on the
+	 * corresponding dense matrix up to floating point rounding.
+	 */
+	class GT2_EXPORT SparseMatrixHTest
+	{
+		public:
+		/**
+		 * Sets the number of threads. 0 uses all available cores.
+		 */
+		void setNumberOfThreads(unsigned int num_threads);
+
+		/**
+		 * Returns true if method can be computed from GroupMoments.
+		 */
+		static bool supports(MatrixHTests method);
+
+		/**
+		 * Returns true if method is known and can be computed from
+		 * GroupMoments.
+		 */
+		bool supports(const std::string& method) const;
+
+		/**
+		 * Computes the score of method for a row from the moments of the
+		 * first (e.g. reference) and the second group.
+		 *
+		 * @throws NotImplemented if the method is not supported.
+		 */
+		static double score(MatrixHTests method, const GroupMoments& fst,
+		                    const GroupMoments& snd);
+
+		/**
+		 * Scores every row of the matrix.
+		 *
+		 * @param method The name of the method as used by MatrixHTest.
+		 * @param ref The column indices of the reference (first) group.
+		 * @param sam The column indices of the sample (second) group.
+		 *
+		 * @throws std::invalid_argument if the method is unknown.
+		 * @throws NotImplemented if the method is not supported.
+		 */
+		Scores test(const std::string& method, const SparseMatrix& matrix,
+		            const std::vector<unsigned int>& ref,
+		            const std::vector<unsigned int>& sam) const;
+
+		private:
+		MatrixHTestFactory factory_;
+		unsigned int num_threads_ = 0;
+	};
+}
+
+#endif // GT2_CORE_SPARSE_MATRIX_HTEST_H
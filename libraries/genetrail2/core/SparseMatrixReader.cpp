@@ -143,7 +143,7 @@ namespace GeneTrail
 	void SparseMatrixReader::readInnerData_(std::istream& input, SparseMatrix& result, uint64_t chunk_size) const
 	{
 		uint64_t bytes_read = 0;
-		result.matrix().resizeNonZeros(chunk_size / sizeof(SparseMatrix::SMatrix::Index));
+		result.matrix().resizeNonZeros(chunk_size / sizeof(SparseMatrix::SMatrix::StorageIndex));
 
 		// As the internal storage format of matrix is column major this is quite efficient...
 		input.read(reinterpret_cast<char*>(result.matrix().innerIndexPtr()), chunk_size);
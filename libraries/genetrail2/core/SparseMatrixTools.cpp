@@ -0,0 +1,219 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "SparseMatrixTools.h"
+
+#include "SparseMatrix.h"
+#include "misc_algorithms.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace GeneTrail
+{
+	namespace
+	{
+		using SMatrix = SparseMatrix::SMatrix;
+
+		// Returns a compressed version of m, using tmp as storage if m
+		// has to be copied.
+		const SMatrix& compressed(const SMatrix& m, SMatrix& tmp)
+		{
+			if(m.isCompressed()) {
+				return m;
+			}
+
+			tmp = m;
+			tmp.makeCompressed();
+			return tmp;
+		}
+
+		// Applies f to the values of every column
+		template <typename Func>
+		void transformColumns(SMatrix& m, unsigned int num_threads, Func f)
+		{
+			m.makeCompressed();
+
+			const auto* outer = m.outerIndexPtr();
+			double* values = m.valuePtr();
+
+			parallel_for(size_t(0), size_t(m.outerSize()), [&](size_t j) {
+				f(j, values + outer[j], values + outer[j + 1]);
+			}, num_threads, size_t(256));
+		}
+	}
+
+	const size_t SparseGroupMoments::NO_GROUP = std::numeric_limits<size_t>::max();
+
+	double GroupMoments::var() const
+	{
+		if(size <= 1.0) {
+			return 0.0;
+		}
+
+		return std::max(0.0, (sum_sq - sum * sum / size) / (size - 1.0));
+	}
+
+	double GroupMoments::meanPositive() const
+	{
+		return positive == 0.0 ? 0.0 : positive_sum / positive;
+	}
+
+	GroupMoments& GroupMoments::operator-=(const GroupMoments& other)
+	{
+		size -= other.size;
+		sum -= other.sum;
+		sum_sq -= other.sum_sq;
+		positive -= other.positive;
+		positive_sum -= other.positive_sum;
+
+		return *this;
+	}
+
+	SparseGroupMoments::SparseGroupMoments(const SparseMatrix& matrix,
+	                                       const std::vector<size_t>& groups,
+	                                       size_t num_groups,
+	                                       unsigned int num_threads)
+	    : sizes_(num_groups, 0.0),
+	      sum_(Eigen::MatrixXd::Zero(matrix.rows(), num_groups)),
+	      sum_sq_(Eigen::MatrixXd::Zero(matrix.rows(), num_groups)),
+	      positive_(Eigen::MatrixXd::Zero(matrix.rows(), num_groups)),
+	      positive_sum_(Eigen::MatrixXd::Zero(matrix.rows(), num_groups))
+	{
+		assert(groups.size() == matrix.cols());
+
+		for(size_t g : groups) {
+			if(g != NO_GROUP) {
+				assert(g < num_groups);
+				sizes_[g] += 1.0;
+			}
+		}
+
+		const size_t rows = matrix.rows();
+		if(rows == 0) {
+			return;
+		}
+
+		SMatrix tmp;
+		const SMatrix& m = compressed(matrix.matrix(), tmp);
+		const auto* outer = m.outerIndexPtr();
+		const auto* inner = m.innerIndexPtr();
+		const double* values = m.valuePtr();
+
+		if(num_threads == 0) {
+			num_threads = default_num_threads();
+		}
+
+		const size_t num_blocks = std::min(rows, 4 * size_t(num_threads));
+
+		parallel_for(size_t(0), num_blocks, [&](size_t b) {
+			const auto first_row = static_cast<SMatrix::StorageIndex>(b * rows / num_blocks);
+			const auto last_row = static_cast<SMatrix::StorageIndex>((b + 1) * rows / num_blocks);
+
+			for(size_t j = 0; j < groups.size(); ++j) {
+				const size_t g = groups[j];
+				if(g == NO_GROUP) {
+					continue;
+				}
+
+				const auto* end = inner + outer[j + 1];
+				const auto* it = std::lower_bound(inner + outer[j], end, first_row);
+
+				for(; it != end && *it < last_row; ++it) {
+					const double v = values[it - inner];
+					sum_(*it, g) += v;
+					sum_sq_(*it, g) += v * v;
+
+					if(v > 0.0) {
+						positive_(*it, g) += 1.0;
+						positive_sum_(*it, g) += v;
+					}
+				}
+			}
+		}, num_threads);
+	}
+
+	GroupMoments SparseGroupMoments::operator()(size_t r, size_t g) const
+	{
+		GroupMoments result;
+		result.size = sizes_[g];
+		result.sum = sum_(r, g);
+		result.sum_sq = sum_sq_(r, g);
+		result.positive = positive_(r, g);
+		result.positive_sum = positive_sum_(r, g);
+
+		return result;
+	}
+
+	GroupMoments SparseGroupMoments::total(size_t r) const
+	{
+		GroupMoments result;
+		for(size_t g = 0; g < sizes_.size(); ++g) {
+			result.size += sizes_[g];
+			result.sum += sum_(r, g);
+			result.sum_sq += sum_sq_(r, g);
+			result.positive += positive_(r, g);
+			result.positive_sum += positive_sum_(r, g);
+		}
+
+		return result;
+	}
+
+	void SparseMatrixTools::setNumberOfThreads(unsigned int num_threads)
+	{
+		num_threads_ = num_threads;
+	}
+
+	std::vector<double> SparseMatrixTools::columnSums(const SparseMatrix& matrix) const
+	{
+		SMatrix tmp;
+		const SMatrix& m = compressed(matrix.matrix(), tmp);
+		const auto* outer = m.outerIndexPtr();
+		const double* values = m.valuePtr();
+
+		std::vector<double> result(m.outerSize(), 0.0);
+		parallel_for(size_t(0), result.size(), [&](size_t j) {
+			result[j] = std::accumulate(values + outer[j], values + outer[j + 1], 0.0);
+		}, num_threads_, size_t(256));
+
+		return result;
+	}
+
+	void SparseMatrixTools::normalizeLibrarySize(SparseMatrix& matrix, double scale) const
+	{
+		transformColumns(matrix.matrix(), num_threads_, [scale](size_t, double* begin, double* end) {
+			const double total = std::accumulate(begin, end, 0.0);
+			if(total == 0.0) {
+				return;
+			}
+
+			const double factor = scale / total;
+			std::for_each(begin, end, [factor](double& x) { x *= factor; });
+		});
+	}
+
+	void SparseMatrixTools::log1p(SparseMatrix& matrix) const
+	{
+		transformColumns(matrix.matrix(), num_threads_, [](size_t, double* begin, double* end) {
+			std::for_each(begin, end, [](double& x) { x = std::log1p(x); });
+		});
+	}
+}
@@ -0,0 +1,135 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_CORE_SPARSE_MATRIX_TOOLS_H
+#define GT2_CORE_SPARSE_MATRIX_TOOLS_H
+
+#include "macros.h"
+
+#include <Eigen/Core>
+
+#include <vector>
+
+namespace GeneTrail
+{
+	class SparseMatrix;
+
+	/**
+	 * The moments of the values of a matrix row within a group of
+	 * columns. Zeros do not contribute to any sum, so entries that are not
+	 * stored in a sparse matrix are only accounted for by the group size.
+	 */
+	struct GT2_EXPORT GroupMoments
+	{
+		double size = 0.0;
+		double sum = 0.0;
+		double sum_sq = 0.0;
+		/// Number and sum of the values larger than zero.
+		double positive = 0.0;
+		double positive_sum = 0.0;
+
+		double mean() const { return sum / size; }
+
+		/// Sample variance. As in statistic::mean_var_size, groups with
+		/// less than two values have a variance of zero.
+		double var() const;
+
+		/// Mean of the values larger than zero or zero if there are none.
+		double meanPositive() const;
+
+		GroupMoments& operator-=(const GroupMoments& other);
+	};
+
+	/**
+	 * Computes the GroupMoments of every row of a sparse matrix for a
+	 * partition of its columns in a single pass over the stored entries.
+	 *
+	 * The rows are split into blocks that are processed in parallel. Every
+	 * block locates its first row in each column by binary search, so no
+	 * thread-local accumulators have to be merged.
+	 */
+	class GT2_EXPORT SparseGroupMoments
+	{
+		public:
+		/// Marks columns that do not belong to any group.
+		static const size_t NO_GROUP;
+
+		/**
+		 * @param matrix The matrix.
+		 * @param groups The group of every column or NO_GROUP.
+		 * @param num_groups The number of groups.
+		 * @param num_threads The number of threads. 0 uses all cores.
+		 */
+		SparseGroupMoments(const SparseMatrix& matrix,
+		                   const std::vector<size_t>& groups, size_t num_groups,
+		                   unsigned int num_threads = 0);
+
+		size_t rows() const { return sum_.rows(); }
+		size_t numberOfGroups() const { return sizes_.size(); }
+
+		GroupMoments operator()(size_t r, size_t g) const;
+
+		/// The moments of all columns that belong to some group.
+		GroupMoments total(size_t r) const;
+
+		private:
+		std::vector<double> sizes_;
+		Eigen::MatrixXd sum_;
+		Eigen::MatrixXd sum_sq_;
+		Eigen::MatrixXd positive_;
+		Eigen::MatrixXd positive_sum_;
+	};
+
+	/**
+	 * Preprocessing of sparse (e.g. single-cell) count matrices. All
+	 * transformations only touch the stored entries and keep the sparsity
+	 * pattern intact.
+	 */
+	class GT2_EXPORT SparseMatrixTools
+	{
+		public:
+		SparseMatrixTools() = default;
+
+		/**
+		 * Sets the number of threads. 0 uses all available cores.
+		 */
+		void setNumberOfThreads(unsigned int num_threads);
+
+		/**
+		 * Returns the sum of every column.
+		 */
+		std::vector<double> columnSums(const SparseMatrix& matrix) const;
+
+		/**
+		 * Scales every column such that it sums up to scale. Empty columns
+		 * are left untouched.
+		 */
+		void normalizeLibrarySize(SparseMatrix& matrix, double scale = 1e4) const;
+
+		/**
+		 * Replaces every entry x by log(1 + x). As log1p(0) = 0, only the
+		 * stored entries need to be transformed.
+		 */
+		void log1p(SparseMatrix& matrix) const;
+
+		private:
+		unsigned int num_threads_ = 0;
+	};
+}
+
+#endif // GT2_CORE_SPARSE_MATRIX_TOOLS_H
@@ -70,14 +70,14 @@ namespace GeneTrail
 		total += n;
 
 		// Write outer indices
-		n = (matrix.matrix().outerSize() + 1) * sizeof(SparseMatrix::SMatrix::Index);
+		n = (matrix.matrix().outerSize() + 1) * sizeof(SparseMatrix::SMatrix::StorageIndex);
 		total += writeChunkHeader_(output, 0x3, n);
 		output.write(reinterpret_cast<const char*>(matrix.matrix().outerIndexPtr()), n);
 		total += n;
 
 		// Write inner indices
-		n = matrix.matrix().nonZeros() * sizeof(SparseMatrix::SMatrix::Index);
-		writeChunkHeader_(output, 0x4, n);
+		n = matrix.matrix().nonZeros() * sizeof(SparseMatrix::SMatrix::StorageIndex);
+		total += writeChunkHeader_(output, 0x4, n);
 		output.write(reinterpret_cast<const char*>(matrix.matrix().innerIndexPtr()), n);
 		total += n;
 
@@ -29,7 +29,10 @@
 #include <boost/math/distributions/normal.hpp>
 #include <boost/numeric/conversion/cast.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <numeric>
+#include <vector>
 
 namespace GeneTrail
 {
@@ -57,6 +60,60 @@ template <typename ValueType> class GT2_EXPORT WilcoxonRankSumTest
 		return n;
 	}
 
+	/**
+	 * Computes the ranks of the values in [begin, end). The smallest value
+	 * receives rank 1, tied values receive the average of their ranks.
+	 * The ranks are returned in input order.
+	 *
+	 * @param begin Iterator (begin) of the values
+	 * @param end Iterator (end) of the values
+	 * @return The tie-averaged rank of every value
+	 */
+	template <typename Iterator>
+	static std::vector<value_type> tiedRanks(Iterator begin, Iterator end)
+	{
+		std::vector<value_type> values(begin, end);
+		std::vector<size_t> order(values.size());
+		std::iota(order.begin(), order.end(), static_cast<size_t>(0));
+		std::sort(order.begin(), order.end(), [&values](size_t a, size_t b) {
+			return values[a] < values[b];
+		});
+
+		std::vector<value_type> ranks(values.size());
+
+		// Every run of tied values is visited exactly once
+		size_t i = 0;
+		while(i < order.size()) {
+			size_t j = i + 1;
+			while(j < order.size() && values[order[j]] == values[order[i]]) {
+				++j;
+			}
+
+			const value_type rank = (value_type)(i + 1 + j) / (value_type)2.0;
+			for(size_t l = i; l < j; ++l) {
+				ranks[order[l]] = rank;
+			}
+
+			i = j;
+		}
+
+		return ranks;
+	}
+
+	/**
+	 * Computes the Z-score for a precomputed rank sum.
+	 *
+	 * @param rank_sum Sum of the ranks of the test set
+	 * @param size1 Size of the test set
+	 * @param size2 Size of the reference set
+	 * @return The Z-score for the given rank sum.
+	 */
+	value_type computeZScoreFromRankSum(value_type rank_sum, size_t size1,
+	                                    size_t size2)
+	{
+		return score_ = computeZScore_(rank_sum, size1, size2);
+	}
+
 	value_type computeZScore_(value_type rank_sum, value_type size1,
 	                          value_type size2)
 	{
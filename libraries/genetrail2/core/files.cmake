@@ -49,9 +49,13 @@ add_header_to_library(SCMatrixFilter.h)
 add_to_library(AbstractMatrix)
 add_to_library(BoostGraphProcessor)
 add_to_library(Category)
+add_to_library(CompressedGraph)
 add_to_library(CategoryDatabase)
+add_to_library(CompiledCategoryDatabase)
+add_to_library(CompiledCategoryFile)
 add_to_library(DenseColumnSubset)
 add_to_library(DenseMatrix)
+add_to_library(DenseMatrixBlockReader)
 add_to_library(DenseMatrixReader)
 add_to_library(DenseMatrixWriter)
 add_to_library(DenseRowSubset)
@@ -67,12 +71,16 @@ add_to_library(GEO)
 add_to_library(GEOGDSParser)
 add_to_library(GEOGPLParser)
 add_to_library(GEOGSEParser)
+add_to_library(GEOSoftParser)
 add_to_library(GMTFile)
+add_to_library(GraphicalLasso)
 add_to_library(JsonCategoryFile)
 add_to_library(MatrixHTest)
 add_to_library(MatrixWriter)
 add_to_library(Metadata)
 add_to_library(misc_algorithms)
+add_to_library(NAHandler)
+add_to_library(NameIndex)
 add_to_library(Path)
 add_to_library(Pathfinder)
 add_to_library(PValue)
@@ -81,6 +89,8 @@ add_to_library(Scores)
 add_to_library(SparseMatrix)
 add_to_library(SparseMatrixReader)
 add_to_library(SparseMatrixWriter)
+add_to_library(SparseMatrixTools)
+add_to_library(SparseMatrixHTest)
 add_to_library(OverRepresentationAnalysis)
 add_to_library(TextFile)
 add_to_library(MetadataReader)
@@ -23,7 +23,11 @@
 #include "macros.h"
 
 #include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
 #include <numeric>
+#include <thread>
 #include <vector>
 
 namespace GeneTrail
@@ -91,6 +95,145 @@ void partial_shuffle(RandomAccessIterator first, RandomAccessIterator until,
 
 		return p;
 	}
+
+	/**
+	 * Returns the number of worker threads that should be used if the
+	 * caller did not request a specific number.
+	 */
+	inline unsigned int default_num_threads()
+	{
+		return std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	/**
+	 * Calls f(i) for every i in [first, last) using a pool of worker
+	 * threads. The indices are handed out in blocks of size grain_size,
+	 * so f must be safe to call concurrently for distinct indices.
+	 *
+	 * If one of the calls throws, the remaining blocks are skipped and the
+	 * first exception is rethrown in the calling thread.
+	 *
+	 * @param first       First index to process
+	 * @param last        One past the last index to process
+	 * @param f           Function that is called for every index
+	 * @param num_threads Number of threads. 0 selects default_num_threads()
+	 * @param grain_size  Number of consecutive indices processed per block
+	 */
+	template <typename Index, typename Function>
+	void parallel_for(Index first, Index last, Function&& f,
+	                  unsigned int num_threads = 0, Index grain_size = 1)
+	{
+		if(last <= first) {
+			return;
+		}
+
+		grain_size = std::max(grain_size, Index(1));
+		const Index num_blocks = (last - first + grain_size - 1) / grain_size;
+
+		if(num_threads == 0) {
+			num_threads = default_num_threads();
+		}
+
+		if(num_threads == 1 || num_blocks == 1) {
+			for(Index i = first; i < last; ++i) {
+				f(i);
+			}
+			return;
+		}
+
+		std::atomic<Index> next_block(0);
+		std::exception_ptr error;
+		std::mutex error_mutex;
+
+		auto worker = [&]() {
+			for(Index b = next_block++; b < num_blocks; b = next_block++) {
+				const Index begin = first + b * grain_size;
+				const Index end = std::min(last, begin + grain_size);
+				try {
+					for(Index i = begin; i < end; ++i) {
+						f(i);
+					}
+				} catch(...) {
+					std::lock_guard<std::mutex> lock(error_mutex);
+					if(!error) {
+						error = std::current_exception();
+					}
+					next_block = num_blocks;
+				}
+			}
+		};
+
+		const auto n = std::min<Index>(num_threads, num_blocks);
+		std::vector<std::thread> threads;
+		threads.reserve(n - 1);
+		for(Index t = 1; t < n; ++t) {
+			threads.emplace_back(worker);
+		}
+
+		worker();
+
+		for(auto& t : threads) {
+			t.join();
+		}
+
+		if(error) {
+			std::rethrow_exception(error);
+		}
+	}
+
+	/**
+	 * Sorts [first, last) using a pool of worker threads. The range is
+	 * split into one chunk per thread, the chunks are sorted concurrently
+	 * and then merged pairwise, where all merges of a level run
+	 * concurrently. Ranges with less than 2 * min_chunk elements are
+	 * sorted sequentially. As std::sort, the sort is not stable.
+	 *
+	 * @param num_threads Number of threads. 0 selects default_num_threads()
+	 * @param min_chunk   Minimal number of elements sorted by one thread
+	 */
+	template <typename RandomAccessIterator, typename Compare>
+	void parallel_sort(RandomAccessIterator first, RandomAccessIterator last,
+	                   Compare comp, unsigned int num_threads = 0,
+	                   size_t min_chunk = size_t(1) << 15)
+	{
+		const size_t n = last - first;
+
+		if(num_threads == 0) {
+			num_threads = default_num_threads();
+		}
+
+		const size_t num_chunks =
+		    std::min<size_t>(num_threads, n / std::max(min_chunk, size_t(1)));
+
+		if(num_chunks <= 1) {
+			std::sort(first, last, comp);
+			return;
+		}
+
+		std::vector<size_t> bounds(num_chunks + 1);
+		for(size_t i = 0; i <= num_chunks; ++i) {
+			bounds[i] = i * n / num_chunks;
+		}
+
+		parallel_for(size_t(0), num_chunks, [&](size_t i) {
+			std::sort(first + bounds[i], first + bounds[i + 1], comp);
+		}, num_threads);
+
+		for(size_t width = 1; width < num_chunks; width *= 2) {
+			const size_t num_merges = (num_chunks + 2 * width - 1) / (2 * width);
+
+			parallel_for(size_t(0), num_merges, [&](size_t m) {
+				const size_t lo = 2 * m * width;
+				const size_t mid = std::min(lo + width, num_chunks);
+				const size_t hi = std::min(lo + 2 * width, num_chunks);
+
+				if(mid < hi) {
+					std::inplace_merge(first + bounds[lo], first + bounds[mid],
+					                   first + bounds[hi], comp);
+				}
+			}, num_threads);
+		}
+	}
 }
 
 #endif // GT2_MISC_ALGORITHMS_H
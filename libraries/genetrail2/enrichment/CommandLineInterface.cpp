@@ -49,6 +49,7 @@ namespace GeneTrail {
 			("just_pvalues",    value(&p.justPvalues)->default_value(false)->zero_tokens(), "If provided, only print the category name and the pvalues. Default: false")
 			("include_all,i",    value(&p.includeAll)->default_value(false)->zero_tokens(), "If provided, all categories from the desired category database are included in the output. If not provided, categories that are filtered due to their size are ignored in the output. Default: false")
 			("output,o",       value(&p.out_)->required(), "Output prefix for text files.")
+			("binary_output",  value(&p.binaryOutput)->default_value(false)->zero_tokens(), "If provided, the results of every database are written in a compact binary format instead of text. Default: false")
 			("adjustment,a",   value(&p.adjustment)->default_value(boost::none, "none"), "P-value adjustment method for multiple testing.")
 			("adjust_separately,u", value(&p.adjustSeparately)->default_value(false)->zero_tokens(), "Indicates if databases are adjusted separatly or combined.")
 			("pvalue_strategy,l",   value(&p.pValueMode)->default_value(PValueMode::RowWise, "row-wise"), "How should p-values be computed. Possible choices are 'row-wise', 'column-wise', and 'restandardize'")
@@ -27,6 +27,7 @@
 #include <genetrail2/core/macros.h>
 
 #include <memory>
+#include <vector>
 
 namespace GeneTrail
 {
@@ -44,6 +45,7 @@ namespace GeneTrail
 		virtual bool canUseCategory(const Category& c, size_t hits) const = 0;
 		virtual bool rowWisePValueIsDirect() const = 0;
 		virtual bool supportsIndices() const = 0;
+		virtual bool supportsPrefixScores() const = 0;
 		virtual Order getOrder() const = 0;
 
 		virtual void setScores(const Scores& scores) = 0;
@@ -51,12 +53,31 @@ namespace GeneTrail
 		virtual std::unique_ptr<EnrichmentResult>
 		computeEnrichment(const std::shared_ptr<Category>& c) = 0;
 
+		/**
+		 * Computes the enrichment of all categories. If the statistic is
+		 * thread-safe (StatTags::Concurrent), the categories are evaluated
+		 * in parallel using num_threads threads, where 0 uses all available
+		 * cores. The results are in the order of the categories.
+		 */
+		virtual std::vector<std::unique_ptr<EnrichmentResult>>
+		computeEnrichments(const std::vector<std::shared_ptr<Category>>& categories,
+		                   unsigned int num_threads) = 0;
+
 		virtual std::tuple<double, double>
 		computeEnrichmentScore(const Category& c) = 0;
 
 		virtual std::tuple<double, double>
 		computeEnrichmentScore(IndexIterator begin, IndexIterator end) = 0;
 
+		/**
+		 * Computes the enrichment scores of the first sizes[i] indices
+		 * starting at begin for all i. The sizes must be sorted
+		 * increasingly. Only available if supportsPrefixScores() is true.
+		 */
+		virtual void computePrefixScores(IndexIterator begin,
+		                                 const std::vector<size_t>& sizes,
+		                                 std::vector<double>& scores) = 0;
+
 		private:
 		PValueMode mode_;
 	};
@@ -100,6 +121,15 @@ namespace GeneTrail
 				    typename Statistics::SupportsIndices(), begin, end);
 			}
 
+			void computePrefixScores(IndexIterator begin,
+			                         const std::vector<size_t>& sizes,
+			                         std::vector<double>& scores) override
+			{
+				computePrefixScoresDispatch_(
+				    typename Statistics::SupportsIndices(), begin, sizes,
+				    scores);
+			}
+
 			std::unique_ptr<EnrichmentResult>
 			computeEnrichment(const std::shared_ptr<Category>& c) override
 			{
@@ -115,6 +145,16 @@ namespace GeneTrail
 				return result;
 			}
 
+			std::vector<std::unique_ptr<EnrichmentResult>> computeEnrichments(
+			    const std::vector<std::shared_ptr<Category>>& categories,
+			    unsigned int num_threads) override
+			{
+				std::vector<std::unique_ptr<EnrichmentResult>> results(categories.size());
+				computeEnrichmentsDispatch_(categories, results, num_threads,
+				                            typename Statistics::ConcurrencyType());
+				return results;
+			}
+
 			bool rowWisePValueIsDirect() const override
 			{
 				return rowWisePValueIsDirectDispatch_(
@@ -127,6 +167,12 @@ namespace GeneTrail
 				    typename Statistics::SupportsIndices());
 			}
 
+			bool supportsPrefixScores() const override
+			{
+				return supportsPrefixScoresDispatch_(
+				    typename Statistics::SupportsIndices());
+			}
+
 			Order getOrder() const override
 			{
 				return getOrderDispatch_(typename Statistics::SupportsIndices());
@@ -140,6 +186,26 @@ namespace GeneTrail
 
 			void setScoresDispatch_(const Scores&, StatTags::Identifiers) {}
 
+			void computeEnrichmentsDispatch_(
+			    const std::vector<std::shared_ptr<Category>>& categories,
+			    std::vector<std::unique_ptr<EnrichmentResult>>& results,
+			    unsigned int, StatTags::Sequential)
+			{
+				for(size_t i = 0; i < categories.size(); ++i) {
+					results[i] = computeEnrichment(categories[i]);
+				}
+			}
+
+			void computeEnrichmentsDispatch_(
+			    const std::vector<std::shared_ptr<Category>>& categories,
+			    std::vector<std::unique_ptr<EnrichmentResult>>& results,
+			    unsigned int num_threads, StatTags::Concurrent)
+			{
+				parallel_for(size_t(0), categories.size(), [&](size_t i) {
+					results[i] = computeEnrichment(categories[i]);
+				}, num_threads);
+			}
+
 			void computePValueDispatch_(EnrichmentResult* result,
 			                            StatTags::Direct)
 			{
@@ -172,6 +238,21 @@ namespace GeneTrail
 				return false;
 			}
 
+			bool supportsPrefixScoresDispatch_(StatTags::SupportsPrefixScores) const
+			{
+				return true;
+			}
+
+			bool supportsPrefixScoresDispatch_(StatTags::SupportsIndices) const
+			{
+				return false;
+			}
+
+			bool supportsPrefixScoresDispatch_(StatTags::DoesNotSupportIndices) const
+			{
+				return false;
+			}
+
 			Order getOrderDispatch_(StatTags::SupportsIndices) const
 			{
 				return statistics_.getOrder();
@@ -203,6 +284,24 @@ namespace GeneTrail
 				                     "indices.");
 			}
 
+			void computePrefixScoresDispatch_(StatTags::SupportsPrefixScores,
+			                                  IndexIterator begin,
+			                                  const std::vector<size_t>& sizes,
+			                                  std::vector<double>& scores)
+			{
+				statistics_.computePrefixScores(begin, sizes, scores);
+			}
+
+			template <typename Tag>
+			void computePrefixScoresDispatch_(Tag, IndexIterator,
+			                                  const std::vector<size_t>&,
+			                                  std::vector<double>&)
+			{
+				throw NotImplemented(__FILE__, __LINE__,
+				                     "This type does not implement the "
+				                     "computation of prefix scores.");
+			}
+
 			Statistics statistics_;
 		};
 	}
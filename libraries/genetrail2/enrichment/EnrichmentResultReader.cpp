@@ -0,0 +1,220 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "EnrichmentResultReader.h"
+
+#include <genetrail2/core/EntityDatabase.h>
+#include <genetrail2/core/Exception.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include <cmath>
+#include <cstring>
+
+namespace GeneTrail
+{
+	namespace
+	{
+		template <typename T>
+		void readValues(std::istream& input, uint64_t chunk_size, size_t n,
+		                std::vector<T>& values)
+		{
+			if(chunk_size != n * sizeof(T)) {
+				throw IOError("Inconsistent chunk size: expected " +
+				              boost::lexical_cast<std::string>(n * sizeof(T)) +
+				              " got " +
+				              boost::lexical_cast<std::string>(chunk_size));
+			}
+
+			values.resize(n);
+			input.read((char*)values.data(), chunk_size);
+
+			if(static_cast<uint64_t>(input.gcount()) != chunk_size) {
+				throw IOError("Unexpected end of result file");
+			}
+		}
+
+		void readNames(std::istream& input, uint64_t chunk_size, size_t n,
+		               std::vector<std::string>& names)
+		{
+			const std::streamoff end = input.tellg() + std::streamoff(chunk_size);
+
+			names.resize(n);
+			for(auto& name : names) {
+				if(input.tellg() >= end || !std::getline(input, name, '\0')) {
+					throw IOError("Result file contains too few names");
+				}
+			}
+
+			if(input.tellg() != end) {
+				throw IOError("Inconsistent size of name chunk");
+			}
+		}
+	}
+
+	EnrichmentResultStore
+	EnrichmentResultReader::readBinary(std::istream& input) const
+	{
+		char magic[12];
+		input.read(magic, 12);
+		if(input.gcount() != 12 || strncmp(magic, "GTENRICHMENT", 12) != 0) {
+			throw IOError("Not a binary enrichment result file");
+		}
+
+		uint8_t chunk_type = 0;
+		uint64_t chunk_size = 0;
+
+		// Returns false at the end of the file, partial headers are an error
+		auto readChunkHeader = [&input, &chunk_type, &chunk_size]() {
+			input.read((char*)&chunk_type, 1);
+			if(input.gcount() == 0 && input.eof()) {
+				return false;
+			}
+
+			input.read((char*)&chunk_size, 8);
+			if(input.gcount() != 8) {
+				throw IOError("Unexpected end of result file");
+			}
+
+			return true;
+		};
+
+		if(!readChunkHeader() || chunk_type != 0x00 || chunk_size != 8) {
+			throw IOError("Unexpected chunk: expected 0 (result header)");
+		}
+
+		uint32_t header[2] = {0, 0};
+		input.read((char*)header, 8);
+		if(input.gcount() != 8) {
+			throw IOError("Unexpected end of result file");
+		}
+
+		const uint32_t n = header[0], num_entities = header[1];
+
+		EnrichmentResultStore store(std::make_shared<EntityDatabase>());
+
+		std::vector<std::string> database_name;
+		std::vector<std::string> entities;
+		std::vector<double> log_p_values(n, 0.0);
+		std::vector<uint64_t> hit_offsets(n + 1, 0);
+
+		store.names_.resize(n);
+		store.references_.resize(n);
+		store.scores_.resize(n, 0.0);
+		store.expected_scores_.resize(n, 0.0);
+		store.hits_.resize(n, 0);
+		store.enriched_.resize(n, 0);
+
+		// All chunks written by EnrichmentResultWriter are required
+		std::vector<bool> seen(0x0C, false);
+
+		while(readChunkHeader()) {
+			if(chunk_type < seen.size()) {
+				seen[chunk_type] = true;
+			}
+
+			switch(chunk_type) {
+				case 0x00:
+					throw IOError("Unexpected chunk: did not expect header chunk!");
+				case 0x01:
+					readNames(input, chunk_size, 1, database_name);
+					break;
+				case 0x02:
+					readNames(input, chunk_size, n, store.names_);
+					break;
+				case 0x03:
+					readNames(input, chunk_size, n, store.references_);
+					break;
+				case 0x04:
+					readNames(input, chunk_size, num_entities, entities);
+					break;
+				case 0x05:
+					readValues(input, chunk_size, n, store.scores_);
+					break;
+				case 0x06:
+					readValues(input, chunk_size, n, store.expected_scores_);
+					break;
+				case 0x07:
+					readValues(input, chunk_size, n, log_p_values);
+					break;
+				case 0x08:
+					readValues(input, chunk_size, n, store.hits_);
+					break;
+				case 0x09:
+					readValues(input, chunk_size, n, store.enriched_);
+					break;
+				case 0x0A:
+					readValues(input, chunk_size, n + 1, hit_offsets);
+					break;
+				case 0x0B:
+					readValues(input, chunk_size, chunk_size / sizeof(uint32_t),
+					           store.hit_entities_);
+					break;
+				default:
+					input.seekg(chunk_size, std::ios::cur);
+			}
+		}
+
+		for(uint8_t type = 0x01; type < seen.size(); ++type) {
+			if(!seen[type]) {
+				throw IOError("Result file misses chunk " +
+				              boost::lexical_cast<std::string>(int(type)));
+			}
+		}
+
+		for(size_t i = 0; i < n; ++i) {
+			if(hit_offsets[i] > hit_offsets[i + 1]) {
+				throw IOError("Hit offsets are not sorted");
+			}
+		}
+
+		if(hit_offsets[0] != 0 || hit_offsets.back() != store.hit_entities_.size()) {
+			throw IOError("Inconsistent number of hits");
+		}
+
+		// Map the entities of the file to the new entity database
+		std::vector<uint32_t> entity_index(entities.size());
+		for(size_t i = 0; i < entities.size(); ++i) {
+			entity_index[i] = store.db_->index(entities[i]);
+		}
+
+		for(auto& entity : store.hit_entities_) {
+			if(entity >= entity_index.size()) {
+				throw IOError("Invalid entity index " +
+				              boost::lexical_cast<std::string>(entity));
+			}
+			entity = entity_index[entity];
+		}
+
+		store.hit_offsets_.assign(hit_offsets.begin(), hit_offsets.end());
+
+		store.p_values_.resize(n);
+		for(size_t i = 0; i < n; ++i) {
+			store.p_values_[i] =
+			    std::isinf(log_p_values[i])
+			        ? big_float(0)
+			        : pow(big_float(10), big_float(log_p_values[i]));
+		}
+
+		store.database_names_.push_back(
+		    database_name.empty() ? std::string() : database_name[0]);
+		store.database_offsets_.push_back(0);
+
+		return store;
+	}
+}
@@ -0,0 +1,45 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_ENRICHMENT_ENRICHMENT_RESULT_READER_H
+#define GT2_ENRICHMENT_ENRICHMENT_RESULT_READER_H
+
+#include "EnrichmentResultStore.h"
+
+#include <genetrail2/core/macros.h>
+
+#include <istream>
+
+namespace GeneTrail
+{
+	/**
+	 * Reads results written by EnrichmentResultWriter::writeBinary. The
+	 * returned store contains a single database and has its own entity
+	 * database.
+	 */
+	class GT2_EXPORT EnrichmentResultReader
+	{
+		public:
+		/**
+		 * @throws IOError if the input is not a valid result file.
+		 */
+		EnrichmentResultStore readBinary(std::istream& input) const;
+	};
+}
+
+#endif // GT2_ENRICHMENT_ENRICHMENT_RESULT_READER_H
@@ -0,0 +1,78 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "EnrichmentResultStore.h"
+
+#include "EnrichmentResult.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace GeneTrail
+{
+	EnrichmentResultStore::EnrichmentResultStore(
+	    const std::shared_ptr<EntityDatabase>& db)
+	    : db_(db), hit_offsets_(1, 0)
+	{
+	}
+
+	size_t EnrichmentResultStore::addDatabase(const std::string& name)
+	{
+		database_names_.push_back(name);
+		database_offsets_.push_back(size());
+
+		return database_names_.size() - 1;
+	}
+
+	size_t EnrichmentResultStore::add(const EnrichmentResult& result,
+	                                  const std::vector<size_t>& hits)
+	{
+		if(database_names_.empty()) {
+			throw std::logic_error("Results can only be added to a database");
+		}
+
+		names_.push_back(result.category->name());
+		references_.push_back(result.category->reference());
+		scores_.push_back(result.score);
+		expected_scores_.push_back(result.expected_score);
+		p_values_.push_back(result.pvalue);
+		hits_.push_back(result.hits);
+		enriched_.push_back(result.enriched);
+
+		hit_entities_.insert(hit_entities_.end(), hits.begin(), hits.end());
+		hit_offsets_.push_back(hit_entities_.size());
+
+		return size() - 1;
+	}
+
+	void EnrichmentResultStore::clearResults()
+	{
+		std::fill(database_offsets_.begin(), database_offsets_.end(), 0);
+
+		names_.clear();
+		references_.clear();
+		scores_.clear();
+		expected_scores_.clear();
+		p_values_.clear();
+		hits_.clear();
+		enriched_.clear();
+
+		hit_offsets_.assign(1, 0);
+		hit_entities_.clear();
+	}
+}
@@ -0,0 +1,140 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_ENRICHMENT_ENRICHMENT_RESULT_STORE_H
+#define GT2_ENRICHMENT_ENRICHMENT_RESULT_STORE_H
+
+#include <genetrail2/core/macros.h>
+#include <genetrail2/core/multiprecision.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace GeneTrail
+{
+	class EntityDatabase;
+	struct EnrichmentResult;
+
+	/**
+	 * Stores the enrichment results of one or more category databases
+	 * column by column. Every result is identified by its position, the
+	 * results of a database are stored consecutively.
+	 *
+	 * Instead of the concatenated names of the hits, the entity indices
+	 * of the hits are stored in compressed sparse row format. The names
+	 * are resolved using the entity database of the store.
+	 */
+	class GT2_EXPORT EnrichmentResultStore
+	{
+		public:
+		explicit EnrichmentResultStore(const std::shared_ptr<EntityDatabase>& db);
+
+		/**
+		 * Starts a new database. All results that are added afterwards
+		 * belong to it.
+		 *
+		 * @return The index of the database.
+		 */
+		size_t addDatabase(const std::string& name);
+
+		/**
+		 * Appends a result to the last database.
+		 *
+		 * @param result The result, its info field is ignored.
+		 * @param hits The entity indices of the hits, in the order in
+		 *             which they should be reported.
+		 * @return The index of the result.
+		 * @throws std::logic_error if no database has been added yet.
+		 */
+		size_t add(const EnrichmentResult& result,
+		           const std::vector<size_t>& hits);
+
+		/**
+		 * Releases all results, e.g. after they have been written. The
+		 * databases are kept, but are empty afterwards.
+		 */
+		void clearResults();
+
+		/// The number of results of all databases
+		size_t size() const { return names_.size(); }
+
+		size_t numDatabases() const { return database_names_.size(); }
+
+		const std::string& databaseName(size_t d) const
+		{
+			return database_names_[d];
+		}
+
+		/// The index of the first result of database d
+		size_t databaseBegin(size_t d) const { return database_offsets_[d]; }
+
+		/// One past the index of the last result of database d
+		size_t databaseEnd(size_t d) const
+		{
+			return d + 1 < database_offsets_.size() ? database_offsets_[d + 1]
+			                                        : size();
+		}
+
+		const std::string& name(size_t i) const { return names_[i]; }
+		const std::string& reference(size_t i) const { return references_[i]; }
+
+		uint32_t hits(size_t i) const { return hits_[i]; }
+		double score(size_t i) const { return scores_[i]; }
+		double expectedScore(size_t i) const { return expected_scores_[i]; }
+		bool enriched(size_t i) const { return enriched_[i] != 0; }
+
+		const big_float& pValue(size_t i) const { return p_values_[i]; }
+		void setPValue(size_t i, const big_float& p) { p_values_[i] = p; }
+
+		/// The entity indices of the hits of result i
+		const uint32_t* hitsBegin(size_t i) const
+		{
+			return hit_entities_.data() + hit_offsets_[i];
+		}
+
+		const uint32_t* hitsEnd(size_t i) const
+		{
+			return hit_entities_.data() + hit_offsets_[i + 1];
+		}
+
+		const std::shared_ptr<EntityDatabase>& db() const { return db_; }
+
+		private:
+		std::shared_ptr<EntityDatabase> db_;
+
+		std::vector<std::string> database_names_;
+		std::vector<size_t> database_offsets_;
+
+		std::vector<std::string> names_;
+		std::vector<std::string> references_;
+		std::vector<double> scores_;
+		std::vector<double> expected_scores_;
+		std::vector<big_float> p_values_;
+		std::vector<uint32_t> hits_;
+		std::vector<uint8_t> enriched_;
+
+		std::vector<size_t> hit_offsets_;
+		std::vector<uint32_t> hit_entities_;
+
+		friend class EnrichmentResultReader;
+	};
+}
+
+#endif // GT2_ENRICHMENT_ENRICHMENT_RESULT_STORE_H
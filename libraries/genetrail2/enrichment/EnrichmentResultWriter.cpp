@@ -0,0 +1,217 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "EnrichmentResultWriter.h"
+
+#include "EnrichmentResultStore.h"
+
+#include <genetrail2/core/EntityDatabase.h>
+#include <genetrail2/core/Exception.h>
+
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace GeneTrail
+{
+	namespace
+	{
+		uint64_t writeChunkHeader(std::ostream& output, uint8_t type,
+		                          uint64_t size)
+		{
+			output.write((const char*)&type, 1);
+			output.write((const char*)&size, 8);
+
+			return 9;
+		}
+
+		template <typename T>
+		uint64_t writeChunk(std::ostream& output, uint8_t type,
+		                    const std::vector<T>& values)
+		{
+			const uint64_t n = values.size() * sizeof(T);
+			const uint64_t total = writeChunkHeader(output, type, n);
+			output.write((const char*)values.data(), n);
+
+			return total + n;
+		}
+
+		template <typename NameAt>
+		uint64_t writeNames(std::ostream& output, uint8_t type, size_t begin,
+		                    size_t end, NameAt name_at)
+		{
+			uint64_t n = 0;
+			for(size_t i = begin; i < end; ++i) {
+				n += name_at(i).size() + 1;
+			}
+
+			const uint64_t total = writeChunkHeader(output, type, n);
+			for(size_t i = begin; i < end; ++i) {
+				const std::string& name = name_at(i);
+				output.write(name.c_str(), name.size() + 1);
+			}
+
+			return total + n;
+		}
+
+		template <typename Column>
+		std::vector<Column> slice(size_t begin, size_t end,
+		                          Column (EnrichmentResultStore::*getter)(size_t)
+		                              const,
+		                          const EnrichmentResultStore& store)
+		{
+			std::vector<Column> result(end - begin);
+			for(size_t i = begin; i < end; ++i) {
+				result[i - begin] = (store.*getter)(i);
+			}
+
+			return result;
+		}
+	}
+
+	void EnrichmentResultWriter::writeText(std::ostream& output,
+	                                       const EnrichmentResultStore& store,
+	                                       size_t database, bool justScores,
+	                                       bool justPvalues) const
+	{
+		const size_t begin = store.databaseBegin(database);
+		const size_t end = store.databaseEnd(database);
+
+		if(begin == end) {
+			return;
+		}
+
+		if(justPvalues) {
+			output << "#Name\tP-value\n";
+		} else if(justScores) {
+			output << "#Name\tScore\n";
+		} else {
+			output << "#Name\tReference\tHits\tScore\tExpected Score\tP-value\t"
+			          "Info\tRegulation_direction\n";
+		}
+
+		const EntityDatabase& db = *store.db();
+
+		for(size_t i = begin; i < end; ++i) {
+			output << store.name(i) << '\t';
+
+			if(justPvalues) {
+				output << store.pValue(i);
+			} else if(justScores) {
+				output << store.score(i);
+			} else {
+				output << store.reference(i) << '\t' << store.hits(i) << '\t'
+				       << store.score(i) << '\t' << store.expectedScore(i)
+				       << '\t' << store.pValue(i) << '\t';
+
+				for(const uint32_t* it = store.hitsBegin(i);
+				    it != store.hitsEnd(i); ++it) {
+					if(it != store.hitsBegin(i)) {
+						output << ',';
+					}
+					output << db.name(*it);
+				}
+
+				output << '\t' << store.enriched(i);
+			}
+
+			output << '\n';
+		}
+
+		if(!output.good()) {
+			throw IOError("Could not write enrichment results");
+		}
+	}
+
+	uint64_t EnrichmentResultWriter::writeBinary(std::ostream& output,
+	                                             const EnrichmentResultStore& store,
+	                                             size_t database) const
+	{
+		const size_t begin = store.databaseBegin(database);
+		const size_t end = store.databaseEnd(database);
+		const EntityDatabase& db = *store.db();
+
+		// Only the entities that are hit are written, they are renumbered
+		// in the order of their first occurrence.
+		std::unordered_map<uint32_t, uint32_t> local_index;
+		std::vector<uint32_t> entities;
+		std::vector<uint32_t> hit_entities;
+		std::vector<uint64_t> hit_offsets(1, 0);
+		for(size_t i = begin; i < end; ++i) {
+			for(const uint32_t* it = store.hitsBegin(i); it != store.hitsEnd(i);
+			    ++it) {
+				auto res = local_index.emplace(*it, entities.size());
+				if(res.second) {
+					entities.push_back(*it);
+				}
+				hit_entities.push_back(res.first->second);
+			}
+			hit_offsets.push_back(hit_entities.size());
+		}
+
+		std::vector<double> log_p_values(end - begin);
+		for(size_t i = begin; i < end; ++i) {
+			const big_float& p = store.pValue(i);
+			log_p_values[i - begin] =
+			    p > 0 ? log10(p).convert_to<double>()
+			          : -std::numeric_limits<double>::infinity();
+		}
+
+		std::vector<uint8_t> enriched(end - begin);
+		for(size_t i = begin; i < end; ++i) {
+			enriched[i - begin] = store.enriched(i);
+		}
+
+		output.write("GTENRICHMENT", 12);
+		uint64_t total = 12;
+
+		const uint32_t num_results = end - begin;
+		const uint32_t num_entities = entities.size();
+		total += writeChunkHeader(output, 0x00, 8);
+		output.write((const char*)&num_results, 4);
+		output.write((const char*)&num_entities, 4);
+		total += 8;
+
+		total += writeNames(output, 0x01, 0, 1, [&](size_t) -> const std::string& {
+			return store.databaseName(database);
+		});
+		total += writeNames(output, 0x02, begin, end, [&](size_t i) -> const std::string& {
+			return store.name(i);
+		});
+		total += writeNames(output, 0x03, begin, end, [&](size_t i) -> const std::string& {
+			return store.reference(i);
+		});
+		total += writeNames(output, 0x04, 0, entities.size(), [&](size_t i) -> const std::string& {
+			return db.name(entities[i]);
+		});
+
+		total += writeChunk(output, 0x05, slice(begin, end, &EnrichmentResultStore::score, store));
+		total += writeChunk(output, 0x06, slice(begin, end, &EnrichmentResultStore::expectedScore, store));
+		total += writeChunk(output, 0x07, log_p_values);
+		total += writeChunk(output, 0x08, slice(begin, end, &EnrichmentResultStore::hits, store));
+		total += writeChunk(output, 0x09, enriched);
+		total += writeChunk(output, 0x0A, hit_offsets);
+		total += writeChunk(output, 0x0B, hit_entities);
+
+		if(!output.good()) {
+			throw IOError("Could not write enrichment results");
+		}
+
+		return total;
+	}
+}
@@ -0,0 +1,70 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_ENRICHMENT_ENRICHMENT_RESULT_WRITER_H
+#define GT2_ENRICHMENT_ENRICHMENT_RESULT_WRITER_H
+
+#include <genetrail2/core/macros.h>
+
+#include <cstdint>
+#include <ostream>
+
+namespace GeneTrail
+{
+	class EnrichmentResultStore;
+
+	/**
+	 * Writes the results of a single database of an EnrichmentResultStore.
+	 *
+	 * The text format is the tab separated table that has always been
+	 * written for enrichments. It is streamed result by result, so no
+	 * intermediate strings are built.
+	 *
+	 * The binary format starts with the magic string "GTENRICHMENT",
+	 * followed by chunks that consist of a one byte type, an eight byte
+	 * size, and the payload:
+	 *
+	 * - 0x00 header: number of results and entities (uint32 each)
+	 * - 0x01 database name, 0x02 category names, 0x03 references and
+	 *   0x04 entity names as null terminated strings
+	 * - 0x05 scores, 0x06 expected scores and 0x07 log10 p-values as
+	 *   doubles
+	 * - 0x08 hits (uint32) and 0x09 enriched flags (uint8)
+	 * - 0x0A offsets (uint64) and 0x0B entries (uint32) of the hits, the
+	 *   entries are indices into the entity names of the file.
+	 *
+	 * P-values are stored as logarithms, as they can be far below the
+	 * smallest double. Chunks with an unknown type are skipped by the
+	 * reader.
+	 *
+	 * \see EnrichmentResultReader
+	 */
+	class GT2_EXPORT EnrichmentResultWriter
+	{
+		public:
+		void writeText(std::ostream& output, const EnrichmentResultStore& store,
+		               size_t database, bool justScores = false,
+		               bool justPvalues = false) const;
+
+		uint64_t writeBinary(std::ostream& output,
+		                     const EnrichmentResultStore& store,
+		                     size_t database) const;
+	};
+}
+
+#endif // GT2_ENRICHMENT_ENRICHMENT_RESULT_WRITER_H
@@ -0,0 +1,314 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "MultiSampleEnrichment.h"
+
+#include "EnrichmentResult.h"
+#include "PermutationTest.h"
+
+#include <genetrail2/core/DenseMatrixWriter.h>
+#include <genetrail2/core/Exception.h>
+#include <genetrail2/core/CompiledCategoryFile.h>
+#include <genetrail2/core/PValue.h>
+#include <genetrail2/core/misc_algorithms.h>
+
+#include <boost/algorithm/string/replace.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+
+namespace GeneTrail
+{
+	CategoryIndex::CategoryIndex(const Scores& genes,
+	                             const CategoryList& cat_list, const Params& p)
+	    : offsets_(1, 0)
+	{
+		for(const auto& cat : cat_list) {
+			try {
+				auto category_db = readCategoryDatabase(genes.db(), cat.second);
+
+				const size_t first = entries_.size();
+				for(const auto& c : category_db) {
+					const size_t hits = genes.subsetIndices(c).size();
+
+					if(hits < p.minimum || hits > p.maximum) {
+						if(!p.includeAll) {
+							continue;
+						}
+					}
+
+					entries_.push_back(Entry{std::make_shared<Category>(c), hits});
+				}
+
+				std::sort(entries_.begin() + first, entries_.end(),
+				          [](const Entry& a, const Entry& b) {
+					          return a.category->name() < b.category->name();
+					      });
+
+				names_.push_back(cat.first);
+				offsets_.push_back(entries_.size());
+			} catch(IOError& exn) {
+				std::cerr << "WARNING: Could not process category file "
+				          << cat.first << "! " << exn.what() << std::endl;
+			}
+		}
+	}
+
+	std::vector<std::string> CategoryIndex::categoryNames(size_t d) const
+	{
+		std::vector<std::string> result;
+		result.reserve(end(d) - begin(d));
+
+		for(size_t i = begin(d); i < end(d); ++i) {
+			result.push_back(entries_[i].category->name());
+		}
+
+		return result;
+	}
+
+	MultiSampleEnrichment::MultiSampleEnrichment(
+	    const CategoryIndex& index, const EnrichmentAlgorithmFactory& factory,
+	    const Params& p)
+	    : index_(index),
+	      factory_(factory),
+	      p_(p),
+	      num_threads_(0),
+	      block_size_(0)
+	{
+		if(p.pValueMode != PValueMode::RowWise) {
+			throw NotImplemented(__FILE__, __LINE__,
+			                     "Multi-sample enrichments only support "
+			                     "row-wise p-values.");
+		}
+	}
+
+	void MultiSampleEnrichment::setNumberOfThreads(unsigned int num_threads)
+	{
+		num_threads_ = num_threads;
+	}
+
+	void MultiSampleEnrichment::setBlockSize(size_t block_size)
+	{
+		block_size_ = block_size;
+	}
+
+	void MultiSampleEnrichment::computeSample(const Scores& scores,
+	                                          size_t sample,
+	                                          double* out_scores,
+	                                          double* out_pvalues) const
+	{
+		auto algorithm = factory_(scores);
+
+		EnrichmentResults results(index_.size());
+		for(size_t i = 0; i < index_.size(); ++i) {
+			const auto& entry = index_[i];
+			const bool valid =
+			    p_.minimum <= entry.hits && entry.hits <= p_.maximum;
+
+			if(valid && algorithm->canUseCategory(*entry.category, entry.hits)) {
+				results[i] = algorithm->computeEnrichment(entry.category);
+			} else {
+				results[i] = std::make_shared<EnrichmentResult>(entry.category);
+			}
+
+			results[i]->hits = entry.hits;
+			out_scores[i] = results[i]->score;
+		}
+
+		if(!algorithm->pValuesComputed()) {
+			using Test = RowPermutationTest<double>;
+
+			// The permutation test reorders the results, so we work on
+			// a copy and keep the index order intact.
+			EnrichmentResults tmp(results);
+			const uint64_t seed = p_.randomSeed + sample;
+			auto test =
+			    algorithm->supportsIndices()
+			        ? Test::IndexBased(scores, p_.numPermutations, seed)
+			        : Test::CategoryBased(scores, p_.numPermutations, seed);
+			test->computePValue(algorithm, tmp);
+		}
+
+		for(size_t i = 0; i < index_.size(); ++i) {
+			out_pvalues[i] = results[i]->pvalue.convert_to<double>();
+		}
+
+		adjust_(out_pvalues);
+	}
+
+	void MultiSampleEnrichment::adjust_(double* pvalues) const
+	{
+		if(!p_.adjustment || p_.adjustment.get() == MultipleTestingCorrection::GSEA) {
+			return;
+		}
+
+		// Samples are processed in parallel already, so sort sequentially
+		auto adjust = [this, pvalues](size_t first, size_t last) {
+			pvalue::adjustInPlace(pvalues + first, last - first,
+			                      p_.adjustment.get(), 1);
+		};
+
+		if(p_.adjustSeparately) {
+			for(size_t d = 0; d < index_.numberOfDatabases(); ++d) {
+				adjust(index_.begin(d), index_.end(d));
+			}
+		} else {
+			adjust(0, index_.size());
+		}
+	}
+
+	void MultiSampleEnrichment::run(const DenseMatrix& matrix,
+	                                const Scores& genes,
+	                                const std::string& output_dir,
+	                                Format format) const
+	{
+		if(genes.size() != matrix.rows()) {
+			throw IOError("Genes and matrix rows are incompatible.");
+		}
+
+		const unsigned int num_threads =
+		    num_threads_ == 0 ? default_num_threads() : num_threads_;
+		const size_t block_size =
+		    block_size_ == 0 ? 4 * static_cast<size_t>(num_threads) : block_size_;
+
+		const size_t num_categories = index_.size();
+		const size_t num_samples = matrix.cols();
+
+		// Position i of the sorted scores corresponds to matrix row order[i]
+		std::vector<size_t> entities(matrix.rows());
+		for(size_t r = 0; r < matrix.rows(); ++r) {
+			entities[r] = genes.db()->index(matrix.rowName(r));
+		}
+
+		std::vector<size_t> order(matrix.rows());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [&entities](size_t a, size_t b) {
+			return entities[a] < entities[b];
+		});
+
+		// Prepare the outputs
+		const bool write_scores = !p_.justPvalues;
+		const bool write_pvalues = !p_.justScores;
+		const std::string extension = format == Format::Binary ? ".bin" : ".txt";
+
+		std::vector<std::ofstream> score_files, pvalue_files;
+		std::vector<DenseMatrix> score_matrices, pvalue_matrices;
+
+		DenseMatrixWriter writer;
+		auto open = [&](std::vector<std::ofstream>& files,
+		                std::vector<DenseMatrix>& matrices,
+		                const std::string& suffix) {
+			for(size_t d = 0; d < index_.numberOfDatabases(); ++d) {
+				auto names = index_.categoryNames(d);
+				for(auto& name : names) {
+					boost::replace_all(name, "_", " ");
+				}
+
+				const auto path =
+				    output_dir + "/" + index_.databaseName(d) + suffix + extension;
+				files.emplace_back(path, std::ios::binary);
+				if(!files.back()) {
+					throw IOError("Could not open output file: " + path);
+				}
+
+				if(format == Format::Binary) {
+					writer.writeBinaryHeader(files.back(), names, matrix.colNames());
+				} else {
+					matrices.emplace_back(names, matrix.colNames());
+				}
+			}
+		};
+
+		if(write_scores) {
+			open(score_files, score_matrices, ".scores");
+		}
+
+		if(write_pvalues) {
+			open(pvalue_files, pvalue_matrices, ".pvalues");
+		}
+
+		auto store = [&](std::vector<std::ofstream>& files,
+		                 std::vector<DenseMatrix>& matrices, const double* column,
+		                 size_t j) {
+			for(size_t d = 0; d < index_.numberOfDatabases(); ++d) {
+				const size_t first = index_.begin(d);
+				const size_t n = index_.end(d) - first;
+
+				if(format == Format::Binary) {
+					writer.writeBinaryColumn(files[d], column + first, n);
+				} else {
+					std::copy(column + first, column + first + n,
+					          matrices[d].matrix().col(j).data());
+				}
+			}
+		};
+
+		std::vector<double> block_scores(num_categories * block_size);
+		std::vector<double> block_pvalues(num_categories * block_size);
+
+		for(size_t start = 0; start < num_samples; start += block_size) {
+			const size_t stop = std::min(num_samples, start + block_size);
+
+			parallel_for(start, stop, [&](size_t j) {
+				std::vector<Score> data;
+				data.reserve(order.size());
+				for(size_t r : order) {
+					data.emplace_back(entities[r], matrix(r, j));
+				}
+
+				Scores scores(std::move(data), genes.db());
+
+				const size_t offset = (j - start) * num_categories;
+				computeSample(scores, j, block_scores.data() + offset,
+				              block_pvalues.data() + offset);
+			}, num_threads);
+
+			// Append the block in sample order
+			for(size_t j = start; j < stop; ++j) {
+				const size_t offset = (j - start) * num_categories;
+
+				if(write_scores) {
+					store(score_files, score_matrices, block_scores.data() + offset, j);
+				}
+
+				if(write_pvalues) {
+					store(pvalue_files, pvalue_matrices, block_pvalues.data() + offset, j);
+				}
+			}
+
+			if(p_.verbose) {
+				std::cout << "INFO: Processed " << stop << "/" << num_samples
+				          << " samples" << std::endl;
+			}
+		}
+
+		if(format == Format::Text) {
+			for(size_t d = 0; d < score_matrices.size(); ++d) {
+				writer.writeText(score_files[d], score_matrices[d]);
+				score_files[d] << '\n';
+			}
+
+			for(size_t d = 0; d < pvalue_matrices.size(); ++d) {
+				writer.writeText(pvalue_files[d], pvalue_matrices[d]);
+				pvalue_files[d] << '\n';
+			}
+		}
+	}
+}
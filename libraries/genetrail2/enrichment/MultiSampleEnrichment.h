@@ -0,0 +1,156 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef GT2_ENRICHMENT_MULTI_SAMPLE_ENRICHMENT_H
+#define GT2_ENRICHMENT_MULTI_SAMPLE_ENRICHMENT_H
+
+#include "common.h"
+#include "EnrichmentAlgorithm.h"
+#include "Parameters.h"
+
+#include <genetrail2/core/Category.h>
+#include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/Scores.h>
+#include <genetrail2/core/macros.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace GeneTrail
+{
+	/**
+	 * The categories of a set of category databases, restricted to the
+	 * genes of a score matrix.
+	 *
+	 * The databases are parsed only once. As all samples of the matrix share
+	 * the same genes, the number of hits of a category and whether it passes
+	 * the size filter are independent of the sample and are computed here.
+	 * Categories are grouped by database and sorted by name within a
+	 * database.
+	 */
+	class GT2_EXPORT CategoryIndex
+	{
+		public:
+		struct Entry
+		{
+			std::shared_ptr<Category> category;
+			size_t hits;
+		};
+
+		/**
+		 * @param genes The genes of the score matrix, sorted by index.
+		 * @param cat_list The category databases that should be read.
+		 * @param p Parameters providing the size filter.
+		 */
+		CategoryIndex(const Scores& genes, const CategoryList& cat_list, const Params& p);
+
+		size_t size() const { return entries_.size(); }
+		const Entry& operator[](size_t i) const { return entries_[i]; }
+
+		size_t numberOfDatabases() const { return names_.size(); }
+		const std::string& databaseName(size_t d) const { return names_[d]; }
+
+		/// The entries of database d are [begin(d), end(d)).
+		size_t begin(size_t d) const { return offsets_[d]; }
+		size_t end(size_t d) const { return offsets_[d + 1]; }
+
+		/// The names of the categories of database d.
+		std::vector<std::string> categoryNames(size_t d) const;
+
+		private:
+		std::vector<std::string> names_;
+		std::vector<size_t> offsets_;
+		std::vector<Entry> entries_;
+	};
+
+	using EnrichmentAlgorithmFactory =
+	    std::function<EnrichmentAlgorithmPtr(const Scores&)>;
+
+	/**
+	 * Computes the enrichment of every column of a genes x samples score
+	 * matrix and writes one categories x samples matrix of scores and one
+	 * of p-values for each category database.
+	 *
+	 * This replaces running a single-sample enrichment for every sample and
+	 * combining the results with CombineReducedEnrichments. The samples are
+	 * evaluated in parallel against a shared CategoryIndex. Results are
+	 * computed in blocks of samples and appended to the binary output in
+	 * column order, so only a block of columns is kept in memory. As text
+	 * matrices are stored row-wise, the text output is written once all
+	 * samples have been processed.
+	 */
+	class GT2_EXPORT MultiSampleEnrichment
+	{
+		public:
+		enum class Format { Text, Binary };
+
+		MultiSampleEnrichment(const CategoryIndex& index,
+		                      const EnrichmentAlgorithmFactory& factory,
+		                      const Params& p);
+
+		/**
+		 * Sets the number of threads. 0 uses all available cores.
+		 */
+		void setNumberOfThreads(unsigned int num_threads);
+
+		/**
+		 * Sets the number of samples that are processed before they are
+		 * written to the binary output. 0 uses four samples per thread.
+		 */
+		void setBlockSize(size_t block_size);
+
+		/**
+		 * Computes the enrichment of a single sample.
+		 *
+		 * @param scores The scores of the sample, sorted by index. The genes
+		 *               have to be the ones the index has been built for.
+		 * @param sample The column of the sample. The permutation test of
+		 *               the sample is seeded with randomSeed + sample, so
+		 *               that the samples use independent permutations.
+		 * @param out_scores Receives index.size() scores.
+		 * @param out_pvalues Receives index.size() (adjusted) p-values.
+		 */
+		void computeSample(const Scores& scores, size_t sample,
+		                   double* out_scores, double* out_pvalues) const;
+
+		/**
+		 * Computes the enrichment for all columns of the matrix. The rows
+		 * of the matrix have to be the genes of the index in matrix order.
+		 *
+		 * The results of database <db> are written to
+		 * <output_dir>/<db>.scores.(txt|bin) and
+		 * <output_dir>/<db>.pvalues.(txt|bin). If just scores or just
+		 * p-values are requested, only the respective file is written.
+		 */
+		void run(const DenseMatrix& matrix, const Scores& genes,
+		         const std::string& output_dir, Format format) const;
+
+		private:
+		void adjust_(double* pvalues) const;
+
+		const CategoryIndex& index_;
+		EnrichmentAlgorithmFactory factory_;
+		const Params& p_;
+		unsigned int num_threads_;
+		size_t block_size_;
+	};
+}
+
+#endif // GT2_ENRICHMENT_MULTI_SAMPLE_ENRICHMENT_H
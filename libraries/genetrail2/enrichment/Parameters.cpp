@@ -28,7 +28,9 @@ Params::Params()
 	maximum(700),
 	numPermutations(100000),
 	randomSeed(std::random_device{}()),
+	numThreads(0),
 	adjustSeparately(false),
+	binaryOutput(false),
 	includeAll(false),
 	justScores(false),
 	justPvalues(false),
@@ -103,7 +103,12 @@ namespace GeneTrail {
 		size_t numPermutations;
 		size_t randomSeed;
 
+		// Number of threads used for evaluating the categories, 0 uses all
+		// available cores
+		unsigned int numThreads;
+
 		bool adjustSeparately;
+		bool binaryOutput;
 		bool includeAll;
 		bool justScores;
 		bool justPvalues;
@@ -127,6 +127,14 @@ class GT2_EXPORT RowPermutationTest
 
 		this->sortResults_(tests);
 
+		// The distinct category sizes in increasing order
+		sizes_.clear();
+		for(const auto& test : tests) {
+			if(sizes_.empty() || sizes_.back() != test->hits) {
+				sizes_.push_back(test->hits);
+			}
+		}
+
 		std::vector<size_t> counter(tests.size());
 		for(size_t i = 0; i < permutations_; ++i) {
 			this->printStatus_(i, permutations_);
@@ -176,6 +184,24 @@ class GT2_EXPORT RowPermutationTest
 		// need to shuffle tests.back()->hits many.
 		shuffle_(tests.back()->hits);
 
+		// The statistic can be evaluated for all sizes in one pass over
+		// the shuffled indices.
+		if(algorithm->supportsPrefixScores()) {
+			algorithm->computePrefixScores(indices_.cbegin(), sizes_,
+			                               prefix_scores_);
+
+			size_t s = 0;
+			for(size_t i = 0; i < tests.size(); ++i) {
+				while(sizes_[s] != tests[i]->hits) {
+					++s;
+				}
+
+				this->updateCounter_(tests[i], counter[i], prefix_scores_[s]);
+			}
+
+			return;
+		}
+
 		for(size_t i = 0; i < tests.size(); ++i) {
 			// Check if the sampleSize has changed. As the tests_ vector is
 			// sorted we can use one running sum value for all categories of
@@ -226,6 +252,8 @@ class GT2_EXPORT RowPermutationTest
 	std::mt19937_64 twister_;
 	std::vector<size_t> indices_;
 	std::vector<size_t> tmp_indices_;
+	std::vector<size_t> sizes_;
+	std::vector<double> prefix_scores_;
 };
 
 template <typename value_type>
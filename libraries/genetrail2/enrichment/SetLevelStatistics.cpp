@@ -20,11 +20,25 @@
 
 #include "SetLevelStatistics.h"
 
+#include <genetrail2/core/Category.h>
+
+#include <boost/math/distributions/fisher_f.hpp>
+#include <boost/math/distributions/normal.hpp>
+
+#include <Eigen/Cholesky>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
 namespace GeneTrail
 {
 	StatisticsEnrichment::StatisticsEnrichment(const Statistics& test,
 	                                           const Scores& scores)
-	    : test_(test), scores_(scores.db()), cached_(0.0)
+	    : test_(test), cached_(0.0)
 	{
 		setInputScores(scores);
 	}
@@ -32,31 +46,97 @@ namespace GeneTrail
 	StatisticsEnrichment::StatisticsEnrichment(const Statistics& test,
 	                                           const Scores& scores,
 	                                           double cached)
-	    : test_(test), scores_(scores), cached_(cached)
+	    : test_(test), cached_(cached)
 	{
-		scores_.sortByIndex();
+		updateLookup_(scores);
 	}
 
 	void StatisticsEnrichment::setInputScores(const Scores& scores)
 	{
-		scores_ = scores;
-		scores_.sortByIndex();
+		updateLookup_(scores);
 		cached_ = cacheStatistic_();
 	}
 
+	void StatisticsEnrichment::updateLookup_(const Scores& scores)
+	{
+		values_.assign(scores.scores().begin(), scores.scores().end());
+		std::sort(values_.begin(), values_.end(), std::greater<double>());
+
+		size_t n = 0;
+		for(const auto& s : scores) {
+			n = std::max(n, s.index() + 1);
+		}
+
+		entity_values_.assign(n, 0.0);
+		has_value_.assign(n, 0);
+
+		for(const auto& s : scores) {
+			entity_values_[s.index()] = s.score();
+			has_value_[s.index()] = 1;
+		}
+
+		buffer_.reserve(values_.size());
+	}
+
+	void StatisticsEnrichment::gather_(const Category& c) const
+	{
+		buffer_.clear();
+
+		for(size_t id : c) {
+			if(id < has_value_.size() && has_value_[id]) {
+				buffer_.push_back(entity_values_[id]);
+			}
+		}
+	}
+
 	std::tuple<double, double>
 	StatisticsEnrichment::computeScore(const Category& c) const
 	{
-		const auto intersection = scores_.subset(c);
-		auto score =
-		    test_(intersection.scores().begin(), intersection.scores().end());
+		gather_(c);
+		auto score = test_(buffer_.cbegin(), buffer_.cend());
 
 		return std::make_tuple(score, getExpectedValue_(c));
 	}
 
+	std::tuple<double, double>
+	StatisticsEnrichment::computeScore(IndexIterator begin,
+	                                   IndexIterator end) const
+	{
+		buffer_.clear();
+		for(; begin != end; ++begin) {
+			buffer_.push_back(values_[*begin]);
+		}
+
+		return std::make_tuple(test_(buffer_.cbegin(), buffer_.cend()), 0.0);
+	}
+
+	void StatisticsEnrichment::computePrefixScores(
+	    IndexIterator begin, const std::vector<size_t>& sizes,
+	    std::vector<double>& scores) const
+	{
+		scores.resize(sizes.size());
+		prefixScores_(begin, sizes, scores);
+	}
+
+	void StatisticsEnrichment::prefixScores_(IndexIterator begin,
+	                                         const std::vector<size_t>& sizes,
+	                                         std::vector<double>& scores) const
+	{
+		// Generic fallback: extend the gathered prefix and evaluate the
+		// statistic for every requested size.
+		buffer_.clear();
+		for(size_t i = 0; i < sizes.size(); ++i) {
+			for(; buffer_.size() < sizes[i]; ++begin) {
+				buffer_.push_back(values_[*begin]);
+			}
+
+			scores[i] = test_(buffer_.cbegin(), buffer_.cend());
+		}
+	}
+
 	double StatisticsEnrichment::cacheStatistic_() const
 	{
-		return test_(scores_.scores().begin(), scores_.scores().end());
+		return test_(values_.cbegin(), values_.cend());
 	}
 
 	double StatisticsEnrichment::getExpectedValue_(const Category&) const
@@ -66,7 +146,300 @@ namespace GeneTrail
 
 	double SumEnrichment::cacheStatistic_() const
 	{
-		return statistic::mean<double>(scores_.scores().begin(),
-		                               scores_.scores().end());
+		return statistic::mean<double>(values_.cbegin(), values_.cend());
+	}
+
+	void SumEnrichment::prefixScores_(IndexIterator begin,
+	                                  const std::vector<size_t>& sizes,
+	                                  std::vector<double>& scores) const
+	{
+		double sum = 0.0;
+		size_t k = 0;
+
+		for(size_t i = 0; i < sizes.size(); ++i) {
+			for(; k < sizes[i]; ++k, ++begin) {
+				sum += values_[*begin];
+			}
+
+			scores[i] = sum;
+		}
+	}
+
+	void MeanEnrichment::prefixScores_(IndexIterator begin,
+	                                   const std::vector<size_t>& sizes,
+	                                   std::vector<double>& scores) const
+	{
+		double sum = 0.0;
+		size_t k = 0;
+
+		for(size_t i = 0; i < sizes.size(); ++i) {
+			for(; k < sizes[i]; ++k, ++begin) {
+				sum += values_[*begin];
+			}
+
+			scores[i] = k == 0 ? 0.0 : sum / k;
+		}
+	}
+
+	void MaxMeanEnrichment::prefixScores_(IndexIterator begin,
+	                                      const std::vector<size_t>& sizes,
+	                                      std::vector<double>& scores) const
+	{
+		double positive_sum = 0.0;
+		double negative_sum = 0.0;
+		size_t k = 0;
+
+		for(size_t i = 0; i < sizes.size(); ++i) {
+			for(; k < sizes[i]; ++k, ++begin) {
+				const double v = values_[*begin];
+				if(v < 0) {
+					negative_sum -= v;
+				} else {
+					positive_sum += v;
+				}
+			}
+
+			if(k == 0) {
+				scores[i] = 0.0;
+			} else if(negative_sum > positive_sum) {
+				scores[i] = -negative_sum / k;
+			} else {
+				scores[i] = positive_sum / k;
+			}
+		}
+	}
+
+	void MedianEnrichment::prefixScores_(IndexIterator begin,
+	                                     const std::vector<size_t>& sizes,
+	                                     std::vector<double>& scores) const
+	{
+		// Running median: lower holds the smaller half (and the middle
+		// element for odd sizes), upper the larger half.
+		std::priority_queue<double> lower;
+		std::priority_queue<double, std::vector<double>, std::greater<double>>
+		    upper;
+
+		size_t k = 0;
+		for(size_t i = 0; i < sizes.size(); ++i) {
+			for(; k < sizes[i]; ++k, ++begin) {
+				const double v = values_[*begin];
+
+				if(lower.empty() || v <= lower.top()) {
+					lower.push(v);
+				} else {
+					upper.push(v);
+				}
+
+				if(lower.size() > upper.size() + 1) {
+					upper.push(lower.top());
+					lower.pop();
+				} else if(upper.size() > lower.size()) {
+					lower.push(upper.top());
+					upper.pop();
+				}
+			}
+
+			if(k == 0) {
+				scores[i] = 0.0;
+			} else if(k % 2 == 0) {
+				scores[i] = (lower.top() + upper.top()) * 0.5;
+			} else {
+				scores[i] = lower.top();
+			}
+		}
+	}
+
+	NormalApproximationEnrichment::NormalApproximationEnrichment(
+	    const Scores& scores, Statistic statistic)
+	    : StatisticsEnrichment(statistic == Statistic::Sum
+	                               ? Statistics(statistic::sum<double, _viter>)
+	                               : Statistics(statistic::mean<double, _viter>),
+	                           scores, 0.0),
+	      statistic_(statistic),
+	      variance_(0.0)
+	{
+		updateMoments_();
+	}
+
+	void NormalApproximationEnrichment::setInputScores(const Scores& scores)
+	{
+		updateLookup_(scores);
+		updateMoments_();
+	}
+
+	void NormalApproximationEnrichment::updateMoments_()
+	{
+		// Population mean and variance of all scores
+		cached_ = statistic::mean<double>(values_.cbegin(), values_.cend());
+
+		variance_ = 0.0;
+		for(double v : values_) {
+			variance_ += (v - cached_) * (v - cached_);
+		}
+
+		if(!values_.empty()) {
+			variance_ /= values_.size();
+		}
+	}
+
+	std::tuple<double, double>
+	NormalApproximationEnrichment::computeScore(const Category& c) const
+	{
+		gather_(c);
+		const double k = buffer_.size();
+		const double score = test_(buffer_.cbegin(), buffer_.cend());
+
+		return std::make_tuple(
+		    score, statistic_ == Statistic::Sum ? k * cached_ : cached_);
+	}
+
+	double NormalApproximationEnrichment::computeRowWisePValue(
+	    EnrichmentResult* result) const
+	{
+		gather_(*result->category);
+
+		const double n = values_.size();
+		const double k = buffer_.size();
+
+		if(k == 0 || k >= n || variance_ <= 0.0) {
+			return 1.0;
+		}
+
+		// Variance of the mean of k scores drawn without replacement
+		double variance = variance_ / k * (n - k) / (n - 1);
+		if(statistic_ == Statistic::Sum) {
+			variance *= k * k;
+		}
+
+		const double z = (result->score - result->expected_score) /
+		                 std::sqrt(variance);
+
+		boost::math::normal dist(0, 1);
+		if(result->enriched) {
+			return boost::math::cdf(boost::math::complement(dist, z));
+		} else {
+			return boost::math::cdf(dist, z);
+		}
+	}
+
+	HotellingT2Enrichment::HotellingT2Enrichment(
+	    const DenseMatrix& data, const std::vector<std::string>& reference,
+	    const std::vector<std::string>& sample,
+	    const std::shared_ptr<EntityDatabase>& db)
+	    : num_reference_(reference.size()), num_sample_(sample.size())
+	{
+		const Eigen::Index num_genes = data.rows();
+		const size_t n = num_reference_ + num_sample_;
+
+		pooled_.resize(n, num_genes);
+		difference_.setZero(num_genes);
+
+		// Copies the columns of a group into the rows [offset, offset + k)
+		// of the pooled matrix and centers them.
+		auto add_group = [&](const std::vector<std::string>& names,
+		                     Eigen::Index offset, double sign) {
+			for(size_t k = 0; k < names.size(); ++k) {
+				if(!data.hasCol(names[k])) {
+					throw std::invalid_argument("Unknown sample: " + names[k]);
+				}
+
+				pooled_.row(offset + k) = data.col(data.colIndex(names[k])).transpose();
+			}
+
+			if(names.empty()) {
+				return;
+			}
+
+			auto group = pooled_.middleRows(offset, names.size());
+			const Eigen::RowVectorXd mean = group.colwise().mean();
+			group.rowwise() -= mean;
+			difference_ += sign * mean.transpose();
+		};
+
+		add_group(reference, 0, -1.0);
+		add_group(sample, num_reference_, 1.0);
+
+		// The Gram product of the scaled columns is the pooled covariance
+		if(n > 2) {
+			pooled_ /= std::sqrt(static_cast<double>(n - 2));
+		}
+
+		for(Eigen::Index i = 0; i < num_genes; ++i) {
+			const size_t entity = db->index(data.rowName(i));
+			if(entity >= column_of_entity_.size()) {
+				column_of_entity_.resize(entity + 1, -1);
+			}
+			column_of_entity_[entity] = i;
+		}
+	}
+
+	size_t HotellingT2Enrichment::members_(const Category& c,
+	                                       std::vector<Eigen::Index>& columns) const
+	{
+		columns.clear();
+		for(size_t id : c) {
+			if(id < column_of_entity_.size() && column_of_entity_[id] >= 0) {
+				columns.push_back(column_of_entity_[id]);
+			}
+		}
+
+		return columns.size();
+	}
+
+	bool HotellingT2Enrichment::canUseCategory(const Category&, size_t hits) const
+	{
+		return hits > 0 && hits + 1 < num_reference_ + num_sample_;
+	}
+
+	std::tuple<double, double>
+	HotellingT2Enrichment::computeScore(const Category& c) const
+	{
+		std::vector<Eigen::Index> columns;
+		const Eigen::Index p = members_(c, columns);
+
+		if(p == 0) {
+			return std::make_tuple(0.0, 0.0);
+		}
+
+		Eigen::MatrixXd X(pooled_.rows(), p);
+		Eigen::VectorXd d(p);
+		for(Eigen::Index j = 0; j < p; ++j) {
+			X.col(j) = pooled_.col(columns[j]);
+			d[j] = difference_[columns[j]];
+		}
+
+		Eigen::MatrixXd covariance = Eigen::MatrixXd::Zero(p, p);
+		covariance.selfadjointView<Eigen::Lower>().rankUpdate(X.transpose());
+
+		Eigen::LDLT<Eigen::MatrixXd> ldlt(covariance);
+		const double tolerance = std::numeric_limits<double>::epsilon() * p *
+		                         ldlt.vectorD().cwiseAbs().maxCoeff();
+
+		if(ldlt.info() != Eigen::Success || !ldlt.isPositive() ||
+		   (ldlt.vectorD().array() <= tolerance).any()) {
+			return std::make_tuple(std::numeric_limits<double>::quiet_NaN(), 0.0);
+		}
+
+		const double n = num_reference_ + num_sample_;
+		const double score = num_reference_ * num_sample_ / n * d.dot(ldlt.solve(d));
+
+		return std::make_tuple(score, 0.0);
+	}
+
+	double HotellingT2Enrichment::computeRowWisePValue(EnrichmentResult* result) const
+	{
+		std::vector<Eigen::Index> columns;
+		const double p = members_(*result->category, columns);
+		const double n = num_reference_ + num_sample_;
+		const double df = n - p - 1;
+
+		if(!std::isfinite(result->score) || p == 0 || df <= 0) {
+			return 1.0;
+		}
+
+		boost::math::fisher_f F(p, df);
+		const double f = result->score * df / ((n - 2) * p);
+
+		return boost::math::cdf(boost::math::complement(F, f));
 	}
 }
@@ -66,9 +66,22 @@ namespace GeneTrail
 		struct SupportsIndices
 		{
 		};
+		/// Indices are supported and the scores of all prefixes of a
+		/// shuffled index list can be computed at once.
+		struct SupportsPrefixScores : public SupportsIndices
+		{
+		};
 		struct DoesNotSupportIndices
 		{
 		};
+		struct Sequential
+		{
+		};
+		/// computeScore and computeRowWisePValue are thread-safe, so that
+		/// categories can be evaluated in parallel.
+		struct Concurrent
+		{
+		};
 	}
 
 	enum NullHypothesis {
@@ -79,38 +92,87 @@ namespace GeneTrail
 
 	template <typename Mode = StatTags::Indirect,
 	          typename Indices = StatTags::DoesNotSupportIndices,
-	          typename Input = StatTags::Scores>
+	          typename Input = StatTags::Scores,
+	          typename Concurrency = StatTags::Sequential>
 	class SetLevelStatistics
 	{
 		public:
 		using RowWiseMode = Mode;
 		using InputType = Input;
 		using SupportsIndices = Indices;
+		using ConcurrencyType = Concurrency;
 	};
 
-	class GT2_EXPORT StatisticsEnrichment : public SetLevelStatistics<>
+	/**
+	 * Base class for statistics that are computed from the scores of the
+	 * category members alone.
+	 *
+	 * The scores are stored sorted decreasingly, indices refer to positions
+	 * in this list. Additionally, the scores are stored by entity index so
+	 * the members of a category can be gathered without creating a subset.
+	 * Derived classes can provide an incremental computation of the
+	 * statistic for all prefixes of a shuffled index list, which is used to
+	 * compute the permutation null for all category sizes at once.
+	 */
+	class GT2_EXPORT StatisticsEnrichment
+	    : public SetLevelStatistics<StatTags::Indirect,
+	                                StatTags::SupportsPrefixScores>
 	{
 		public:
-		using _viter = Scores::ConstScoreIterator;
+		using _viter = std::vector<double>::const_iterator;
 		using Statistics = std::function<double(_viter, _viter)>;
 
 		StatisticsEnrichment(const Statistics& test, const Scores& scores);
 		StatisticsEnrichment(const Statistics& test, const Scores& scores,
 		                     double cached);
+		virtual ~StatisticsEnrichment() = default;
 
 		void setInputScores(const Scores& scores);
 
 		bool canUseCategory(const Category&, size_t) const { return true; }
 
+		Order getOrder() const { return Order::Decreasing; }
+
 		std::tuple<double, double> computeScore(const Category& c) const;
 
+		std::tuple<double, double> computeScore(IndexIterator begin,
+		                                        IndexIterator end) const;
+
+		/**
+		 * Computes the statistic for the first sizes[i] entries of the
+		 * index list starting at begin. The sizes must be sorted
+		 * increasingly.
+		 */
+		void computePrefixScores(IndexIterator begin,
+		                         const std::vector<size_t>& sizes,
+		                         std::vector<double>& scores) const;
+
 		protected:
 		virtual double cacheStatistic_() const;
 		virtual double getExpectedValue_(const Category&) const;
+		virtual void prefixScores_(IndexIterator begin,
+		                           const std::vector<size_t>& sizes,
+		                           std::vector<double>& scores) const;
+
+		/// Copies the scores of the members of c into buffer_.
+		void gather_(const Category& c) const;
+
+		void updateLookup_(const Scores& scores);
 
 		Statistics test_;
-		Scores scores_;
 		double cached_;
+
+		// Scores sorted decreasingly
+		std::vector<double> values_;
+
+		// Scores by entity index
+		std::vector<double> entity_values_;
+		std::vector<char> has_value_;
+
+		// Scratch space shared by all computeScore calls. This is only safe
+		// because the statistics are StatTags::Sequential, i.e. categories
+		// are never evaluated concurrently on the same instance.
+		mutable std::vector<double> buffer_;
 	};
 
 	class GT2_EXPORT SumEnrichment final : public StatisticsEnrichment
@@ -129,9 +191,13 @@ namespace GeneTrail
 		{
 			return c.size() * cached_;
 		}
+
+		void prefixScores_(IndexIterator begin,
+		                   const std::vector<size_t>& sizes,
+		                   std::vector<double>& scores) const override;
 	};
 
-	class MaxMeanEnrichment final : public StatisticsEnrichment
+	class GT2_EXPORT MaxMeanEnrichment final : public StatisticsEnrichment
 	{
 		public:
 		MaxMeanEnrichment(const Scores& scores)
@@ -142,24 +208,124 @@ namespace GeneTrail
 
 		protected:
 		double cacheStatistic_() const override { return 0.0; }
+
+		void prefixScores_(IndexIterator begin,
+		                   const std::vector<size_t>& sizes,
+		                   std::vector<double>& scores) const override;
 	};
 
-	class MedianEnrichment final : public StatisticsEnrichment
+	class GT2_EXPORT MedianEnrichment final : public StatisticsEnrichment
 	{
 		public:
 		MedianEnrichment(const Scores& scores)
 		    : StatisticsEnrichment(statistic::median<double, _viter>, scores)
 		{
 		}
+
+		protected:
+		void prefixScores_(IndexIterator begin,
+		                   const std::vector<size_t>& sizes,
+		                   std::vector<double>& scores) const override;
 	};
 
-	class MeanEnrichment final : public StatisticsEnrichment
+	class GT2_EXPORT MeanEnrichment final : public StatisticsEnrichment
 	{
 		public:
 		MeanEnrichment(const Scores& scores)
 		    : StatisticsEnrichment(statistic::mean<double, _viter>, scores)
 		{
 		}
+
+		protected:
+		void prefixScores_(IndexIterator begin,
+		                   const std::vector<size_t>& sizes,
+		                   std::vector<double>& scores) const override;
+	};
+
+	/**
+	 * Mean or sum of the category members with p-values from a normal
+	 * approximation. The null distribution of the statistic for random sets
+	 * of k genes drawn without replacement has the mean k * mu and the
+	 * variance k * sigma^2 * (n - k) / (n - 1) for the sum, and the
+	 * corresponding moments for the mean. No permutations are needed.
+	 */
+	class GT2_EXPORT NormalApproximationEnrichment final
+	    : public StatisticsEnrichment
+	{
+		public:
+		using RowWiseMode = StatTags::Direct;
+
+		enum class Statistic { Mean, Sum };
+
+		NormalApproximationEnrichment(const Scores& scores, Statistic statistic);
+
+		void setInputScores(const Scores& scores);
+
+		using StatisticsEnrichment::computeScore;
+		std::tuple<double, double> computeScore(const Category& c) const;
+
+		double computeRowWisePValue(EnrichmentResult* result) const;
+
+		private:
+		void updateMoments_();
+
+		Statistic statistic_;
+		double variance_;
+	};
+
+	/**
+	 * Two-sample Hotelling T^2 test comparing the mean expression of the
+	 * category members between a reference and a sample group.
+	 *
+	 * Both groups are centered once and stored as one pooled matrix with
+	 * the genes as contiguous columns. The pooled covariance of a category
+	 * is the Gram product of the columns of its members, and the quadratic
+	 * form is evaluated with an LDLT solve. As no state is modified,
+	 * categories are evaluated in parallel.
+	 */
+	class GT2_EXPORT HotellingT2Enrichment
+	    : public SetLevelStatistics<StatTags::Direct,
+	                                StatTags::DoesNotSupportIndices,
+	                                StatTags::Identifiers,
+	                                StatTags::Concurrent>
+	{
+		public:
+		/**
+		 * @param data Matrix with genes as rows and samples as columns.
+		 * @param reference Names of the columns of the reference group.
+		 * @param sample Names of the columns of the sample group.
+		 * @param db The database the categories are based on.
+		 *
+		 * @throws std::invalid_argument if a column cannot be found.
+		 */
+		HotellingT2Enrichment(const DenseMatrix& data,
+		                      const std::vector<std::string>& reference,
+		                      const std::vector<std::string>& sample,
+		                      const std::shared_ptr<EntityDatabase>& db);
+
+		/**
+		 * The test requires at least one member and more samples than
+		 * members + 1.
+		 */
+		bool canUseCategory(const Category& c, size_t hits) const;
+
+		/**
+		 * Returns the T^2 statistic. It is NaN if the covariance of the
+		 * members is singular.
+		 */
+		std::tuple<double, double> computeScore(const Category& c) const;
+
+		double computeRowWisePValue(EnrichmentResult* result) const;
+
+		private:
+		size_t members_(const Category& c, std::vector<Eigen::Index>& columns) const;
+
+		// Samples x genes, centered per group and scaled by 1/sqrt(n-2)
+		Eigen::MatrixXd pooled_;
+		Eigen::VectorXd difference_;
+		std::vector<Eigen::Index> column_of_entity_;
+		size_t num_reference_;
+		size_t num_sample_;
 	};
 
 	template <typename Test>
@@ -233,74 +399,85 @@ namespace GeneTrail
 		Test test_;
 	};
 
-    template <typename T>
-    class HTestEnrichment<WilcoxonRankSumTest<T>>
-        : public HTestEnrichmentBase<WilcoxonRankSumTest<T>>
-    {
-	  public:
+	/**
+	 * Rank sum enrichment. The input scores are ranked once and the ranks
+	 * are stored by entity index, so the rank sum of a category is a
+	 * simple gather over its members.
+	 */
+	template <typename T>
+	class HTestEnrichment<WilcoxonRankSumTest<T>>
+	    : public HTestEnrichmentBase<WilcoxonRankSumTest<T>>
+	{
+		public:
 		using Base = HTestEnrichmentBase<WilcoxonRankSumTest<T>>;
 
-		HTestEnrichment(const Scores& scores)
-			: Base(scores),
-			  sorted_scores_(scores)
+		HTestEnrichment(const Scores& scores) : Base(scores)
 		{
-			updateSortedScores_();
+			updateRanks_();
 		}
 
-	    void setInputScores(const Scores& scores)
-	    {
-		    this->scores_ = scores;
-		    this->scores_.sortByIndex();
-		    this->sorted_scores_ = scores;
+		void setInputScores(const Scores& scores)
+		{
+			this->scores_ = scores;
+			this->scores_.sortByIndex();
 
-			updateSortedScores_();
-	    }
+			updateRanks_();
+		}
 
-	    bool canUseCategory(const Category&, size_t hits) const
-	    {
-		    return hits > 1;
-	    }
+		bool canUseCategory(const Category&, size_t hits) const
+		{
+			return hits > 1;
+		}
 
-	    double computeRowWisePValue(EnrichmentResult* result)
-	    {
-		    return Base::computeRowWisePValue(test_, result);
-	    }
+		double computeRowWisePValue(EnrichmentResult* result)
+		{
+			return Base::computeRowWisePValue(test_, result);
+		}
 
-	    std::tuple<double, double> computeScore(const Category& c)
-	    {
-		    using namespace boost;
+		std::tuple<double, double> computeScore(const Category& c)
+		{
+			T rank_sum = 0;
+			size_t size1 = 0;
 
-		    auto which = this->scores_.subset(c);
-			which.sortByScore(Order::Increasing);
+			for(size_t id : c) {
+				if(id < has_rank_.size() && has_rank_[id]) {
+					rank_sum += ranks_[id];
+					++size1;
+				}
+			}
 
-		    auto score = test_.test_sorted(sorted_scores_, which.begin(), which.end());
+			auto score = test_.computeZScoreFromRankSum(
+			    rank_sum, size1, this->scores_.size() - size1);
 
-		    return std::make_tuple(score, 0.0);
-	    }
+			return std::make_tuple(score, 0.0);
+		}
 
-	  private:
-		void updateSortedScores_()
+		private:
+		void updateRanks_()
 		{
-		    score_permutation_.resize(this->scores_.size());
-		    std::iota(score_permutation_.begin(), score_permutation_.end(),
-		              static_cast<size_t>(0));
+			auto ranks = WilcoxonRankSumTest<T>::tiedRanks(
+			    this->scores_.scores().begin(), this->scores_.scores().end());
 
-		    auto comp = [this](size_t i, size_t j) {
-				return Scores::LessScore()(this->scores_[i], this->scores_[j]);
-			};
+			// The scores are sorted by index, so the last entry has the
+			// largest index.
+			const size_t n =
+			    this->scores_.size() == 0
+			        ? 0
+			        : this->scores_[this->scores_.size() - 1].index() + 1;
 
-		    score_permutation_ = sort_permutation(
-		        score_permutation_.begin(), score_permutation_.end(), comp);
+			ranks_.assign(n, T());
+			has_rank_.assign(n, 0);
 
-		    for(size_t i = 0; i < sorted_scores_.size(); ++i) {
-			    sorted_scores_.set(i, this->scores_[score_permutation_[i]]);
-		    }
+			for(size_t i = 0; i < this->scores_.size(); ++i) {
+				ranks_[this->scores_[i].index()] = ranks[i];
+				has_rank_[this->scores_[i].index()] = 1;
+			}
 		}
 
-	    WilcoxonRankSumTest<T> test_;
-	    Scores sorted_scores_;
-	    std::vector<size_t> score_permutation_;
-    };
+		WilcoxonRankSumTest<T> test_;
+		std::vector<T> ranks_;
+		std::vector<char> has_rank_;
+	};
 
 	template <typename T>
 	class HTestEnrichment<OneSampleTTest<T>>
@@ -22,13 +22,15 @@
 
 #include "EnrichmentAlgorithm.h"
 #include "EnrichmentResult.h"
+#include "EnrichmentResultStore.h"
+#include "EnrichmentResultWriter.h"
 #include "Parameters.h"
 #include "PermutationTest.h"
 
 #include <genetrail2/core/DenseMatrixReader.h>
-#include <genetrail2/core/GeneSet.h>
 #include <genetrail2/core/GeneSetReader.h>
-#include <genetrail2/core/GMTFile.h>
+#include <genetrail2/core/Scores.h>
+#include <genetrail2/core/CompiledCategoryFile.h>
 #include <genetrail2/core/PValue.h>
 #include <genetrail2/core/TextFile.h>
 
@@ -36,6 +38,8 @@
 
 #include <algorithm>
 #include <fstream>
+#include <numeric>
+#include <unordered_map>
 
 static CategoryList getCategoryList(const std::string& catfile_list)
 {
@@ -62,90 +66,76 @@ static CategoryList getCategoryList(const std::string& catfile_list)
 	return categories;
 }
 
-static void readTestSet(GeneSet& test_set, const Params& p)
+static void readTestSet(Scores& test_set, const Params& p)
 {
 	GeneSetReader reader;
 	if(p.scores() != "" && p.identifier() != "") {
 		throw GeneTrail::IOError("Too many input files specified.");
 	} else if(p.scores() != "") {
-		test_set = reader.readScoringFile(p.scores());
+		test_set = reader.readScoringFile(p.scores(), test_set.db());
 	} else if(p.identifier() != "") {
-		test_set = reader.readGeneList(p.identifier());
+		test_set = reader.readGeneList(p.identifier(), test_set.db());
 	} else {
 		throw GeneTrail::IOError("No input file specified.");
 	}
 }
 
-static PValueList resultVector(const Results& results)
+/**
+ * Adjusts the p-values of the results [begin, end) of the store in one go.
+ * The p-values are gathered into a contiguous array, so neither keys need
+ * to be built nor the results looked up again.
+ */
+static void adjust(EnrichmentResultStore& store, size_t begin, size_t end,
+                   MultipleTestingCorrection correction)
 {
-	PValueList result;
-	result.reserve(results.size());
-	for(const auto& jt : results) {
-		result.push_back(
-		    std::make_pair(jt.first, jt.second->pvalue.convert_to<double>()));
+	std::vector<double> pvalues(end - begin);
+	for(size_t i = begin; i < end; ++i) {
+		pvalues[i - begin] = store.pValue(i).convert_to<double>();
 	}
-	return result;
-}
 
-static PValueList resultVector(const AllResults& results)
-{
-	PValueList result;
-	result.reserve(results.size());
-	for(const auto& it : results) {
-		for(const auto& jt : it.second) {
-			result.push_back(
-			    std::make_pair(it.first + "\t" + jt.first,
-			                   jt.second->pvalue.convert_to<double>()));
-		}
+	pvalue::adjustInPlace(pvalues, correction);
+
+	for(size_t i = begin; i < end; ++i) {
+		store.setPValue(i, pvalues[i - begin]);
 	}
-	return result;
 }
 
-static std::tuple<bool, size_t, std::string>
+/**
+ * Determines if a category passes the size filter and the entity indices
+ * of its hits, ordered by name as they are reported in this order.
+ */
+static std::pair<bool, std::vector<size_t>>
 processCategory(const Category& c, const Scores& test_set, const Params& p)
 {
 	Scores subset = test_set.subset(c);
 	subset.sortByName();
 
-	std::string entries;
-	for(const auto& entry : subset.names()) {
-		entries += entry + ',';
-	}
-
-	if(!entries.empty()) {
-		entries.resize(entries.size() - 1);
-	}
+	std::vector<size_t> hits(subset.indices().begin(), subset.indices().end());
+	const bool isValid = p.minimum <= hits.size() && hits.size() <= p.maximum;
 
-	return std::make_tuple(p.minimum <= subset.size() && subset.size() <= p.maximum, subset.size(), std::move(entries));
+	return std::make_pair(isValid, std::move(hits));
 }
 
-static void writeFiles(const std::string& output_dir, const AllResults& all_results, const bool justScores, const bool justPvalues)
+static void writeDatabase(const EnrichmentResultStore& store, size_t database,
+                          const Params& p)
 {
+	const std::string path = p.out() + "/" + store.databaseName(database) +
+	                         (p.binaryOutput ? ".bin" : ".txt");
 
-	size_t size = 0;
-	for(auto& results_it : all_results) {
-		size += results_it.second.size();
+	std::ofstream output(path, std::ios::binary);
+	if(!output) {
+		throw GeneTrail::IOError("Could not open " + path + " for writing.");
 	}
 
-	for(const auto& database : all_results) {
-		std::ofstream output(output_dir + "/" + database.first + ".txt");
-		if(database.second.begin() == database.second.end()) {
-			output.close();
-			continue;
-		}
-		if(!output) {
-			throw GeneTrail::IOError("No input file specified.");
-		}
-		output << database.second.begin()->second->header(justScores, justPvalues) << std::endl;
-		for(const auto& ele : database.second) {
-			ele.second->serialize(output, justScores, justPvalues);
-			output << std::endl;
-		}
-		output.close();
+	EnrichmentResultWriter writer;
+	if(p.binaryOutput) {
+		writer.writeBinary(output, store, database);
+	} else {
+		writer.writeText(output, store, database, p.justScores, p.justPvalues);
 	}
 }
 
-int initTestSet(GeneSet& test_set, const Params& p){
+int initTestSet(Scores& test_set, const Params& p){
 	try {
 		readTestSet(test_set, p);
 	} catch(IOError& exn) {
@@ -172,110 +162,139 @@ int initCategories(CategoryList& cat_list, const Params& p){
 	return 0;
 }
 
-int init(GeneSet& test_set, CategoryList& cat_list, const Params& p)
+int init(Scores& test_set, CategoryList& cat_list, const Params& p)
 {
 	if(initTestSet(test_set, p) != 0) return -1;
 	return initCategories(cat_list, p);
 }
 
-static void updatePValues(Results& results, const PValueList& pvalues)
-{
-	for(const auto& it : pvalues) {
-		results[it.first]->pvalue = it.second;
-	}
-}
-
-static void updatePValues(AllResults& results, const PValueList& pvalues)
-{
-	for(unsigned int i = 0; i < pvalues.size(); ++i) {
-		std::vector<std::string> s;
-		boost::split(s, pvalues[i].first, boost::is_any_of("\t"));
-		results[s[0]][s[1]]->pvalue = pvalues[i].second;
-	}
-}
-
-static void computeOne(AllResults& name_to_cat_results, Scores& test_set,
-					   const CategoryDatabase& category_db,
-					   EnrichmentAlgorithmPtr& algorithm, const Params& p)
+/**
+ * Computes the results of a database and appends them to the store,
+ * ordered by category name. If keep is given, the results are appended to
+ * it as well, so that their p-values can be computed afterwards.
+ */
+static void computeOne(EnrichmentResultStore& store, EnrichmentResults* keep,
+                       Scores& test_set, const CategoryDatabase& category_db,
+                       EnrichmentAlgorithmPtr& algorithm, const Params& p)
 {
-	Results name_to_result;
+	// Usable categories are collected first, so that algorithms that
+	// support it can evaluate them in parallel.
+	std::vector<std::shared_ptr<Category>> usable;
+	std::vector<std::shared_ptr<EnrichmentResult>> results;
+	std::vector<std::vector<size_t>> hits;
 	for(const auto& c : category_db) {
 		if(p.verbose) std::cout << "INFO: Processing - " << category_db.name() << " - " << c.name() << std::endl;
 		auto processed = processCategory(c, test_set, p);
 
-		std::shared_ptr<EnrichmentResult> result;
-		auto isValid = std::get<0>(processed);
+		auto isValid = processed.first;
 
 		// TODO: get rid of this
 		auto tmp_cat = std::make_shared<Category>(c);
-		if(algorithm->canUseCategory(c, std::get<1>(processed)) && isValid) {
-			result = algorithm->computeEnrichment(tmp_cat);
+		if(algorithm->canUseCategory(c, processed.second.size()) && isValid) {
+			usable.push_back(tmp_cat);
+			results.emplace_back();
 		} else {
 			if(!isValid && !p.includeAll){
 				continue;
 			}
-			result = std::make_shared<EnrichmentResult>(tmp_cat);
+			results.push_back(std::make_shared<EnrichmentResult>(tmp_cat));
 		}
 
-		result->hits = std::get<1>(processed);
-		result->info = std::move(std::get<2>(processed));
+		hits.push_back(std::move(processed.second));
+	}
+
+	auto computed = algorithm->computeEnrichments(usable, p.numThreads);
+
+	for(size_t i = 0, j = 0; i < results.size(); ++i) {
+		if(!results[i]) {
+			results[i] = std::move(computed[j++]);
+		}
+
+		results[i]->hits = hits[i].size();
+	}
+
+	// Results are reported by name, for duplicate names only the first
+	// category is kept.
+	std::vector<size_t> order(results.size());
+	std::iota(order.begin(), order.end(), size_t(0));
+	std::stable_sort(order.begin(), order.end(), [&results](size_t a, size_t b) {
+		return results[a]->category->name() < results[b]->category->name();
+	});
+
+	store.addDatabase(category_db.name());
+	for(size_t k = 0; k < order.size(); ++k) {
+		const auto& result = results[order[k]];
+		if(k > 0 && result->category->name() == results[order[k - 1]]->category->name()) {
+			continue;
+		}
+
+		store.add(*result, hits[order[k]]);
+
+		if(keep) {
+			keep->push_back(result);
+		}
+	}
+}
 
-		name_to_result.emplace(c.name(), std::move(result));
+/**
+ * Databases are written to files named after them. For duplicate names
+ * only the first database is used.
+ */
+static bool isDuplicate(const EnrichmentResultStore& store, const std::string& name)
+{
+	for(size_t d = 0; d < store.numDatabases(); ++d) {
+		if(store.databaseName(d) == name) {
+			std::cerr << "WARNING: Skipping duplicate category database "
+			          << name << "!" << std::endl;
+			return true;
+		}
 	}
-	//std::cerr << "[" << category_db.name() << "]";
-	name_to_cat_results.emplace(category_db.name(), std::move(name_to_result));
+
+	return false;
 }
 
-static AllResults compute(Scores& test_set, const CategoryList& cat_list,
-                   EnrichmentAlgorithmPtr& algorithm, const Params& p)
+/**
+ * Computes the results of all databases, done is called after each
+ * database has been added to the store.
+ */
+template <typename Callback>
+static void compute(EnrichmentResultStore& store, EnrichmentResults* keep,
+                    Scores& test_set, const CategoryList& cat_list,
+                    EnrichmentAlgorithmPtr& algorithm, const Params& p,
+                    Callback done)
 {
-	AllResults name_to_cat_results;
 	for(const auto& cat : cat_list) {
-		try {
-			GMTFile input(test_set.db(), cat.second);
-			if(!input) {
-				std::cerr << "WARNING: Could not open database " + cat.first +
-									" for reading! Skipping database."
-							<< std::endl;
-				continue;
-			}
+		if(isDuplicate(store, cat.first)) {
+			continue;
+		}
 
-			auto category_db = input.read();
+		try {
+			auto category_db = readCategoryDatabase(test_set.db(), cat.second);
 			category_db.setName(cat.first);
-			computeOne(name_to_cat_results, test_set, category_db, algorithm, p);
+			computeOne(store, keep, test_set, category_db, algorithm, p);
 		} catch(IOError& exn) {
 			std::cerr << "WARNING: Could not process category file "
 				<< cat.first << "! " << exn.what() << std::endl;
+			continue;
 		}
-	}
 
-	return name_to_cat_results;
-}
-
-static AllResults compute(Scores& test_set, const CategoryDBList& category_db,
-						  EnrichmentAlgorithmPtr& algorithm, const Params& p)
-{
-	AllResults name_to_cat_results;
-	for(const auto& db : category_db) {
-		computeOne(name_to_cat_results, test_set, db, algorithm, p);
+		done();
 	}
-	
-	return name_to_cat_results;
 }
 
-static void adjustCombined(AllResults& all_results, MultipleTestingCorrection correction)
+template <typename Callback>
+static void compute(EnrichmentResultStore& store, EnrichmentResults* keep,
+                    Scores& test_set, const CategoryDBList& category_db,
+                    EnrichmentAlgorithmPtr& algorithm, const Params& p,
+                    Callback done)
 {
-	auto results = resultVector(all_results);
-	results = pvalue::adjustPValues(results, pvalue::get_second(), correction);
-	updatePValues(all_results, results);
-}
+	for(const auto& db : category_db) {
+		if(isDuplicate(store, db.name())) {
+			continue;
+		}
 
-static void adjustSeparately(AllResults& all_results, MultipleTestingCorrection correction)
-{
-	for(auto& results_it : all_results) {
-		auto results = resultVector(results_it.second);
-		results = pvalue::adjustPValues(results, pvalue::get_second(), correction);
-		updatePValues(results_it.second, results);
+		computeOne(store, keep, test_set, db, algorithm, p);
+		done();
 	}
 }
 
@@ -336,13 +355,19 @@ static void sortMatrixRows(DenseMatrix& data, const EntityDatabase* db) {
 	std::vector<size_t> matrix_indices(data.rows());
 	db->transform(data.rowNames(), matrix_indices.begin());
 
-	auto permutation = sort_permutation(matrix_indices.begin(), matrix_indices.end(), std::less<size_t>());
-
-	std::vector<DenseMatrix::index_type> tmp(permutation.size());
+	// Matrices that are already ordered by entity need not be touched
+	if(std::is_sorted(matrix_indices.begin(), matrix_indices.end())) {
+		return;
+	}
 
-	std::copy(permutation.begin(), permutation.end(), tmp.begin());
+	std::vector<DenseMatrix::index_type> permutation(matrix_indices.size());
+	std::iota(permutation.begin(), permutation.end(), 0);
+	std::sort(permutation.begin(), permutation.end(),
+	          [&matrix_indices](DenseMatrix::index_type a, DenseMatrix::index_type b) {
+		          return matrix_indices[a] < matrix_indices[b];
+	          });
 
-	data.shuffleRows(tmp);
+	data.shuffleRows(permutation);
 }
 
 static void computeColumnWisePValues(const EnrichmentAlgorithmPtr& algorithm,
@@ -386,53 +411,92 @@ computeRestandardizationPValues(const EnrichmentAlgorithmPtr&)
 }
 
 static void computePValues(EnrichmentAlgorithmPtr& algorithm,
-                    const AllResults& name_to_cat_results, const Scores& scores, const Params& p)
+                           EnrichmentResults& results, const Scores& scores,
+                           const Params& p)
 {
-	EnrichmentResults results;
-
-	// TODO: This is really inefficient and clumsy
-	//      we should have a better way of getting the necessary stuff
-	//      together for pvalue computation.
-	for(const auto& db : name_to_cat_results) {
-		for(const auto& result : db.second) {
-			results.push_back(result.second);
-		}
-	}
-
 	switch(algorithm->pValueMode()) {
 		case PValueMode::RowWise:
 			computeRowWisePValues(algorithm, results, scores, p);
 			break;
-                case PValueMode::ColumnWise:
-                        computeColumnWisePValues(algorithm, results, scores, p, scores.db().get());
-                        break;
-                case PValueMode::Restandardize:
-                        computeRestandardizationPValues(algorithm);
-                        break;
-        }
+		case PValueMode::ColumnWise:
+			computeColumnWisePValues(algorithm, results, scores, p, scores.db().get());
+			break;
+		case PValueMode::Restandardize:
+			computeRestandardizationPValues(algorithm);
+			break;
+	}
 }
 
 template <typename Categories>
 void run(Scores& test_set, const Categories& cat_list,
          EnrichmentAlgorithmPtr& algorithm, const Params& p, bool computePValue)
 {
-        test_set.sortByIndex();
-
-        AllResults name_to_cat_results(compute(test_set, cat_list, algorithm, p));
-        if(computePValue && !algorithm->pValuesComputed()) {
-                computePValues(algorithm, name_to_cat_results, test_set, p);
-        }
-
-        if(p.adjustment && boost::get(p.adjustment) != MultipleTestingCorrection::GSEA) {
-                // Checks how they should be adjusted
-                if(p.adjustSeparately) {
-                        adjustSeparately(name_to_cat_results, p.adjustment.get());
-                } else {
-                        adjustCombined(name_to_cat_results, p.adjustment.get());
-                }
-        }
-
-        writeFiles(p.out(), name_to_cat_results, p.justScores, p.justPvalues);
+	test_set.sortByIndex();
+
+	const bool pending = computePValue && !algorithm->pValuesComputed();
+	const bool adjustment =
+	    p.adjustment && boost::get(p.adjustment) != MultipleTestingCorrection::GSEA;
+
+	// A database can be written as soon as it is computed, unless its
+	// p-values depend on the other databases.
+	const bool streaming = !pending && (!adjustment || p.adjustSeparately);
+
+	EnrichmentResultStore store(test_set.db());
+	EnrichmentResults pending_results;
+
+	compute(store, pending ? &pending_results : nullptr, test_set, cat_list,
+	        algorithm, p, [&]() {
+		        if(!streaming) {
+			        return;
+		        }
+
+		        const size_t d = store.numDatabases() - 1;
+		        if(adjustment) {
+			        adjust(store, store.databaseBegin(d), store.databaseEnd(d),
+			               p.adjustment.get());
+		        }
+
+		        writeDatabase(store, d, p);
+		        store.clearResults();
+	        });
+
+	if(streaming) {
+		return;
+	}
+
+	if(pending) {
+		// The permutation tests reorder the results, thus every result
+		// needs to remember its row in the store.
+		std::unordered_map<const EnrichmentResult*, size_t> rows;
+		rows.reserve(pending_results.size());
+		for(size_t i = 0; i < pending_results.size(); ++i) {
+			rows.emplace(pending_results[i].get(), i);
+		}
+
+		computePValues(algorithm, pending_results, test_set, p);
+
+		for(const auto& result : pending_results) {
+			store.setPValue(rows.at(result.get()), result->pvalue);
+		}
+
+		pending_results.clear();
+	}
+
+	if(adjustment) {
+		// Checks how they should be adjusted
+		if(p.adjustSeparately) {
+			for(size_t d = 0; d < store.numDatabases(); ++d) {
+				adjust(store, store.databaseBegin(d), store.databaseEnd(d),
+				       p.adjustment.get());
+			}
+		} else {
+			adjust(store, 0, store.size(), p.adjustment.get());
+		}
+	}
+
+	for(size_t d = 0; d < store.numDatabases(); ++d) {
+		writeDatabase(store, d, p);
+	}
 }
 
 template
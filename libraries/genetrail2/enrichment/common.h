@@ -43,8 +43,6 @@ using namespace GeneTrail;
 
 namespace GeneTrail
 {
-	class GeneSet;
-
 	struct DirectoryPath;
 	struct EnrichmentResult;
 	struct FilePath;
@@ -53,24 +51,21 @@ namespace GeneTrail
 	using EnrichmentAlgorithmPtr = std::unique_ptr<EnrichmentAlgorithm>;
 }
 
-typedef std::map<std::string, std::shared_ptr<EnrichmentResult>> Results;
-typedef std::map<std::string, Results> AllResults;
-typedef std::vector<std::pair<std::string, double>> PValueList;
-
 using CategoryList = std::list<std::pair<std::string, std::string>>;
 using CategoryDBList = std::vector<CategoryDatabase>;
 
 /**
  * This function initializes the needed attributes.
  *
- * @param test_set Test set to be filled
+ * @param test_set Test set to be filled, its entity database is used to
+ *                 register the identifiers
  * @param cat_list CategoryList to be filled
  * @param p Parameter object
  * @return -1 if an error occurred and 0 if not
  */
-GT2_EXPORT int init(GeneSet& test_set, CategoryList& cat_list, const Params& p);
+GT2_EXPORT int init(Scores& test_set, CategoryList& cat_list, const Params& p);
 
-GT2_EXPORT int initTestSet(GeneSet& test_set, const Params& p);
+GT2_EXPORT int initTestSet(Scores& test_set, const Params& p);
 
 GT2_EXPORT int initCategories(CategoryList& cat_list, const Params& p);
 
@@ -25,12 +25,12 @@
 #include <genetrail2/core/Exception.h>
 #include <genetrail2/core/Matrix.h>
 #include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/NameDatabases.h>
 
 #include "RegulationFile.h"
 
-#include <boost/filesystem.hpp>
 #include <boost/lexical_cast.hpp>
-#include <boost/algorithm/string.hpp>
+#include <boost/utility/string_ref.hpp>
 
 #include <unordered_set>
 #include <map>
@@ -78,55 +78,24 @@ template <typename NameDatabase, typename ValueType> class GT2_EXPORT Regulation
 	           const std::unordered_set<size_t>& test_set,
 	           const std::string& file, value_type default_value)
 	{
-		std::ifstream input(file);
-		if(!input) {
-			throw GeneTrail::IOError("File (" + file +
-			                         ") is not open for reading");
-		}
-
-		std::vector<std::string> sline;
-		for(std::string line; getline(input, line);) {
-			boost::trim_if(line, boost::is_any_of("\t "));
-			boost::split(sline, line, boost::is_any_of(" \t"), boost::token_compress_on);
-			if(sline.size() == 2) {
-				addRegulation_(name_database, test_set, sline[0], sline[1],
-				               default_value);
-			} else if(sline.size() == 3) {
-				addRegulation_(name_database, test_set, sline[0], sline[1],
-				               boost::lexical_cast<value_type>(sline[2]));
-			} else {
-				throw GeneTrail::IOError("Wrong file format.");
-			}
-		}
+		forEachRegulation(file, default_value,
+		                  [&](const std::string& regulator,
+		                      const std::string& target, value_type value) {
+			                  addRegulation_(name_database, test_set,
+			                                 regulator, target, value);
+		                  });
 	}
 	//function for MAGAE
 	void read_(NameDatabase& name_database, NameDatabase& name_database_micro,
 	           const std::unordered_set<size_t>& test_set,
 	           const std::string& file, value_type default_value)
 	{
-		std::ifstream input(file);
-		if(!input) {
-			throw GeneTrail::IOError("File (" + file +
-			                         ") is not open for reading");
-		}
-
-		std::vector<std::string> sline;
-		for(std::string line; getline(input, line);) {
-
-			boost::trim_if(line, boost::is_any_of("\t "));
-			boost::split(sline, line, boost::is_any_of(" \t"), boost::token_compress_on);
-
-			if(sline.size() == 2) {
-				addRegulation_(name_database,name_database_micro, test_set, sline[0], sline[1],
-				               default_value);
-			} else if(sline.size() == 3) {
-				addRegulation_(name_database,name_database_micro, test_set, sline[0], sline[1],
-				               boost::lexical_cast<value_type>(sline[2]));
-			} else {
-				throw GeneTrail::IOError("Wrong file format.");
-			}
-
-		}
+		forEachRegulation(file, default_value,
+		                  [&](const std::string& regulator,
+		                      const std::string& target, value_type value) {
+			                  addRegulation_(name_database, name_database_micro,
+			                                 test_set, regulator, target, value);
+		                  });
 	}
 
 	void addRegulation_(NameDatabase& name_database,
@@ -1,51 +1,207 @@
 #include "RegulatorEffectResultAggregator.h"
 
+#include <rapidjson/istreamwrapper.h>
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/reader.h>
+#include <rapidjson/stringbuffer.h>
+
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <tuple>
+
 namespace GeneTrail
 {
+namespace
+{
+/**
+ * SAX handler that passes the regulator, rank and p-value of every entry
+ * of a REGGAE result file to the aggregator. All other fields are
+ * skipped, so the file is never held in memory.
+ */
+class ResultHandler
+    : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, ResultHandler>
+{
+  public:
+	ResultHandler(RegulatorEffectResultAggregator& aggregator)
+	    : aggregator_(aggregator)
+	{
+	}
+
+	// Scalars outside of an entry are invalid, inside they are skipped
+	bool Default() { return depth_ > 1; }
+
+	bool Int(int i) { return number_(i); }
+	bool Uint(unsigned u) { return number_(u); }
+	bool Int64(int64_t i) { return number_(i); }
+	bool Uint64(uint64_t u) { return number_(u); }
+	bool Double(double d) { return number_(d); }
+
+	bool String(const char* str, rapidjson::SizeType length, bool)
+	{
+		if(depth_ == 2 && key_ == "regulator") {
+			name_.assign(str, length);
+			has_name_ = true;
+			return true;
+		}
+
+		return Default();
+	}
+
+	bool Key(const char* str, rapidjson::SizeType length, bool)
+	{
+		if(depth_ == 2) {
+			key_.assign(str, length);
+		}
+
+		return true;
+	}
+
+	bool StartObject()
+	{
+		// Every entry of the top-level array is an object
+		if(depth_ == 0) {
+			return false;
+		}
+
+		if(++depth_ == 2) {
+			has_name_ = has_rank_ = has_p_value_ = false;
+			key_.clear();
+		}
+
+		return true;
+	}
+
+	bool EndObject(rapidjson::SizeType)
+	{
+		if(depth_-- == 2) {
+			if(!has_name_) {
+				throw IOError("Found result without name.");
+			}
+
+			if(!has_rank_) {
+				throw IOError("Found result without rank.");
+			}
+
+			if(!has_p_value_) {
+				throw IOError("Found result without number of pValue.");
+			}
+
+			aggregator_.addResult(name_, rank_, p_value_);
+		}
+
+		return true;
+	}
+
+	bool StartArray()
+	{
+		// Only the top-level array may contain entries
+		if(depth_ == 1) {
+			return false;
+		}
+
+		++depth_;
+		return true;
+	}
+
+	bool EndArray(rapidjson::SizeType)
+	{
+		--depth_;
+		return true;
+	}
+
+  private:
+	template <typename T> bool number_(T value)
+	{
+		if(depth_ != 2) {
+			return Default();
+		}
+
+		if(key_ == "rank") {
+			rank_ = static_cast<uint32_t>(value);
+			has_rank_ = true;
+		} else if(key_ == "pValue") {
+			p_value_ = static_cast<double>(value);
+			has_p_value_ = true;
+		}
+
+		return true;
+	}
+
+	RegulatorEffectResultAggregator& aggregator_;
+
+	size_t depth_ = 0;
+	std::string key_;
+
+	std::string name_;
+	uint32_t rank_ = 0;
+	double p_value_ = 1.0;
+
+	bool has_name_ = false;
+	bool has_rank_ = false;
+	bool has_p_value_ = false;
+};
+}
+
 void RegulatorEffectResultAggregator::read_results(const std::string& fname)
 {
 	std::ifstream infile(fname);
+	if(!infile.good()) {
+		throw IOError("Cannot open result list '" + fname + "'.");
+	}
+
+	std::vector<std::string> paths;
 	std::string line;
-	numberOfResults = 0;
 	while(std::getline(infile, line)) {
-		numberOfResults += 1;
-		parse_results(line);
+		if(!line.empty()) {
+			paths.emplace_back(std::move(line));
+		}
+	}
+
+	names_ = NameIndex();
+	p_values_.clear();
+	ranks_.clear();
+	num_runs_ = paths.size();
+
+	for(current_run_ = 0; current_run_ < paths.size(); ++current_run_) {
+		parse_results(paths[current_run_]);
 	}
+
+	// Regulators that were not detected get the worst rank
+	const uint32_t worst_rank = names_.size();
+	std::replace(ranks_.begin(), ranks_.end(), uint32_t(0), worst_rank);
+
+	rank_sums_.assign(names_.size(), 0);
+	aggregated_p_values_.assign(names_.size(), 1.0);
+	corrected_p_values_.assign(names_.size(), 1.0);
 }
 
-void
-RegulatorEffectResultAggregator::adjustPValues(const std::string& method)
+void RegulatorEffectResultAggregator::addResult(boost::string_ref name,
+                                                uint32_t rank, double p_value)
 {
-	std::vector<std::pair<std::string, double>> p_values;
-	p_values.reserve(aggregated_results_.size());
-	for(auto& r : aggregated_results_) {
-		p_values.emplace_back(
-		    std::make_pair(r.first, r.second.aggregated_p_value));
+	const size_t i = names_.insert(name);
+
+	if(p_values_.size() <= i * num_runs_) {
+		p_values_.resize((i + 1) * num_runs_, 1.0);
+		ranks_.resize((i + 1) * num_runs_, 0);
 	}
 
-	// Adjust p-values
-	p_values = pvalue::adjustPValues(p_values, pvalue::get_second(),
-	                                 pvalue::getCorrectionMethod(method).get());
+	p_values_[i * num_runs_ + current_run_] = p_value;
+	ranks_[i * num_runs_ + current_run_] = rank;
+}
 
-	// Update p-values
-	for(const auto& pair : p_values) {
-		aggregated_results_[pair.first].corrected_p_value = pair.second;
-	}
+void
+RegulatorEffectResultAggregator::adjustPValues(const std::string& method)
+{
+	corrected_p_values_ = aggregated_p_values_;
+	pvalue::adjustInPlace(corrected_p_values_,
+	                      pvalue::getCorrectionMethod(method).get(),
+	                      num_threads_);
 }
 
 void
 RegulatorEffectResultAggregator::aggregatePValues(const std::string& method)
 {
-	/**
-	 * This needs to be done since not every regulator might be detected by 
-	 * every REAGGAE run! 
-	 */
-	for(auto& entry : aggregated_results_) {
-		for(size_t i = entry.second.p_values.size(); i < numberOfResults; ++i){
-			entry.second.p_values.emplace_back(1.0);
-		}
-	}
-	
 	if(method == "max") {
 		RegulatorEffectResultAggregator::aggregatePValues(max_pvalue_aggregator());
 	} else if(method == "second-order") {
@@ -68,17 +224,6 @@ void
 RegulatorEffectResultAggregator::aggregateRanks(const std::string& method)
 {
 	if(method == "sum") {
-		
-		/**
-		 * This needs to be done since not every regulator might be detected by 
-		 * every REAGGAE run! 
-		 */
-		for(auto& entry : aggregated_results_) {
-			for(size_t i = entry.second.ranks.size(); i < numberOfResults; ++i){
-				entry.second.ranks.emplace_back(aggregated_results_.size());
-			}
-		}
-		
 		RegulatorEffectResultAggregator::aggregateRanks(sum_rank_aggregator());
 	} else {
 		throw NotImplemented(
@@ -87,40 +232,39 @@ RegulatorEffectResultAggregator::aggregateRanks(const std::string& method)
 	}
 }
 
-void RegulatorEffectResultAggregator::parse_results(const std::string& line)
+void RegulatorEffectResultAggregator::parse_results(const std::string& path)
 {
-	std::ifstream f(line.c_str());
+	std::ifstream f(path.c_str());
 	if(!f.good()) {
-		throw IOError("Cannot open result '" + line + "'.");
+		throw IOError("Cannot open result '" + path + "'.");
 	}
+
 	rapidjson::IStreamWrapper isw(f);
-	rapidjson::Document d;
-	d.ParseStream(isw);
-	if(!d.IsArray()) {
-		throw IOError("Result '" + line + "' is malformed.");
-	}
-	for(auto& v : d.GetArray()) {
-		parse_result(v);
+	ResultHandler handler(*this);
+	rapidjson::Reader reader;
+	reader.Parse(isw, handler);
+
+	if(reader.HasParseError()) {
+		throw IOError("Result '" + path + "' is malformed.");
 	}
 }
 
 void RegulatorEffectResultAggregator::write(const std::string& fname)
 {
-	std::vector<AggregatedRegulatorEffectResult> results;
-	for(auto& r : aggregated_results_) {
-		results.emplace_back(r.second);
-	}
-	std::sort(results.begin(), results.end(),
-	          [](const AggregatedRegulatorEffectResult& lhs,
-	             const AggregatedRegulatorEffectResult& rhs) {
-		return lhs.rank_sum < rhs.rank_sum;
+	// Ties are reported in the order of the regulator names
+	std::vector<size_t> order(names_.size());
+	std::iota(order.begin(), order.end(), size_t(0));
+	std::sort(order.begin(), order.end(), [this](size_t lhs, size_t rhs) {
+		return std::tie(rank_sums_[lhs], names_[lhs]) <
+		       std::tie(rank_sums_[rhs], names_[rhs]);
 	});
+
 	rapidjson::StringBuffer sb;
 	rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(sb);
 
 	writer.StartArray();
-	for(AggregatedRegulatorEffectResult& res : results) {
-		serializeJSON(writer, res);
+	for(size_t i : order) {
+		serializeJSON(writer, i);
 	}
 	writer.EndArray();
 
@@ -23,104 +23,165 @@
 
 #include <string>
 #include <vector>
-#include <map>
-#include <tuple>
-#include <fstream>
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 
-#include <rapidjson/document.h>
-#include <rapidjson/istreamwrapper.h>
-#include <rapidjson/writer.h>
-#include <rapidjson/stringbuffer.h>
-#include <rapidjson/prettywriter.h>
+#include <Eigen/Core>
 
-#include "RegulatorEffectResult.h"
+#include <boost/math/distributions/chi_squared.hpp>
+#include <boost/math/distributions/normal.hpp>
 
 #include <genetrail2/core/Exception.h>
+#include <genetrail2/core/NameIndex.h>
 #include <genetrail2/core/PValue.h>
 #include <genetrail2/core/macros.h>
+#include <genetrail2/core/misc_algorithms.h>
 
 namespace GeneTrail
 {
 
-struct GT2_EXPORT AggregatedRegulatorEffectResult
-{
-	std::string name = "";
-	std::vector<size_t> ranks;
-	size_t rank_sum = 0;
-	std::vector<double> p_values;
-	double aggregated_p_value = 0.0;
-	double corrected_p_value = 0.0;
-	std::vector<double> mean_correlations;
-};
+/**
+ * The results of all runs for a single regulator. Runs are contiguous, so
+ * that aggregators are vectorized reductions.
+ */
+using PValueColumn = Eigen::Map<const Eigen::VectorXd>;
+using RankColumn = Eigen::Map<const Eigen::Matrix<uint32_t, Eigen::Dynamic, 1>>;
 
 struct GT2_EXPORT sum_rank_aggregator
 {
-	size_t operator()(const std::vector<size_t>& values)
+	size_t operator()(const RankColumn& values) const
 	{
-		return std::accumulate(values.begin(), values.end(), size_t());
+		return values.cast<size_t>().sum();
 	}
 };
 
 struct GT2_EXPORT max_pvalue_aggregator
 {
-	double operator()(const std::vector<double>& values)
+	double operator()(const PValueColumn& values) const
 	{
-		return *std::max_element(values.begin(), values.end());
+		return values.maxCoeff();
 	}
 };
 
 struct GT2_EXPORT second_order_pvalue_aggregator
 {
-	double operator()(const std::vector<double>& values)
+	// The second smallest p-value, found in a single pass
+	double operator()(const PValueColumn& values) const
 	{
-		std::vector<double> tmp(values);
-		std::nth_element(tmp.begin(), tmp.begin() + 1, tmp.end());
-		return tmp[1];
+		double first = std::numeric_limits<double>::infinity();
+		double second = first;
+		for(Eigen::Index i = 0; i < values.size(); ++i) {
+			if(values[i] < first) {
+				second = first;
+				first = values[i];
+			} else if(values[i] < second) {
+				second = values[i];
+			}
+		}
+
+		return values.size() < 2 ? first : second;
 	}
 };
 
 struct GT2_EXPORT fisher_pvalue_aggregator
 {
-	double operator()(const std::vector<double>& pvalues)
+	double operator()(const PValueColumn& pvalues) const
 	{
-		return pvalue::fisher(pvalues, pvalue::identity());
+		const double x = pvalues.array().log().sum();
+		boost::math::chi_squared dist(2 * pvalues.size());
+		return boost::math::cdf(boost::math::complement(dist, -2.0 * x));
 	}
 };
 
 struct GT2_EXPORT stouffer_pvalue_aggregator
 {
-	double operator()(const std::vector<double>& pvalues)
+	/**
+	 * Uniform weights, i.e. z = sum(z_i) / sqrt(n). P-values are clamped
+	 * to the open interval (0, 1), as the quantiles of 0 and 1 (the
+	 * p-value of undetected regulators) are infinite.
+	 */
+	double operator()(const PValueColumn& pvalues) const
 	{
-		std::vector<double> weights(pvalues.size(), 1.0 / pvalues.size());
-		return pvalue::stouffer(pvalues, weights, pvalue::identity());
+		const double lower = std::numeric_limits<double>::min();
+		const double upper = std::nextafter(1.0, 0.0);
+
+		boost::math::normal dist(0.0, 1.0);
+		double zi = 0.0;
+		for(Eigen::Index i = 0; i < pvalues.size(); ++i) {
+			const double p = std::min(std::max(pvalues[i], lower), upper);
+			zi += quantile(complement(dist, p));
+		}
+
+		const double z = zi / std::sqrt(double(pvalues.size()));
+		return boost::math::cdf(boost::math::complement(dist, z));
 	}
 };
 
+/**
+ * Aggregates the results of many REGGAE runs.
+ *
+ * The result files are parsed one after another with a SAX parser, so
+ * only the aggregated tables are kept in memory. Regulator names are
+ * interned and the p-values and ranks are stored in dense
+ * runs x regulators matrices. Regulators that were not detected in a run
+ * get a p-value of 1 and the worst rank, i.e. the number of regulators.
+ * All aggregations are computed for the regulators in parallel.
+ */
 class GT2_EXPORT RegulatorEffectResultAggregator
 {
   public:
 	RegulatorEffectResultAggregator() {}
 
 	/**
+	 * Reads the result files listed in fname (one path per line). This
+	 * replaces all previously read results.
 	 *
+	 * @throws IOError if a result file cannot be read or is malformed.
 	 */
 	void read_results(const std::string& fname);
 
+	/// The number of threads used for aggregation. 0 uses all cores.
+	void setNumberOfThreads(unsigned int num_threads)
+	{
+		num_threads_ = num_threads;
+	}
+
+	size_t numberOfRegulators() const { return names_.size(); }
+	size_t numberOfResults() const { return num_runs_; }
+
+	/// The name of the i-th regulator in order of appearance
+	const std::string& name(size_t i) const { return names_[i]; }
+
+	PValueColumn pValues(size_t i) const
+	{
+		return PValueColumn(p_values_.data() + i * num_runs_, num_runs_);
+	}
+
+	RankColumn ranks(size_t i) const
+	{
+		return RankColumn(ranks_.data() + i * num_runs_, num_runs_);
+	}
+
+	size_t rankSum(size_t i) const { return rank_sums_[i]; }
+	double aggregatedPValue(size_t i) const { return aggregated_p_values_[i]; }
+	double correctedPValue(size_t i) const { return corrected_p_values_[i]; }
+
 	template <typename Aggregator> void aggregatePValues(Aggregator aggregator)
 	{
-		for(auto& entry : aggregated_results_) {
-			entry.second.aggregated_p_value = aggregator(entry.second.p_values);
-		}
+		parallel_for(size_t(0), names_.size(), [&](size_t i) {
+			aggregated_p_values_[i] = aggregator(pValues(i));
+		}, num_threads_, size_t(64));
 	}
 
 	void aggregatePValues(const std::string& method);
 	
 	template <typename Aggregator> void aggregateRanks(Aggregator aggregator)
 	{
-		for(auto& entry : aggregated_results_) {
-			entry.second.rank_sum = aggregator(entry.second.ranks);
-		}
+		parallel_for(size_t(0), names_.size(), [&](size_t i) {
+			rank_sums_[i] = aggregator(ranks(i));
+		}, num_threads_, size_t(64));
 	}
 	
 	void aggregateRanks(const std::string& method);
@@ -129,81 +190,65 @@ class GT2_EXPORT RegulatorEffectResultAggregator
 
 	void write(const std::string& fname);
 
+	/**
+	 * Stores the rank and p-value of a regulator in the current run.
+	 * Called by the parser for every entry of a result file.
+	 */
+	void addResult(boost::string_ref name, uint32_t rank, double p_value);
+
   protected:
-	template <typename Writer>
-	void serializeJSON(Writer& writer,
-	                   AggregatedRegulatorEffectResult result)
+	template <typename Writer> void serializeJSON(Writer& writer, size_t i)
 	{
 		writer.StartObject();
 
 		writer.String("regulator");
-		writer.String(result.name.c_str());
+		writer.String(names_[i].c_str());
 
 		writer.String("rankSum");
-		writer.Int(result.rank_sum);
+		writer.Int(rank_sums_[i]);
 		
 		writer.String("ranks");
 		writer.StartArray();
-		for(const auto& r : result.ranks) {
-			writer.Int(r);
+		for(size_t j = 0; j < num_runs_; ++j) {
+			writer.Int(ranks_[i * num_runs_ + j]);
 		}
 		writer.EndArray();
 
 		writer.String("aggregatedPValue");
-		writer.Double(result.aggregated_p_value);
+		writer.Double(aggregated_p_values_[i]);
 
 		writer.String("correctedPValue");
-		writer.Double(result.corrected_p_value);
+		writer.Double(corrected_p_values_[i]);
 
 		writer.String("pValues");
 		writer.StartArray();
-		for(const auto& p : result.p_values) {
-			writer.Double(p);
+		for(size_t j = 0; j < num_runs_; ++j) {
+			writer.Double(p_values_[i * num_runs_ + j]);
 		}
 		writer.EndArray();
 		writer.EndObject();
 	}
 
 	/**
-	 *
+	 * Parses a single result file as the current run.
 	 */
-	template <typename Value> void parse_result(Value& v)
-	{
-		if(!v.HasMember("regulator")) {
-			throw IOError("Found result without name.");
-		}
+	void parse_results(const std::string& path);
 
-		std::string name = v["regulator"].GetString();
-
-		auto it = aggregated_results_.find(name);
-		if(it == aggregated_results_.end()) {
-			AggregatedRegulatorEffectResult result;
-			result.name = name;
-			it = aggregated_results_.emplace(name,result).first;
-		}
-
-		if(!v.HasMember("rank")) {
-			throw IOError("Found result without rank.");
-		}
-
-		it->second.ranks.emplace_back(v["rank"].GetInt());
-		//it->second.rank_sum += v["rank"].GetInt();
+	private:
+	unsigned int num_threads_ = 0;
 
-		if(!v.HasMember("pValue")) {
-			throw IOError("Found result without number of pValue.");
-		}
+	size_t num_runs_ = 0;
+	size_t current_run_ = 0;
 
-		it->second.p_values.emplace_back(v["pValue"].GetDouble());
-	}
+	NameIndex names_;
 
-	/**
-	 *
-	 */
-	void parse_results(const std::string& line);
+	// Column i holds the results of regulator i for all runs
+	std::vector<double> p_values_;
+	std::vector<uint32_t> ranks_;
 
-	private:
-	size_t numberOfResults;
-	std::map<std::string, AggregatedRegulatorEffectResult> aggregated_results_;
+	std::vector<size_t> rank_sums_;
+	std::vector<double> aggregated_p_values_;
+	std::vector<double> corrected_p_values_;
 };
 }
 
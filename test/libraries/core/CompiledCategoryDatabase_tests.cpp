@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/Category.h>
+#include <genetrail2/core/CategoryDatabase.h>
+#include <genetrail2/core/CompiledCategoryDatabase.h>
+#include <genetrail2/core/CompiledCategoryFile.h>
+#include <genetrail2/core/Exception.h>
+#include <genetrail2/core/GMTFile.h>
+#include <genetrail2/core/JsonCategoryFile.h>
+
+#include <config.h>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+
+using namespace GeneTrail;
+namespace fs = boost::filesystem;
+
+class CompiledCategoryDatabaseTest : public ::testing::Test
+{
+  public:
+	CompiledCategoryDatabaseTest()
+	    : tmp_file_name_("/tmp/" + fs::unique_path().native())
+	{
+	}
+
+	void TearDown() override { fs::remove(tmp_file_name_); }
+
+  protected:
+	void compile(const CategoryDatabase& database)
+	{
+		std::ofstream out(tmp_file_name_, std::ios::binary);
+		CompiledCategoryDatabase::write(out, database);
+	}
+
+	std::string tmp_file_name_;
+};
+
+TEST_F(CompiledCategoryDatabaseTest, view)
+{
+	auto db = std::make_shared<EntityDatabase>();
+	GMTFile in(db, TEST_DATA_PATH("categories.gmt"));
+	compile(in.read());
+
+	ASSERT_TRUE(CompiledCategoryDatabase::isCompiled(tmp_file_name_));
+	EXPECT_FALSE(CompiledCategoryDatabase::isCompiled(TEST_DATA_PATH("categories.gmt")));
+
+	CompiledCategoryDatabase view(tmp_file_name_);
+
+	ASSERT_EQ(5, view.size());
+	EXPECT_EQ(9, view.numMembers());
+
+	// Identifiers are sorted
+	ASSERT_EQ(5, view.numIdentifiers());
+	EXPECT_EQ("123", view.identifier(0));
+	EXPECT_EQ("323", view.identifier(1));
+	EXPECT_EQ("A", view.identifier(2));
+	EXPECT_EQ("B", view.identifier(3));
+	EXPECT_EQ("Bla Bla", view.identifier(4));
+
+	EXPECT_EQ(2, view.findIdentifier("A"));
+	EXPECT_EQ(CompiledCategoryDatabase::npos, view.findIdentifier("C"));
+
+	EXPECT_EQ("CatB", view.categoryName(1));
+	EXPECT_EQ("Strange but valid", view.categoryReference(1));
+	EXPECT_EQ("Cat D", view.categoryName(3));
+	EXPECT_EQ("", view.categoryReference(3));
+	EXPECT_TRUE(view.categoryMembers(4).empty());
+
+	auto members = view.categoryMembers(0);
+	ASSERT_EQ(3, members.size());
+	EXPECT_EQ(2u, members[0]);
+	EXPECT_EQ(3u, members[1]);
+	EXPECT_EQ(4u, members[2]);
+
+	EXPECT_TRUE(view.contains(2, 2));
+	EXPECT_FALSE(view.contains(2, 4));
+	EXPECT_TRUE(view.categoryMetadata(0).empty());
+}
+
+TEST_F(CompiledCategoryDatabaseTest, readWriteMetadata)
+{
+	auto db = std::make_shared<EntityDatabase>();
+	JsonCategoryFile in(db, TEST_DATA_PATH("CategoryMetadata.json"));
+	auto database = in.read();
+
+	{
+		CompiledCategoryFile out(db, tmp_file_name_, FileOpenMode::WRITE);
+		ASSERT_TRUE(out.write(database));
+	}
+
+	// Use a different entity database to check the remapping of ids
+	auto db2 = std::make_shared<EntityDatabase>();
+	db2->index("C");
+
+	CompiledCategoryFile in2(db2, tmp_file_name_);
+	ASSERT_TRUE(in2);
+	auto database2 = in2.read();
+
+	EXPECT_EQ(db2, database2.entityDatabase());
+	EXPECT_EQ("Metadata", database2.name());
+	EXPECT_EQ("Jane Doe", database2.editor().name);
+	EXPECT_EQ("jane@doe.net", database2.editor().email);
+	EXPECT_EQ("2015-10-21", database2.creationDate());
+	EXPECT_EQ("http://doe.net", database2.sourceUrl());
+	EXPECT_EQ("EntrezGene", database2.identifier());
+
+	const Metadata& md = database2.metadata();
+	EXPECT_EQ(3, md.size());
+	EXPECT_EQ("Unit tests", get<std::string>(md.get("purpose")));
+
+	const auto& array = get<Metadata::Array>(md.get("stuff"));
+	ASSERT_EQ(7, array.size());
+	EXPECT_EQ(1, get<int64_t>(array[0]));
+	EXPECT_EQ(4, get<int64_t>(array[3]));
+	EXPECT_EQ(true, get<bool>(array[4]));
+	EXPECT_EQ("", get<std::string>(array[5]));
+	EXPECT_EQ(nullptr, get<std::nullptr_t>(array[6]));
+
+	const auto& obj = get<Metadata::Object>(md.get("objTest"));
+	EXPECT_EQ(3, obj.size());
+	EXPECT_EQ(1.0, get<double>(obj.find("asdasd")->second));
+	EXPECT_EQ(true, get<bool>(obj.find("blabla")->second));
+	EXPECT_EQ(3, get<Metadata::Array>(obj.find("nested")->second).size());
+
+	ASSERT_EQ(1, database2.size());
+	const auto& cat = database2[0];
+	EXPECT_EQ("CatA", cat.name());
+	EXPECT_EQ("http://doe.net/CatA", cat.reference());
+	EXPECT_EQ(3, cat.size());
+	EXPECT_TRUE(cat.contains("A"));
+	EXPECT_TRUE(cat.contains("B"));
+	EXPECT_TRUE(cat.contains("C"));
+	EXPECT_EQ(0.4, get<double>(cat.metadata().get("concentration")));
+}
+
+TEST_F(CompiledCategoryDatabaseTest, readCategoryDatabase)
+{
+	auto db = std::make_shared<EntityDatabase>();
+	auto gmt = readCategoryDatabase(db, TEST_DATA_PATH("categories.gmt"));
+	compile(gmt);
+
+	auto compiled = readCategoryDatabase(db, tmp_file_name_);
+
+	ASSERT_EQ(gmt.size(), compiled.size());
+	for(size_t i = 0; i < gmt.size(); ++i) {
+		EXPECT_EQ(gmt[i].name(), compiled[i].name());
+		EXPECT_EQ(gmt[i].reference(), compiled[i].reference());
+		EXPECT_TRUE(gmt[i] == compiled[i]);
+	}
+}
+
+TEST_F(CompiledCategoryDatabaseTest, invalidFile)
+{
+	EXPECT_THROW(CompiledCategoryDatabase(TEST_DATA_PATH("categories.gmt")), IOError);
+	EXPECT_THROW(CompiledCategoryDatabase("/does/not/exist.gtcat"), IOError);
+
+	auto db = std::make_shared<EntityDatabase>();
+	GMTFile in(db, TEST_DATA_PATH("categories.gmt"));
+	compile(in.read());
+
+	// Truncate the file
+	fs::resize_file(tmp_file_name_, fs::file_size(tmp_file_name_) - 8);
+	EXPECT_THROW(CompiledCategoryDatabase view(tmp_file_name_), IOError);
+}
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/BoostGraphParser.h>
+#include <genetrail2/core/CompressedGraph.h>
+#include <genetrail2/core/EntityDatabase.h>
+
+#include <config.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace GeneTrail;
+
+TEST(CompressedGraph, builder)
+{
+	auto db = std::make_shared<EntityDatabase>();
+	CompressedGraph::Builder builder(db);
+
+	builder.addEdge("A", "B", "pp");
+	builder.addEdge("A", "C", "activation");
+	builder.addEdge("C", "B", "my own type");
+	builder.addEdge("B", "A", "my own type");
+
+	CompressedGraph g = builder.build();
+
+	ASSERT_EQ(3u, g.numberOfVertices());
+	ASSERT_EQ(4u, g.numberOfEdges());
+
+	auto a = g.vertex("A");
+	auto b = g.vertex("B");
+	auto c = g.vertex("C");
+
+	EXPECT_EQ(0u, a);
+	EXPECT_EQ(1u, b);
+	EXPECT_EQ(2u, c);
+	EXPECT_EQ(CompressedGraph::NOT_FOUND, g.vertex("D"));
+	EXPECT_EQ("C", g.name(c));
+
+	EXPECT_EQ(2u, g.outDegree(a));
+	EXPECT_EQ(b, g.outBegin(a)[0]);
+	EXPECT_EQ(c, g.outBegin(a)[1]);
+
+	// In-edges keep the insertion order
+	ASSERT_EQ(2u, g.inDegree(b));
+	EXPECT_EQ(a, g.inBegin(b)[0]);
+	EXPECT_EQ(c, g.inBegin(b)[1]);
+
+	auto e = g.findEdge(a, c);
+	ASSERT_NE(CompressedGraph::NOT_FOUND, e);
+	EXPECT_EQ(EdgeType::ACTIVATION, g.outEdgeType(e));
+	EXPECT_EQ(CompressedGraph::NOT_FOUND, g.findEdge(b, c));
+
+	auto custom = g.outEdgeType(g.findEdge(c, b));
+	EXPECT_EQ(EdgeType::FIRST_CUSTOM_EDGE_TYPE, custom);
+	EXPECT_EQ(custom, g.outEdgeType(g.findEdge(b, a)));
+	EXPECT_EQ("my own type", g.edgeTypeName(custom));
+}
+
+TEST(CompressedGraph, readCytoscapeFile)
+{
+	auto db = std::make_shared<EntityDatabase>();
+	BoostGraphParser parser;
+
+	GraphType boost_graph;
+	parser.readCytoscapeFile(TEST_DATA_PATH("test_kegg.sif"), boost_graph);
+	CompressedGraph g = parser.readCompressedGraph(TEST_DATA_PATH("test_kegg.sif"), db);
+
+	ASSERT_EQ(boost::num_vertices(boost_graph), g.numberOfVertices());
+	ASSERT_EQ(boost::num_edges(boost_graph), g.numberOfEdges());
+
+	auto v = g.vertex("01234");
+	ASSERT_NE(CompressedGraph::NOT_FOUND, v);
+	EXPECT_EQ(4u, g.outDegree(v));
+	EXPECT_NE(CompressedGraph::NOT_FOUND, g.findEdge(v, g.vertex("90123")));
+
+	size_t in_edges = 0;
+	for(CompressedGraph::vertex_type i = 0; i < g.numberOfVertices(); ++i) {
+		in_edges += g.inDegree(i);
+	}
+	EXPECT_EQ(g.numberOfEdges(), in_edges);
+}
+
+TEST(CompressedGraph, boostAdapters)
+{
+	auto db = std::make_shared<EntityDatabase>();
+	BoostGraphParser parser;
+
+	GraphType boost_graph;
+	parser.readCytoscapeFile(TEST_DATA_PATH("test_kegg.sif"), boost_graph);
+
+	CompressedGraph g(db, boost_graph);
+	GraphType converted = g.toBoostGraph();
+	CompressedGraph g2(db, converted);
+
+	ASSERT_EQ(g.numberOfVertices(), g2.numberOfVertices());
+	ASSERT_EQ(g.numberOfEdges(), g2.numberOfEdges());
+
+	for(CompressedGraph::vertex_type i = 0; i < g.numberOfVertices(); ++i) {
+		EXPECT_EQ(g.entity(i), g2.entity(i));
+		ASSERT_EQ(g.outDegree(i), g2.outDegree(i));
+		EXPECT_TRUE(std::equal(g.outBegin(i), g.outEnd(i), g2.outBegin(i)));
+		ASSERT_EQ(g.inDegree(i), g2.inDegree(i));
+		EXPECT_TRUE(std::equal(g.inBegin(i), g.inEnd(i), g2.inBegin(i)));
+	}
+
+	auto vertices = g.vertexSet();
+	EXPECT_TRUE(std::is_sorted(vertices.begin(), vertices.end()));
+	EXPECT_EQ(g.numberOfVertices(), vertices.size());
+}
+
+TEST(CompressedGraph, boostAdapterParallelEdges)
+{
+	auto db = std::make_shared<EntityDatabase>();
+
+	GraphType boost_graph;
+	auto a = boost::add_vertex(boost_graph);
+	auto b = boost::add_vertex(boost_graph);
+	boost::put(vertex_identifier, boost_graph, a, "A");
+	boost::put(vertex_identifier, boost_graph, b, "B");
+
+	auto e1 = boost::add_edge(a, b, boost_graph).first;
+	auto e2 = boost::add_edge(a, b, boost_graph).first;
+	boost::put(edge_regulation_type, boost_graph, e1, "activation");
+	boost::put(edge_regulation_type, boost_graph, e2, "my custom type");
+
+	CompressedGraph g(db, boost_graph);
+
+	const auto vb = g.vertex("B");
+	ASSERT_EQ(2u, g.inDegree(vb));
+
+	std::vector<std::string> in_types;
+	for(auto e = g.firstInEdge(vb); e < g.firstInEdge(vb) + g.inDegree(vb); ++e) {
+		in_types.push_back(g.edgeTypeName(g.inEdgeType(e)));
+	}
+
+	std::sort(in_types.begin(), in_types.end());
+	EXPECT_EQ("activation", in_types[0]);
+	EXPECT_EQ("my custom type", in_types[1]);
+}
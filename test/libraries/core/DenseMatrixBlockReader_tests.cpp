@@ -0,0 +1,137 @@
+/*
+ * GeneTrail2 - An efficient library for interpreting genetic data
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the Lesser GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * Lesser GNU General Public License for more details.
+ *
+ * You should have received a copy of the Lesser GNU General Public
+ * License along with this program.
+ * If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/DenseMatrixBlockReader.h>
+#include <genetrail2/core/DenseMatrixReader.h>
+#include <genetrail2/core/DenseMatrixWriter.h>
+#include <genetrail2/core/Exception.h>
+#include <config.h>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+
+using namespace GeneTrail;
+
+// Reads the matrix in blocks and checks that their concatenation is
+// identical to the matrix read by DenseMatrixReader
+void compareBlocks(const std::string& path, size_t block_rows,
+                   unsigned int opts = DenseMatrixReader::defaultOptions())
+{
+	std::ifstream strm(path, std::ios::binary);
+	ASSERT_TRUE(strm.good());
+
+	DenseMatrixReader reader;
+	DenseMatrix expected = reader.read(strm, opts);
+
+	DenseMatrixBlockReader block_reader(path, opts);
+	ASSERT_EQ(expected.cols(), block_reader.cols());
+
+	DenseMatrix block(0, 0);
+	DenseMatrix::index_type row = 0;
+	while(block_reader.next(block, block_rows)) {
+		ASSERT_LE(block.rows(), block_rows);
+		ASSERT_EQ(expected.cols(), block.cols());
+		EXPECT_EQ(expected.colNames(), block.colNames());
+
+		for(DenseMatrix::index_type i = 0; i < block.rows(); ++i, ++row) {
+			ASSERT_LT(row, expected.rows());
+			EXPECT_EQ(expected.rowName(row), block.rowName(i));
+			for(DenseMatrix::index_type j = 0; j < block.cols(); ++j) {
+				EXPECT_EQ(expected(row, j), block(i, j));
+			}
+		}
+	}
+
+	EXPECT_EQ(expected.rows(), row);
+	EXPECT_FALSE(block_reader.next(block, block_rows));
+}
+
+TEST(DenseMatrixBlockReader, textBlocks)
+{
+	compareBlocks(TEST_DATA_PATH("ascii_matrix4x5.mat"), 3);
+	compareBlocks(TEST_DATA_PATH("ascii_matrix4x5.mat"), 4);
+	compareBlocks(TEST_DATA_PATH("matrix_names.txt"), 2,
+	              DenseMatrixReader::READ_ROW_NAMES);
+	compareBlocks(TEST_DATA_PATH("matrix_nonames.txt"), 2,
+	              DenseMatrixReader::NO_OPTIONS);
+}
+
+TEST(DenseMatrixBlockReader, binaryBlocks)
+{
+	compareBlocks(TEST_DATA_PATH("binary_matrix4x5_rm.bmat"), 3);
+	compareBlocks(TEST_DATA_PATH("binary_matrix4x5_cm.bmat"), 3);
+	compareBlocks(TEST_DATA_PATH("binary_matrix4x5_cm.bmat"), 1);
+}
+
+TEST(DenseMatrixBlockReader, rowsForBudget)
+{
+	const size_t row_size = 10 * sizeof(double) + sizeof(std::string);
+
+	// One more block is buffered by the reader
+	EXPECT_EQ(33, DenseMatrixBlockReader::rowsForBudget(100 * row_size, 10));
+	EXPECT_EQ(50, DenseMatrixBlockReader::rowsForBudget(100 * row_size, 10, 1));
+	EXPECT_EQ(1, DenseMatrixBlockReader::rowsForBudget(0, 10));
+}
+
+TEST(DenseMatrixBlockReader, invalid)
+{
+	EXPECT_THROW(DenseMatrixBlockReader("does_not_exist.txt"), IOError);
+	EXPECT_THROW(DenseMatrixBlockReader(TEST_DATA_PATH("ascii_matrix4x5.mat"),
+	                                    DenseMatrixReader::TRANSPOSE),
+	             NotImplemented);
+}
+
+TEST(DenseMatrixBlockReader, emptyRowName)
+{
+	const std::string path = "/tmp/" + boost::filesystem::unique_path().native();
+	DenseMatrix block(0, 0);
+
+	{
+		std::ofstream out(path);
+		out << "c1\tc2\na\t1\t2\n\t3\t4\n";
+	}
+
+	// Leading whitespace is ignored unless only tabs separate the fields
+	DenseMatrixBlockReader tabs(path, DenseMatrixReader::defaultOptions() |
+	                                      DenseMatrixReader::SPLIT_ONLY_TAB);
+	try {
+		tabs.next(block, 2);
+		ADD_FAILURE() << "Expected an IOError";
+	} catch(const IOError& e) {
+		EXPECT_NE(std::string::npos, std::string(e.what()).find("Empty row name"));
+	}
+
+	{
+		DenseMatrix mat({"a", ""}, {"c1", "c2"});
+		std::ofstream out(path, std::ios::binary);
+		DenseMatrixWriter().writeBinary(out, mat);
+	}
+
+	try {
+		DenseMatrixBlockReader reader(path);
+		ADD_FAILURE() << "Expected an IOError";
+	} catch(const IOError& e) {
+		EXPECT_NE(std::string::npos, std::string(e.what()).find("empty row name"));
+	}
+
+	boost::filesystem::remove(path);
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/DenseColumnSubset.h>
+#include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/DenseRowSubset.h>
+
+#include <limits>
+
+using namespace GeneTrail;
+
+static const Matrix::index_type NOT_FOUND = std::numeric_limits<Matrix::index_type>::max();
+
+TEST(DenseRowSubset, rowIndex)
+{
+	DenseMatrix mat({"a", "b", "c", "d", "e"}, {"x", "y"});
+	DenseRowSubset subset(&mat, DenseRowSubset::ISubset{3, 0, 4});
+
+	EXPECT_EQ(0, subset.rowIndex("d"));
+	EXPECT_EQ(1, subset.rowIndex("a"));
+	EXPECT_EQ(2, subset.rowIndex("e"));
+	EXPECT_EQ(NOT_FOUND, subset.rowIndex("b"));
+	EXPECT_EQ(NOT_FOUND, subset.rowIndex("z"));
+	EXPECT_FALSE(subset.hasRow("c"));
+	EXPECT_TRUE(subset.hasRow("e"));
+	EXPECT_EQ(1, subset.colIndex("y"));
+
+	subset.shuffleRows({2, 0, 1});
+	EXPECT_EQ(0, subset.rowIndex("e"));
+	EXPECT_EQ(1, subset.rowIndex("d"));
+	EXPECT_EQ(2, subset.rowIndex("a"));
+
+	subset.removeRows({1});
+	EXPECT_EQ(0, subset.rowIndex("e"));
+	EXPECT_EQ(1, subset.rowIndex("a"));
+	EXPECT_FALSE(subset.hasRow("d"));
+
+	std::vector<Matrix::index_type> rows{1, 2};
+	subset.assign(rows.begin(), rows.end());
+	EXPECT_EQ(0, subset.rowIndex("b"));
+	EXPECT_EQ(1, subset.rowIndex("c"));
+	EXPECT_FALSE(subset.hasRow("a"));
+
+	DenseRowSubset copy(subset);
+	EXPECT_EQ(1, copy.rowIndex("c"));
+
+	DenseRowSubset named(&mat, DenseRowSubset::SSubset{"e", "b"});
+	EXPECT_EQ(0, named.rowIndex("e"));
+	EXPECT_EQ(1, named.rowIndex("b"));
+}
+
+TEST(DenseRowSubset, rowIndexAfterMoveAndRepeatedChanges)
+{
+	DenseMatrix mat({"a", "b", "c", "d", "e"}, {"x", "y"});
+	DenseRowSubset subset(&mat, DenseRowSubset::ISubset{3, 0, 4, 1});
+	EXPECT_EQ(1, subset.rowIndex("a"));
+
+	// Several changes without a lookup in between
+	subset.shuffleRows({3, 2, 1, 0});
+	subset.removeRows({0});
+	subset.shuffleRows({1, 0, 2});
+	EXPECT_EQ(0, subset.rowIndex("a"));
+	EXPECT_EQ(1, subset.rowIndex("e"));
+	EXPECT_EQ(2, subset.rowIndex("d"));
+	EXPECT_FALSE(subset.hasRow("b"));
+
+	DenseRowSubset moved(std::move(subset));
+	EXPECT_EQ(2, moved.rowIndex("d"));
+
+	subset = std::move(moved);
+	EXPECT_EQ(1, subset.rowIndex("e"));
+}
+
+TEST(DenseRowSubset, renameAndDuplicates)
+{
+	// The first "a" is not part of the subset
+	DenseMatrix mat({"a", "b", "a", ""}, {"x"});
+	DenseRowSubset subset(&mat, DenseRowSubset::ISubset{1, 2, 3});
+
+	EXPECT_EQ(1, subset.rowIndex("a"));
+	EXPECT_FALSE(subset.hasRow(""));
+
+	subset.setRowName(0, "f");
+	EXPECT_EQ(0, subset.rowIndex("f"));
+	EXPECT_FALSE(subset.hasRow("b"));
+
+	subset.setRowName("a", "g");
+	EXPECT_EQ(1, subset.rowIndex("g"));
+	EXPECT_FALSE(subset.hasRow("a"));
+
+	// Renaming the matrix is visible in the subset
+	mat.setRowName(3, "h");
+	EXPECT_EQ(2, subset.rowIndex("h"));
+}
+
+TEST(DenseColumnSubset, colIndex)
+{
+	DenseMatrix mat({"x", "y"}, {"a", "b", "c", "d", "e"});
+	DenseColumnSubset subset(&mat, DenseColumnSubset::ISubset{3, 0, 4});
+
+	EXPECT_EQ(0, subset.colIndex("d"));
+	EXPECT_EQ(1, subset.colIndex("a"));
+	EXPECT_EQ(2, subset.colIndex("e"));
+	EXPECT_EQ(NOT_FOUND, subset.colIndex("b"));
+	EXPECT_FALSE(subset.hasCol("c"));
+	EXPECT_EQ(1, subset.rowIndex("y"));
+
+	subset.shuffleCols({2, 0, 1});
+	EXPECT_EQ(0, subset.colIndex("e"));
+	EXPECT_EQ(2, subset.colIndex("a"));
+
+	subset.removeCols({0});
+	EXPECT_EQ(0, subset.colIndex("d"));
+	EXPECT_EQ(1, subset.colIndex("a"));
+	EXPECT_FALSE(subset.hasCol("e"));
+
+	DenseMatrix dup({"x"}, {"a", "b", "a"});
+	DenseColumnSubset second(&dup, DenseColumnSubset::ISubset{2, 1});
+	EXPECT_EQ(0, second.colIndex("a"));
+	EXPECT_EQ(1, second.colIndex("b"));
+}
@@ -199,6 +199,25 @@ TEST_F(DenseMatrixWriterTest, binaryWrite_known)
 	ASSERT_TRUE(memcmp(in_buffer, &tmp[0], bytes_read) == 0);
 }
 
+TEST_F(DenseMatrixWriterTest, binaryWriteColumns_known)
+{
+	DenseMatrix result = buildKnownMatrix();
+
+	std::ostringstream expected;
+	DenseMatrixWriter writer;
+	writer.writeBinary(expected, result);
+
+	// Stream the same matrix column by column
+	std::ostringstream ostrm;
+	uint64_t total = writer.writeBinaryHeader(ostrm, result.rowNames(), result.colNames());
+	for(unsigned int j = 0; j < result.cols(); ++j) {
+		total += writer.writeBinaryColumn(ostrm, result.matrix().col(j).data(), result.rows());
+	}
+
+	ASSERT_EQ(expected.str().length(), total);
+	ASSERT_EQ(expected.str(), ostrm.str());
+}
+
 TEST_F(DenseMatrixWriterTest, textReadWrite_random)
 {
 	DenseMatrix out = buildRandomMatrix();
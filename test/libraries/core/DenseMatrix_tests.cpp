@@ -24,6 +24,8 @@
 #include <config.h>
 #include <Eigen/Core>
 
+#include <limits>
+
 using namespace GeneTrail;
 
 class DenseMatrixTest : public ::testing::Test
@@ -713,4 +715,73 @@ TEST_F(DenseMatrixTest,sortRows2)
 	EXPECT_EQ(mat.rowName(0), "mir4");
 	EXPECT_EQ(mat.rowName(1), "mir5");
 	EXPECT_EQ(mat.rowName(2), "mir6");
-}
\ No newline at end of file
+}
+
+TEST_F(DenseMatrixTest, reorderLarge)
+{
+	// Large enough to be processed in several blocks
+	const unsigned int rows = 300, cols = 301;
+
+	std::vector<std::string> row_names, col_names;
+	for(unsigned int i = 0; i < rows; ++i) row_names.push_back("r" + std::to_string(i));
+	for(unsigned int j = 0; j < cols; ++j) col_names.push_back("c" + std::to_string(j));
+
+	DenseMatrix mat(row_names, col_names);
+	for(unsigned int j = 0; j < cols; ++j) {
+		for(unsigned int i = 0; i < rows; ++i) {
+			mat(i, j) = i * 1000.0 + j;
+		}
+	}
+
+	std::vector<DenseMatrix::index_type> row_perm(rows), col_perm(cols);
+	for(unsigned int i = 0; i < rows; ++i) row_perm[i] = (i * 7) % rows;
+	for(unsigned int j = 0; j < cols; ++j) col_perm[j] = cols - 1 - j;
+
+	mat.shuffleRows(row_perm);
+	mat.shuffleCols(col_perm);
+
+	std::vector<DenseMatrix::index_type> removed_rows, removed_cols;
+	for(unsigned int i = 1; i < rows; i += 4) removed_rows.push_back(i);
+	for(unsigned int j = 0; j < cols; j += 5) removed_cols.push_back(j);
+
+	mat.removeRows(removed_rows);
+	mat.removeCols(removed_cols);
+
+	ASSERT_EQ(rows - removed_rows.size(), mat.rows());
+	ASSERT_EQ(cols - removed_cols.size(), mat.cols());
+
+	for(unsigned int j = 0; j < mat.cols(); ++j) {
+		const unsigned int oj = col_perm[j + j / 4 + 1];
+		EXPECT_EQ(j, mat.colIndex("c" + std::to_string(oj)));
+
+		for(unsigned int i = 0; i < mat.rows(); ++i) {
+			// Every fourth row starting at 1 was removed
+			const unsigned int si = i + (i + 2) / 3;
+			const unsigned int oi = row_perm[si];
+			EXPECT_EQ(oi * 1000.0 + oj, mat(i, j));
+			EXPECT_EQ("r" + std::to_string(oi), mat.rowName(i));
+		}
+	}
+}
+
+TEST_F(DenseMatrixTest, emptyNames)
+{
+	// Empty names mark unnamed rows and columns and are never found
+	DenseMatrix unnamed(2, 3);
+	EXPECT_FALSE(unnamed.hasRow(""));
+	EXPECT_FALSE(unnamed.hasCol(""));
+
+	DenseMatrix mat({"a", "", "c"}, {"", "y"});
+	EXPECT_FALSE(mat.hasRow(""));
+	EXPECT_FALSE(mat.hasCol(""));
+	EXPECT_EQ(std::numeric_limits<DenseMatrix::index_type>::max(), mat.rowIndex(""));
+	EXPECT_EQ(std::numeric_limits<DenseMatrix::index_type>::max(), mat.colIndex(""));
+	EXPECT_EQ(2, mat.rowIndex("c"));
+	EXPECT_EQ(1, mat.colIndex("y"));
+
+	// Stealing a name leaves the previous row unnamed
+	mat.setRowName(1, "a");
+	EXPECT_EQ(1, mat.rowIndex("a"));
+	EXPECT_EQ("", mat.rowName(0));
+	EXPECT_FALSE(mat.hasRow(""));
+}
@@ -228,4 +228,52 @@ TEST(ConditionalCummulativeEntropyEstimatorGreedy, SameVectorUnordered)
 	//EXPECT_NEAR(ve[2], 0.381909, TOLERANCE);
 	//EXPECT_NEAR(ve[3], 0.727127, TOLERANCE);
 	EXPECT_NEAR(ve[4], 1.17341, TOLERANCE);
-}
\ No newline at end of file
+}
+
+TEST(ConditionalCummulativeEntropyEstimatorGreedy, ConditionedOnTwoVectors10)
+{
+	std::vector<std::vector<double>> v;
+	v.emplace_back(y);
+	v.emplace_back(z);
+	std::vector<double> ve = Entropy::conditional_cummulative_entropy_estimator(x,v);
+	EXPECT_EQ(ve.size(),10);
+	EXPECT_NEAR(ve[0], 0.0, TOLERANCE);
+	for(size_t i=1; i<ve.size(); ++i) {
+		EXPECT_LE(ve[i-1], ve[i] + TOLERANCE);
+	}
+	// After the last merge all samples are in one bin
+	double entropy = Entropy::cummulative_entropy<double, std::vector<double>::iterator>(x.begin(),x.end());
+	EXPECT_NEAR(ve[9], entropy, TOLERANCE);
+}
+
+// Reference values were computed with a brute-force implementation that
+// re-evaluates every possible merge and the total entropy from scratch.
+TEST(ConditionalCummulativeEntropyEstimator, Batch)
+{
+	std::vector<std::vector<double>> v1, v2;
+	v1.emplace_back(y);
+	v2.emplace_back(y);
+	v2.emplace_back(z);
+
+	Entropy::ConditionalCummulativeEntropyEstimator<double> estimator(x);
+	auto greedy = estimator.greedy({v1, v2}, 2);
+	auto kruskall = estimator.kruskall({v1, v2}, 2);
+
+	const std::vector<std::vector<double>> expected_greedy{
+	    {0.0, 0.0268981, 0.0562606, 0.1307334, 0.3134665, 0.5146214, 0.8381353, 0.8994739, 1.3175903, 1.7563245},
+	    {0.0, 0.0186397, 0.0392049, 0.2276343, 0.2602735, 0.4534062, 0.6369616, 0.8856113, 1.3149536, 1.7563245}};
+	const std::vector<std::vector<double>> expected_kruskall{
+	    {0.0, 0.3754403, 0.4878483, 0.8936821, 1.0480330, 1.1577544, 1.3687133, 1.6103185, 1.6393953, 1.7563245},
+	    {0.0, 0.2486497, 0.3610577, 0.5792411, 0.6764643, 1.2131427, 1.4193435, 1.5987954, 1.7039022, 1.7563245}};
+
+	ASSERT_EQ(2u, greedy.size());
+	ASSERT_EQ(2u, kruskall.size());
+	for(size_t g = 0; g < 2; ++g) {
+		ASSERT_EQ(expected_greedy[g].size(), greedy[g].size());
+		ASSERT_EQ(expected_kruskall[g].size(), kruskall[g].size());
+		for(size_t i = 0; i < greedy[g].size(); ++i) {
+			EXPECT_NEAR(expected_greedy[g][i], greedy[g][i], TOLERANCE);
+			EXPECT_NEAR(expected_kruskall[g][i], kruskall[g][i], TOLERANCE);
+		}
+	}
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/Exception.h>
+#include <genetrail2/core/GEOSoftParser.h>
+
+#include <config.h>
+
+#include <cmath>
+
+using namespace GeneTrail;
+
+TEST(GEOSoftParser, readGSEFile)
+{
+	for(size_t batch_size : {1, 2}) {
+		GEOSoftParser parser;
+		parser.setNumberOfThreads(2);
+		parser.setBatchSize(batch_size);
+
+		auto result = parser.readGSEFile(TEST_DATA_PATH("GEOSoftParser_GSE.soft"));
+		const auto& values = result.values;
+
+		EXPECT_EQ("GPL42", result.platform);
+
+		ASSERT_EQ(4, values.rows());
+		ASSERT_EQ(2, values.cols());
+		EXPECT_EQ("GSM10", values.colName(0));
+		EXPECT_EQ("GSM11", values.colName(1));
+
+		const auto a = values.rowIndex("1007_s_at");
+		const auto b = values.rowIndex("1053_at");
+		const auto c = values.rowIndex("117_at");
+		const auto d = values.rowIndex("121_at");
+
+		EXPECT_DOUBLE_EQ(1.5, values(a, 0));
+		EXPECT_DOUBLE_EQ(-2.0, values(b, 0));
+		EXPECT_TRUE(std::isnan(values(c, 0)));
+		EXPECT_TRUE(std::isnan(values(d, 0)));
+
+		// The VALUE column comes after an empty column
+		EXPECT_TRUE(std::isnan(values(a, 1)));
+		EXPECT_DOUBLE_EQ(3.25, values(b, 1));
+		EXPECT_TRUE(std::isnan(values(c, 1)));
+		EXPECT_DOUBLE_EQ(4.0, values(d, 1));
+	}
+}
+
+TEST(GEOSoftParser, readGSEFileWithoutValueColumn)
+{
+	GEOSoftParser parser;
+	EXPECT_THROW(parser.readGSEFile(TEST_DATA_PATH("GEOSoftParser_GSE_novalue.soft")), IOError);
+}
+
+TEST(GEOSoftParser, readGDSFile)
+{
+	GEOSoftParser parser;
+	parser.setNumberOfThreads(2);
+
+	auto result = parser.readGDSFile(TEST_DATA_PATH("GEOSoftParser_GDS.soft"));
+	const auto& values = result.values;
+
+	EXPECT_EQ("GPL42", result.platform);
+	EXPECT_EQ("GDS7", result.dataset);
+
+	ASSERT_EQ(2, values.rows());
+	ASSERT_EQ(3, values.cols());
+	EXPECT_EQ("1007_s_at", values.rowName(0));
+	EXPECT_EQ("1053_at", values.rowName(1));
+	EXPECT_EQ("GSM1", values.colName(0));
+	EXPECT_EQ("GSM3", values.colName(2));
+
+	EXPECT_DOUBLE_EQ(1.5, values(0, 0));
+	EXPECT_DOUBLE_EQ(2.0, values(0, 1));
+	EXPECT_DOUBLE_EQ(3.0, values(0, 2));
+	EXPECT_TRUE(std::isnan(values(1, 0)));
+	EXPECT_TRUE(std::isnan(values(1, 1)));
+	EXPECT_DOUBLE_EQ(-100.0, values(1, 2));
+}
+
+TEST(GEOSoftParser, readMalformedGDSFile)
+{
+	GEOSoftParser parser;
+	EXPECT_THROW(parser.readGDSFile(TEST_DATA_PATH("GEOSoftParser_GDS_malformed.soft")), IOError);
+	EXPECT_THROW(parser.readGDSFile(TEST_DATA_PATH("GEOSoftParser_GSE.soft")), IOError);
+	EXPECT_THROW(parser.readGDSFile(TEST_DATA_PATH("does_not_exist.soft")), IOError);
+}
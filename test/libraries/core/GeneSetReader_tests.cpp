@@ -7,12 +7,20 @@
 #include <utility>
 #include <vector>
 
+#include <genetrail2/core/EntityDatabase.h>
+#include <genetrail2/core/Exception.h>
 #include <genetrail2/core/GeneSet.h>
 #include <genetrail2/core/GeneSetReader.h>
+#include <genetrail2/core/Scores.h>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
 
 #include <config.h>
 
 using namespace GeneTrail;
+namespace fs = boost::filesystem;
 
 TEST(Parsing, readScoreFileSimple) {
 	GeneSetReader parser;
@@ -180,3 +188,64 @@ TEST(Parsing, sortAbsolute) {
 
     EXPECT_TRUE(sorted);
 }
+
+TEST(Parsing, readScoreFileIntoDatabase) {
+	GeneSetReader parser;
+	auto db = std::make_shared<EntityDatabase>();
+	auto gene_set = parser.readScoringFile(TEST_DATA_PATH("test_scores.txt"));
+	auto scores = parser.readScoringFile(TEST_DATA_PATH("test_scores.txt"), db);
+
+	ASSERT_EQ(gene_set.size(), scores.size());
+	for(size_t i = 0; i < scores.size(); ++i) {
+		EXPECT_EQ(gene_set[i].first, scores[i].name(*db));
+		EXPECT_DOUBLE_EQ(gene_set[i].second, scores[i].score());
+	}
+
+	auto genes = parser.readGeneList(TEST_DATA_PATH("test_genes2.txt"), db);
+	ASSERT_EQ(5u, genes.size());
+	EXPECT_EQ("sdfdfdsf", genes[0].name(*db));
+	EXPECT_EQ("123", genes[4].name(*db));
+	EXPECT_EQ(0.0, genes[4].score());
+}
+
+TEST(Parsing, readScoreFileErrors) {
+	GeneSetReader parser;
+	const std::string path = "/tmp/" + fs::unique_path().native();
+
+	{
+		std::ofstream out(path);
+		out << "a\t1.0\r\nb\t2x\n";
+	}
+	EXPECT_THROW(parser.readScoringFile(path), IOError);
+
+	{
+		std::ofstream out(path);
+		out << "a\t1.0\nb\t2.0\t3.0";
+	}
+	EXPECT_THROW(parser.readScoringFile(path), IOError);
+
+	{
+		std::ofstream out(path);
+		out << "a\t1.0\r\n\nb  -2e3";
+	}
+	auto file = parser.readScoringFile(path);
+	ASSERT_EQ(2u, file.size());
+	EXPECT_EQ("b", file[1].first);
+	EXPECT_DOUBLE_EQ(-2000.0, file[1].second);
+
+	fs::remove(path);
+}
+
+TEST(Parsing, sortedIndices) {
+	GeneSet gene_set;
+	gene_set.insert("a", 1.0);
+	gene_set.insert("b", -3.0);
+	gene_set.insert("c", 2.0);
+	gene_set.insert("d", 1.0);
+
+	EXPECT_EQ(std::vector<size_t>({1, 0, 3, 2}), gene_set.sortedIndices(false));
+	EXPECT_EQ(std::vector<size_t>({2, 0, 3, 1}), gene_set.sortedIndices(true));
+	EXPECT_EQ(std::vector<size_t>({1, 2, 0, 3}), gene_set.absoluteSortedIndices());
+	EXPECT_EQ(std::vector<std::string>({"c", "a", "d", "b"}),
+	          gene_set.getDecreasinglySortedIdentifier());
+}
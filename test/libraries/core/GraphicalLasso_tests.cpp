@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/GraphicalLasso.h>
+#include <genetrail2/core/SparseMatrix.h>
+
+#include <Eigen/Dense>
+
+#include <cmath>
+#include <vector>
+
+using namespace GeneTrail;
+
+namespace
+{
+	// Two correlated blocks {0,1,2} and {3,4} with weak cross terms
+	Eigen::MatrixXd createCovariance()
+	{
+		Eigen::MatrixXd S(5, 5);
+		S << 1.0, 0.5, 0.3, 0.05, 0.0,
+		     0.5, 1.2, 0.4, 0.0, 0.02,
+		     0.3, 0.4, 0.9, 0.0, 0.0,
+		     0.05, 0.0, 0.0, 1.1, 0.6,
+		     0.0, 0.02, 0.0, 0.6, 1.3;
+		return S;
+	}
+
+	// Subgradient conditions of the graphical lasso: W = Theta^-1,
+	// W_ij - S_ij = rho * sign(Theta_ij) if Theta_ij != 0 and
+	// |W_ij - S_ij| <= rho otherwise.
+	void checkOptimality(const Eigen::MatrixXd& S, const GraphicalLassoResult& r, double tol)
+	{
+		const Eigen::MatrixXd identity = Eigen::MatrixXd::Identity(S.rows(), S.cols());
+		EXPECT_LT((r.covariance * r.precision - identity).cwiseAbs().maxCoeff(), 10 * tol);
+
+		for(Eigen::Index i = 0; i < S.rows(); ++i) {
+			EXPECT_NEAR(S(i, i) + r.rho, r.covariance(i, i), tol);
+			for(Eigen::Index j = 0; j < S.cols(); ++j) {
+				if(i == j) {
+					continue;
+				}
+
+				const double d = r.covariance(i, j) - S(i, j);
+				if(std::abs(r.precision(i, j)) > tol) {
+					EXPECT_NEAR(r.rho * std::copysign(1.0, r.precision(i, j)), d, tol);
+				} else {
+					EXPECT_LE(std::abs(d), r.rho + tol);
+				}
+			}
+		}
+	}
+}
+
+TEST(GraphicalLasso, components)
+{
+	std::vector<size_t> component;
+	EXPECT_EQ(2u, GraphicalLasso::components(createCovariance(), 0.1, component));
+	EXPECT_EQ((std::vector<size_t>{0, 0, 0, 1, 1}), component);
+
+	EXPECT_EQ(1u, GraphicalLasso::components(createCovariance(), 0.01, component));
+	EXPECT_EQ(5u, GraphicalLasso::components(createCovariance(), 1.0, component));
+	EXPECT_EQ((std::vector<size_t>{0, 1, 2, 3, 4}), component);
+}
+
+TEST(GraphicalLasso, zeroPenaltyInvertsCovariance)
+{
+	GraphicalLasso glasso;
+	glasso.setThreshold(1e-10);
+
+	const Eigen::MatrixXd S = createCovariance();
+	auto result = glasso.fit(S, 0.0);
+
+	EXPECT_TRUE(result.converged);
+	EXPECT_EQ(1u, result.num_components);
+	EXPECT_LT((result.precision - S.inverse()).cwiseAbs().maxCoeff(), 1e-6);
+}
+
+TEST(GraphicalLasso, fit)
+{
+	GraphicalLasso glasso;
+	glasso.setThreshold(1e-10);
+
+	const Eigen::MatrixXd S = createCovariance();
+	auto result = glasso.fit(S, 0.1);
+
+	EXPECT_TRUE(result.converged);
+	EXPECT_EQ(2u, result.num_components);
+	EXPECT_EQ(0.1, result.rho);
+	checkOptimality(S, result, 1e-6);
+
+	// No edges between the components
+	for(Eigen::Index i = 0; i < 3; ++i) {
+		for(Eigen::Index j = 3; j < 5; ++j) {
+			EXPECT_EQ(0.0, result.precision(i, j));
+			EXPECT_EQ(0.0, result.precision(j, i));
+		}
+	}
+}
+
+TEST(GraphicalLasso, isolatedVariables)
+{
+	GraphicalLasso glasso;
+	const Eigen::MatrixXd S = createCovariance();
+	auto result = glasso.fit(S, 1.0);
+
+	EXPECT_EQ(5u, result.num_components);
+	for(Eigen::Index i = 0; i < 5; ++i) {
+		EXPECT_DOUBLE_EQ(1.0 / (S(i, i) + 1.0), result.precision(i, i));
+	}
+	EXPECT_EQ(5, (result.precision.array() != 0.0).count());
+
+	glasso.setPenalizeDiagonal(false);
+	result = glasso.fit(S, 1.0);
+	for(Eigen::Index i = 0; i < 5; ++i) {
+		EXPECT_DOUBLE_EQ(1.0 / S(i, i), result.precision(i, i));
+	}
+}
+
+TEST(GraphicalLasso, pathMatchesColdStarts)
+{
+	GraphicalLasso glasso;
+	glasso.setThreshold(1e-10);
+	glasso.setNumberOfThreads(2);
+
+	const Eigen::MatrixXd S = createCovariance();
+	std::vector<double> rhos{0.01, 0.2, 0.05, 0.45};
+
+	std::vector<double> seen;
+	glasso.path(S, rhos, [&](const GraphicalLassoResult& r) {
+		seen.push_back(r.rho);
+		checkOptimality(S, r, 1e-6);
+
+		auto cold = glasso.fit(S, r.rho);
+		EXPECT_LT((cold.precision - r.precision).cwiseAbs().maxCoeff(), 1e-6);
+	});
+
+	EXPECT_EQ((std::vector<double>{0.45, 0.2, 0.05, 0.01}), seen);
+}
+
+TEST(GraphicalLasso, sparsePrecision)
+{
+	GraphicalLasso glasso;
+	auto result = glasso.fit(createCovariance(), 0.1);
+
+	SparseMatrix precision = result.sparsePrecision({"a", "b", "c", "d", "e"});
+	EXPECT_EQ(5u, precision.rows());
+	EXPECT_EQ("d", precision.rowName(3));
+	EXPECT_EQ("d", precision.colName(3));
+	EXPECT_EQ(3 * 3 + 2 * 2, precision.matrix().nonZeros());
+	EXPECT_DOUBLE_EQ(result.precision(0, 1), precision(0, 1));
+	EXPECT_EQ(0.0, precision(0, 3));
+}
+
+TEST(GraphicalLasso, invalidInput)
+{
+	GraphicalLasso glasso;
+	EXPECT_THROW(glasso.fit(Eigen::MatrixXd::Identity(2, 3), 0.1), std::invalid_argument);
+	EXPECT_THROW(glasso.fit(createCovariance(), -0.1), std::invalid_argument);
+	EXPECT_THROW(glasso.path(createCovariance(), {0.1, -0.1}, [](const GraphicalLassoResult&) {}), std::invalid_argument);
+}
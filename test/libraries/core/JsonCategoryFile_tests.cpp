@@ -2,12 +2,15 @@
 
 #include <genetrail2/core/Category.h>
 #include <genetrail2/core/CategoryDatabase.h>
+#include <genetrail2/core/Exception.h>
 #include <genetrail2/core/JsonCategoryFile.h>
 
 #include <config.h>
 
 #include <boost/filesystem.hpp>
 
+#include <fstream>
+
 using namespace GeneTrail;
 namespace fs = boost::filesystem;
 
@@ -206,3 +209,54 @@ TEST_F(JsonCategoryFileTest, readWriteMetadata)
 	const auto& obj = get<Metadata::Object>(md2.get("objTest"));
 	EXPECT_EQ(3, obj.size());
 }
+
+TEST_F(JsonCategoryFileTest, streamWrite)
+{
+	auto db = std::make_shared<EntityDatabase>();
+	JsonCategoryFile in(db, TEST_DATA_PATH("CategoryMetadata.json"));
+	auto database = in.read();
+
+	CategoryDatabase header(db);
+	header.setName(database.name());
+	header.setIdentifier(database.identifier());
+	header.setSourceUrl(database.sourceUrl());
+	header.setCreationDate(database.creationDate());
+	header.editor() = database.editor();
+	header.metadata() = database.metadata();
+
+	{
+		std::ofstream out(tmp_file_name_);
+		JsonCategoryWriter writer(out, header);
+		for(int i = 0; i < 3; ++i) {
+			writer.write(database[0]);
+		}
+	}
+
+	JsonCategoryFile in2(db, tmp_file_name_);
+	auto database2 = in2.read();
+
+	EXPECT_EQ(database.name(), database2.name());
+	EXPECT_EQ(database.editor().email, database2.editor().email);
+	EXPECT_EQ(database.metadata().size(), database2.metadata().size());
+
+	ASSERT_EQ(3, database2.size());
+	for(const auto& cat : database2) {
+		EXPECT_EQ("CatA", cat.name());
+		EXPECT_EQ(database[0].size(), cat.size());
+		EXPECT_EQ(0.4, get<double>(cat.metadata().get("concentration")));
+	}
+}
+
+TEST_F(JsonCategoryFileTest, readMissingMembers)
+{
+	{
+		std::ofstream out(tmp_file_name_);
+		out << R"({"name": "A", "identifier": "B", "sourceUrl": "C",)"
+		    << R"( "creationDate": "D", "editor": {"name": "E", "email": "F"},)"
+		    << R"( "categories": [{"name": "G", "reference": "H"}]})";
+	}
+
+	auto db = std::make_shared<EntityDatabase>();
+	JsonCategoryFile in(db, tmp_file_name_);
+	EXPECT_THROW(in.read(), IOError);
+}
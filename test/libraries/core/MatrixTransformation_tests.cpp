@@ -243,9 +243,56 @@ TEST(MT, valuesToRanksInt)
 	}
 }
 
+TEST(MT, valuesToRanksTies)
+{
+	const unsigned int num_rows = 5;
+	const unsigned int num_cols = 2;
+
+	DenseMatrix mat(num_rows, num_cols);
+
+	mat(0, 0) = 3.0;
+	mat(1, 0) = 1.0;
+	mat(2, 0) = 3.0;
+	mat(3, 0) = 2.0;
+	mat(4, 0) = 3.0;
+
+	mat(0, 1) = 0.5;
+	mat(1, 1) = 0.5;
+	mat(2, 1) = -1.0;
+	mat(3, 1) = -1.0;
+	mat(4, 1) = 0.5;
+
+	DenseMatrix mat2(mat);
+
+	DenseMatrix results(num_rows, num_cols);
+
+	results(0, 0) = 2;
+	results(1, 0) = 5;
+	results(2, 0) = 2;
+	results(3, 0) = 4;
+	results(4, 0) = 2;
+
+	results(0, 1) = 2;
+	results(1, 1) = 2;
+	results(2, 1) = 4.5;
+	results(3, 1) = 4.5;
+	results(4, 1) = 2;
+
+	valuesToRanks(mat);
+	// The generic implementation has to agree with the DenseMatrix one
+	valuesToRanks(static_cast<Matrix&>(mat2));
+
+	for(unsigned int i=0; i<num_rows; ++i) {
+	  for(unsigned  int j=0; j<num_cols; ++j) {
+	    EXPECT_EQ(results(i,j), mat(i,j));
+	    EXPECT_EQ(results(i,j), mat2(i,j));
+	  }
+	}
+}
+
 TEST(MT, upweightEnds) 
 {
-	const unsigned int num_rows = 4;
+	const unsigned int num_rows = 5;
 	const unsigned int num_cols = 3;
 	
 	DenseMatrix mat(num_rows, num_cols);
@@ -276,7 +323,7 @@ TEST(MT, upweightEnds)
 
 TEST(MT, upweightTail) 
 {
-	const unsigned int num_rows = 4;
+	const unsigned int num_rows = 5;
 	const unsigned int num_cols = 3;
 	
 	DenseMatrix mat(num_rows, num_cols);
@@ -307,7 +354,7 @@ TEST(MT, upweightTail)
 
 TEST(MT, abs) 
 {
-	const unsigned int num_rows = 4;
+	const unsigned int num_rows = 5;
 	const unsigned int num_cols = 3;
 	
 	DenseMatrix mat(num_rows, num_cols);
@@ -331,7 +378,7 @@ TEST(MT, abs)
 
 TEST(MT, sqrt) 
 {
-	const unsigned int num_rows = 4;
+	const unsigned int num_rows = 5;
 	const unsigned int num_cols = 3;
 	
 	DenseMatrix mat(num_rows, num_cols);
@@ -349,7 +396,7 @@ TEST(MT, sqrt)
 
 TEST(MT, log) 
 {
-	const unsigned int num_rows = 4;
+	const unsigned int num_rows = 5;
 	const unsigned int num_cols = 3;
 	
 	DenseMatrix mat(num_rows, num_cols);
@@ -367,7 +414,7 @@ TEST(MT, log)
 
 TEST(MT, log2) 
 {
-	const unsigned int num_rows = 4;
+	const unsigned int num_rows = 5;
 	const unsigned int num_cols = 3;
 	
 	DenseMatrix mat(num_rows, num_cols);
@@ -385,7 +432,7 @@ TEST(MT, log2)
 
 TEST(MT, log10) 
 {
-	const unsigned int num_rows = 4;
+	const unsigned int num_rows = 5;
 	const unsigned int num_cols = 3;
 	
 	DenseMatrix mat(num_rows, num_cols);
@@ -403,7 +450,7 @@ TEST(MT, log10)
 
 TEST(MT, pow) 
 {
-	const unsigned int num_rows = 4;
+	const unsigned int num_rows = 5;
 	const unsigned int num_cols = 3;
 	
 	DenseMatrix mat(num_rows, num_cols);
@@ -427,7 +474,7 @@ TEST(MT, pow)
 
 TEST(MT, pow2) 
 {
-const unsigned int num_rows = 4;
+const unsigned int num_rows = 5;
 	const unsigned int num_cols = 3;
 	
 	DenseMatrix mat(num_rows, num_cols);
@@ -86,3 +86,44 @@ TEST_F(MiscAlgorithmsTest, stressTestInvertPermutation)
 		}
 	}
 }
+
+TEST_F(MiscAlgorithmsTest, testParallelFor)
+{
+	std::vector<int> visited(1013, 0);
+
+	parallel_for(size_t(0), visited.size(), [&visited](size_t i) { visited[i] += static_cast<int>(i); }, 4, size_t(10));
+
+	for(size_t i = 0; i < visited.size(); ++i) {
+		EXPECT_EQ(static_cast<int>(i), visited[i]);
+	}
+}
+
+TEST_F(MiscAlgorithmsTest, testParallelForException)
+{
+	EXPECT_THROW(parallel_for(0, 100, [](int i) {
+		             if(i == 42) {
+			             throw std::runtime_error("error");
+		             }
+	             }, 4),
+	             std::runtime_error);
+}
+
+TEST_F(MiscAlgorithmsTest, testParallelSort)
+{
+	std::mt19937 gen(7);
+	std::uniform_int_distribution<int> dist(0, 1000);
+
+	for(size_t n : {0, 1, 17, 1000, 10007}) {
+		std::vector<int> values(n);
+		for(auto& v : values) {
+			v = dist(gen);
+		}
+
+		auto expected = values;
+		std::sort(expected.begin(), expected.end());
+
+		// Use small chunks, so that several levels of merges are needed
+		parallel_sort(values.begin(), values.end(), std::less<int>(), 5, 3);
+		EXPECT_EQ(expected, values);
+	}
+}
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/NameIndex.h>
+
+#include <string>
+#include <vector>
+
+using namespace GeneTrail;
+
+TEST(NameIndex, find)
+{
+	std::vector<std::string> names;
+	for(int i = 0; i < 100; ++i) {
+		names.push_back("name" + std::to_string(i));
+	}
+
+	NameIndex index(names);
+
+	ASSERT_EQ(100u, index.size());
+	for(NameIndex::index_type i = 0; i < 100; ++i) {
+		EXPECT_EQ(i, index.find(names[i]));
+		EXPECT_EQ(names[i], index[i]);
+	}
+
+	EXPECT_EQ(NameIndex::NOT_FOUND, index.find("name100"));
+	EXPECT_FALSE(index.contains(""));
+}
+
+TEST(NameIndex, duplicates)
+{
+	NameIndex index(std::vector<std::string>{"A", "B", "A"});
+
+	EXPECT_EQ(0u, index.find("A"));
+
+	// The next occurrence takes over after the first one is removed
+	index.remove({0});
+	EXPECT_EQ(1u, index.find("A"));
+	EXPECT_EQ(0u, index.find("B"));
+}
+
+TEST(NameIndex, duplicatesAfterPermute)
+{
+	NameIndex index(std::vector<std::string>{"A", "B", "A", "C"});
+
+	index.permute({3, 2, 1, 0});
+	EXPECT_EQ(1u, index.find("A"));
+	EXPECT_EQ(2u, index.find("B"));
+	EXPECT_EQ(0u, index.find("C"));
+
+	index.permute({3, 0, 2, 1});
+	EXPECT_EQ(0u, index.find("A"));
+	EXPECT_EQ(1u, index.find("C"));
+}
+
+TEST(NameIndex, duplicatesAfterRename)
+{
+	NameIndex index(std::vector<std::string>{"A", "B", "A"});
+
+	index.rename(0, "C");
+	EXPECT_EQ(2u, index.find("A"));
+	EXPECT_EQ(0u, index.find("C"));
+
+	index.rename(1, "A");
+	EXPECT_EQ(1u, index.find("A"));
+	EXPECT_FALSE(index.contains("B"));
+	EXPECT_EQ("", index[2]);
+}
+
+TEST(NameIndex, insert)
+{
+	NameIndex index;
+	index.reserve(100);
+
+	const std::string line = "A\tB\tA";
+	EXPECT_EQ(0u, index.insert(boost::string_ref(line).substr(0, 1)));
+	EXPECT_EQ(1u, index.insert(boost::string_ref(line).substr(2, 1)));
+	EXPECT_EQ(0u, index.insert(boost::string_ref(line).substr(4, 1)));
+
+	ASSERT_EQ(2u, index.size());
+	EXPECT_EQ("B", index[1]);
+
+	for(int i = 0; i < 100; ++i) {
+		EXPECT_EQ(i + 2u, index.insert("name" + std::to_string(i)));
+	}
+
+	EXPECT_EQ(1u, index.find("B"));
+	EXPECT_EQ(101u, index.find("name99"));
+}
+
+TEST(NameIndex, rename)
+{
+	NameIndex index(std::vector<std::string>{"A", "B", "C"});
+
+	index.rename(0u, "D");
+	EXPECT_EQ(NameIndex::NOT_FOUND, index.find("A"));
+	EXPECT_EQ(0u, index.find("D"));
+
+	// The name is stolen from the previous owner
+	index.rename("D", "C");
+	EXPECT_EQ(0u, index.find("C"));
+	EXPECT_EQ("", index[2]);
+
+	index.rename("X", "Y");
+	EXPECT_FALSE(index.contains("Y"));
+}
+
+TEST(NameIndex, removeAndPermute)
+{
+	std::vector<std::string> names;
+	for(int i = 0; i < 50; ++i) {
+		names.push_back(std::to_string(i));
+	}
+
+	NameIndex index(names);
+
+	std::vector<NameIndex::index_type> removed;
+	for(NameIndex::index_type i = 0; i < 50; i += 3) {
+		removed.push_back(i);
+	}
+	index.remove(removed);
+
+	std::vector<std::string> expected;
+	for(int i = 0; i < 50; ++i) {
+		if(i % 3 != 0) {
+			expected.push_back(std::to_string(i));
+		}
+	}
+
+	ASSERT_EQ(expected, index.names());
+
+	std::vector<NameIndex::index_type> perm(expected.size());
+	for(size_t i = 0; i < perm.size(); ++i) {
+		perm[i] = perm.size() - 1 - i;
+	}
+	index.permute(perm);
+
+	for(NameIndex::index_type i = 0; i < index.size(); ++i) {
+		EXPECT_EQ(expected[perm[i]], index[i]);
+		EXPECT_EQ(i, index.find(expected[perm[i]]));
+	}
+
+	for(NameIndex::index_type i : removed) {
+		EXPECT_FALSE(index.contains(std::to_string(i)));
+	}
+}
+
+TEST(NameIndex, copyOnWrite)
+{
+	NameIndex index(std::vector<std::string>{"A", "B"});
+	NameIndex copy(index);
+
+	EXPECT_EQ(&index.names(), &copy.names());
+
+	copy.rename(0u, "C");
+	EXPECT_NE(&index.names(), &copy.names());
+	EXPECT_EQ("A", index[0]);
+	EXPECT_EQ(0u, index.find("A"));
+	EXPECT_EQ(0u, copy.find("C"));
+
+	copy.append({"D"});
+	EXPECT_EQ(2u, index.size());
+	EXPECT_EQ(2u, copy.find("D"));
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/Metadata.h>
+#include <genetrail2/core/ORAGroupPreference.h>
+
+#include <boost/math/distributions/chi_squared.hpp>
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace GeneTrail;
+
+namespace
+{
+	// Signed chi^2 p-value computed from the four cells of the table
+	double referencePValue(size_t m, size_t l, size_t n, size_t k)
+	{
+		if(l == 0) return -1.0;
+		if(l == m || n == 0 || n == m) return 1.0;
+
+		const double E_11 = double(l) * n / m, E_12 = double(m - l) * n / m;
+		const double E_21 = double(l) * (m - n) / m, E_22 = double(m - l) * (m - n) / m;
+		const double o_11 = k, o_12 = double(n) - k;
+		const double o_21 = double(l) - k, o_22 = (m - l) - o_12;
+		const double chi = (o_11 - E_11) * (o_11 - E_11) / E_11 +
+		                   (o_12 - E_12) * (o_12 - E_12) / E_12 +
+		                   (o_21 - E_21) * (o_21 - E_21) / E_21 +
+		                   (o_22 - E_22) * (o_22 - E_22) / E_22;
+
+		const double p = boost::math::cdf(boost::math::complement(boost::math::chi_squared(1), chi));
+		return o_11 < E_11 ? -p : p;
+	}
+}
+
+TEST(ORAGroupPreference, calculatePreference)
+{
+	const size_t rows = 600, cols = 30;
+	const std::vector<std::string> group_names{"B", "A", "C"};
+
+	std::vector<std::string> row_names, col_names;
+	for(size_t i = 0; i < rows; ++i) {
+		row_names.push_back("cat" + std::to_string(i));
+	}
+
+	Metadata metadata;
+	for(size_t j = 0; j < cols; ++j) {
+		col_names.push_back("s" + std::to_string(j));
+		metadata[col_names.back()] = group_names[j % 3];
+	}
+
+	DenseMatrix matrix(row_names, col_names);
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<double> dist(0.0, 1.0);
+	for(size_t i = 0; i < rows; ++i) {
+		// Some rows are only significant in a single group
+		for(size_t j = 0; j < cols; ++j) {
+			matrix.set(i, j, i % 5 == 0 && j % 3 == 1 ? 0.001 : dist(rng));
+		}
+	}
+
+	// All entries of the first row are significant
+	for(size_t j = 0; j < cols; ++j) {
+		matrix.set(0, j, 0.0);
+	}
+
+	ORAGroupPreference ogp(0.05);
+	ogp.setNumberOfThreads(3);
+
+	DenseMatrix result(0, 0);
+	ogp.calculatePreference(matrix, {metadata}, result);
+
+	ASSERT_EQ(rows, result.rows());
+	ASSERT_EQ(3u, result.cols());
+	EXPECT_EQ("A", result.colName(0));
+	EXPECT_EQ("B", result.colName(1));
+	EXPECT_EQ("C", result.colName(2));
+	EXPECT_EQ(row_names, result.rowNames());
+
+	for(size_t i = 0; i < rows; ++i) {
+		size_t l = 0;
+		std::vector<size_t> n(3, 0), k(3, 0);
+		for(size_t j = 0; j < cols; ++j) {
+			const size_t g = result.colIndex(group_names[j % 3]);
+			const bool significant = matrix(i, j) < 0.05;
+			++n[g];
+			k[g] += significant;
+			l += significant;
+		}
+
+		for(size_t g = 0; g < 3; ++g) {
+			EXPECT_NEAR(referencePValue(cols, l, n[g], k[g]), result(i, g), 1e-12);
+		}
+	}
+
+	EXPECT_EQ(1.0, result(0, 0));
+	EXPECT_LT(0.0, result(5, 0));
+	EXPECT_GT(1e-3, result(5, 0));
+	EXPECT_GT(0.0, result(5, 1));
+}
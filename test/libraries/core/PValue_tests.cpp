@@ -2,7 +2,9 @@
 
 #include <genetrail2/core/PValue.h>
 
-#include<vector>
+#include <random>
+#include <stdexcept>
+#include <vector>
 
 using namespace GeneTrail;
 
@@ -211,3 +213,63 @@ TEST(PValue, Stouffer){
 	EXPECT_NEAR(f, 0.0, 0.0001);
 }
 
+
+// The index based methods need to agree with the container based ones,
+// but keep the p-values at their position.
+TEST(PValue, AdjustInPlace){
+	std::mt19937 gen(42);
+	std::uniform_real_distribution<double> dist(0.0, 0.1);
+
+	std::vector<std::pair<size_t, double>> random;
+	for(size_t i = 0; i < 1000; ++i) {
+		// Include ties
+		random.emplace_back(i, i % 10 == 0 ? 0.05 : dist(gen));
+	}
+
+	const std::vector<MultipleTestingCorrection> methods{
+	    MultipleTestingCorrection::Bonferroni,
+	    MultipleTestingCorrection::Sidak,
+	    MultipleTestingCorrection::Holm,
+	    MultipleTestingCorrection::HolmSidak,
+	    MultipleTestingCorrection::Finner,
+	    MultipleTestingCorrection::BenjaminiHochberg,
+	    MultipleTestingCorrection::BenjaminiYekutieli,
+	    MultipleTestingCorrection::Hochberg,
+	    MultipleTestingCorrection::Simes};
+
+	for(const auto& input : {std::vector<std::pair<size_t, double>>{
+	                             {0, 0.05}, {1, 0.01}, {2, 0.07}, {3, 0.03}, {4, 0.1}},
+	                         random}) {
+		std::vector<double> raw;
+		for(const auto& p : input) {
+			raw.push_back(p.second);
+		}
+
+		const auto order = pvalue::ascendingOrder(raw.data(), raw.size(), 4);
+
+		for(auto method : methods) {
+			auto expected = pvalue::adjustPValues(input, pvalue::get_second(), method);
+
+			std::vector<double> adjusted(raw);
+			pvalue::adjustInPlace(adjusted.data(), adjusted.size(), order, method);
+
+			for(const auto& p : expected) {
+				EXPECT_NEAR(p.second, adjusted[p.first], 1e-12);
+			}
+		}
+	}
+}
+
+TEST(PValue, AdjustInPlaceWithoutOrder){
+	std::vector<double> values{0.05, 0.01, 0.07, 0.03, 0.1};
+	EXPECT_THROW(pvalue::adjustInPlace(values.data(), values.size(), {},
+	                                   MultipleTestingCorrection::Holm),
+	             std::invalid_argument);
+
+	pvalue::adjustInPlace(values, MultipleTestingCorrection::Holm);
+	EXPECT_NEAR(values[0], 0.15, TOLERANCE);
+	EXPECT_NEAR(values[1], 0.05, TOLERANCE);
+	EXPECT_NEAR(values[2], 0.15, TOLERANCE);
+	EXPECT_NEAR(values[3], 0.12, TOLERANCE);
+	EXPECT_NEAR(values[4], 0.15, TOLERANCE);
+}
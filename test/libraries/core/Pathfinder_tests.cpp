@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/BoostGraphParser.h>
+#include <genetrail2/core/Pathfinder.h>
+
+#include <config.h>
+
+#include <string>
+#include <vector>
+
+using namespace GeneTrail;
+
+namespace
+{
+	struct ExpectedPath
+	{
+		int running_sum;
+		std::vector<std::string> vertices;
+		std::vector<std::string> regulations;
+	};
+
+	const std::vector<std::string> sorted_gene_list{
+	    "G24", "G22", "G21", "G27", "G01", "G28", "G06", "G09", "G08", "G10",
+	    "G12", "G11", "G04", "G17", "G02", "G14", "G23", "G00", "G05", "G20",
+	    "G03", "G18", "G25", "G26", "G29", "G15", "G13", "G07", "G19", "G16"};
+
+	// Results of the implementation based on the prefix count matrices
+	const std::vector<ExpectedPath> expected_paths{
+	    {54, {"G22", "G21"}, {"inhibition"}},
+	    {72, {"G28", "G22", "G21"}, {"activation", "inhibition"}},
+	    {80, {"G09", "G08", "G10", "G06"}, {"pp", "pp", "inhibition"}},
+	    {95,
+	     {"G22", "G01", "G13", "G27", "G21"},
+	     {"activation", "activation", "pp", "activation"}},
+	    {114,
+	     {"G28", "G22", "G01", "G13", "G27", "G21"},
+	     {"activation", "activation", "activation", "pp", "activation"}},
+	    {126,
+	     {"G28", "G22", "G21", "G11", "G08", "G10", "G06"},
+	     {"activation", "inhibition", "activation", "activation", "pp",
+	      "inhibition"}},
+	    {124,
+	     {"G28", "G22", "G01", "G13", "G27", "G21", "G11", "G06"},
+	     {"activation", "activation", "activation", "pp", "activation",
+	      "activation", "inhibition"}},
+	    {135,
+	     {"G28", "G22", "G21", "G11", "G08", "G10", "G06", "G02", "G04"},
+	     {"activation", "inhibition", "activation", "activation", "pp",
+	      "inhibition", "activation", "pp"}},
+	    {150,
+	     {"G28", "G22", "G01", "G13", "G27", "G21", "G11", "G08", "G10", "G06"},
+	     {"activation", "activation", "activation", "pp", "activation",
+	      "activation", "activation", "pp", "inhibition"}}};
+
+	void expectPaths(std::vector<Path>& paths)
+	{
+		ASSERT_EQ(expected_paths.size(), paths.size());
+
+		for(size_t i = 0; i < paths.size(); ++i) {
+			Path& path = paths[i];
+			const ExpectedPath& expected = expected_paths[i];
+
+			EXPECT_EQ(expected.running_sum, path.runningSum()) << i;
+			ASSERT_EQ(expected.vertices.size(), path.length()) << i;
+
+			for(size_t j = 0; j < expected.vertices.size(); ++j) {
+				EXPECT_EQ(expected.vertices[j], path.getVertex(j)) << i;
+			}
+
+			for(size_t j = 1; j < expected.vertices.size(); ++j) {
+				EXPECT_EQ(expected.regulations[j - 1],
+				          path.getRegulation(path.getVertex(j - 1),
+				                             path.getVertex(j)))
+				    << i;
+			}
+		}
+	}
+}
+
+TEST(Pathfinder, matchesPreviousResults)
+{
+	GraphType graph;
+	BoostGraphParser().readCytoscapeFile<GraphType>(
+	    TEST_DATA_PATH("Pathfinder_test.sif"), graph);
+
+	Pathfinder pathfinder;
+	auto paths = pathfinder.computeDeregulatedPath(graph, sorted_gene_list, 10);
+	expectPaths(paths);
+}
+
+TEST(Pathfinder, independentOfNumberOfThreads)
+{
+	GraphType graph;
+	BoostGraphParser().readCytoscapeFile<GraphType>(
+	    TEST_DATA_PATH("Pathfinder_test.sif"), graph);
+
+	for(unsigned int num_threads : {1u, 3u}) {
+		Pathfinder pathfinder;
+		pathfinder.setNumberOfThreads(num_threads);
+		auto paths = pathfinder.computeDeregulatedPath(graph, sorted_gene_list, 10);
+		expectPaths(paths);
+	}
+}
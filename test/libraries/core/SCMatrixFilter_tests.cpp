@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/SCMatrixFilter.h>
+#include <genetrail2/core/SparseMatrix.h>
+#include <genetrail2/core/SparseMatrixReader.h>
+
+#include <fstream>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+
+using namespace GeneTrail;
+namespace fs = boost::filesystem;
+
+class SCMatrixFilterTest : public ::testing::Test
+{
+	public:
+	SCMatrixFilterTest()
+	    : input_("/tmp/" + fs::unique_path().native()),
+	      output_("/tmp/" + fs::unique_path().native()),
+	      sparse_output_("/tmp/" + fs::unique_path().native()),
+	      statistics_("/tmp/" + fs::unique_path().native())
+	{
+		std::ofstream out(input_);
+		out << "c1\tc2\tc3\tc4\n"
+		    << "G1\t1\t0\t4\t0\n"
+		    << "MT-1\t1\t0\t0\t5\n"
+		    << "\n"
+		    << "G2\t0\t3\t2\t0\n"
+		    << "G3\t2\t0\t0\t1\n";
+	}
+
+	void TearDown() override
+	{
+		fs::remove(input_);
+		fs::remove(output_);
+		fs::remove(sparse_output_);
+		fs::remove(statistics_);
+	}
+
+	protected:
+	FilterParams params(size_t chunk_size)
+	{
+		FilterParams p;
+		p.min_total_count = 4;
+		p.max_mito = 0.5;
+		p.out_matrix = output_;
+		p.out_sparse_matrix = sparse_output_;
+		p.out_statistics = statistics_;
+		p.num_threads = 2;
+		p.chunk_size = chunk_size;
+		return p;
+	}
+
+	std::string readFile(const std::string& file)
+	{
+		std::ifstream in(file);
+		std::stringstream ss;
+		ss << in.rdbuf();
+		return ss.str();
+	}
+
+	std::string input_;
+	std::string output_;
+	std::string sparse_output_;
+	std::string statistics_;
+};
+
+TEST_F(SCMatrixFilterTest, filterMatrix)
+{
+	// c2 has too few counts, c4 too many mitochondrial counts.
+	const std::string expected_matrix = "c1\tc3\n"
+	                                    "G1\t1\t4\n"
+	                                    "MT-1\t1\t0\n"
+	                                    "G2\t0\t2\n"
+	                                    "G3\t2\t0\n";
+
+	const std::string expected_statistics = "c1\tc3\n"
+	                                        "total_count\t4\t6\n"
+	                                        "mito_percentage\t0.25\t0\n"
+	                                        "nonzero_features\t3\t2\n";
+
+	// Small chunks force lines to be split across blocks
+	for(size_t chunk_size : {3, 16, 1024}) {
+		SCMatrixFilter filter;
+		filter.filterMatrix(input_, {"MT-1"}, params(chunk_size));
+
+		EXPECT_EQ(expected_matrix, readFile(output_));
+		EXPECT_EQ(expected_statistics, readFile(statistics_));
+
+		std::ifstream in(sparse_output_, std::ios::binary);
+		SparseMatrix m = SparseMatrixReader().read(in);
+
+		ASSERT_EQ(4u, m.rows());
+		ASSERT_EQ(2u, m.cols());
+		EXPECT_EQ(5, m.matrix().nonZeros());
+		EXPECT_EQ("MT-1", m.rowName(1));
+		EXPECT_EQ("c3", m.colName(1));
+		EXPECT_EQ(4.0, m(0, 1));
+		EXPECT_EQ(1.0, m(1, 0));
+		EXPECT_EQ(0.0, m(1, 1));
+		EXPECT_EQ(2.0, m(3, 0));
+	}
+}
+
+TEST_F(SCMatrixFilterTest, emptyTrailingField)
+{
+	// The empty value of G1 must neither be read from the next row, whose
+	// name looks like a number, nor from beyond the end of the file.
+	{
+		std::ofstream out(input_);
+		out << "c1\tc2\tc3\tc4\n"
+		    << "G1\t1\t0\t4\t\n"
+		    << "42\t1\t3\t0\t5\n"
+		    << "G3\t0\t0\t1\t";
+	}
+
+	// Values are copied verbatim into the filtered matrix
+	const std::string expected_matrix = "c3\tc4\n"
+	                                    "G1\t4\t\n"
+	                                    "42\t0\t5\n"
+	                                    "G3\t1\t\n";
+
+	const std::string expected_statistics = "c3\tc4\n"
+	                                        "total_count\t5\t5\n"
+	                                        "mito_percentage\t0\t0\n"
+	                                        "nonzero_features\t2\t1\n";
+
+	for(size_t chunk_size : {3, 1024}) {
+		SCMatrixFilter filter;
+		filter.filterMatrix(input_, {"MT-1"}, params(chunk_size));
+
+		EXPECT_EQ(expected_matrix, readFile(output_));
+		EXPECT_EQ(expected_statistics, readFile(statistics_));
+	}
+}
+
+TEST_F(SCMatrixFilterTest, filterSparseMatrix)
+{
+	SparseMatrix input({"G1", "MT-1", "G2", "G3"}, {"c1", "c2", "c3", "c4"});
+	input(0, 0) = 1.0;
+	input(0, 2) = 4.0;
+	input(1, 0) = 1.0;
+	input(1, 3) = 5.0;
+	input(2, 1) = 3.0;
+	input(2, 2) = 2.0;
+	input(3, 0) = 2.0;
+	input(3, 3) = 1.0;
+	input.matrix().makeCompressed();
+
+	const std::string expected_matrix = "c1\tc3\n"
+	                                    "G1\t1\t4\n"
+	                                    "MT-1\t1\t0\n"
+	                                    "G2\t0\t2\n"
+	                                    "G3\t2\t0\n";
+
+	const std::string expected_statistics = "c1\tc3\n"
+	                                        "total_count\t4\t6\n"
+	                                        "mito_percentage\t0.25\t0\n"
+	                                        "nonzero_features\t3\t2\n";
+
+	SCMatrixFilter filter;
+	filter.filterMatrix(input, {"MT-1"}, params(1024));
+
+	EXPECT_EQ(expected_matrix, readFile(output_));
+	EXPECT_EQ(expected_statistics, readFile(statistics_));
+
+	std::ifstream in(sparse_output_, std::ios::binary);
+	SparseMatrix m = SparseMatrixReader().read(in);
+
+	ASSERT_EQ(4u, m.rows());
+	ASSERT_EQ(2u, m.cols());
+	EXPECT_EQ(5, m.matrix().nonZeros());
+	EXPECT_EQ("c3", m.colName(1));
+	EXPECT_EQ(4.0, m(0, 1));
+	EXPECT_EQ(1.0, m(1, 0));
+	EXPECT_EQ(2.0, m(3, 0));
+}
@@ -222,3 +222,23 @@ TEST_F(ScoresTest, subsetUnsorted)
 	EXPECT_FALSE(subset.contains("H"));
 	EXPECT_FALSE(subset.contains("B"));
 }
+
+TEST_F(ScoresTest, toCategory)
+{
+	auto db = std::make_shared<EntityDatabase>();
+
+	Scores scores(db);
+	scores.emplace_back("F", 1.1);
+	scores.emplace_back("A", -2.0);
+	scores.emplace_back("P", 0.0);
+	scores.emplace_back("A", 3.0);
+
+	Category c = scores.toCategory("test");
+
+	EXPECT_EQ("test", c.name());
+	EXPECT_EQ(size_t(3), c.size());
+	EXPECT_TRUE(c.contains("A"));
+	EXPECT_TRUE(c.contains("F"));
+	EXPECT_TRUE(c.contains("P"));
+	EXPECT_FALSE(c.contains("B"));
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/DenseColumnSubset.h>
+#include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/Exception.h>
+#include <genetrail2/core/GroupedScores.h>
+#include <genetrail2/core/MatrixHTest.h>
+#include <genetrail2/core/Metadata.h>
+#include <genetrail2/core/SparseMatrix.h>
+#include <genetrail2/core/SparseMatrixHTest.h>
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace GeneTrail;
+
+namespace
+{
+	const double TOLERANCE = 1e-9;
+
+	std::vector<std::string> names(const std::string& prefix, size_t n)
+	{
+		std::vector<std::string> result;
+		for(size_t i = 0; i < n; ++i) {
+			result.push_back(prefix + std::to_string(i));
+		}
+		return result;
+	}
+
+	// About two thirds of the entries are zero. The last row is empty.
+	DenseMatrix createDenseMatrix()
+	{
+		DenseMatrix m(names("G", 40), names("C", 24));
+
+		std::mt19937 twister(42);
+		std::uniform_real_distribution<double> value(0.0, 10.0);
+		std::bernoulli_distribution nonzero(0.33);
+
+		for(unsigned int i = 0; i + 1 < m.rows(); ++i) {
+			for(unsigned int j = 0; j < m.cols(); ++j) {
+				m(i, j) = nonzero(twister) ? std::round(value(twister)) : 0.0;
+			}
+		}
+		m.matrix().row(m.rows() - 1).setZero();
+
+		return m;
+	}
+
+	SparseMatrix toSparse(const DenseMatrix& dense)
+	{
+		SparseMatrix m(dense.rowNames(), dense.colNames());
+		m.matrix() = dense.matrix().sparseView();
+		return m;
+	}
+
+	void expectEqual(double expected, double value)
+	{
+		if(std::isfinite(expected)) {
+			EXPECT_NEAR(expected, value, TOLERANCE * std::max(1.0, std::abs(expected)));
+		} else if(std::isnan(expected)) {
+			EXPECT_TRUE(std::isnan(value));
+		} else {
+			EXPECT_EQ(expected, value);
+		}
+	}
+}
+
+TEST(SparseMatrixHTest, agreesWithDense)
+{
+	DenseMatrix dense = createDenseMatrix();
+	SparseMatrix sparse = toSparse(dense);
+
+	std::vector<unsigned int> ref{0, 2, 3, 5, 7, 8, 11, 13, 17, 19};
+	std::vector<unsigned int> sam{1, 4, 6, 9, 10, 12, 14, 15, 20, 22, 23};
+
+	DenseColumnSubset dense_ref(&dense, ref);
+	DenseColumnSubset dense_sam(&dense, sam);
+
+	MatrixHTest htest;
+	SparseMatrixHTest sparse_htest;
+	sparse_htest.setNumberOfThreads(2);
+
+	for(const std::string method :
+	    {"independent-t-test", "log-mean-fold-quotient", "mean-fold-quotient",
+	     "mean-fold-difference", "mean-first-group", "mean-larger-zero",
+	     "larger-zero", "mean-first-larger-zero"}) {
+		SCOPED_TRACE(method);
+		ASSERT_TRUE(sparse_htest.supports(method));
+
+		auto expected = htest.test(method, dense_ref, dense_sam);
+		auto scores = sparse_htest.test(method, sparse, ref, sam);
+
+		ASSERT_EQ(expected.size(), scores.size());
+		for(size_t i = 0; i < scores.size(); ++i) {
+			EXPECT_EQ(expected[i].name(*expected.db()), scores[i].name(*scores.db()));
+			expectEqual(expected[i].score(), scores[i].score());
+		}
+	}
+
+	// Overlapping groups
+	auto expected = htest.test("independent-t-test", dense_ref, DenseColumnSubset(&dense, {0, 1, 2}));
+	auto scores = sparse_htest.test("independent-t-test", sparse, ref, {0, 1, 2});
+	for(size_t i = 0; i < scores.size(); ++i) {
+		expectEqual(expected[i].score(), scores[i].score());
+	}
+}
+
+TEST(SparseMatrixHTest, unsupportedMethods)
+{
+	SparseMatrix sparse = toSparse(createDenseMatrix());
+	SparseMatrixHTest htest;
+
+	EXPECT_FALSE(htest.supports("wilcoxon"));
+	EXPECT_FALSE(htest.supports("unknown"));
+	EXPECT_THROW(htest.test("wilcoxon", sparse, {0}, {1}), NotImplemented);
+	EXPECT_THROW(htest.test("unknown", sparse, {0}, {1}), std::invalid_argument);
+}
+
+TEST(SparseMatrixHTest, groupedScores)
+{
+	DenseMatrix dense = createDenseMatrix();
+	SparseMatrix sparse = toSparse(dense);
+
+	Metadata meta;
+	const std::vector<std::string> groups{"a", "b", "c", "b"};
+	for(unsigned int j = 0; j < dense.cols(); ++j) {
+		meta.add(dense.colName(j), groups[(j * 7) % groups.size()]);
+	}
+
+	GroupedScores calculator;
+	for(const std::string method : {"independent-t-test", "mean-fold-difference", "larger-zero"}) {
+		SCOPED_TRACE(method);
+
+		DenseMatrix expected(0, 0), result(0, 0);
+		calculator.calculateGroupedScores(dense, {meta}, method, expected);
+		calculator.calculateGroupedScores(sparse, {meta}, method, result, 2);
+
+		ASSERT_EQ(expected.rows(), result.rows());
+		ASSERT_EQ(expected.cols(), result.cols());
+		EXPECT_EQ(expected.rowNames(), result.rowNames());
+		EXPECT_EQ(expected.colNames(), result.colNames());
+
+		for(unsigned int i = 0; i < result.rows(); ++i) {
+			for(unsigned int j = 0; j < result.cols(); ++j) {
+				expectEqual(expected(i, j), result(i, j));
+			}
+		}
+	}
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/SparseMatrix.h>
+#include <genetrail2/core/SparseMatrixTools.h>
+
+#include <cmath>
+#include <vector>
+
+using namespace GeneTrail;
+
+namespace
+{
+	// 0 2 0 1
+	// 0 0 0 0
+	// 3 1 0 -1
+	SparseMatrix createMatrix()
+	{
+		SparseMatrix m({"A", "B", "C"}, {"c1", "c2", "c3", "c4"});
+		m(0, 1) = 2.0;
+		m(0, 3) = 1.0;
+		m(2, 0) = 3.0;
+		m(2, 1) = 1.0;
+		m(2, 3) = -1.0;
+		m.matrix().makeCompressed();
+		return m;
+	}
+}
+
+TEST(SparseMatrixTools, columnSums)
+{
+	SparseMatrixTools tools;
+	auto sums = tools.columnSums(createMatrix());
+
+	ASSERT_EQ(4u, sums.size());
+	EXPECT_EQ(3.0, sums[0]);
+	EXPECT_EQ(3.0, sums[1]);
+	EXPECT_EQ(0.0, sums[2]);
+	EXPECT_EQ(0.0, sums[3]);
+}
+
+TEST(SparseMatrixTools, normalizeLibrarySize)
+{
+	SparseMatrix m = createMatrix();
+	SparseMatrixTools tools;
+	tools.setNumberOfThreads(2);
+	tools.normalizeLibrarySize(m, 6.0);
+
+	EXPECT_EQ(5, m.matrix().nonZeros());
+	EXPECT_DOUBLE_EQ(6.0, m(2, 0));
+	EXPECT_DOUBLE_EQ(4.0, m(0, 1));
+	EXPECT_DOUBLE_EQ(2.0, m(2, 1));
+	// Columns summing up to zero are left untouched
+	EXPECT_DOUBLE_EQ(1.0, m(0, 3));
+	EXPECT_DOUBLE_EQ(-1.0, m(2, 3));
+
+	tools.log1p(m);
+	EXPECT_EQ(5, m.matrix().nonZeros());
+	EXPECT_DOUBLE_EQ(std::log(7.0), m(2, 0));
+	EXPECT_DOUBLE_EQ(std::log(3.0), m(2, 1));
+	EXPECT_EQ(0.0, m(1, 1));
+}
+
+TEST(SparseMatrixTools, groupMoments)
+{
+	SparseMatrix m = createMatrix();
+	const size_t NO_GROUP = SparseGroupMoments::NO_GROUP;
+
+	for(unsigned int num_threads : {1u, 2u, 8u}) {
+		SparseGroupMoments moments(m, {0, 1, NO_GROUP, 0}, 2, num_threads);
+
+		ASSERT_EQ(3u, moments.rows());
+		ASSERT_EQ(2u, moments.numberOfGroups());
+
+		// Row C, group 0 = {3, -1}
+		auto g = moments(2, 0);
+		EXPECT_EQ(2.0, g.size);
+		EXPECT_EQ(2.0, g.sum);
+		EXPECT_EQ(10.0, g.sum_sq);
+		EXPECT_EQ(1.0, g.positive);
+		EXPECT_EQ(3.0, g.positive_sum);
+		EXPECT_DOUBLE_EQ(1.0, g.mean());
+		EXPECT_DOUBLE_EQ(8.0, g.var());
+		EXPECT_DOUBLE_EQ(3.0, g.meanPositive());
+
+		// Row B only consists of implicit zeros
+		g = moments(1, 1);
+		EXPECT_EQ(1.0, g.size);
+		EXPECT_EQ(0.0, g.mean());
+		EXPECT_EQ(0.0, g.var());
+		EXPECT_EQ(0.0, g.meanPositive());
+
+		// Row A, both groups = {0, 2, 1}
+		g = moments.total(0);
+		EXPECT_EQ(3.0, g.size);
+		EXPECT_DOUBLE_EQ(1.0, g.mean());
+		EXPECT_DOUBLE_EQ(1.0, g.var());
+
+		g -= moments(0, 1);
+		EXPECT_EQ(2.0, g.size);
+		EXPECT_DOUBLE_EQ(0.5, g.mean());
+	}
+}
@@ -36,4 +36,30 @@ TEST(WilcoxonRankSumTest, Simple2)
 {
 	WilcoxonRankSumTest<double> test;
     EXPECT_NEAR(test.test(a2.begin(), a2.end(), b2.begin(), b2.end()), test.computeZScore_(25, 3, 7), TOLERANCE);
-}
\ No newline at end of file
+}
+TEST(WilcoxonRankSumTest, TiedRanks)
+{
+	std::vector<double> values{3.0, 1.0, 3.0, 2.0, 3.0, 0.5};
+	auto ranks = WilcoxonRankSumTest<double>::tiedRanks(values.begin(), values.end());
+
+	std::vector<double> expected{5.0, 2.0, 5.0, 3.0, 5.0, 1.0};
+	ASSERT_EQ(expected.size(), ranks.size());
+	for(size_t i = 0; i < ranks.size(); ++i) {
+		EXPECT_DOUBLE_EQ(expected[i], ranks[i]);
+	}
+}
+
+TEST(WilcoxonRankSumTest, RankSumWithTies)
+{
+	std::vector<double> first{4.0, 2.0, 2.0};
+	std::vector<double> second{1.0, 2.0, 4.0, 5.0};
+
+	std::vector<double> all(first);
+	all.insert(all.end(), second.begin(), second.end());
+	auto ranks = WilcoxonRankSumTest<double>::tiedRanks(all.begin(), all.end());
+
+	WilcoxonRankSumTest<double> test;
+	EXPECT_NEAR(test.test(first.begin(), first.end(), second.begin(), second.end()),
+	            test.computeZScoreFromRankSum(ranks[0] + ranks[1] + ranks[2], 3, 4),
+	            TOLERANCE);
+}
@@ -27,6 +27,8 @@
 #include <config.h>
 
 #include <fstream>
+#include <limits>
+#include <stdexcept>
 
 using namespace GeneTrail;
 
@@ -79,7 +81,7 @@ TEST(NAHandlerTest, remove){
 	ASSERT_EQ(4, m.cols());
 
 	EXPECT_EQ("G1", m.rowName(0));
-	EXPECT_EQ("G3", m.rowName(2));
+	EXPECT_EQ("G3", m.rowName(1));
 
 	EXPECT_EQ("Hi", m.colName(0));
 	EXPECT_EQ("Hi2", m.colName(1));
@@ -202,3 +204,72 @@ TEST(NAHandlerTest, median){
 }
 
 
+TEST(NAHandlerTest, knn){
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+
+	DenseMatrix m(4, 5);
+	m.matrix() <<   1.0,  2.0,  3.0,  4.0,   nan,
+	                1.0,  2.0,  3.0,  4.0,   5.0,
+	                1.0,  2.0,  3.0,  4.5,   7.0,
+	                4.0,  3.0,  2.0,  1.0, 100.0;
+
+	DenseMatrix m2(m), m3(m);
+
+	NAHandler h;
+	h.handle(m, NAStrategyKNN(1));
+	h.handle(m2, NAStrategyKNN(2));
+	h.handle(m3, NAStrategyKNN(1, NAStrategyKNN::Metric::Correlation));
+
+	ASSERT_EQ(4, m.rows());
+	EXPECT_EQ(5.0, m(0,4));
+	EXPECT_EQ(6.0, m2(0,4));
+	EXPECT_EQ(5.0, m3(0,4));
+
+	// Only the NaN has been touched
+	EXPECT_EQ(7.0, m(2,4));
+	EXPECT_EQ(4.0, m2(0,3));
+}
+
+TEST(NAHandlerTest, knnFallback){
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+
+	DenseMatrix m(3, 3);
+	m.matrix() << 1.0, 3.0, nan,
+	              1.0, 2.0, nan,
+	              nan, nan, 1.0;
+
+	NAHandler h;
+	h.handle(m, NAStrategyKNN(2));
+
+	// No neighbour provides the last column, so the row mean is used
+	EXPECT_EQ(2.0, m(0,2));
+	EXPECT_EQ(1.5, m(1,2));
+	// The last row shares no observed column with any other row
+	EXPECT_EQ(1.0, m(2,0));
+	EXPECT_EQ(1.0, m(2,1));
+}
+
+TEST(NAHandlerTest, knnDistantNeighbour){
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+
+	DenseMatrix m(7, 4);
+	m.matrix() << 1.0, 2.0, 3.0,  nan,
+	              1.0, 2.0, 3.1,  nan,
+	              1.0, 2.0, 3.2,  nan,
+	              1.0, 2.0, 3.3,  nan,
+	              1.0, 2.0, 3.4,  nan,
+	              5.0, 5.0, 5.0,  9.0,
+	              8.0, 8.0, 8.0, 20.0;
+
+	NAHandler h;
+	h.handle(m, NAStrategyKNN(1));
+
+	// The closest rows do not observe the last column
+	for(unsigned int i = 0; i < 5; ++i) {
+		EXPECT_EQ(9.0, m(i,3));
+	}
+}
+
+TEST(NAHandlerTest, knnRejectsZeroNeighbours){
+	EXPECT_THROW(NAStrategyKNN(0), std::invalid_argument);
+}
@@ -0,0 +1,326 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/Category.h>
+#include <genetrail2/core/CategoryDatabase.h>
+#include <genetrail2/core/EntityDatabase.h>
+#include <genetrail2/core/Exception.h>
+#include <genetrail2/core/Scores.h>
+
+#include <genetrail2/enrichment/common.h>
+#include <genetrail2/enrichment/EnrichmentAlgorithm.h>
+#include <genetrail2/enrichment/EnrichmentResult.h>
+#include <genetrail2/enrichment/EnrichmentResultReader.h>
+#include <genetrail2/enrichment/EnrichmentResultStore.h>
+#include <genetrail2/enrichment/EnrichmentResultWriter.h>
+#include <genetrail2/enrichment/Parameters.h>
+#include <genetrail2/enrichment/PermutationTest.h>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <map>
+#include <sstream>
+
+using namespace GeneTrail;
+namespace fs = boost::filesystem;
+
+class EnrichmentResultStoreTest : public ::testing::Test
+{
+  public:
+	EnrichmentResultStoreTest()
+	    : db_(std::make_shared<EntityDatabase>()), store_(db_)
+	{
+		for(const auto& name : {"E", "D", "C", "B", "A"}) {
+			db_->index(name);
+		}
+
+		store_.addDatabase("first");
+		add("Cat 1", 3, 1.5, 0.5, 0.01, true, {4, 0, 2});
+		add("Cat 2", 0, -2.0, 0.0, 1.0, false, {});
+		add("Cat 3", 1, 0.25, 1.0, 0.0, false, {3});
+
+		store_.addDatabase("empty");
+
+		store_.addDatabase("last");
+		add("Cat 4", 2, 4.0, 2.0, 1e-5, true, {1, 4});
+	}
+
+  protected:
+	void add(const std::string& name, unsigned int hits, double score,
+	         double expected, double p, bool enriched,
+	         const std::vector<size_t>& entities)
+	{
+		auto c = std::make_shared<Category>(db_.get(), name);
+		c->setReference("ref");
+
+		EnrichmentResult result(c);
+		result.hits = hits;
+		result.score = score;
+		result.expected_score = expected;
+		result.pvalue = p;
+		result.enriched = enriched;
+		result.info = "ignored";
+
+		store_.add(result, entities);
+	}
+
+	static std::vector<std::string> hitNames(const EnrichmentResultStore& store,
+	                                         size_t i)
+	{
+		std::vector<std::string> names;
+		for(auto it = store.hitsBegin(i); it != store.hitsEnd(i); ++it) {
+			names.push_back((*store.db())(*it));
+		}
+
+		return names;
+	}
+
+	std::shared_ptr<EntityDatabase> db_;
+	EnrichmentResultStore store_;
+};
+
+TEST_F(EnrichmentResultStoreTest, databases)
+{
+	ASSERT_EQ(4, store_.size());
+	ASSERT_EQ(3, store_.numDatabases());
+
+	EXPECT_EQ("first", store_.databaseName(0));
+	EXPECT_EQ(0, store_.databaseBegin(0));
+	EXPECT_EQ(3, store_.databaseEnd(0));
+
+	EXPECT_EQ("empty", store_.databaseName(1));
+	EXPECT_EQ(3, store_.databaseBegin(1));
+	EXPECT_EQ(3, store_.databaseEnd(1));
+
+	EXPECT_EQ("last", store_.databaseName(2));
+	EXPECT_EQ(3, store_.databaseBegin(2));
+	EXPECT_EQ(4, store_.databaseEnd(2));
+}
+
+TEST_F(EnrichmentResultStoreTest, hits)
+{
+	EXPECT_EQ(std::vector<std::string>({"A", "E", "C"}), hitNames(store_, 0));
+	EXPECT_TRUE(hitNames(store_, 1).empty());
+	EXPECT_EQ(std::vector<std::string>({"B"}), hitNames(store_, 2));
+	EXPECT_EQ(std::vector<std::string>({"D", "A"}), hitNames(store_, 3));
+}
+
+TEST_F(EnrichmentResultStoreTest, clearResults)
+{
+	store_.clearResults();
+
+	EXPECT_EQ(0, store_.size());
+	ASSERT_EQ(3, store_.numDatabases());
+	for(size_t d = 0; d < store_.numDatabases(); ++d) {
+		EXPECT_EQ(0, store_.databaseBegin(d));
+		EXPECT_EQ(0, store_.databaseEnd(d));
+	}
+
+	store_.addDatabase("new");
+	add("Cat 5", 1, 1.0, 1.0, 0.5, false, {2});
+	EXPECT_EQ(0, store_.databaseBegin(3));
+	EXPECT_EQ(1, store_.databaseEnd(3));
+	EXPECT_EQ(std::vector<std::string>({"C"}), hitNames(store_, 0));
+}
+
+TEST_F(EnrichmentResultStoreTest, writeText)
+{
+	EnrichmentResultWriter writer;
+
+	std::ostringstream first;
+	writer.writeText(first, store_, 0, false, false);
+
+	std::istringstream lines(first.str());
+	std::string line;
+
+	ASSERT_TRUE(std::getline(lines, line));
+	EXPECT_EQ('#', line[0]);
+
+	ASSERT_TRUE(std::getline(lines, line));
+	EXPECT_EQ(0u, line.find("Cat 1\tref\t3\t1.5\t0.5\t0.01\tA,E,C\t"));
+	ASSERT_TRUE(std::getline(lines, line));
+	EXPECT_EQ(0u, line.find("Cat 2\tref\t0\t-2\t0\t1\t\t"));
+	ASSERT_TRUE(std::getline(lines, line));
+	EXPECT_EQ(0u, line.find("Cat 3\tref\t1\t0.25\t1\t0\tB\t"));
+	EXPECT_FALSE(std::getline(lines, line));
+
+	// Empty databases result in empty files, without a header
+	std::ostringstream empty;
+	writer.writeText(empty, store_, 1, false, false);
+	EXPECT_TRUE(empty.str().empty());
+
+	std::ostringstream pvalues;
+	writer.writeText(pvalues, store_, 2, false, true);
+	EXPECT_NE(std::string::npos, pvalues.str().find("Cat 4\t1e-05\n"));
+}
+
+TEST_F(EnrichmentResultStoreTest, binaryRoundTrip)
+{
+	EnrichmentResultWriter writer;
+	EnrichmentResultReader reader;
+
+	for(size_t d = 0; d < store_.numDatabases(); ++d) {
+		std::stringstream buffer;
+		const uint64_t written = writer.writeBinary(buffer, store_, d);
+		EXPECT_EQ(buffer.str().size(), written);
+
+		const auto store = reader.readBinary(buffer);
+
+		ASSERT_EQ(1, store.numDatabases());
+		EXPECT_EQ(store_.databaseName(d), store.databaseName(0));
+		ASSERT_EQ(store_.databaseEnd(d) - store_.databaseBegin(d), store.size());
+
+		for(size_t i = 0; i < store.size(); ++i) {
+			const size_t j = store_.databaseBegin(d) + i;
+			EXPECT_EQ(store_.name(j), store.name(i));
+			EXPECT_EQ(store_.reference(j), store.reference(i));
+			EXPECT_EQ(store_.hits(j), store.hits(i));
+			EXPECT_EQ(store_.score(j), store.score(i));
+			EXPECT_EQ(store_.expectedScore(j), store.expectedScore(i));
+			EXPECT_EQ(store_.enriched(j), store.enriched(i));
+			EXPECT_NEAR(store_.pValue(j).convert_to<double>(),
+			            store.pValue(i).convert_to<double>(), 1e-15);
+			EXPECT_EQ(hitNames(store_, j), hitNames(store, i));
+		}
+	}
+}
+
+TEST_F(EnrichmentResultStoreTest, binaryTruncated)
+{
+	EnrichmentResultWriter writer;
+	EnrichmentResultReader reader;
+
+	std::ostringstream output;
+	writer.writeBinary(output, store_, 0);
+	const std::string data = output.str();
+
+	for(size_t length : {size_t(0), size_t(11), size_t(12), size_t(13),
+	                     size_t(30), data.size() / 2, data.size() - 1}) {
+		std::istringstream input(data.substr(0, length));
+		EXPECT_THROW(reader.readBinary(input), IOError) << length;
+	}
+
+	std::ostringstream broken;
+	broken.setstate(std::ios::badbit);
+	EXPECT_THROW(writer.writeBinary(broken, store_, 0), IOError);
+	EXPECT_THROW(writer.writeText(broken, store_, 0, false, false), IOError);
+}
+
+TEST(EnrichmentRun, rowWisePValuesStayWithTheirCategory)
+{
+	auto db = std::make_shared<EntityDatabase>();
+
+	Scores scores(db);
+	for(size_t i = 0; i < 40; ++i) {
+		scores.emplace_back("G" + std::to_string(i), (i % 7) * 0.5 - 1.0 + 0.01 * i);
+	}
+
+	// The names are ordered differently than the number of hits, as the
+	// results are written by name but permuted by size.
+	CategoryDatabase categories(db);
+	categories.setName("db");
+	const std::vector<std::pair<std::string, std::vector<size_t>>> members{
+	    {"A", {0, 7, 14, 21, 28, 35, 1, 8, 15, 22, 29, 36}},
+	    {"B", {2, 9, 16}},
+	    {"C", {3, 10, 17, 24, 31, 38, 4, 11}},
+	    {"D", {5, 12, 19, 26, 33}}};
+
+	for(const auto& m : members) {
+		auto& c = categories.addCategory();
+		c.setName(m.first);
+		for(size_t i : m.second) {
+			c.insert("G" + std::to_string(i));
+		}
+	}
+
+	Params p;
+	p.verbose = false;
+	p.numPermutations = 500;
+	p.randomSeed = 42;
+	p.binaryOutput = true;
+	p.out_ = DirectoryPath("/tmp/" + fs::unique_path().native());
+	fs::create_directory(p.out());
+
+	auto algorithm = createEnrichmentAlgorithm<MeanEnrichment>(PValueMode::RowWise, scores);
+	run(scores, CategoryDBList{categories}, algorithm, p, true);
+
+	std::ifstream input(p.out() + "/db.bin", std::ios::binary);
+	const auto store = EnrichmentResultReader().readBinary(input);
+	input.close();
+	fs::remove_all(p.out());
+
+	// Reference p-values, computed directly on the same categories
+	auto reference_algorithm = createEnrichmentAlgorithm<MeanEnrichment>(PValueMode::RowWise, scores);
+	std::vector<std::shared_ptr<Category>> cats;
+	for(const auto& c : categories) {
+		cats.push_back(std::make_shared<Category>(c));
+	}
+
+	EnrichmentResults results;
+	for(auto& result : reference_algorithm->computeEnrichments(cats, 1)) {
+		result->hits = result->category->size();
+		results.push_back(std::move(result));
+	}
+
+	RowPermutationTest<double>::IndexBased(scores, p.numPermutations, p.randomSeed)
+	    ->computePValue(reference_algorithm, results);
+
+	std::map<std::string, double> expected;
+	for(const auto& result : results) {
+		expected[result->category->name()] = result->pvalue.convert_to<double>();
+	}
+
+	ASSERT_EQ(members.size(), store.size());
+	for(size_t i = 0; i < store.size(); ++i) {
+		EXPECT_EQ(members[i].first, store.name(i));
+		EXPECT_EQ(members[i].second.size(), store.hits(i));
+		EXPECT_DOUBLE_EQ(expected.at(store.name(i)), store.pValue(i).convert_to<double>())
+		    << store.name(i);
+	}
+}
+
+TEST(EnrichmentRun, duplicateDatabaseNamesKeepTheFirst)
+{
+	auto db = std::make_shared<EntityDatabase>();
+
+	Scores scores(db);
+	for(size_t i = 0; i < 10; ++i) {
+		scores.emplace_back("G" + std::to_string(i), 0.5 * i);
+	}
+
+	CategoryDBList databases;
+	for(const std::string category : {"First", "Second", "Third"}) {
+		CategoryDatabase categories(db);
+		categories.setName(category == "Third" ? "other" : "db");
+
+		auto& c = categories.addCategory();
+		c.setName(category);
+		c.insert("G1");
+		c.insert("G2");
+
+		databases.push_back(categories);
+	}
+
+	Params p;
+	p.verbose = false;
+	p.numPermutations = 10;
+	p.binaryOutput = true;
+	p.out_ = DirectoryPath("/tmp/" + fs::unique_path().native());
+	fs::create_directory(p.out());
+
+	// Without p-values the databases are written one by one, otherwise
+	// all of them are written at the end.
+	for(bool computePValues : {false, true}) {
+		auto algorithm = createEnrichmentAlgorithm<MeanEnrichment>(PValueMode::RowWise, scores);
+		run(scores, databases, algorithm, p, computePValues);
+
+		std::ifstream input(p.out() + "/db.bin", std::ios::binary);
+		const auto store = EnrichmentResultReader().readBinary(input);
+
+		ASSERT_EQ(1, store.size());
+		EXPECT_EQ("First", store.name(0));
+		EXPECT_TRUE(fs::exists(p.out() + "/other.bin"));
+	}
+
+	fs::remove_all(p.out());
+}
@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/CompiledCategoryFile.h>
+#include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/DenseMatrixReader.h>
+#include <genetrail2/core/EntityDatabase.h>
+#include <genetrail2/core/Scores.h>
+
+#include <genetrail2/enrichment/common.h>
+#include <genetrail2/enrichment/EnrichmentAlgorithm.h>
+#include <genetrail2/enrichment/EnrichmentResultReader.h>
+#include <genetrail2/enrichment/EnrichmentResultStore.h>
+#include <genetrail2/enrichment/MultiSampleEnrichment.h>
+#include <genetrail2/enrichment/Parameters.h>
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+
+using namespace GeneTrail;
+namespace fs = boost::filesystem;
+
+class MultiSampleEnrichmentTest : public ::testing::Test
+{
+  public:
+	MultiSampleEnrichmentTest()
+	    : dir_("/tmp/" + fs::unique_path().native()),
+	      db_(std::make_shared<EntityDatabase>()),
+	      genes_(db_),
+	      matrix_(40, 3)
+	{
+		fs::create_directory(dir_);
+
+		std::vector<std::string> names;
+		for(size_t i = 0; i < 40; ++i) {
+			names.push_back("G" + std::to_string(i));
+		}
+
+		// Registering the genes in reverse order makes the matrix order
+		// differ from the index order
+		for(auto it = names.crbegin(); it != names.crend(); ++it) {
+			genes_.emplace_back(*it, 0.0);
+		}
+		genes_.sortByIndex();
+
+		matrix_.setRowNames(names);
+		matrix_.setColNames({"S0", "S1", "S2"});
+		for(size_t i = 0; i < 40; ++i) {
+			for(size_t j = 0; j < 3; ++j) {
+				matrix_(i, j) = ((i * (j + 3)) % 11) * 0.25 - 1.0 + 0.01 * i;
+			}
+		}
+
+		writeGMT("first.gmt", {{"B", {1, 2, 3, 4, 5, 6, 7, 8}},
+		                       {"A", {0, 9, 18, 27, 36}},
+		                       {"Tiny", {10}},
+		                       {"C", {11, 13, 15, 17, 19, 21, 23, 25, 29, 31, 33}}});
+		writeGMT("second.gmt", {{"D", {2, 4, 6, 8, 10, 12, 14}},
+		                        {"E", {1, 3, 5, 7, 50, 51}}});
+
+		cat_list_.emplace_back("first", dir_ + "/first.gmt");
+		cat_list_.emplace_back("second", dir_ + "/second.gmt");
+
+		p_.verbose = false;
+		p_.minimum = 2;
+		p_.numPermutations = 500;
+		p_.randomSeed = 42;
+	}
+
+	void TearDown() override { fs::remove_all(dir_); }
+
+  protected:
+	void writeGMT(const std::string& file,
+	              const std::vector<std::pair<std::string, std::vector<size_t>>>& categories)
+	{
+		std::ofstream out(dir_ + "/" + file);
+		for(const auto& c : categories) {
+			out << c.first << "\tref";
+			for(size_t i : c.second) {
+				out << "\tG" << i;
+			}
+			out << '\n';
+		}
+	}
+
+	static EnrichmentAlgorithmPtr algorithm(const Scores& scores)
+	{
+		return createEnrichmentAlgorithm<MeanEnrichment>(PValueMode::RowWise, scores);
+	}
+
+	DenseMatrix readMatrix(const std::string& file) const
+	{
+		std::ifstream input(dir_ + "/" + file, std::ios::binary);
+		return DenseMatrixReader().read(input);
+	}
+
+	std::string dir_;
+	std::shared_ptr<EntityDatabase> db_;
+	Scores genes_;
+	DenseMatrix matrix_;
+	CategoryList cat_list_;
+	Params p_;
+};
+
+TEST_F(MultiSampleEnrichmentTest, categoryIndex)
+{
+	CategoryIndex index(genes_, cat_list_, p_);
+
+	ASSERT_EQ(2, index.numberOfDatabases());
+	EXPECT_EQ("first", index.databaseName(0));
+	EXPECT_EQ("second", index.databaseName(1));
+
+	// Tiny is filtered, the rest is sorted by name
+	EXPECT_EQ(std::vector<std::string>({"A", "B", "C"}), index.categoryNames(0));
+	EXPECT_EQ(std::vector<std::string>({"D", "E"}), index.categoryNames(1));
+
+	ASSERT_EQ(5, index.size());
+	EXPECT_EQ(5, index[0].hits);
+	EXPECT_EQ(8, index[1].hits);
+	EXPECT_EQ(11, index[2].hits);
+	EXPECT_EQ(7, index[3].hits);
+	// Genes that are not part of the matrix are no hits
+	EXPECT_EQ(4, index[4].hits);
+
+	p_.includeAll = true;
+	CategoryIndex all(genes_, cat_list_, p_);
+	EXPECT_EQ(std::vector<std::string>({"A", "B", "C", "Tiny"}), all.categoryNames(0));
+	EXPECT_EQ(1, all[3].hits);
+}
+
+TEST_F(MultiSampleEnrichmentTest, matchesSingleSampleRuns)
+{
+	CategoryIndex index(genes_, cat_list_, p_);
+
+	MultiSampleEnrichment enrichment(index, &algorithm, p_);
+	enrichment.setNumberOfThreads(2);
+	enrichment.setBlockSize(2);
+	enrichment.run(matrix_, genes_, dir_, MultiSampleEnrichment::Format::Binary);
+
+	const DenseMatrix scores = readMatrix("first.scores.bin");
+	const DenseMatrix pvalues = readMatrix("first.pvalues.bin");
+	const DenseMatrix second = readMatrix("second.pvalues.bin");
+
+	ASSERT_EQ(3, scores.rows());
+	ASSERT_EQ(3, scores.cols());
+	ASSERT_EQ(2, second.rows());
+
+	CategoryDBList databases;
+	for(const auto& cat : cat_list_) {
+		databases.push_back(readCategoryDatabase(db_, cat.second));
+		databases.back().setName(cat.first);
+	}
+
+	for(size_t j = 0; j < matrix_.cols(); ++j) {
+		// Every sample is seeded differently
+		Params p = p_;
+		p.randomSeed = p_.randomSeed + j;
+		p.binaryOutput = true;
+		p.out_ = DirectoryPath(dir_);
+
+		Scores sample(db_);
+		for(size_t i = 0; i < matrix_.rows(); ++i) {
+			sample.emplace_back(matrix_.rowName(i), matrix_(i, j));
+		}
+
+		auto single = algorithm(sample);
+		run(sample, databases, single, p, true);
+
+		for(const std::string name : {"first", "second"}) {
+			std::ifstream input(dir_ + "/" + name + ".bin", std::ios::binary);
+			const auto store = EnrichmentResultReader().readBinary(input);
+
+			const DenseMatrix& expected_pvalues = name == "first" ? pvalues : second;
+			ASSERT_EQ(expected_pvalues.rows(), store.size());
+
+			for(size_t i = 0; i < store.size(); ++i) {
+				EXPECT_EQ(expected_pvalues.rowName(i), store.name(i));
+				EXPECT_NEAR(expected_pvalues(i, j),
+				            store.pValue(i).convert_to<double>(), 1e-12)
+				    << name << " " << store.name(i) << " " << j;
+
+				if(name == "first") {
+					EXPECT_NEAR(scores(i, j), store.score(i), 1e-12);
+				}
+			}
+		}
+	}
+
+	// Samples do not share their permutations
+	EXPECT_FALSE(pvalues.matrix().col(0) == pvalues.matrix().col(1) &&
+	             pvalues.matrix().col(1) == pvalues.matrix().col(2));
+}
@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/Category.h>
+#include <genetrail2/core/DenseMatrix.h>
+#include <genetrail2/core/EntityDatabase.h>
+#include <genetrail2/core/Scores.h>
+
+#include <genetrail2/enrichment/EnrichmentResult.h>
+#include <genetrail2/enrichment/SetLevelStatistics.h>
+
+#include <Eigen/Dense>
+
+#include <boost/math/distributions/fisher_f.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <tuple>
+
+using namespace GeneTrail;
+
+class StatisticsEnrichmentTest : public ::testing::Test
+{
+  public:
+	StatisticsEnrichmentTest()
+	    : scores_(std::make_shared<EntityDatabase>()), indices_(31)
+	{
+		// Contains ties and scores of both signs
+		for(size_t i = 0; i < indices_.size(); ++i) {
+			scores_.emplace_back("G" + std::to_string(i),
+			                     ((i * 7) % 13) * 0.5 - 2.5 + (i % 3 == 0 ? 0.0 : 0.125 * i));
+		}
+
+		std::iota(indices_.begin(), indices_.end(), 0);
+		std::shuffle(indices_.begin(), indices_.end(), std::mt19937(42));
+	}
+
+  protected:
+	/**
+	 * Checks that the prefix scores equal the scores of every prefix
+	 * computed on its own.
+	 */
+	void expectPrefixScoresMatch(const StatisticsEnrichment& statistics) const
+	{
+		std::vector<size_t> sizes{1, 2, 3, 4, 7, 8, 15, 16, 30, 31};
+		std::vector<double> prefix_scores;
+		statistics.computePrefixScores(indices_.cbegin(), sizes, prefix_scores);
+
+		ASSERT_EQ(sizes.size(), prefix_scores.size());
+		for(size_t i = 0; i < sizes.size(); ++i) {
+			EXPECT_NEAR(std::get<0>(statistics.computeScore(
+			                indices_.cbegin(), indices_.cbegin() + sizes[i])),
+			            prefix_scores[i], 1e-10)
+			    << sizes[i];
+		}
+
+		// Sizes may repeat, e.g. if several categories have the same size
+		sizes = {2, 2, 5, 5, 5, 31};
+		statistics.computePrefixScores(indices_.cbegin(), sizes, prefix_scores);
+		ASSERT_EQ(sizes.size(), prefix_scores.size());
+		for(size_t i = 0; i < sizes.size(); ++i) {
+			EXPECT_NEAR(std::get<0>(statistics.computeScore(
+			                indices_.cbegin(), indices_.cbegin() + sizes[i])),
+			            prefix_scores[i], 1e-10)
+			    << sizes[i];
+		}
+	}
+
+	Scores scores_;
+	std::vector<size_t> indices_;
+};
+
+TEST_F(StatisticsEnrichmentTest, sumPrefixScores)
+{
+	expectPrefixScoresMatch(SumEnrichment(scores_));
+}
+
+TEST_F(StatisticsEnrichmentTest, meanPrefixScores)
+{
+	expectPrefixScoresMatch(MeanEnrichment(scores_));
+}
+
+TEST_F(StatisticsEnrichmentTest, medianPrefixScores)
+{
+	expectPrefixScoresMatch(MedianEnrichment(scores_));
+}
+
+TEST_F(StatisticsEnrichmentTest, maxMeanPrefixScores)
+{
+	expectPrefixScoresMatch(MaxMeanEnrichment(scores_));
+}
+
+TEST_F(StatisticsEnrichmentTest, normalApproximationPrefixScores)
+{
+	expectPrefixScoresMatch(NormalApproximationEnrichment(
+	    scores_, NormalApproximationEnrichment::Statistic::Mean));
+	expectPrefixScoresMatch(NormalApproximationEnrichment(
+	    scores_, NormalApproximationEnrichment::Statistic::Sum));
+}
+
+TEST_F(StatisticsEnrichmentTest, prefixScoresAfterNewInputScores)
+{
+	MeanEnrichment mean(scores_);
+
+	Scores other(scores_.db());
+	for(size_t i = 0; i < indices_.size(); ++i) {
+		other.emplace_back("G" + std::to_string(i), -1.0 * i);
+	}
+	mean.setInputScores(other);
+
+	expectPrefixScoresMatch(mean);
+}
+
+class HotellingT2EnrichmentTest : public ::testing::Test
+{
+  public:
+	HotellingT2EnrichmentTest()
+	    : db_(std::make_shared<EntityDatabase>()),
+	      data_({"G0", "G1", "G2", "G3"},
+	            {"R0", "R1", "R2", "R3", "S0", "S1", "S2", "S3", "S4"}),
+	      reference_{"R0", "R1", "R2", "R3"},
+	      sample_{"S0", "S1", "S2", "S3", "S4"}
+	{
+		const double values[3][9] = {
+		    {1.0, 2.5, 0.5, 1.5, 3.0, 2.0, 4.5, 3.5, 2.5},
+		    {0.2, -0.4, 0.9, 0.1, 1.1, 0.3, 1.8, 0.7, 1.4},
+		    {5.0, 4.2, 6.1, 5.5, 4.8, 6.6, 5.9, 7.2, 6.0}};
+
+		for(Matrix::index_type j = 0; j < data_.cols(); ++j) {
+			for(Matrix::index_type i = 0; i < 3; ++i) {
+				data_(i, j) = values[i][j];
+			}
+
+			// A multiple of G0, which makes the covariance singular
+			data_(3, j) = 2.0 * values[0][j];
+		}
+	}
+
+  protected:
+	std::shared_ptr<Category> category(const std::vector<std::string>& genes)
+	{
+		auto c = std::make_shared<Category>(db_.get(), "category");
+		for(const auto& gene : genes) {
+			c->insert(gene);
+		}
+
+		return c;
+	}
+
+	// Textbook two-sample T^2 with an explicitly inverted pooled covariance
+	double expectedScore(const std::vector<Matrix::index_type>& genes) const
+	{
+		const Eigen::Index p = genes.size();
+		const double n1 = reference_.size();
+		const double n2 = sample_.size();
+
+		auto group = [&](const std::vector<std::string>& names,
+		                 Eigen::VectorXd& mean, Eigen::MatrixXd& scatter) {
+			Eigen::MatrixXd x(names.size(), p);
+			for(size_t k = 0; k < names.size(); ++k) {
+				for(Eigen::Index j = 0; j < p; ++j) {
+					x(k, j) = data_(genes[j], data_.colIndex(names[k]));
+				}
+			}
+
+			mean = x.colwise().mean().transpose();
+			x.rowwise() -= mean.transpose();
+			scatter = x.transpose() * x;
+		};
+
+		Eigen::VectorXd mean_reference, mean_sample;
+		Eigen::MatrixXd scatter_reference, scatter_sample;
+		group(reference_, mean_reference, scatter_reference);
+		group(sample_, mean_sample, scatter_sample);
+
+		const Eigen::MatrixXd covariance =
+		    (scatter_reference + scatter_sample) / (n1 + n2 - 2.0);
+		const Eigen::VectorXd d = mean_sample - mean_reference;
+
+		return n1 * n2 / (n1 + n2) * d.dot(covariance.inverse() * d);
+	}
+
+	double expectedPValue(double t2, double p) const
+	{
+		const double n = reference_.size() + sample_.size();
+		const double f = (n - p - 1.0) / ((n - 2.0) * p) * t2;
+
+		boost::math::fisher_f F(p, n - p - 1.0);
+		return boost::math::cdf(boost::math::complement(F, f));
+	}
+
+	std::shared_ptr<EntityDatabase> db_;
+	DenseMatrix data_;
+	std::vector<std::string> reference_;
+	std::vector<std::string> sample_;
+};
+
+TEST_F(HotellingT2EnrichmentTest, matchesDirectComputation)
+{
+	HotellingT2Enrichment hotelling(data_, reference_, sample_, db_);
+
+	const std::vector<std::pair<std::vector<std::string>,
+	                            std::vector<Matrix::index_type>>> cases{
+	    {{"G0"}, {0}}, {{"G0", "G2"}, {0, 2}}, {{"G0", "G1", "G2"}, {0, 1, 2}}};
+
+	for(const auto& test : cases) {
+		EnrichmentResult result(category(test.first));
+		ASSERT_TRUE(hotelling.canUseCategory(*result.category, test.first.size()));
+
+		result.score = std::get<0>(hotelling.computeScore(*result.category));
+		const double expected = expectedScore(test.second);
+		EXPECT_NEAR(expected, result.score, 1e-10 * expected)
+		    << test.first.size();
+
+		EXPECT_NEAR(expectedPValue(expected, test.first.size()),
+		            hotelling.computeRowWisePValue(&result), 1e-10)
+		    << test.first.size();
+	}
+}
+
+TEST_F(HotellingT2EnrichmentTest, singularCovariance)
+{
+	HotellingT2Enrichment hotelling(data_, reference_, sample_, db_);
+
+	EnrichmentResult result(category({"G0", "G3"}));
+	ASSERT_TRUE(hotelling.canUseCategory(*result.category, 2));
+
+	result.score = std::get<0>(hotelling.computeScore(*result.category));
+	EXPECT_TRUE(std::isnan(result.score));
+	EXPECT_EQ(1.0, hotelling.computeRowWisePValue(&result));
+}
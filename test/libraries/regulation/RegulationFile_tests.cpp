@@ -296,3 +296,16 @@ TEST(RegulationFile, MatrixNameDatabaseMicro) {
       
     }
 }
+
+TEST(RegulationFile, splitFields) {
+    boost::string_ref fields[3];
+
+    EXPECT_EQ(2u, splitFields(" GeneA \t\tGeneB\r", fields, 3));
+    EXPECT_EQ("GeneA", fields[0]);
+    EXPECT_EQ("GeneB", fields[1]);
+
+    EXPECT_EQ(4u, splitFields("a b c d", fields, 3));
+    EXPECT_EQ("c", fields[2]);
+
+    EXPECT_EQ(0u, splitFields(" \t ", fields, 3));
+}
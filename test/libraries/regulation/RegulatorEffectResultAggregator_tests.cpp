@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <genetrail2/core/Exception.h>
+#include <genetrail2/regulation/RegulatorEffectResultAggregator.h>
+
+#include <config.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/math/distributions/chi_squared.hpp>
+#include <boost/math/distributions/normal.hpp>
+
+#include <cmath>
+#include <fstream>
+
+using namespace GeneTrail;
+
+namespace fs = boost::filesystem;
+
+class RegulatorEffectResultAggregatorTest : public ::testing::Test
+{
+  protected:
+	void SetUp() override
+	{
+		list_ = "/tmp/" + fs::unique_path().native();
+		std::ofstream out(list_);
+		out << TEST_DATA_PATH("reggae_result1.json") << '\n'
+		    << TEST_DATA_PATH("reggae_result2.json") << '\n';
+	}
+
+	void TearDown() override { fs::remove(list_); }
+
+	std::string list_;
+};
+
+// Regulators are numbered in order of appearance: A, B, C
+TEST_F(RegulatorEffectResultAggregatorTest, readResults)
+{
+	RegulatorEffectResultAggregator aggregator;
+	aggregator.read_results(list_);
+
+	ASSERT_EQ(3, aggregator.numberOfRegulators());
+	ASSERT_EQ(2, aggregator.numberOfResults());
+	EXPECT_EQ("A", aggregator.name(0));
+	EXPECT_EQ("B", aggregator.name(1));
+	EXPECT_EQ("C", aggregator.name(2));
+
+	// Missing results are stored per run with the default values
+	EXPECT_EQ(0.01, aggregator.pValues(0)[0]);
+	EXPECT_EQ(0.04, aggregator.pValues(0)[1]);
+	EXPECT_EQ(0.2, aggregator.pValues(1)[0]);
+	EXPECT_EQ(1.0, aggregator.pValues(1)[1]);
+	EXPECT_EQ(1.0, aggregator.pValues(2)[0]);
+	EXPECT_EQ(0.05, aggregator.pValues(2)[1]);
+
+	EXPECT_EQ(2, aggregator.ranks(1)[0]);
+	EXPECT_EQ(3, aggregator.ranks(1)[1]);
+	EXPECT_EQ(3, aggregator.ranks(2)[0]);
+	EXPECT_EQ(1, aggregator.ranks(2)[1]);
+
+	aggregator.aggregateRanks(std::string("sum"));
+	EXPECT_EQ(3, aggregator.rankSum(0));
+	EXPECT_EQ(5, aggregator.rankSum(1));
+	EXPECT_EQ(4, aggregator.rankSum(2));
+}
+
+TEST_F(RegulatorEffectResultAggregatorTest, aggregatePValues)
+{
+	RegulatorEffectResultAggregator aggregator;
+	aggregator.read_results(list_);
+
+	aggregator.aggregatePValues(std::string("max"));
+	EXPECT_EQ(0.04, aggregator.aggregatedPValue(0));
+	EXPECT_EQ(1.0, aggregator.aggregatedPValue(1));
+
+	aggregator.aggregatePValues(std::string("second-order"));
+	EXPECT_EQ(0.04, aggregator.aggregatedPValue(0));
+	EXPECT_EQ(1.0, aggregator.aggregatedPValue(2));
+
+	aggregator.aggregatePValues(std::string("fisher"));
+	boost::math::chi_squared chi2(4);
+	const double fisher = boost::math::cdf(boost::math::complement(
+	    chi2, -2.0 * (std::log(0.01) + std::log(0.04))));
+	EXPECT_NEAR(fisher, aggregator.aggregatedPValue(0), 1e-12);
+
+	aggregator.aggregatePValues(std::string("stouffer"));
+	boost::math::normal normal;
+	const double z = (quantile(complement(normal, 0.2)) +
+	                  quantile(complement(normal, std::nextafter(1.0, 0.0)))) /
+	               std::sqrt(2.0);
+	EXPECT_NEAR(boost::math::cdf(boost::math::complement(normal, z)),
+	            aggregator.aggregatedPValue(1), 1e-12);
+
+	EXPECT_THROW(aggregator.aggregatePValues(std::string("unknown")), NotImplemented);
+}
+
+TEST_F(RegulatorEffectResultAggregatorTest, invalidResult)
+{
+	std::ofstream out(list_);
+	out << TEST_DATA_PATH("reggae_result_invalid.json") << '\n';
+	out.close();
+
+	RegulatorEffectResultAggregator aggregator;
+	EXPECT_THROW(aggregator.read_results(list_), IOError);
+}